@@ -0,0 +1,114 @@
+package fileutils
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"strconv"
+	"sync/atomic"
+
+	"golang.org/x/sys/unix"
+)
+
+// tmpfileCounter makes the names atomicWriteTmpfile links temporary files under unique within the process.
+var tmpfileCounter atomic.Uint64
+
+// atomicWriteTmpfile writes data to an O_TMPFILE file in the directory of path, and links it to path.
+// It returns false without error when the kernel or the filesystem does not support O_TMPFILE, or when
+// /proc is not available to link the file, so that the caller can fall back to a named temporary file.
+func atomicWriteTmpfile(path string, data []byte, filePerm os.FileMode, policy SyncPolicy) (done bool, err error) {
+	dir := filepath.Dir(path)
+	perm := uint32(0600)
+	if filePerm != 0 {
+		perm = uint32(filePerm.Perm())
+	}
+
+	fd, err := unix.Open(dir, unix.O_TMPFILE|unix.O_WRONLY|unix.O_CLOEXEC, perm)
+	if isUnsupported(err) {
+		return false, nil
+	}
+	if err != nil {
+		return false, fmt.Errorf("could not create temporary file: %v", err)
+	}
+	f := os.NewFile(uintptr(fd), dir)
+	defer f.Close()
+
+	if _, err := f.Write(data); err != nil {
+		return false, fmt.Errorf("could not write to temporary file: %v", err)
+	}
+
+	// The mode of the file is only masked by the umask at creation.
+	if filePerm != 0 {
+		if err := f.Chmod(filePerm); err != nil {
+			return false, fmt.Errorf("could not set permissions on file: %v", err)
+		}
+	}
+
+	if policy >= SyncFile {
+		if err := f.Sync(); err != nil {
+			return false, fmt.Errorf("could not sync temporary file: %v", err)
+		}
+	}
+
+	// linkat can only link to a free name: link straight to path when it does not exist yet,
+	// otherwise link next to it and rename over it.
+	procPath := "/proc/self/fd/" + strconv.Itoa(fd)
+	err = unix.Linkat(unix.AT_FDCWD, procPath, unix.AT_FDCWD, path, unix.AT_SYMLINK_FOLLOW)
+	if errors.Is(err, unix.EEXIST) {
+		err = linkAndRename(procPath, path)
+	}
+	if errors.Is(err, unix.ENOENT) {
+		if _, e := os.Stat(dir); e == nil {
+			// The directory is there, so it is /proc which is missing.
+			return false, nil
+		}
+	}
+	if err != nil {
+		return false, fmt.Errorf("could not link temporary file: %v", err)
+	}
+
+	if policy >= SyncFileAndDir {
+		if err := syncDir(dir); err != nil {
+			return true, fmt.Errorf("could not sync directory: %v", err)
+		}
+	}
+	return true, nil
+}
+
+// linkAndRename links the file at procPath to a free temporary name next to path, and renames it over path.
+func linkAndRename(procPath, path string) error {
+	prefix := filepath.Join(filepath.Dir(path), ".tmp-"+strconv.Itoa(os.Getpid())+"-")
+	for {
+		tmp := prefix + strconv.FormatUint(tmpfileCounter.Add(1), 10) + ".tmp"
+		err := unix.Linkat(unix.AT_FDCWD, procPath, unix.AT_FDCWD, tmp, unix.AT_SYMLINK_FOLLOW)
+		if errors.Is(err, unix.EEXIST) {
+			// Left over by a process which had our pid, or in another pid namespace.
+			continue
+		}
+		if err != nil {
+			return err
+		}
+
+		if err := os.Rename(tmp, path); err != nil {
+			_ = os.Remove(tmp)
+			return err
+		}
+		return nil
+	}
+}
+
+// isUnsupported returns true if err is how open reports that O_TMPFILE is not supported.
+func isUnsupported(err error) bool {
+	return errors.Is(err, unix.EOPNOTSUPP) || errors.Is(err, unix.EISDIR) || errors.Is(err, unix.EINVAL)
+}
+
+// syncDir flushes the entries of the directory dir to disk.
+func syncDir(dir string) error {
+	d, err := os.Open(dir)
+	if err != nil {
+		return err
+	}
+	defer d.Close()
+	return d.Sync()
+}
@@ -0,0 +1,27 @@
+//go:build !linux
+
+package fileutils
+
+import (
+	"os"
+	"runtime"
+)
+
+// atomicWriteTmpfile is not supported outside Linux, so that atomic writes always go through a named temporary file.
+func atomicWriteTmpfile(string, []byte, os.FileMode, SyncPolicy) (bool, error) {
+	return false, nil
+}
+
+// syncDir flushes the entries of the directory dir to disk.
+// Directories can't be flushed on Windows, where it does nothing.
+func syncDir(dir string) error {
+	if runtime.GOOS == "windows" {
+		return nil
+	}
+	d, err := os.Open(dir)
+	if err != nil {
+		return err
+	}
+	defer d.Close()
+	return d.Sync()
+}
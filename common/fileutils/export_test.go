@@ -0,0 +1,8 @@
+package fileutils
+
+// WithoutTmpfile makes atomic writes go through a named temporary file, as where O_TMPFILE is not supported.
+func WithoutTmpfile() AtomicWriteOption {
+	return func(o *atomicWriteOptions) {
+		o.noTmpfile = true
+	}
+}
@@ -10,35 +10,83 @@ import (
 	"strings"
 )
 
+// SyncPolicy is how durable an atomic write is once it returns.
+type SyncPolicy int
+
+const (
+	// SyncNone leaves flushing the file to the kernel: the write is atomic but can be lost on power failure.
+	SyncNone SyncPolicy = iota
+	// SyncFile flushes the file content to disk before it replaces the destination.
+	SyncFile
+	// SyncFileAndDir also flushes the directory, so that the replacement itself survives power failure.
+	SyncFileAndDir
+)
+
+type atomicWriteOptions struct {
+	sync SyncPolicy
+
+	noTmpfile bool
+}
+
+// AtomicWriteOption is a functional option to configure atomic writes.
+type AtomicWriteOption func(*atomicWriteOptions)
+
+// WithSync sets how durable the atomic write is once it returns. The default is SyncNone.
+func WithSync(policy SyncPolicy) AtomicWriteOption {
+	return func(o *atomicWriteOptions) {
+		o.sync = policy
+	}
+}
+
 // AtomicWrite writes data to a file atomically.
 // If the file already exists, then it will be overwritten.
 // Not atomic on Windows.
-func AtomicWrite(path string, data []byte) (err error) {
-	return atomicWrite(path, data, 0)
+func AtomicWrite(path string, data []byte, args ...AtomicWriteOption) (err error) {
+	return atomicWrite(path, data, 0, args...)
 }
 
 // AtomicWriteWithPerm writes data to a file atomically, creating any missing parent
 // directories with dirPerm and setting the resulting file's mode to filePerm.
 // If the file already exists, then it will be overwritten.
 // Not atomic on Windows.
-func AtomicWriteWithPerm(path string, data []byte, dirPerm, filePerm os.FileMode) (err error) {
+func AtomicWriteWithPerm(path string, data []byte, dirPerm, filePerm os.FileMode, args ...AtomicWriteOption) (err error) {
 	if err := os.MkdirAll(filepath.Dir(path), dirPerm); err != nil {
 		return fmt.Errorf("could not create directory: %v", err)
 	}
-	return atomicWrite(path, data, filePerm)
+	return atomicWrite(path, data, filePerm, args...)
 }
 
-// atomicWrite writes data to a file atomically via a temporary file and rename.
+// atomicWrite writes data to a file atomically.
 // If filePerm is non-zero, the resulting file's mode is set to filePerm; otherwise
 // the temporary file's default mode is kept.
+//
+// Where the filesystem supports it, the data is written to an unnamed temporary file which is only linked
+// into the directory once complete, so that no partial file is ever visible. Otherwise, it goes through
+// a named temporary file and rename.
 // Not atomic on Windows.
-func atomicWrite(path string, data []byte, filePerm os.FileMode) (err error) {
+func atomicWrite(path string, data []byte, filePerm os.FileMode, args ...AtomicWriteOption) (err error) {
+	var opts atomicWriteOptions
+	for _, opt := range args {
+		opt(&opts)
+	}
+
+	if !opts.noTmpfile {
+		done, err := atomicWriteTmpfile(path, data, filePerm, opts.sync)
+		if done || err != nil {
+			return err
+		}
+	}
+
 	tmp, err := os.CreateTemp(filepath.Dir(path), "tmp-*.tmp")
 	if err != nil {
 		return fmt.Errorf("could not create temporary file: %v", err)
 	}
+	renamed := false
 	defer func() {
 		_ = tmp.Close()
+		if renamed {
+			return
+		}
 		if e := os.Remove(tmp.Name()); e != nil && !os.IsNotExist(e) {
 			err = fmt.Errorf("failed to remove temporary file %s: %v", tmp.Name(), e)
 		}
@@ -48,6 +96,12 @@ func atomicWrite(path string, data []byte, filePerm os.FileMode) (err error) {
 		return fmt.Errorf("could not write to temporary file: %v", err)
 	}
 
+	if opts.sync >= SyncFile {
+		if err := tmp.Sync(); err != nil {
+			return fmt.Errorf("could not sync temporary file: %v", err)
+		}
+	}
+
 	if err := tmp.Close(); err != nil {
 		return fmt.Errorf("could not close temporary file: %v", err)
 	}
@@ -55,12 +109,19 @@ func atomicWrite(path string, data []byte, filePerm os.FileMode) (err error) {
 	if err := os.Rename(tmp.Name(), path); err != nil {
 		return fmt.Errorf("could not rename temporary file: %v", err)
 	}
+	renamed = true
 
 	if filePerm != 0 {
 		if err := os.Chmod(path, filePerm); err != nil {
 			return fmt.Errorf("could not set permissions on file: %v", err)
 		}
 	}
+
+	if opts.sync >= SyncFileAndDir {
+		if err := syncDir(filepath.Dir(path)); err != nil {
+			return fmt.Errorf("could not sync directory: %v", err)
+		}
+	}
 	return nil
 }
 
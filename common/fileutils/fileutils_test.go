@@ -21,6 +21,8 @@ func TestAtomicWrite(t *testing.T) {
 		fileExists      bool
 		fileExistsPerms os.FileMode
 		invalidDir      bool
+		sync            fileutils.SyncPolicy
+		noTmpfile       bool
 
 		wantError bool
 	}{
@@ -35,6 +37,15 @@ func TestAtomicWrite(t *testing.T) {
 		"Override read-only file": {data: []byte("data"), fileExistsPerms: 0400, fileExists: true, wantError: runtime.GOOS == "windows"},
 		"Override No Perms file":  {data: []byte("data"), fileExistsPerms: 0000, fileExists: true, wantError: runtime.GOOS == "windows"},
 		"Invalid Dir":             {data: []byte("data"), invalidDir: true, wantError: true},
+
+		"Syncs file":                      {data: []byte("data"), sync: fileutils.SyncFile},
+		"Syncs file and dir":              {data: []byte("data"), sync: fileutils.SyncFileAndDir},
+		"Syncs file and dir on override":  {data: []byte("data"), fileExistsPerms: 0600, fileExists: true, sync: fileutils.SyncFileAndDir},
+		"Without tmpfile":                 {data: []byte("data"), noTmpfile: true},
+		"Without tmpfile override file":   {data: []byte("data"), fileExistsPerms: 0600, fileExists: true, noTmpfile: true},
+		"Without tmpfile syncs file":      {data: []byte("data"), sync: fileutils.SyncFile, noTmpfile: true},
+		"Without tmpfile syncs file, dir": {data: []byte("data"), sync: fileutils.SyncFileAndDir, noTmpfile: true},
+		"Without tmpfile invalid Dir":     {data: []byte("data"), invalidDir: true, noTmpfile: true, wantError: true},
 	}
 
 	for name, tc := range tests {
@@ -54,7 +65,12 @@ func TestAtomicWrite(t *testing.T) {
 				t.Cleanup(func() { _ = os.Chmod(path, 0600) })
 			}
 
-			err := fileutils.AtomicWrite(path, tc.data)
+			opts := []fileutils.AtomicWriteOption{fileutils.WithSync(tc.sync)}
+			if tc.noTmpfile {
+				opts = append(opts, fileutils.WithoutTmpfile())
+			}
+
+			err := fileutils.AtomicWrite(path, tc.data, opts...)
 			if tc.wantError {
 				require.Error(t, err, "AtomicWrite should return an error")
 
@@ -79,6 +95,10 @@ func TestAtomicWrite(t *testing.T) {
 			data, err := os.ReadFile(path)
 			require.NoError(t, err, "ReadFile should not return an error")
 			require.Equal(t, tc.data, data, "AtomicWrite should write the data to the file")
+
+			entries, err := os.ReadDir(tempDir)
+			require.NoError(t, err, "ReadDir should not return an error")
+			require.Len(t, entries, 1, "AtomicWrite should not leave temporary files behind")
 		})
 	}
 }
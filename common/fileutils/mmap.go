@@ -0,0 +1,124 @@
+package fileutils
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"math"
+	"os"
+	"runtime/debug"
+)
+
+// ErrFileTooLarge is returned by MapFile and WithMappedFile when the file is larger than the allowed size.
+var ErrFileTooLarge = errors.New("file is too large")
+
+// Mapping is the read-only content of a file. Regular files are mapped into memory where supported,
+// so that reading them does not allocate, and others are read into a buffer.
+type Mapping struct {
+	data  []byte
+	unmap func() error
+}
+
+// MapFile returns the content of the file at path, which must be closed after use.
+//
+// Files larger than maxSize bytes return ErrFileTooLarge without being read in full.
+// Accessing a mapped file which gets truncated meanwhile faults: files replaced by renaming over them,
+// like with AtomicWrite, are safe.
+func MapFile(path string, maxSize int64) (*Mapping, error) {
+	f, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+
+	fi, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+
+	if fi.Mode().IsRegular() {
+		if fi.Size() > maxSize {
+			return nil, fmt.Errorf("%s is %d bytes, more than %d: %w", path, fi.Size(), maxSize, ErrFileTooLarge)
+		}
+
+		data, unmap, err := mapFile(f, fi.Size())
+		if err != nil {
+			return nil, fmt.Errorf("could not map %s: %v", path, err)
+		}
+		if data != nil {
+			return &Mapping{data: data, unmap: unmap}, nil
+		}
+	}
+
+	// Not mappable: read it, without trusting its reported size.
+	limit := maxSize
+	if limit < math.MaxInt64 {
+		limit++
+	}
+	data, err := io.ReadAll(io.LimitReader(f, limit))
+	if err != nil {
+		return nil, err
+	}
+	if int64(len(data)) > maxSize {
+		return nil, fmt.Errorf("%s is more than %d bytes: %w", path, maxSize, ErrFileTooLarge)
+	}
+	return &Mapping{data: data}, nil
+}
+
+// NewMapping returns a Mapping holding data, which is not mapped from any file, for callers handing out
+// either mapped files or content held in memory.
+func NewMapping(data []byte) *Mapping {
+	return &Mapping{data: data}
+}
+
+// Bytes returns the content of the file, which is only valid until the mapping is closed.
+func (m *Mapping) Bytes() []byte {
+	return m.data
+}
+
+// Mapped reports whether the content is mapped from the file, rather than read into memory owned by Go.
+func (m *Mapping) Mapped() bool {
+	return m.unmap != nil
+}
+
+// Close releases the mapping. It is safe to call several times.
+func (m *Mapping) Close() error {
+	unmap := m.unmap
+	m.data, m.unmap = nil, nil
+	if unmap == nil {
+		return nil
+	}
+	return unmap()
+}
+
+// WithMappedFile calls fn with the content of the file at path, mapped as MapFile does.
+// data is only valid during the call, and fn must copy what it keeps.
+//
+// Files larger than maxSize bytes return ErrFileTooLarge without being read in full.
+// A fault accessing the mapping, like when the file is truncated meanwhile, is returned as an error.
+func WithMappedFile(path string, maxSize int64, fn func(data []byte) error) error {
+	m, err := MapFile(path, maxSize)
+	if err != nil {
+		return err
+	}
+	defer m.Close()
+
+	return callOnMapping(fn, m.Bytes())
+}
+
+// callOnMapping calls fn with the mapped data, turning faults accessing it into an error instead of a crash.
+func callOnMapping(fn func(data []byte) error, data []byte) (err error) {
+	defer debug.SetPanicOnFault(debug.SetPanicOnFault(true))
+	defer func() {
+		r := recover()
+		if r == nil {
+			return
+		}
+		if _, ok := r.(interface{ Addr() uintptr }); !ok {
+			panic(r)
+		}
+		err = fmt.Errorf("fault reading mapped file: %v", r)
+	}()
+
+	return fn(data)
+}
@@ -0,0 +1,124 @@
+package fileutils_test
+
+import (
+	"errors"
+	"math"
+	"os"
+	"path/filepath"
+	"runtime"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+)
+
+func TestWithMappedFile(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		content   string
+		maxSize   int64
+		noFile    bool
+		isDir     bool
+		callbackE error
+
+		wantTooLarge bool
+		wantErr      bool
+	}{
+		"Content is passed":           {content: `{"key": "value"}`, maxSize: 1024},
+		"Content of maximum size":     {content: "0123456789", maxSize: 10},
+		"Empty file is passed":        {content: "", maxSize: 10},
+		"Empty file with zero limit":  {content: "", maxSize: 0},
+		"Callback error is returned":  {content: "data", maxSize: 10, callbackE: errors.New("callback error"), wantErr: true},
+		"Errors on file too large":    {content: "0123456789a", maxSize: 10, wantTooLarge: true},
+		"Errors on missing file":      {noFile: true, maxSize: 10, wantErr: true},
+		"Errors on directory":         {isDir: true, maxSize: 10, wantErr: runtime.GOOS != "windows"},
+		"Errors on negative max size": {content: "data", maxSize: -1, wantTooLarge: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			path := filepath.Join(t.TempDir(), "file")
+			switch {
+			case tc.isDir:
+				require.NoError(t, os.Mkdir(path, 0700), "Setup: failed to create directory")
+			case !tc.noFile:
+				require.NoError(t, os.WriteFile(path, []byte(tc.content), 0600), "Setup: failed to write file")
+			}
+
+			var got string
+			called := false
+			err := fileutils.WithMappedFile(path, tc.maxSize, func(data []byte) error {
+				called = true
+				got = string(data)
+				return tc.callbackE
+			})
+			if tc.wantTooLarge {
+				require.ErrorIs(t, err, fileutils.ErrFileTooLarge, "WithMappedFile should reject files over the maximum size")
+				assert.False(t, called, "Callback should not be called for files over the maximum size")
+				return
+			}
+			if tc.callbackE != nil {
+				require.ErrorIs(t, err, tc.callbackE, "WithMappedFile should return the callback error")
+				return
+			}
+			if tc.wantErr {
+				require.Error(t, err, "WithMappedFile should return an error")
+				return
+			}
+			if tc.isDir {
+				return
+			}
+			require.NoError(t, err, "WithMappedFile should not return an error")
+			assert.True(t, called, "Callback should be called")
+			assert.Equal(t, tc.content, got, "Callback should receive the file content")
+		})
+	}
+}
+
+// faultSink keeps reads of the mapping from being optimized away.
+var faultSink byte
+
+func TestWithMappedFileTruncated(t *testing.T) {
+	t.Parallel()
+
+	if runtime.GOOS == "windows" {
+		t.Skip("Files are not mapped on Windows")
+	}
+
+	path := filepath.Join(t.TempDir(), "file")
+	require.NoError(t, os.WriteFile(path, make([]byte, 3*os.Getpagesize()), 0600), "Setup: failed to write file")
+
+	err := fileutils.WithMappedFile(path, 1<<20, func(data []byte) error {
+		require.NoError(t, os.Truncate(path, 0), "Setup: failed to truncate file")
+		faultSink = data[len(data)-1]
+		return nil
+	})
+	require.Error(t, err, "WithMappedFile should return faults reading a truncated file as errors")
+}
+
+func TestMapFile(t *testing.T) {
+	t.Parallel()
+
+	path := filepath.Join(t.TempDir(), "file")
+	require.NoError(t, os.WriteFile(path, []byte("content"), 0600), "Setup: failed to write file")
+
+	m, err := fileutils.MapFile(path, math.MaxInt64)
+	require.NoError(t, err, "MapFile should not return an error")
+	assert.Equal(t, "content", string(m.Bytes()), "MapFile should return the file content")
+	assert.Equal(t, runtime.GOOS != "windows", m.Mapped(), "MapFile should map regular files where supported")
+
+	// Replacing the file does not change the mapped content.
+	require.NoError(t, fileutils.AtomicWrite(path, []byte("replaced")), "Setup: failed to replace file")
+	assert.Equal(t, "content", string(m.Bytes()), "Mapped content should not change when the file is replaced")
+
+	require.NoError(t, m.Close(), "Close should not return an error")
+	require.NoError(t, m.Close(), "Close should be safe to call several times")
+	assert.Nil(t, m.Bytes(), "Closed mapping should hold no content")
+
+	_, err = fileutils.MapFile(path, 4)
+	require.ErrorIs(t, err, fileutils.ErrFileTooLarge, "MapFile should reject files over the maximum size")
+}
@@ -0,0 +1,145 @@
+package fileutils
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"log/slog"
+
+	"golang.org/x/sys/unix"
+)
+
+// ErrMultiline is returned when a sysfs attribute holds more than a single line.
+var ErrMultiline = errors.New("attribute spans several lines")
+
+// sysfsAttrSize is the size of a sysfs attribute, which the kernel never exceeds.
+const sysfsAttrSize = 4096
+
+// SysfsDir reads the attributes of a sysfs directory.
+//
+// The directory is opened once, and attributes are read relative to it into a buffer reused between reads,
+// instead of resolving their full path and allocating for each of them.
+// A SysfsDir is not safe for concurrent use.
+type SysfsDir struct {
+	fd   int
+	path string
+	buf  []byte
+}
+
+// OpenSysfsDir opens the sysfs directory at path, following symlinks.
+func OpenSysfsDir(path string) (*SysfsDir, error) {
+	fd, err := openDir(unix.AT_FDCWD, path)
+	if err != nil {
+		return nil, fmt.Errorf("failed to open %s: %v", path, err)
+	}
+	return &SysfsDir{fd: fd, path: path, buf: make([]byte, sysfsAttrSize)}, nil
+}
+
+// Open opens the subdirectory name of the directory, following symlinks, like the device link of a class entry.
+// The subdirectory shares the read buffer of its parent, and must not be used concurrently with it.
+func (d *SysfsDir) Open(name string) (*SysfsDir, error) {
+	fd, err := openDir(d.fd, name)
+	if err != nil {
+		return nil, fmt.Errorf("failed to open %s in %s: %v", name, d.path, err)
+	}
+	return &SysfsDir{fd: fd, path: d.path + "/" + name, buf: d.buf}, nil
+}
+
+// Path returns the path the directory was opened with.
+func (d *SysfsDir) Path() string {
+	return d.path
+}
+
+// Close closes the directory.
+func (d *SysfsDir) Close() error {
+	return unix.Close(d.fd)
+}
+
+// Read returns the value of the attribute name, without surrounding whitespace.
+// Values spanning several lines return ErrMultiline.
+func (d *SysfsDir) Read(name string) (string, error) {
+	fd, err := unix.Openat(d.fd, name, unix.O_RDONLY|unix.O_CLOEXEC, 0)
+	if err != nil {
+		return "", fmt.Errorf("failed to open %s in %s: %v", name, d.path, err)
+	}
+	defer unix.Close(fd)
+
+	n := 0
+	for n < len(d.buf) {
+		m, err := unix.Pread(fd, d.buf[n:], int64(n))
+		if err == unix.EINTR {
+			continue
+		}
+		if err != nil {
+			return "", fmt.Errorf("failed to read %s in %s: %v", name, d.path, err)
+		}
+		if m == 0 {
+			break
+		}
+		n += m
+	}
+
+	v, ok := trimSingleLine(d.buf[:n])
+	if !ok {
+		return "", fmt.Errorf("%s in %s: %w", name, d.path, ErrMultiline)
+	}
+	return string(v), nil
+}
+
+// ReadLog returns the value of the attribute name, or "" on error.
+// Failed reads are logged at the specified level, and values spanning several lines at the Warn level.
+func (d *SysfsDir) ReadLog(name string, log *slog.Logger, level slog.Level) string {
+	v, err := d.Read(name)
+	switch {
+	case errors.Is(err, ErrMultiline):
+		log.Warn("attribute contains invalid value", "attribute", name, "dir", d.path)
+	case err != nil:
+		log.Log(context.Background(), level, "failed to read attribute", "error", err)
+	}
+	return v
+}
+
+// Readlink returns the destination of the symlink name in the directory.
+func (d *SysfsDir) Readlink(name string) (string, error) {
+	n, err := unix.Readlinkat(d.fd, name, d.buf)
+	if err != nil {
+		return "", fmt.Errorf("failed to read link %s in %s: %v", name, d.path, err)
+	}
+	return string(d.buf[:n]), nil
+}
+
+func openDir(dirfd int, path string) (int, error) {
+	for {
+		fd, err := unix.Openat(dirfd, path, unix.O_RDONLY|unix.O_DIRECTORY|unix.O_CLOEXEC, 0)
+		if err != unix.EINTR {
+			return fd, err
+		}
+	}
+}
+
+// trimSingleLine returns b without surrounding ASCII whitespace, and whether what is left holds no newline.
+// It walks b only once.
+func trimSingleLine(b []byte) (v []byte, ok bool) {
+	start, end := -1, 0
+	newline := false
+	ok = true
+	for i, c := range b {
+		switch c {
+		case '\n':
+			newline = start >= 0
+		case ' ', '\t', '\r', '\v', '\f':
+		default:
+			if start < 0 {
+				start = i
+			}
+			if newline {
+				ok = false
+			}
+			end = i + 1
+		}
+	}
+	if start < 0 {
+		return b[:0], true
+	}
+	return b[start:end], ok
+}
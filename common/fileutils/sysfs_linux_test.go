@@ -0,0 +1,109 @@
+package fileutils_test
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+)
+
+func TestSysfsDirRead(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		content   string
+		noAttr    bool
+		attrIsDir bool
+
+		want          string
+		wantMultiline bool
+		wantErr       bool
+	}{
+		"Value is returned":                 {content: "Intel Corporation", want: "Intel Corporation"},
+		"Trailing newline is trimmed":       {content: "0x10de\n", want: "0x10de"},
+		"Surrounding whitespace is trimmed": {content: " \t value \r\n\n", want: "value"},
+		"Inner spaces are kept":             {content: "To Be Filled By O.E.M.\n", want: "To Be Filled By O.E.M."},
+		"Empty value is empty":              {content: "", want: ""},
+		"Whitespace only value is empty":    {content: " \n\n", want: ""},
+		"Leading newlines are trimmed":      {content: "\n\nvalue", want: "value"},
+
+		// Error cases
+		"Errors on multiline value":     {content: "first\nsecond\n", wantMultiline: true},
+		"Errors on missing attribute":   {noAttr: true, wantErr: true},
+		"Errors on directory attribute": {attrIsDir: true, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			attr := filepath.Join(dir, "attr")
+			switch {
+			case tc.attrIsDir:
+				require.NoError(t, os.Mkdir(attr, 0700), "Setup: failed to create attribute directory")
+			case !tc.noAttr:
+				require.NoError(t, os.WriteFile(attr, []byte(tc.content), 0600), "Setup: failed to write attribute")
+			}
+
+			d, err := fileutils.OpenSysfsDir(dir)
+			require.NoError(t, err, "OpenSysfsDir should not return an error")
+			defer d.Close()
+
+			got, err := d.Read("attr")
+			if tc.wantMultiline {
+				require.ErrorIs(t, err, fileutils.ErrMultiline, "Read should reject multiline values")
+				return
+			}
+			if tc.wantErr {
+				require.Error(t, err, "Read should return an error")
+				require.NotErrorIs(t, err, fileutils.ErrMultiline, "Read should not report failures as multiline values")
+				return
+			}
+			require.NoError(t, err, "Read should not return an error")
+			assert.Equal(t, tc.want, got, "Read should return the trimmed value")
+		})
+	}
+}
+
+func TestSysfsDirOpen(t *testing.T) {
+	t.Parallel()
+
+	// Mimic a class entry: a symlink to a directory with a device symlink.
+	root := t.TempDir()
+	devDir := filepath.Join(root, "devices", "d0")
+	require.NoError(t, os.MkdirAll(devDir, 0700), "Setup: failed to create device directory")
+	require.NoError(t, os.MkdirAll(filepath.Join(root, "drivers", "i915"), 0700), "Setup: failed to create driver directory")
+	require.NoError(t, os.WriteFile(filepath.Join(devDir, "vendor"), []byte("0x8086\n"), 0600), "Setup: failed to write vendor")
+	require.NoError(t, os.Symlink("../../drivers/i915", filepath.Join(devDir, "driver")), "Setup: failed to create driver symlink")
+	require.NoError(t, os.MkdirAll(filepath.Join(root, "c0"), 0700), "Setup: failed to create card directory")
+	require.NoError(t, os.Symlink("../devices/d0", filepath.Join(root, "c0", "device")), "Setup: failed to create device symlink")
+	require.NoError(t, os.Symlink("c0", filepath.Join(root, "card0")), "Setup: failed to create card symlink")
+
+	card, err := fileutils.OpenSysfsDir(filepath.Join(root, "card0"))
+	require.NoError(t, err, "OpenSysfsDir should follow symlinks")
+	defer card.Close()
+
+	dev, err := card.Open("device")
+	require.NoError(t, err, "Open should follow symlinks")
+	defer dev.Close()
+	assert.Equal(t, filepath.Join(root, "card0", "device"), dev.Path(), "Open should join the path of its parent")
+
+	vendor, err := dev.Read("vendor")
+	require.NoError(t, err, "Read should not return an error")
+	assert.Equal(t, "0x8086", vendor, "Read should return the value of the subdirectory attribute")
+
+	driver, err := dev.Readlink("driver")
+	require.NoError(t, err, "Readlink should not return an error")
+	assert.Equal(t, "../../drivers/i915", driver, "Readlink should return the link destination")
+
+	_, err = dev.Readlink("vendor")
+	require.Error(t, err, "Readlink should fail on regular files")
+	_, err = card.Open("missing")
+	require.Error(t, err, "Open should fail on missing directories")
+	_, err = fileutils.OpenSysfsDir(filepath.Join(devDir, "vendor"))
+	require.Error(t, err, "OpenSysfsDir should fail on regular files")
+}
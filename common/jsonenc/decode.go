@@ -0,0 +1,398 @@
+package jsonenc
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"strconv"
+	"unicode/utf8"
+)
+
+// ErrUnsupported is returned by generated decoders when the input is valid JSON, but not in the exact
+// shape they handle without reflection (escaped keys, type mismatches, lossy numbers, …).
+// Callers are expected to fall back to their reflection based decoding for such input.
+var ErrUnsupported = errors.New("input is not supported by the generated decoder")
+
+// maxExactInteger is the largest magnitude an integer can have while being exactly representable by
+// a float64, which is how encoding/json decodes numbers into untyped values.
+const maxExactInteger = 1 << 53
+
+// Decoder reads JSON values from a byte slice, for use by generated decoders.
+type Decoder struct {
+	data []byte
+	pos  int
+}
+
+// NewDecoder returns a Decoder reading data.
+func NewDecoder(data []byte) *Decoder {
+	return &Decoder{data: data}
+}
+
+// End checks that only whitespace is left in the input.
+func (d *Decoder) End() error {
+	d.skipSpace()
+	if d.pos != len(d.data) {
+		return d.syntaxError("unexpected data after top-level value")
+	}
+	return nil
+}
+
+// Null consumes a JSON null if it is the next value, and reports whether it did.
+func (d *Decoder) Null() bool {
+	d.skipSpace()
+	if bytes.HasPrefix(d.data[d.pos:], []byte("null")) {
+		d.pos += len("null")
+		return true
+	}
+	return false
+}
+
+// Object decodes a JSON object, calling fn for each key. fn must consume the value of the key.
+// The key is only valid for the duration of the call.
+func (d *Decoder) Object(fn func(key []byte) error) error {
+	d.skipSpace()
+	if err := d.expect('{'); err != nil {
+		return err
+	}
+	d.skipSpace()
+	if d.peek() == '}' {
+		d.pos++
+		return nil
+	}
+
+	for {
+		d.skipSpace()
+		key, err := d.key()
+		if err != nil {
+			return err
+		}
+		d.skipSpace()
+		if err := d.expect(':'); err != nil {
+			return err
+		}
+		if err := fn(key); err != nil {
+			return err
+		}
+
+		d.skipSpace()
+		switch d.peek() {
+		case ',':
+			d.pos++
+		case '}':
+			d.pos++
+			return nil
+		default:
+			return d.syntaxError("expected ',' or '}' after object value")
+		}
+	}
+}
+
+// String decodes a JSON string.
+func (d *Decoder) String() (string, error) {
+	d.skipSpace()
+	if d.peek() != '"' {
+		return "", fmt.Errorf("%w: expected string", ErrUnsupported)
+	}
+
+	start := d.pos
+	d.pos++
+	simple := true
+	for d.pos < len(d.data) {
+		c := d.data[d.pos]
+		switch {
+		case c == '"':
+			d.pos++
+			lit := d.data[start:d.pos]
+			if simple && utf8.Valid(lit) {
+				return string(lit[1 : len(lit)-1]), nil
+			}
+			// Escapes and invalid UTF-8 are rare enough to leave to encoding/json.
+			var s string
+			if err := json.Unmarshal(lit, &s); err != nil {
+				return "", err
+			}
+			return s, nil
+		case c == '\\':
+			simple = false
+			d.pos += 2
+		case c < 0x20:
+			return "", d.syntaxError("invalid character in string literal")
+		default:
+			d.pos++
+		}
+	}
+	return "", d.syntaxError("unexpected end of string literal")
+}
+
+// Bool decodes a JSON boolean.
+func (d *Decoder) Bool() (bool, error) {
+	d.skipSpace()
+	rest := d.data[d.pos:]
+	switch {
+	case bytes.HasPrefix(rest, []byte("true")):
+		d.pos += len("true")
+		return true, nil
+	case bytes.HasPrefix(rest, []byte("false")):
+		d.pos += len("false")
+		return false, nil
+	}
+	return false, fmt.Errorf("%w: expected boolean", ErrUnsupported)
+}
+
+// Int decodes a JSON integer fitting in bitSize bits.
+// Integers which could not be decoded exactly through a float64 return ErrUnsupported.
+func (d *Decoder) Int(bitSize int) (int64, error) {
+	lit, err := d.integer()
+	if err != nil {
+		return 0, err
+	}
+	n, err := strconv.ParseInt(string(lit), 10, bitSize)
+	if err != nil || n > maxExactInteger || n < -maxExactInteger {
+		return 0, fmt.Errorf("%w: integer %s out of range", ErrUnsupported, lit)
+	}
+	return n, nil
+}
+
+// Uint decodes a non-negative JSON integer fitting in bitSize bits.
+// Integers which could not be decoded exactly through a float64 return ErrUnsupported.
+func (d *Decoder) Uint(bitSize int) (uint64, error) {
+	lit, err := d.integer()
+	if err != nil {
+		return 0, err
+	}
+	n, err := strconv.ParseUint(string(lit), 10, bitSize)
+	if err != nil || n > maxExactInteger {
+		return 0, fmt.Errorf("%w: integer %s out of range", ErrUnsupported, lit)
+	}
+	return n, nil
+}
+
+// Float decodes a JSON number into a float of bitSize bits.
+func (d *Decoder) Float(bitSize int) (float64, error) {
+	raw, err := d.Raw()
+	if err != nil {
+		return 0, err
+	}
+	if c := raw[0]; c != '-' && (c < '0' || c > '9') {
+		return 0, fmt.Errorf("%w: expected number", ErrUnsupported)
+	}
+	f, err := strconv.ParseFloat(string(raw), bitSize)
+	if err != nil {
+		return 0, fmt.Errorf("%w: number %s out of range", ErrUnsupported, raw)
+	}
+	return f, nil
+}
+
+// Raw returns the next JSON value as is, after checking it is valid. The returned slice aliases the input.
+//
+// Values with escaped UTF-16 surrogates are reported as ErrUnsupported: passing them through verbatim
+// could store code points which encoding/json would have replaced.
+func (d *Decoder) Raw() ([]byte, error) {
+	d.skipSpace()
+	start := d.pos
+	if err := d.skipValue(); err != nil {
+		return nil, err
+	}
+
+	raw := d.data[start:d.pos]
+	if !json.Valid(raw) {
+		return nil, d.syntaxError("invalid value")
+	}
+	if hasEscapedSurrogate(raw) {
+		return nil, fmt.Errorf("%w: escaped surrogate in value", ErrUnsupported)
+	}
+	return raw, nil
+}
+
+// Any decodes the next JSON value with encoding/json, for free-form values without a generated decoder.
+func (d *Decoder) Any() (any, error) {
+	raw, err := d.Raw()
+	if err != nil {
+		return nil, err
+	}
+	var v any
+	if err := json.Unmarshal(raw, &v); err != nil {
+		return nil, err
+	}
+	return v, nil
+}
+
+// FoldMatch reports whether key matches any of names case-insensitively. Generated decoders use it to detect
+// keys which encoding/json would have matched to a field, but they do not handle.
+func FoldMatch(key []byte, names []string) bool {
+	for _, name := range names {
+		if bytes.EqualFold(key, []byte(name)) {
+			return true
+		}
+	}
+	return false
+}
+
+// key decodes an object key. Escaped keys are rare, and left to reflection based decoders.
+func (d *Decoder) key() ([]byte, error) {
+	if err := d.expect('"'); err != nil {
+		return nil, err
+	}
+	start := d.pos
+	for d.pos < len(d.data) {
+		c := d.data[d.pos]
+		switch {
+		case c == '"':
+			key := d.data[start:d.pos]
+			d.pos++
+			if !utf8.Valid(key) {
+				return nil, fmt.Errorf("%w: invalid UTF-8 in object key", ErrUnsupported)
+			}
+			return key, nil
+		case c == '\\':
+			return nil, fmt.Errorf("%w: escaped object key", ErrUnsupported)
+		case c < 0x20:
+			return nil, d.syntaxError("invalid character in object key")
+		}
+		d.pos++
+	}
+	return nil, d.syntaxError("unexpected end of object key")
+}
+
+// integer returns the literal of the next JSON number, which must be an integer.
+func (d *Decoder) integer() ([]byte, error) {
+	d.skipSpace()
+	start := d.pos
+	if d.peek() == '-' {
+		d.pos++
+	}
+	digits := d.pos
+	for d.pos < len(d.data) && d.data[d.pos] >= '0' && d.data[d.pos] <= '9' {
+		d.pos++
+	}
+
+	switch {
+	case d.pos == digits:
+		return nil, fmt.Errorf("%w: expected integer", ErrUnsupported)
+	case d.data[digits] == '0' && d.pos-digits > 1:
+		return nil, d.syntaxError("invalid leading zero in number")
+	}
+	switch d.peek() {
+	case '.', 'e', 'E':
+		return nil, fmt.Errorf("%w: expected integer", ErrUnsupported)
+	}
+	return d.data[start:d.pos], nil
+}
+
+// skipValue advances past the next value. It only checks the structure, Raw validates the skipped bytes.
+func (d *Decoder) skipValue() error {
+	switch d.peek() {
+	case '"':
+		return d.skipString()
+	case '{', '[':
+		depth := 0
+		for d.pos < len(d.data) {
+			switch d.data[d.pos] {
+			case '"':
+				if err := d.skipString(); err != nil {
+					return err
+				}
+				continue
+			case '{', '[':
+				depth++
+			case '}', ']':
+				depth--
+				if depth == 0 {
+					d.pos++
+					return nil
+				}
+			}
+			d.pos++
+		}
+		return d.syntaxError("unexpected end of input")
+	}
+
+	// Literals: numbers, booleans and null.
+	start := d.pos
+	for d.pos < len(d.data) && !isDelimiter(d.data[d.pos]) {
+		d.pos++
+	}
+	if d.pos == start {
+		return d.syntaxError("expected value")
+	}
+	return nil
+}
+
+// isDelimiter reports whether c ends a literal value.
+func isDelimiter(c byte) bool {
+	switch c {
+	case ',', '}', ']', ' ', '\t', '\n', '\r':
+		return true
+	}
+	return false
+}
+
+// skipString advances past a string literal, starting on its opening quote.
+func (d *Decoder) skipString() error {
+	d.pos++
+	for d.pos < len(d.data) {
+		switch d.data[d.pos] {
+		case '"':
+			d.pos++
+			return nil
+		case '\\':
+			d.pos += 2
+		default:
+			d.pos++
+		}
+	}
+	return d.syntaxError("unexpected end of string literal")
+}
+
+func (d *Decoder) expect(c byte) error {
+	if d.peek() != c {
+		return d.syntaxError(fmt.Sprintf("expected %q", c))
+	}
+	d.pos++
+	return nil
+}
+
+func (d *Decoder) peek() byte {
+	if d.pos >= len(d.data) {
+		return 0
+	}
+	return d.data[d.pos]
+}
+
+func (d *Decoder) skipSpace() {
+	for d.pos < len(d.data) {
+		switch d.data[d.pos] {
+		case ' ', '\t', '\n', '\r':
+			d.pos++
+		default:
+			return
+		}
+	}
+}
+
+func (d *Decoder) syntaxError(msg string) error {
+	return fmt.Errorf("invalid JSON at offset %d: %s", d.pos, msg)
+}
+
+// hasEscapedSurrogate reports whether raw contains a \uD800-\uDFFF escape.
+func hasEscapedSurrogate(raw []byte) bool {
+	for i := bytes.Index(raw, []byte(`\u`)); i >= 0; {
+		// Skip escaped backslashes, so that \\u is not taken for an escape.
+		bs := 0
+		for j := i - 1; j >= 0 && raw[j] == '\\'; j-- {
+			bs++
+		}
+		if bs%2 == 0 && i+3 < len(raw) && (raw[i+2] == 'd' || raw[i+2] == 'D') {
+			if c := raw[i+3] | 0x20; c >= '8' && c <= '9' || c >= 'a' && c <= 'f' {
+				return true
+			}
+		}
+		next := bytes.Index(raw[i+2:], []byte(`\u`))
+		if next < 0 {
+			return false
+		}
+		i += 2 + next
+	}
+	return false
+}
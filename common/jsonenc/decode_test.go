@@ -0,0 +1,166 @@
+package jsonenc_test
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// decodeFields decodes a flat object using the typed methods of the decoder, chosen by key.
+func decodeFields(data string) (map[string]any, error) {
+	got := make(map[string]any)
+	d := jsonenc.NewDecoder([]byte(data))
+	err := d.Object(func(key []byte) error {
+		var v any
+		var err error
+		switch k := string(key); {
+		case d.Null():
+			v = nil
+		case k == "s":
+			v, err = d.String()
+		case k == "b":
+			v, err = d.Bool()
+		case k == "i":
+			v, err = d.Int(32)
+		case k == "u":
+			v, err = d.Uint(64)
+		case k == "f":
+			v, err = d.Float(64)
+		case k == "raw":
+			var raw []byte
+			raw, err = d.Raw()
+			v = string(raw)
+		default:
+			v, err = d.Any()
+		}
+		got[string(key)] = v
+		return err
+	})
+	if err != nil {
+		return nil, err
+	}
+	return got, d.End()
+}
+
+func TestDecoder(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		data string
+
+		want            map[string]any
+		wantUnsupported bool
+		wantErr         bool
+	}{
+		"Empty object": {
+			data: ` { } `,
+			want: map[string]any{},
+		},
+		"Typed values": {
+			data: `{"s": "text", "b": true, "i": -12, "u": 9007199254740992, "f": 1.5e3}`,
+			want: map[string]any{"s": "text", "b": true, "i": int64(-12), "u": uint64(1 << 53), "f": 1500.0},
+		},
+		"Escaped strings are decoded": {
+			data: `{"s": "a\"bé\n"}`,
+			want: map[string]any{"s": "a\"bé\n"},
+		},
+		"Null values": {
+			data: `{"s": null, "i": null}`,
+			want: map[string]any{"s": nil, "i": nil},
+		},
+		"Raw values are returned as is": {
+			data: `{"raw": {"b": [1, "]}"], "a": {}}}`,
+			want: map[string]any{"raw": `{"b": [1, "]}"], "a": {}}`},
+		},
+		"Other values are decoded with encoding/json": {
+			data: `{"other": [1, "two", {"three": false}]}`,
+			want: map[string]any{"other": []any{1.0, "two", map[string]any{"three": false}}},
+		},
+
+		// Unsupported cases
+		"Unsupported on escaped key": {
+			data:            `{"\u0073": "text"}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on type mismatch": {
+			data:            `{"s": 1}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on fractional integer": {
+			data:            `{"i": 1.0}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on integer overflow": {
+			data:            `{"i": 2147483648}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on integer beyond float precision": {
+			data:            `{"u": 9007199254740993}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on negative unsigned integer": {
+			data:            `{"u": -1}`,
+			wantUnsupported: true,
+		},
+		"Unsupported on escaped surrogate in raw value": {
+			data:            `{"raw": ["\ud83d\ude00"]}`,
+			wantUnsupported: true,
+		},
+
+		// Error cases
+		"Errors on trailing data": {
+			data:    `{} {}`,
+			wantErr: true,
+		},
+		"Errors on missing colon": {
+			data:    `{"s" "text"}`,
+			wantErr: true,
+		},
+		"Errors on unterminated object": {
+			data:    `{"s": "text"`,
+			wantErr: true,
+		},
+		"Errors on invalid raw value": {
+			data:    `{"raw": [1,]}`,
+			wantErr: true,
+		},
+		"Errors on leading zero": {
+			data:    `{"i": 012}`,
+			wantErr: true,
+		},
+		"Errors on non object": {
+			data:    `[]`,
+			wantErr: true,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := decodeFields(tc.data)
+			if tc.wantUnsupported {
+				require.ErrorIs(t, err, jsonenc.ErrUnsupported, "Decoder should report input it does not handle as unsupported")
+				return
+			}
+			if tc.wantErr {
+				require.Error(t, err, "Decoder should fail on invalid input")
+				require.NotErrorIs(t, err, jsonenc.ErrUnsupported, "Decoder should not report invalid input as unsupported")
+				return
+			}
+			require.NoError(t, err)
+			assert.Equal(t, tc.want, got, "Decoder should decode the expected values")
+		})
+	}
+}
+
+func TestFoldMatch(t *testing.T) {
+	t.Parallel()
+
+	names := []string{"insightsVersion", "sysinfo"}
+	assert.True(t, jsonenc.FoldMatch([]byte("INSIGHTSVERSION"), names), "FoldMatch should match keys case-insensitively")
+	assert.True(t, jsonenc.FoldMatch([]byte("sysinfo"), names), "FoldMatch should match exact keys")
+	assert.False(t, jsonenc.FoldMatch([]byte("other"), names), "FoldMatch should not match unknown keys")
+}
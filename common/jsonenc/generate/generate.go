@@ -0,0 +1,753 @@
+//go:build tools
+
+// Command generate writes reflection-free JSON encoders, and optionally decoders, for the structs of a Go file.
+//
+// Usage:
+//
+//	go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate [-decode] <file.go> <Type>...
+//
+// Code is generated for the given types, and for the struct types declared in the same file which they
+// reference. It is written next to the source file, as <file>_jsonenc.go, keeping any GOOS suffix last.
+//
+// Encoders follow encoding/json: the same output, json tags with omitempty and omitzero, and HTML escaping.
+// Decoders handle the exact shape of the structs only, returning jsonenc.ErrUnsupported otherwise, so that
+// callers can fall back to reflection. A map[string]any field tagged `mapstructure:",remain"` receives
+// unknown keys when decoding.
+//
+// It lives in the common module, next to the jsonenc package its output depends on, rather than with the
+// insights/C generators: the server ingest models are generated too, and the server module can't depend on insights.
+package main
+
+import (
+	"bytes"
+	"errors"
+	"flag"
+	"fmt"
+	"go/ast"
+	"go/format"
+	"go/parser"
+	"go/token"
+	"maps"
+	"os"
+	"path/filepath"
+	"reflect"
+	"slices"
+	"strconv"
+	"strings"
+
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// knownOS are the GOOS file name suffixes which must stay last in the generated file name.
+var knownOS = []string{"aix", "android", "darwin", "dragonfly", "freebsd", "illumos", "ios", "js",
+	"linux", "netbsd", "openbsd", "plan9", "solaris", "wasip1", "windows"}
+
+func main() {
+	decode := flag.Bool("decode", false, "also generate decoders")
+	flag.Parse()
+
+	if flag.NArg() < 2 {
+		fmt.Fprintln(os.Stderr, "Usage: generate [-decode] <file.go> <Type>...")
+		os.Exit(2)
+	}
+
+	if err := generate(flag.Arg(0), flag.Args()[1:], *decode); err != nil {
+		fmt.Fprintf(os.Stderr, "Failed to generate JSON encoders: %v\n", err)
+		os.Exit(1)
+	}
+}
+
+func generate(path string, types []string, decode bool) error {
+	fset := token.NewFileSet()
+	f, err := parser.ParseFile(fset, path, nil, parser.ParseComments)
+	if err != nil {
+		return err
+	}
+
+	g := newGenerator(f, decode)
+	src, err := g.run(types)
+	if err != nil {
+		return err
+	}
+
+	out := outputPath(path)
+	if err := os.WriteFile(out, src, 0600); err != nil {
+		return fmt.Errorf("could not write %s: %v", out, err)
+	}
+	return nil
+}
+
+// outputPath returns the generated file path for a source file, keeping the GOOS suffix last.
+func outputPath(path string) string {
+	base := strings.TrimSuffix(filepath.Base(path), ".go")
+	suffix := ""
+	if i := strings.LastIndexByte(base, '_'); i >= 0 && slices.Contains(knownOS, base[i+1:]) {
+		base, suffix = base[:i], base[i:]
+	}
+	return filepath.Join(filepath.Dir(path), base+"_jsonenc"+suffix+".go")
+}
+
+// field is a struct field as seen by encoding/json.
+type field struct {
+	name      string
+	key       string
+	omitEmpty bool
+	omitZero  bool
+	remain    bool
+	typ       ast.Expr
+}
+
+type generator struct {
+	file    *ast.File
+	decode  bool
+	structs map[string]*ast.StructType
+	imports map[string]string // package name to import path
+	json    string            // local name of encoding/json
+
+	usedImports map[string]bool
+	zeroFuncs   []string // non comparable types needing a generated zero check
+	needErr     bool
+}
+
+func newGenerator(f *ast.File, decode bool) *generator {
+	g := &generator{
+		file:        f,
+		decode:      decode,
+		structs:     make(map[string]*ast.StructType),
+		imports:     make(map[string]string),
+		usedImports: make(map[string]bool),
+	}
+
+	for _, imp := range f.Imports {
+		p, _ := strconv.Unquote(imp.Path.Value)
+		name := filepath.Base(p)
+		if imp.Name != nil {
+			name = imp.Name.Name
+		}
+		g.imports[name] = p
+		if p == "encoding/json" {
+			g.json = name
+		}
+	}
+
+	ast.Inspect(f, func(n ast.Node) bool {
+		if ts, ok := n.(*ast.TypeSpec); ok {
+			if st, ok := ts.Type.(*ast.StructType); ok && ts.TypeParams == nil {
+				g.structs[ts.Name.Name] = st
+			}
+		}
+		return true
+	})
+
+	return g
+}
+
+// run generates the formatted source for the given types and the local structs they reference.
+func (g *generator) run(types []string) ([]byte, error) {
+	order, err := g.closure(types)
+	if err != nil {
+		return nil, err
+	}
+
+	var body bytes.Buffer
+	for _, name := range order {
+		if err := g.writeEncoder(&body, name); err != nil {
+			return nil, fmt.Errorf("%s: %v", name, err)
+		}
+		if g.decode {
+			if err := g.writeDecoder(&body, name); err != nil {
+				return nil, fmt.Errorf("%s: %v", name, err)
+			}
+		}
+	}
+	for i := 0; i < len(g.zeroFuncs); i++ {
+		// Writing a zero check may require others, appended as we go.
+		if err := g.writeZeroFunc(&body, g.zeroFuncs[i]); err != nil {
+			return nil, fmt.Errorf("%s: %v", g.zeroFuncs[i], err)
+		}
+	}
+
+	var out bytes.Buffer
+	fmt.Fprintf(&out, "// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.\n\n")
+	for _, c := range g.file.Comments {
+		if c.Pos() >= g.file.Package {
+			break
+		}
+		for _, l := range c.List {
+			if strings.HasPrefix(l.Text, "//go:build") {
+				fmt.Fprintf(&out, "%s\n\n", l.Text)
+			}
+		}
+	}
+	fmt.Fprintf(&out, "package %s\n\n", g.file.Name.Name)
+
+	var imports []string
+	if bytes.Contains(body.Bytes(), []byte("jsonenc.")) {
+		imports = append(imports, strconv.Quote("github.com/ubuntu/ubuntu-insights/common/jsonenc"))
+	}
+	for _, name := range slices.Sorted(maps.Keys(g.usedImports)) {
+		if p := g.imports[name]; filepath.Base(p) != name {
+			imports = append(imports, name+" "+strconv.Quote(p))
+		} else {
+			imports = append(imports, strconv.Quote(p))
+		}
+	}
+	if len(imports) > 0 {
+		fmt.Fprintf(&out, "import (\n%s\n)\n\n", strings.Join(imports, "\n"))
+	}
+	out.Write(body.Bytes())
+
+	src, err := format.Source(out.Bytes())
+	if err != nil {
+		return nil, fmt.Errorf("generated invalid code: %v\n%s", err, out.Bytes())
+	}
+	return src, nil
+}
+
+// closure returns the requested types followed by the local struct types they reference, in a stable order.
+func (g *generator) closure(types []string) ([]string, error) {
+	var order []string
+	seen := make(map[string]bool)
+	var visit func(name string) error
+	visit = func(name string) error {
+		if seen[name] {
+			return nil
+		}
+		st, ok := g.structs[name]
+		if !ok {
+			return fmt.Errorf("no struct type %q in file", name)
+		}
+		seen[name] = true
+		order = append(order, name)
+
+		for _, f := range st.Fields.List {
+			for _, ref := range g.localRefs(f.Type) {
+				if err := visit(ref); err != nil {
+					return err
+				}
+			}
+		}
+		return nil
+	}
+
+	for _, t := range types {
+		if err := visit(t); err != nil {
+			return nil, err
+		}
+	}
+	return order, nil
+}
+
+// localRefs returns the local struct types referenced by t.
+func (g *generator) localRefs(t ast.Expr) []string {
+	switch t := t.(type) {
+	case *ast.Ident:
+		if _, ok := g.structs[t.Name]; ok {
+			return []string{t.Name}
+		}
+	case *ast.ArrayType:
+		return g.localRefs(t.Elt)
+	case *ast.StarExpr:
+		return g.localRefs(t.X)
+	}
+	return nil
+}
+
+// jsonFields returns the fields of a struct as encoding/json sees them.
+func (g *generator) jsonFields(st *ast.StructType) ([]field, error) {
+	var fields []field
+	for _, f := range st.Fields.List {
+		if len(f.Names) == 0 {
+			return nil, errors.New("embedded fields are not supported")
+		}
+
+		var tag reflect.StructTag
+		if f.Tag != nil {
+			t, err := strconv.Unquote(f.Tag.Value)
+			if err != nil {
+				return nil, err
+			}
+			tag = reflect.StructTag(t)
+		}
+		jsonTag := tag.Get("json")
+		if jsonTag == "-" {
+			continue
+		}
+		key, opts, _ := strings.Cut(jsonTag, ",")
+		optList := strings.Split(opts, ",")
+		remain := slices.Contains(strings.Split(tag.Get("mapstructure"), ","), "remain")
+
+		for _, n := range f.Names {
+			if !n.IsExported() {
+				continue
+			}
+			k := key
+			if k == "" {
+				k = n.Name
+			}
+			fields = append(fields, field{
+				name:      n.Name,
+				key:       k,
+				omitEmpty: slices.Contains(optList, "omitempty"),
+				omitZero:  slices.Contains(optList, "omitzero"),
+				remain:    remain,
+				typ:       f.Type,
+			})
+		}
+	}
+	return fields, nil
+}
+
+// commaState tracks whether a separator must be written before the next field.
+type commaState int
+
+const (
+	noComma    commaState = iota // nothing written yet
+	needComma                    // a field was always written before
+	maybeComma                   // known at run time only, through the comma variable
+)
+
+func (g *generator) writeEncoder(w *bytes.Buffer, name string) error {
+	fields, err := g.jsonFields(g.structs[name])
+	if err != nil {
+		return err
+	}
+
+	conds := make([]string, len(fields))
+	states := make([]commaState, len(fields))
+	state := noComma
+	for i, f := range fields {
+		if conds[i], err = g.writeCondition("v."+f.name, f); err != nil {
+			return fmt.Errorf("field %s: %v", f.name, err)
+		}
+		states[i] = state
+		switch {
+		case conds[i] == "":
+			state = needComma
+		case state == noComma:
+			state = maybeComma
+		}
+	}
+
+	g.needErr = false
+	var body bytes.Buffer
+	if slices.Contains(states, maybeComma) {
+		fmt.Fprintf(&body, "comma := false\n")
+	}
+	fmt.Fprintf(&body, "dst = append(dst, '{')\n")
+	for i, f := range fields {
+		if conds[i] != "" {
+			fmt.Fprintf(&body, "if %s {\n", conds[i])
+		}
+
+		key := string(jsonenc.AppendString(nil, f.key)) + ":"
+		switch states[i] {
+		case needComma:
+			key = "," + key
+		case maybeComma:
+			fmt.Fprintf(&body, "if comma {\ndst = append(dst, ',')\n}\n")
+		}
+		fmt.Fprintf(&body, "dst = append(dst, %s...)\n", goString(key))
+
+		// Omitted fields are never nil when written, sparing a check.
+		if err := g.writeValue(&body, "v."+f.name, f.typ, 0, conds[i] != ""); err != nil {
+			return fmt.Errorf("field %s: %v", f.name, err)
+		}
+
+		if conds[i] != "" {
+			if slices.Contains(states[i+1:], maybeComma) {
+				fmt.Fprintf(&body, "comma = true\n")
+			}
+			fmt.Fprintf(&body, "}\n")
+		}
+	}
+	fmt.Fprintf(&body, "dst = append(dst, '}')\nreturn dst, nil\n")
+
+	fmt.Fprintf(w, "// AppendJSON appends the JSON encoding of v to dst.\n")
+	fmt.Fprintf(w, "func (v %s) AppendJSON(dst []byte) ([]byte, error) {\n", name)
+	if g.needErr {
+		fmt.Fprintf(w, "var err error\n")
+	}
+	w.Write(body.Bytes())
+	fmt.Fprintf(w, "}\n\n")
+
+	fmt.Fprintf(w, "// MarshalJSON implements json.Marshaler with the generated encoder.\n")
+	fmt.Fprintf(w, "func (v %s) MarshalJSON() ([]byte, error) {\nreturn v.AppendJSON(nil)\n}\n\n", name)
+	return nil
+}
+
+// writeValue writes the code appending the JSON encoding of expr, of type t, to dst.
+// If nonNil is set, expr is known not to be a nil slice.
+func (g *generator) writeValue(w *bytes.Buffer, expr string, t ast.Expr, depth int, nonNil bool) error {
+	switch t := t.(type) {
+	case *ast.Ident:
+		switch t.Name {
+		case "string":
+			fmt.Fprintf(w, "dst = jsonenc.AppendString(dst, %s)\n", expr)
+		case "bool":
+			fmt.Fprintf(w, "dst = jsonenc.AppendBool(dst, %s)\n", expr)
+		case "int64":
+			fmt.Fprintf(w, "dst = jsonenc.AppendInt(dst, %s)\n", expr)
+		case "int", "int8", "int16", "int32":
+			fmt.Fprintf(w, "dst = jsonenc.AppendInt(dst, int64(%s))\n", expr)
+		case "uint64":
+			fmt.Fprintf(w, "dst = jsonenc.AppendUint(dst, %s)\n", expr)
+		case "uint", "uint8", "uint16", "uint32":
+			fmt.Fprintf(w, "dst = jsonenc.AppendUint(dst, uint64(%s))\n", expr)
+		case "float32":
+			g.writeCall(w, fmt.Sprintf("jsonenc.AppendFloat(dst, float64(%s), 32)", expr))
+		case "float64":
+			g.writeCall(w, fmt.Sprintf("jsonenc.AppendFloat(dst, %s, 64)", expr))
+		case "any":
+			g.writeCall(w, fmt.Sprintf("jsonenc.AppendAny(dst, %s)", expr))
+		default:
+			if _, ok := g.structs[t.Name]; !ok {
+				return fmt.Errorf("unsupported type %s", t.Name)
+			}
+			g.writeCall(w, fmt.Sprintf("%s.AppendJSON(dst)", expr))
+		}
+	case *ast.SelectorExpr:
+		if g.isRawMessage(t) {
+			g.writeCall(w, fmt.Sprintf("jsonenc.AppendRaw(dst, %s)", expr))
+			return nil
+		}
+		// Types of other packages are expected to have a generated encoder too.
+		g.writeCall(w, fmt.Sprintf("%s.AppendJSON(dst)", expr))
+	case *ast.ArrayType:
+		if t.Len != nil {
+			return errors.New("arrays are not supported")
+		}
+		if id, ok := t.Elt.(*ast.Ident); ok && (id.Name == "byte" || id.Name == "uint8") {
+			return errors.New("byte slices are not supported")
+		}
+		i, e := fmt.Sprintf("i%d", depth), fmt.Sprintf("e%d", depth)
+		if !nonNil {
+			fmt.Fprintf(w, "if %s == nil {\ndst = append(dst, \"null\"...)\n} else {\n", expr)
+		}
+		fmt.Fprintf(w, "dst = append(dst, '[')\nfor %s, %s := range %s {\n", i, e, expr)
+		fmt.Fprintf(w, "if %s > 0 {\ndst = append(dst, ',')\n}\n", i)
+		if err := g.writeValue(w, e, t.Elt, depth+1, false); err != nil {
+			return err
+		}
+		fmt.Fprintf(w, "}\ndst = append(dst, ']')\n")
+		if !nonNil {
+			fmt.Fprintf(w, "}\n")
+		}
+	case *ast.MapType:
+		if id, ok := t.Key.(*ast.Ident); !ok || id.Name != "string" {
+			return errors.New("only maps with string keys are supported")
+		}
+		// Maps are free-form by nature and sorted by encoding/json.
+		g.writeCall(w, fmt.Sprintf("jsonenc.AppendAny(dst, %s)", expr))
+	case *ast.InterfaceType:
+		g.writeCall(w, fmt.Sprintf("jsonenc.AppendAny(dst, %s)", expr))
+	default:
+		return fmt.Errorf("unsupported type %T", t)
+	}
+	return nil
+}
+
+// writeCall writes an appending call which can fail.
+func (g *generator) writeCall(w *bytes.Buffer, call string) {
+	g.needErr = true
+	fmt.Fprintf(w, "if dst, err = %s; err != nil {\nreturn dst, err\n}\n", call)
+}
+
+// writeCondition returns the condition under which the field is written, or "" if it always is.
+func (g *generator) writeCondition(expr string, f field) (string, error) {
+	var conds []string
+	if f.omitEmpty {
+		if c := g.nonEmpty(expr, f.typ); c != "" {
+			conds = append(conds, c)
+		}
+	}
+	if f.omitZero {
+		c, err := g.nonZero(expr, f.typ)
+		if err != nil {
+			return "", err
+		}
+		conds = append(conds, c)
+	}
+	return strings.Join(conds, " && "), nil
+}
+
+// nonEmpty returns the omitempty condition of encoding/json. Structs are never empty.
+func (g *generator) nonEmpty(expr string, t ast.Expr) string {
+	switch t := t.(type) {
+	case *ast.Ident:
+		switch {
+		case t.Name == "string":
+			return expr + ` != ""`
+		case t.Name == "bool":
+			return expr
+		case isNumber(t.Name):
+			return expr + " != 0"
+		case t.Name == "any":
+			return expr + " != nil"
+		}
+	case *ast.SelectorExpr:
+		if g.isRawMessage(t) {
+			return "len(" + expr + ") != 0"
+		}
+	case *ast.ArrayType, *ast.MapType:
+		return "len(" + expr + ") != 0"
+	case *ast.StarExpr, *ast.InterfaceType:
+		return expr + " != nil"
+	}
+	return ""
+}
+
+// nonZero returns the omitzero condition of encoding/json.
+func (g *generator) nonZero(expr string, t ast.Expr) (string, error) {
+	switch t := t.(type) {
+	case *ast.Ident:
+		switch {
+		case t.Name == "string":
+			return expr + ` != ""`, nil
+		case t.Name == "bool":
+			return expr, nil
+		case isNumber(t.Name):
+			return expr + " != 0", nil
+		case t.Name == "any":
+			return expr + " != nil", nil
+		}
+		if _, ok := g.structs[t.Name]; !ok {
+			return "", fmt.Errorf("unsupported type %s", t.Name)
+		}
+		if g.comparable(t.Name, nil) {
+			return fmt.Sprintf("%s != (%s{})", expr, t.Name), nil
+		}
+		if !slices.Contains(g.zeroFuncs, t.Name) {
+			g.zeroFuncs = append(g.zeroFuncs, t.Name)
+		}
+		return "!" + expr + ".jsonencIsZero()", nil
+	case *ast.SelectorExpr:
+		if g.isRawMessage(t) {
+			return expr + " != nil", nil
+		}
+		// Types of other packages are expected to be comparable.
+		pkg, ok := t.X.(*ast.Ident)
+		if !ok {
+			return "", fmt.Errorf("unsupported type %T", t.X)
+		}
+		g.usedImports[pkg.Name] = true
+		return fmt.Sprintf("%s != (%s.%s{})", expr, pkg.Name, t.Sel.Name), nil
+	case *ast.ArrayType, *ast.MapType, *ast.StarExpr, *ast.InterfaceType:
+		return expr + " != nil", nil
+	}
+	return "", fmt.Errorf("unsupported type %T", t)
+}
+
+// isZero returns the negation of a nonZero condition.
+func isZero(nonZero string) string {
+	switch {
+	case strings.HasSuffix(nonZero, " != nil"):
+		return strings.TrimSuffix(nonZero, " != nil") + " == nil"
+	case strings.HasSuffix(nonZero, ` != ""`):
+		return strings.TrimSuffix(nonZero, ` != ""`) + ` == ""`
+	case strings.HasSuffix(nonZero, " != 0"):
+		return strings.TrimSuffix(nonZero, " != 0") + " == 0"
+	case strings.Contains(nonZero, " != ("):
+		return strings.Replace(nonZero, " != (", " == (", 1)
+	case strings.HasPrefix(nonZero, "!"):
+		return strings.TrimPrefix(nonZero, "!")
+	}
+	return "!" + nonZero
+}
+
+// writeZeroFunc writes the zero check of a non comparable struct, considering all its fields like reflect.Value.IsZero.
+func (g *generator) writeZeroFunc(w *bytes.Buffer, name string) error {
+	var conds []string
+	for _, f := range g.structs[name].Fields.List {
+		for _, n := range f.Names {
+			c, err := g.nonZero("v."+n.Name, f.Type)
+			if err != nil {
+				return fmt.Errorf("field %s: %v", n.Name, err)
+			}
+			conds = append(conds, isZero(c))
+		}
+	}
+	if len(conds) == 0 {
+		conds = []string{"true"}
+	}
+
+	fmt.Fprintf(w, "// jsonencIsZero reports whether v is the zero value, for omitzero.\n")
+	fmt.Fprintf(w, "func (v %s) jsonencIsZero() bool {\nreturn %s\n}\n\n", name, strings.Join(conds, " &&\n"))
+	return nil
+}
+
+// comparable reports whether a local struct type can be compared with ==.
+func (g *generator) comparable(name string, seen map[string]bool) bool {
+	if seen == nil {
+		seen = make(map[string]bool)
+	}
+	if seen[name] {
+		return true
+	}
+	seen[name] = true
+
+	for _, f := range g.structs[name].Fields.List {
+		switch t := f.Type.(type) {
+		case *ast.ArrayType:
+			if t.Len == nil {
+				return false
+			}
+		case *ast.MapType, *ast.FuncType:
+			return false
+		case *ast.SelectorExpr:
+			if g.isRawMessage(t) {
+				return false
+			}
+		case *ast.Ident:
+			if _, ok := g.structs[t.Name]; ok && !g.comparable(t.Name, seen) {
+				return false
+			}
+		}
+	}
+	return true
+}
+
+func (g *generator) writeDecoder(w *bytes.Buffer, name string) error {
+	fields, err := g.jsonFields(g.structs[name])
+	if err != nil {
+		return err
+	}
+
+	var remain *field
+	var keys []string
+	var cases bytes.Buffer
+	for _, f := range fields {
+		if f.remain {
+			if m, ok := f.typ.(*ast.MapType); !ok || !isIdent(m.Key, "string") || !isIdent(m.Value, "any") {
+				return fmt.Errorf("field %s: remain fields must be map[string]any", f.name)
+			}
+			remain = &f
+			continue
+		}
+		keys = append(keys, f.key)
+		fmt.Fprintf(&cases, "case %s:\n", strconv.Quote(f.key))
+		if err := g.writeDecodeValue(&cases, "v."+f.name, f.typ); err != nil {
+			return fmt.Errorf("field %s: %v", f.name, err)
+		}
+	}
+
+	keysVar := lowerFirst(name) + "JSONKeys"
+	fmt.Fprintf(w, "// %s are the keys decoded into fields of %s.\n", keysVar, name)
+	fmt.Fprintf(w, "var %s = []string{", keysVar)
+	for _, k := range keys {
+		fmt.Fprintf(w, "%s, ", strconv.Quote(k))
+	}
+	fmt.Fprintf(w, "}\n\n")
+
+	fmt.Fprintf(w, "// DecodeJSON decodes the JSON object in data into v, with the generated decoder.\n")
+	fmt.Fprintf(w, "// Raw JSON fields alias data. Valid input of another shape returns jsonenc.ErrUnsupported.\n")
+	fmt.Fprintf(w, "func (v *%s) DecodeJSON(data []byte) error {\n", name)
+	fmt.Fprintf(w, "d := jsonenc.NewDecoder(data)\nif err := v.DecodeJSONFrom(d); err != nil {\nreturn err\n}\nreturn d.End()\n}\n\n")
+
+	fmt.Fprintf(w, "// DecodeJSONFrom decodes the next JSON object of d into v.\n")
+	fmt.Fprintf(w, "func (v *%s) DecodeJSONFrom(d *jsonenc.Decoder) error {\n", name)
+	fmt.Fprintf(w, "return d.Object(func(key []byte) error {\nswitch string(key) {\n")
+	w.Write(cases.Bytes())
+	fmt.Fprintf(w, "default:\n")
+	fmt.Fprintf(w, "if jsonenc.FoldMatch(key, %s) {\n", keysVar)
+	fmt.Fprintf(w, "// encoding/json matches keys case-insensitively.\nreturn jsonenc.ErrUnsupported\n}\n")
+	if remain != nil {
+		fmt.Fprintf(w, "x, err := d.Any()\nif err != nil {\nreturn err\n}\n")
+		fmt.Fprintf(w, "if v.%[1]s == nil {\nv.%[1]s = make(map[string]any)\n}\nv.%[1]s[string(key)] = x\n", remain.name)
+	} else {
+		fmt.Fprintf(w, "if _, err := d.Raw(); err != nil {\nreturn err\n}\n")
+	}
+	fmt.Fprintf(w, "}\nreturn nil\n})\n}\n\n")
+	return nil
+}
+
+// writeDecodeValue writes the case body decoding the next value into expr, of type t.
+// A null value leaves expr untouched, as encoding/json does.
+func (g *generator) writeDecodeValue(w *bytes.Buffer, expr string, t ast.Expr) error {
+	var call, conv string
+	switch t := t.(type) {
+	case *ast.Ident:
+		switch t.Name {
+		case "string":
+			call = "d.String()"
+		case "bool":
+			call = "d.Bool()"
+		case "int", "int8", "int16", "int32", "int64":
+			call, conv = fmt.Sprintf("d.Int(%d)", bitSize(t.Name)), t.Name
+		case "uint", "uint8", "uint16", "uint32", "uint64":
+			call, conv = fmt.Sprintf("d.Uint(%d)", bitSize(t.Name)), t.Name
+		case "float32", "float64":
+			call, conv = fmt.Sprintf("d.Float(%d)", bitSize(t.Name)), t.Name
+		default:
+			if _, ok := g.structs[t.Name]; !ok {
+				return fmt.Errorf("unsupported type %s", t.Name)
+			}
+			fmt.Fprintf(w, "if d.Null() {\nreturn nil\n}\nreturn %s.DecodeJSONFrom(d)\n", expr)
+			return nil
+		}
+	case *ast.SelectorExpr:
+		if g.isRawMessage(t) {
+			// encoding/json keeps a raw null, where other decoders drop it: let the caller decide.
+			fmt.Fprintf(w, "if d.Null() {\nreturn jsonenc.ErrUnsupported\n}\n")
+			fmt.Fprintf(w, "raw, err := d.Raw()\nif err != nil {\nreturn err\n}\n%s = raw\n", expr)
+			return nil
+		}
+		fmt.Fprintf(w, "if d.Null() {\nreturn nil\n}\nreturn %s.DecodeJSONFrom(d)\n", expr)
+		return nil
+	default:
+		return fmt.Errorf("unsupported type %T for decoding", t)
+	}
+
+	fmt.Fprintf(w, "if d.Null() {\nreturn nil\n}\nx, err := %s\nif err != nil {\nreturn err\n}\n", call)
+	if conv != "" && conv != "int64" && conv != "uint64" && conv != "float64" {
+		fmt.Fprintf(w, "%s = %s(x)\n", expr, conv)
+	} else {
+		fmt.Fprintf(w, "%s = x\n", expr)
+	}
+	return nil
+}
+
+func (g *generator) isRawMessage(t *ast.SelectorExpr) bool {
+	return g.json != "" && isIdent(t.X, g.json) && t.Sel.Name == "RawMessage"
+}
+
+func isIdent(e ast.Expr, name string) bool {
+	id, ok := e.(*ast.Ident)
+	return ok && id.Name == name
+}
+
+func isNumber(name string) bool {
+	return bitSize(name) >= 0
+}
+
+// bitSize returns the bit size of a numeric type name for strconv, or -1 if not numeric.
+func bitSize(name string) int {
+	switch name {
+	case "int", "uint":
+		return 0
+	case "int8", "uint8":
+		return 8
+	case "int16", "uint16":
+		return 16
+	case "int32", "uint32", "float32":
+		return 32
+	case "int64", "uint64", "float64":
+		return 64
+	}
+	return -1
+}
+
+// goString returns s as a Go string literal, preferring raw strings for readability.
+func goString(s string) string {
+	if strings.ContainsAny(s, "`\r") {
+		return strconv.Quote(s)
+	}
+	return "`" + s + "`"
+}
+
+func lowerFirst(s string) string {
+	if s == "" {
+		return s
+	}
+	return strings.ToLower(s[:1]) + s[1:]
+}
@@ -0,0 +1,211 @@
+// Package jsonenc is the runtime support for the reflection-free JSON encoders and decoders
+// produced by the generator in ./generate.
+//
+// The encoders produce byte-for-byte the same output as encoding/json, including HTML escaping.
+package jsonenc
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"math"
+	"strconv"
+	"sync"
+	"unicode/utf8"
+)
+
+const (
+	// defaultBufferSize is the starting capacity of pooled buffers, large enough for a typical report.
+	defaultBufferSize = 4 << 10
+	// maxPooledBufferSize is the largest buffer kept in the pool, so that an odd huge report does not pin memory.
+	maxPooledBufferSize = 1 << 20
+)
+
+var bufPool = sync.Pool{
+	New: func() any {
+		b := make([]byte, 0, defaultBufferSize)
+		return &b
+	},
+}
+
+// GetBuffer returns an empty buffer from the pool.
+func GetBuffer() *[]byte {
+	b := bufPool.Get().(*[]byte)
+	*b = (*b)[:0]
+	return b
+}
+
+// PutBuffer returns b to the pool. b must not be used afterwards.
+func PutBuffer(b *[]byte) {
+	if cap(*b) > maxPooledBufferSize {
+		return
+	}
+	bufPool.Put(b)
+}
+
+// Marshal encodes v with its generated encoder into a pooled buffer and returns a copy of the result.
+func Marshal(v interface{ AppendJSON([]byte) ([]byte, error) }) ([]byte, error) {
+	buf := GetBuffer()
+	defer PutBuffer(buf)
+
+	b, err := v.AppendJSON(*buf)
+	if err != nil {
+		return nil, err
+	}
+	*buf = b
+
+	out := make([]byte, len(b))
+	copy(out, b)
+	return out, nil
+}
+
+const hex = "0123456789abcdef"
+
+// AppendString appends s as a quoted JSON string, escaped as encoding/json does.
+func AppendString(dst []byte, s string) []byte {
+	dst = append(dst, '"')
+	start := 0
+	for i := 0; i < len(s); {
+		if c := s[i]; c < utf8.RuneSelf {
+			if c >= 0x20 && c != '"' && c != '\\' && c != '<' && c != '>' && c != '&' {
+				i++
+				continue
+			}
+			dst = append(dst, s[start:i]...)
+			switch c {
+			case '"', '\\':
+				dst = append(dst, '\\', c)
+			case '\b':
+				dst = append(dst, '\\', 'b')
+			case '\f':
+				dst = append(dst, '\\', 'f')
+			case '\n':
+				dst = append(dst, '\\', 'n')
+			case '\r':
+				dst = append(dst, '\\', 'r')
+			case '\t':
+				dst = append(dst, '\\', 't')
+			default:
+				// Remaining control characters and HTML special characters.
+				dst = append(dst, '\\', 'u', '0', '0', hex[c>>4], hex[c&0xF])
+			}
+			i++
+			start = i
+			continue
+		}
+
+		r, size := utf8.DecodeRuneInString(s[i:])
+		if r == utf8.RuneError && size == 1 {
+			dst = append(dst, s[start:i]...)
+			dst = append(dst, `\ufffd`...)
+			i += size
+			start = i
+			continue
+		}
+		// U+2028 and U+2029 are valid JSON but break JavaScript parsers.
+		if r == '\u2028' || r == '\u2029' {
+			dst = append(dst, s[start:i]...)
+			dst = append(dst, '\\', 'u', '2', '0', '2', hex[r&0xF])
+			i += size
+			start = i
+			continue
+		}
+		i += size
+	}
+	dst = append(dst, s[start:]...)
+	return append(dst, '"')
+}
+
+// AppendBool appends b as a JSON boolean.
+func AppendBool(dst []byte, b bool) []byte {
+	return strconv.AppendBool(dst, b)
+}
+
+// AppendInt appends n as a JSON number.
+func AppendInt(dst []byte, n int64) []byte {
+	return strconv.AppendInt(dst, n, 10)
+}
+
+// AppendUint appends n as a JSON number.
+func AppendUint(dst []byte, n uint64) []byte {
+	return strconv.AppendUint(dst, n, 10)
+}
+
+// AppendFloat appends f as a JSON number, formatted as encoding/json does for the given bit size.
+// It returns an error for NaN and infinite values, which JSON cannot represent.
+func AppendFloat(dst []byte, f float64, bits int) ([]byte, error) {
+	if math.IsInf(f, 0) || math.IsNaN(f) {
+		return dst, fmt.Errorf("unsupported float value: %s", strconv.FormatFloat(f, 'g', -1, bits))
+	}
+
+	// Use the same cutoffs as encoding/json (and ES6) between fixed and exponent notation.
+	format := byte('f')
+	if abs := math.Abs(f); abs != 0 {
+		if bits == 64 && (abs < 1e-6 || abs >= 1e21) || bits == 32 && (float32(abs) < 1e-6 || float32(abs) >= 1e21) {
+			format = 'e'
+		}
+	}
+	dst = strconv.AppendFloat(dst, f, format, -1, bits)
+	if format == 'e' {
+		// Clean up e-09 to e-9.
+		if n := len(dst); n >= 4 && dst[n-4] == 'e' && dst[n-3] == '-' && dst[n-2] == '0' {
+			dst[n-2] = dst[n-1]
+			dst = dst[:n-1]
+		}
+	}
+	return dst, nil
+}
+
+// AppendRaw appends an already encoded JSON value, compacted and HTML escaped as encoding/json does
+// for json.RawMessage. A nil value is encoded as null.
+func AppendRaw(dst []byte, raw []byte) ([]byte, error) {
+	if raw == nil {
+		return append(dst, "null"...), nil
+	}
+	if !json.Valid(raw) {
+		return dst, errors.New("raw JSON value is not valid")
+	}
+
+	start := 0
+	inString, escaped := false, false
+	for i := 0; i < len(raw); i++ {
+		c := raw[i]
+		switch {
+		case c == '<' || c == '>' || c == '&':
+			dst = append(dst, raw[start:i]...)
+			dst = append(dst, '\\', 'u', '0', '0', hex[c>>4], hex[c&0xF])
+			start = i + 1
+		case c == 0xE2 && i+2 < len(raw) && raw[i+1] == 0x80 && raw[i+2]&^1 == 0xA8:
+			// U+2028 and U+2029 (E2 80 A8 and E2 80 A9).
+			dst = append(dst, raw[start:i]...)
+			dst = append(dst, '\\', 'u', '2', '0', '2', hex[raw[i+2]&0xF])
+			i += 2
+			start = i + 1
+		case inString:
+			switch {
+			case escaped:
+				escaped = false
+			case c == '\\':
+				escaped = true
+			case c == '"':
+				inString = false
+			}
+		case c == '"':
+			inString = true
+		case c == ' ' || c == '\t' || c == '\n' || c == '\r':
+			dst = append(dst, raw[start:i]...)
+			start = i + 1
+		}
+	}
+	return append(dst, raw[start:]...), nil
+}
+
+// AppendAny appends v using encoding/json. It is the reflection based escape hatch for free-form
+// values, such as maps of extra fields, which have no generated encoder.
+func AppendAny(dst []byte, v any) ([]byte, error) {
+	b, err := json.Marshal(v)
+	if err != nil {
+		return dst, err
+	}
+	return append(dst, b...), nil
+}
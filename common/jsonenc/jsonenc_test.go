@@ -0,0 +1,154 @@
+package jsonenc_test
+
+import (
+	"encoding/json"
+	"math"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+func TestAppendString(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		s string
+	}{
+		"Empty string":                  {s: ""},
+		"Plain ASCII":                   {s: "Intel(R) Core(TM) i7"},
+		"Quotes and backslashes":        {s: `a "quoted" \path\`},
+		"Control characters":            {s: "\b\f\n\r\t\x00\x1f"},
+		"HTML special characters":       {s: "<script>&</script>"},
+		"Multi-byte UTF-8":              {s: "héllo wörld, 日本語 🙂"},
+		"Line and paragraph separators": {s: "a\u2028b\u2029c"},
+		"Invalid UTF-8":                 {s: "a\xffb\xc3"},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			want, err := json.Marshal(tc.s)
+			require.NoError(t, err, "Setup: failed to marshal string")
+
+			got := jsonenc.AppendString([]byte("prefix"), tc.s)
+			assert.Equal(t, "prefix"+string(want), string(got), "AppendString should escape as encoding/json does")
+		})
+	}
+}
+
+func TestAppendFloat(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		f    float64
+		bits int
+
+		wantErr bool
+	}{
+		"Zero":                      {f: 0, bits: 64},
+		"Negative zero":             {f: math.Copysign(0, -1), bits: 64},
+		"Integer value":             {f: 42, bits: 64},
+		"Fraction":                  {f: 3.14159, bits: 64},
+		"Small value uses exponent": {f: 1.5e-9, bits: 64},
+		"Large value uses exponent": {f: -2e21, bits: 64},
+		"Below exponent cutoff":     {f: 1e20, bits: 64},
+		"Float32 value":             {f: float64(float32(0.1)), bits: 32},
+		"Float32 small value":       {f: float64(float32(1e-7)), bits: 32},
+
+		// Error cases
+		"Errors on NaN":               {f: math.NaN(), bits: 64, wantErr: true},
+		"Errors on positive infinity": {f: math.Inf(1), bits: 64, wantErr: true},
+		"Errors on negative infinity": {f: math.Inf(-1), bits: 32, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := jsonenc.AppendFloat(nil, tc.f, tc.bits)
+			if tc.wantErr {
+				require.Error(t, err, "AppendFloat should fail on values JSON cannot represent")
+				return
+			}
+			require.NoError(t, err)
+
+			var want []byte
+			if tc.bits == 32 {
+				want, err = json.Marshal(float32(tc.f))
+			} else {
+				want, err = json.Marshal(tc.f)
+			}
+			require.NoError(t, err, "Setup: failed to marshal float")
+			assert.Equal(t, string(want), string(got), "AppendFloat should format as encoding/json does")
+		})
+	}
+}
+
+func TestAppendRaw(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		raw json.RawMessage
+
+		wantErr bool
+	}{
+		"Nil is null":                  {raw: nil},
+		"Scalar":                       {raw: json.RawMessage(`1.50`)},
+		"Object is compacted":          {raw: json.RawMessage("{\n  \"b\": [1, 2],\t\"a\" : null\r\n}")},
+		"Spaces in strings are kept":   {raw: json.RawMessage(`{"a b": " c \" d "}`)},
+		"HTML characters are escaped":  {raw: json.RawMessage(`{"<a>": "&"}`)},
+		"Line separators are escaped":  {raw: json.RawMessage("[\"a\u2028b\u2029\"]")},
+		"Escaped quotes end no string": {raw: json.RawMessage(`["\\", " x "]`)},
+
+		// Error cases
+		"Errors on invalid JSON": {raw: json.RawMessage(`{"a":}`), wantErr: true},
+		"Errors on empty value":  {raw: json.RawMessage{}, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := jsonenc.AppendRaw(nil, tc.raw)
+			if tc.wantErr {
+				require.Error(t, err, "AppendRaw should fail on invalid JSON")
+				return
+			}
+			require.NoError(t, err)
+
+			want, err := json.Marshal(tc.raw)
+			require.NoError(t, err, "Setup: failed to marshal raw message")
+			assert.Equal(t, string(want), string(got), "AppendRaw should encode as encoding/json does")
+		})
+	}
+}
+
+type marshalFunc func([]byte) ([]byte, error)
+
+func (f marshalFunc) AppendJSON(dst []byte) ([]byte, error) { return f(dst) }
+
+func TestMarshal(t *testing.T) {
+	t.Parallel()
+
+	enc := marshalFunc(func(dst []byte) ([]byte, error) {
+		return jsonenc.AppendString(dst, "value"), nil
+	})
+
+	first, err := jsonenc.Marshal(enc)
+	require.NoError(t, err, "Marshal should not fail")
+	second, err := jsonenc.Marshal(enc)
+	require.NoError(t, err, "Marshal should not fail")
+
+	assert.Equal(t, `"value"`, string(first), "Marshal should return the encoded value")
+	assert.Equal(t, string(first), string(second), "Marshal should return the same result on each call")
+	first[1] = 'X'
+	assert.Equal(t, `"value"`, string(second), "Marshal should not share its result with the pool")
+
+	_, err = jsonenc.Marshal(marshalFunc(func(dst []byte) ([]byte, error) {
+		return jsonenc.AppendFloat(dst, math.NaN(), 64)
+	}))
+	require.Error(t, err, "Marshal should return encoder errors")
+}
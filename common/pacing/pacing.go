@@ -0,0 +1,58 @@
+// Package pacing provides the hints the server gives clients to spread their uploads over time.
+package pacing
+
+import (
+	"net/http"
+	"strconv"
+	"time"
+)
+
+const (
+	// WindowHeader is the response header advertising the period, in seconds, over which clients spread their uploads.
+	WindowHeader = "X-Insights-Upload-Window"
+	// RetryAfterHeader is the response header asking clients to wait before uploading again, as defined in RFC 9110.
+	RetryAfterHeader = "Retry-After"
+)
+
+// Window returns the upload window advertised in h, and whether there is a valid one.
+// A zero window means that the server does not ask clients to spread their uploads.
+func Window(h http.Header) (time.Duration, bool) {
+	return seconds(h.Get(WindowHeader))
+}
+
+// SetWindow advertises the upload window d in h, rounded up to the second.
+func SetWindow(h http.Header, d time.Duration) {
+	h.Set(WindowHeader, formatSeconds(d))
+}
+
+// RetryAfter returns the delay requested in h, and whether there is a valid one.
+// The delay is given either in seconds, or as an HTTP date which is relative to now.
+func RetryAfter(h http.Header, now time.Time) (time.Duration, bool) {
+	v := h.Get(RetryAfterHeader)
+	if d, ok := seconds(v); ok {
+		return d, true
+	}
+	t, err := http.ParseTime(v)
+	if err != nil {
+		return 0, false
+	}
+	return max(t.Sub(now), 0), true
+}
+
+// SetRetryAfter asks clients to wait d before uploading again in h, rounded up to the second.
+func SetRetryAfter(h http.Header, d time.Duration) {
+	h.Set(RetryAfterHeader, formatSeconds(d))
+}
+
+// seconds parses v as a non-negative number of seconds.
+func seconds(v string) (time.Duration, bool) {
+	n, err := strconv.ParseUint(v, 10, 32)
+	if err != nil {
+		return 0, false
+	}
+	return time.Duration(n) * time.Second, true
+}
+
+func formatSeconds(d time.Duration) string {
+	return strconv.FormatInt(int64((max(d, 0)+time.Second-1)/time.Second), 10)
+}
@@ -0,0 +1,92 @@
+package pacing_test
+
+import (
+	"net/http"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
+)
+
+func TestWindow(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		value string
+
+		want   time.Duration
+		wantOk bool
+	}{
+		"Parses seconds":      {value: "3600", want: time.Hour, wantOk: true},
+		"Parses zero windows": {value: "0", want: 0, wantOk: true},
+
+		"Not ok when missing":         {},
+		"Not ok when negative":        {value: "-1"},
+		"Not ok when fractional":      {value: "1.5"},
+		"Not ok when out of range":    {value: "4294967296"},
+		"Not ok when not a number":    {value: "soon"},
+		"Not ok when given as a date": {value: "Wed, 21 Oct 2015 07:28:00 GMT"},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			h := http.Header{}
+			if tc.value != "" {
+				h.Set(pacing.WindowHeader, tc.value)
+			}
+			got, ok := pacing.Window(h)
+			assert.Equal(t, tc.wantOk, ok, "Window should return whether there is a valid window")
+			assert.Equal(t, tc.want, got, "Window should return the advertised window")
+		})
+	}
+}
+
+func TestRetryAfter(t *testing.T) {
+	t.Parallel()
+
+	now := time.Date(2015, time.October, 21, 7, 0, 0, 0, time.UTC)
+
+	tests := map[string]struct {
+		value string
+
+		want   time.Duration
+		wantOk bool
+	}{
+		"Parses seconds":            {value: "120", want: 2 * time.Minute, wantOk: true},
+		"Parses dates":              {value: "Wed, 21 Oct 2015 07:28:00 GMT", want: 28 * time.Minute, wantOk: true},
+		"Parses dates in the past":  {value: "Wed, 21 Oct 2015 06:00:00 GMT", want: 0, wantOk: true},
+		"Parses obsolete date form": {value: "Wednesday, 21-Oct-15 07:01:00 GMT", want: time.Minute, wantOk: true},
+
+		"Not ok when missing":      {},
+		"Not ok when negative":     {value: "-120"},
+		"Not ok when not a number": {value: "later"},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			h := http.Header{}
+			if tc.value != "" {
+				h.Set(pacing.RetryAfterHeader, tc.value)
+			}
+			got, ok := pacing.RetryAfter(h, now)
+			assert.Equal(t, tc.wantOk, ok, "RetryAfter should return whether there is a valid delay")
+			assert.Equal(t, tc.want, got, "RetryAfter should return the requested delay")
+		})
+	}
+}
+
+func TestSetHeaders(t *testing.T) {
+	t.Parallel()
+
+	h := http.Header{}
+	pacing.SetWindow(h, 90*time.Minute)
+	pacing.SetRetryAfter(h, 1500*time.Millisecond)
+
+	assert.Equal(t, "5400", h.Get(pacing.WindowHeader), "SetWindow should advertise the window in seconds")
+	assert.Equal(t, "2", h.Get(pacing.RetryAfterHeader), "SetRetryAfter should round the delay up to the second")
+}
@@ -0,0 +1,182 @@
+// Package reportdelta implements the delta encoding of reports against a previously acknowledged report.
+//
+// A delta is a JSON merge patch (RFC 7396) turning the base report into the new one. Both sides work on the
+// canonical encoding of reports, so that the base a client refers to by digest is byte for byte the one the
+// server holds, whichever of a full report or a delta it was received as.
+package reportdelta
+
+import (
+	"bytes"
+	"crypto/sha256"
+	"encoding/hex"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"reflect"
+)
+
+const (
+	// ContentType is the content type of a delta upload.
+	ContentType = "application/merge-patch+json"
+	// BaseHeader is the request header holding the digest of the report a delta applies to.
+	BaseHeader = "X-Insights-Delta-Base"
+	// DigestHeader is the request header holding the digest of the report a delta reconstructs.
+	DigestHeader = "X-Insights-Delta-Digest"
+	// UnknownBase is the body of the response to a delta against a base the server does not hold.
+	// The client is expected to send the full report instead.
+	UnknownBase = "unknown base"
+)
+
+// ErrNotObject is returned when a report or a delta is not a JSON object.
+var ErrNotObject = errors.New("not a JSON object")
+
+// Canonical returns the canonical encoding of the JSON document doc: compact, with object keys sorted and
+// numbers kept as written.
+func Canonical(doc []byte) ([]byte, error) {
+	v, err := decode(doc)
+	if err != nil {
+		return nil, err
+	}
+	return json.Marshal(v)
+}
+
+// Digest returns the hex encoded SHA-256 digest of the canonical report doc.
+func Digest(doc []byte) string {
+	sum := sha256.Sum256(doc)
+	return hex.EncodeToString(sum[:])
+}
+
+// Diff returns the merge patch turning the report base into the report target, in canonical encoding.
+// It returns false when target can't be expressed as a merge patch against base, as merge patches can't set
+// object members to null.
+func Diff(base, target []byte) (patch []byte, ok bool, err error) {
+	b, err := decodeObject(base)
+	if err != nil {
+		return nil, false, fmt.Errorf("invalid base: %w", err)
+	}
+	t, err := decodeObject(target)
+	if err != nil {
+		return nil, false, fmt.Errorf("invalid target: %w", err)
+	}
+
+	p, ok := diffObjects(b, t)
+	if !ok {
+		return nil, false, nil
+	}
+	patch, err = json.Marshal(p)
+	if err != nil {
+		return nil, false, err
+	}
+	return patch, true, nil
+}
+
+// Apply applies the merge patch patch to the report base, and returns the resulting report in canonical encoding.
+func Apply(base, patch []byte) ([]byte, error) {
+	b, err := decodeObject(base)
+	if err != nil {
+		return nil, fmt.Errorf("invalid base: %w", err)
+	}
+	p, err := decodeObject(patch)
+	if err != nil {
+		return nil, fmt.Errorf("invalid patch: %w", err)
+	}
+	return json.Marshal(merge(b, p))
+}
+
+// diffObjects returns the merge patch turning base into target.
+func diffObjects(base, target map[string]any) (map[string]any, bool) {
+	patch := make(map[string]any)
+	for k, tv := range target {
+		bv, inBase := base[k]
+		if inBase && reflect.DeepEqual(bv, tv) {
+			continue
+		}
+		// A null in a patch removes the member instead of setting it.
+		if tv == nil {
+			return nil, false
+		}
+
+		tObj, tIsObj := tv.(map[string]any)
+		if bObj, bIsObj := bv.(map[string]any); tIsObj && bIsObj {
+			sub, ok := diffObjects(bObj, tObj)
+			if !ok {
+				return nil, false
+			}
+			patch[k] = sub
+			continue
+		}
+		if tIsObj && hasNullMember(tObj) {
+			return nil, false
+		}
+		patch[k] = tv
+	}
+
+	for k := range base {
+		if _, ok := target[k]; !ok {
+			patch[k] = nil
+		}
+	}
+	return patch, true
+}
+
+// hasNullMember returns true if obj, or any object nested in it outside of arrays, has a null member.
+// Arrays are replaced as a whole by merge patches, so nulls in them are kept.
+func hasNullMember(obj map[string]any) bool {
+	for _, v := range obj {
+		if v == nil {
+			return true
+		}
+		if o, ok := v.(map[string]any); ok && hasNullMember(o) {
+			return true
+		}
+	}
+	return false
+}
+
+// merge applies patch to target as RFC 7396 describes. target is modified in place.
+func merge(target, patch any) any {
+	p, ok := patch.(map[string]any)
+	if !ok {
+		return patch
+	}
+	t, ok := target.(map[string]any)
+	if !ok {
+		t = make(map[string]any, len(p))
+	}
+	for k, v := range p {
+		if v == nil {
+			delete(t, k)
+			continue
+		}
+		t[k] = merge(t[k], v)
+	}
+	return t
+}
+
+// decodeObject decodes doc, which must hold a single JSON object.
+func decodeObject(doc []byte) (map[string]any, error) {
+	v, err := decode(doc)
+	if err != nil {
+		return nil, err
+	}
+	obj, ok := v.(map[string]any)
+	if !ok {
+		return nil, ErrNotObject
+	}
+	return obj, nil
+}
+
+// decode decodes doc, which must hold a single JSON value, keeping numbers as written.
+func decode(doc []byte) (any, error) {
+	d := json.NewDecoder(bytes.NewReader(doc))
+	d.UseNumber()
+	var v any
+	if err := d.Decode(&v); err != nil {
+		return nil, err
+	}
+	if _, err := d.Token(); err != io.EOF {
+		return nil, errors.New("unexpected data after JSON value")
+	}
+	return v, nil
+}
@@ -0,0 +1,145 @@
+package reportdelta_test
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/reportdelta"
+)
+
+func TestCanonical(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		doc string
+
+		want    string
+		wantErr bool
+	}{
+		"Sorts keys and compacts":  {doc: `{ "b": [1, 2], "a": {"d": true, "c": null} }`, want: `{"a":{"c":null,"d":true},"b":[1,2]}`},
+		"Keeps numbers as written": {doc: `{"i": 18446744073709551615, "f": 1.50, "e": 1e3}`, want: `{"e":1e3,"f":1.50,"i":18446744073709551615}`},
+		"Accepts other values":     {doc: `"value"`, want: `"value"`},
+
+		"Errors on invalid JSON":        {doc: `{"a":}`, wantErr: true},
+		"Errors on trailing JSON value": {doc: `{"a":1} {"b":2}`, wantErr: true},
+		"Errors on empty input":         {doc: ``, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := reportdelta.Canonical([]byte(tc.doc))
+			if tc.wantErr {
+				require.Error(t, err, "Canonical should return an error")
+				return
+			}
+			require.NoError(t, err, "Canonical should not return an error")
+			assert.Equal(t, tc.want, string(got), "Canonical should return the canonical encoding")
+		})
+	}
+}
+
+func TestDiffAndApply(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		base, target string
+
+		wantPatch   string
+		wantNoPatch bool
+		wantDiffErr bool
+	}{
+		"Identical reports give an empty patch": {
+			base: `{"a":1,"b":{"c":"d"}}`, target: `{"a":1,"b":{"c":"d"}}`, wantPatch: `{}`},
+		"Changed members are set": {
+			base: `{"a":1,"b":"c"}`, target: `{"a":2,"b":"c"}`, wantPatch: `{"a":2}`},
+		"Added members are set": {
+			base: `{"a":1}`, target: `{"a":1,"b":[1,null]}`, wantPatch: `{"b":[1,null]}`},
+		"Removed members are nulled": {
+			base: `{"a":1,"b":2}`, target: `{"a":1}`, wantPatch: `{"b":null}`},
+		"Nested objects are diffed": {
+			base: `{"s":{"cpu":{"n":4,"m":"x"},"mem":8}}`, target: `{"s":{"cpu":{"n":8,"m":"x"},"mem":8}}`, wantPatch: `{"s":{"cpu":{"n":8}}}`},
+		"Arrays are replaced whole": {
+			base: `{"a":[{"x":1},{"x":2}]}`, target: `{"a":[{"x":1},{"x":3}]}`, wantPatch: `{"a":[{"x":1},{"x":3}]}`},
+		"Objects replace other values": {
+			base: `{"a":"b"}`, target: `{"a":{"c":1}}`, wantPatch: `{"a":{"c":1}}`},
+
+		"No patch when setting a member to null": {
+			base: `{"a":1}`, target: `{"a":null}`, wantNoPatch: true},
+		"No patch when adding a null member": {
+			base: `{"a":{"b":1}}`, target: `{"a":{"b":1,"c":null}}`, wantNoPatch: true},
+		"No patch when replacing a value by an object with null members": {
+			base: `{"a":1}`, target: `{"a":{"b":{"c":null}}}`, wantNoPatch: true},
+
+		"Diff errors when base is not an object":   {base: `[1]`, target: `{"a":1}`, wantDiffErr: true},
+		"Diff errors when target is not an object": {base: `{"a":1}`, target: `1`, wantDiffErr: true},
+		"Diff errors when base is invalid JSON":    {base: `{`, target: `{"a":1}`, wantDiffErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			patch, ok, err := reportdelta.Diff([]byte(tc.base), []byte(tc.target))
+			if tc.wantDiffErr {
+				require.Error(t, err, "Diff should return an error")
+				return
+			}
+			require.NoError(t, err, "Diff should not return an error")
+			if tc.wantNoPatch {
+				require.False(t, ok, "Diff should report that no patch can express the target")
+				return
+			}
+			require.True(t, ok, "Diff should return a patch")
+			assert.Equal(t, tc.wantPatch, string(patch), "Diff should return the expected patch")
+
+			got, err := reportdelta.Apply([]byte(tc.base), patch)
+			require.NoError(t, err, "Apply should not return an error")
+			want, err := reportdelta.Canonical([]byte(tc.target))
+			require.NoError(t, err, "Setup: failed to get canonical target")
+			assert.Equal(t, string(want), string(got), "Apply should reconstruct the canonical target")
+		})
+	}
+}
+
+func TestApply(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		base, patch string
+
+		want    string
+		wantErr bool
+	}{
+		"Removing a missing member does nothing": {base: `{"a":1}`, patch: `{"b":null}`, want: `{"a":1}`},
+		"Patches objects into other values":      {base: `{"a":1}`, patch: `{"a":{"b":{"c":2}}}`, want: `{"a":{"b":{"c":2}}}`},
+		"Result is canonical":                    {base: `{ "z": 1, "a": 2 }`, patch: `{}`, want: `{"a":2,"z":1}`},
+
+		"Errors when the patch is not an object": {base: `{"a":1}`, patch: `[]`, wantErr: true},
+		"Errors when the patch is invalid JSON":  {base: `{"a":1}`, patch: `{"a"`, wantErr: true},
+		"Errors when the base is not an object":  {base: `null`, patch: `{}`, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := reportdelta.Apply([]byte(tc.base), []byte(tc.patch))
+			if tc.wantErr {
+				require.Error(t, err, "Apply should return an error")
+				return
+			}
+			require.NoError(t, err, "Apply should not return an error")
+			assert.Equal(t, tc.want, string(got), "Apply should return the patched report")
+		})
+	}
+}
+
+func TestDigest(t *testing.T) {
+	t.Parallel()
+
+	assert.Equal(t, "44136fa355b3678a1146ad16f7e8649e94fb4fc21fe77e8310c060f61caaff8a", reportdelta.Digest([]byte(`{}`)),
+		"Digest should return the hex encoded SHA-256 digest")
+}
@@ -0,0 +1,130 @@
+// TiCS: disabled // Test helpers.
+
+package testutils
+
+import (
+	"encoding"
+	"encoding/json"
+	"reflect"
+)
+
+// jsonAppender is implemented by the types with a generated JSON encoder.
+type jsonAppender interface {
+	AppendJSON([]byte) ([]byte, error)
+}
+
+var (
+	jsonAppenderType  = reflect.TypeFor[jsonAppender]()
+	jsonMarshalerType = reflect.TypeFor[json.Marshaler]()
+	textMarshalerType = reflect.TypeFor[encoding.TextMarshaler]()
+)
+
+// WithoutGeneratedJSON returns a copy of v whose types with a generated JSON encoder are rebuilt without their
+// methods, for encoding/json to handle it by reflection. It is meant for benchmarks comparing both encoders.
+// Unexported fields, which encoding/json ignores, are dropped.
+func WithoutGeneratedJSON(v any) any {
+	rv := reflect.ValueOf(v)
+	return convertToPlain(rv, plainType(rv.Type())).Interface()
+}
+
+// plainType returns the type t is rebuilt as, without generated JSON encoders.
+// Types encoding themselves otherwise are kept as they are.
+func plainType(t reflect.Type) reflect.Type {
+	if !implements(t, jsonAppenderType) && (implements(t, jsonMarshalerType) || implements(t, textMarshalerType)) {
+		return t
+	}
+
+	var plain reflect.Type
+	switch t.Kind() {
+	case reflect.Struct:
+		changed := implements(t, jsonAppenderType)
+		fields := make([]reflect.StructField, 0, t.NumField())
+		for i := range t.NumField() {
+			f := t.Field(i)
+			if !f.IsExported() {
+				continue
+			}
+			ft := plainType(f.Type)
+			changed = changed || ft != f.Type
+			fields = append(fields, reflect.StructField{Name: f.Name, Type: ft, Tag: f.Tag})
+		}
+		if !changed {
+			return t
+		}
+		return reflect.StructOf(fields)
+	case reflect.Pointer:
+		plain = reflect.PointerTo(plainType(t.Elem()))
+	case reflect.Slice:
+		plain = reflect.SliceOf(plainType(t.Elem()))
+	case reflect.Array:
+		plain = reflect.ArrayOf(t.Len(), plainType(t.Elem()))
+	case reflect.Map:
+		plain = reflect.MapOf(t.Key(), plainType(t.Elem()))
+	default:
+		return t
+	}
+
+	// Composite types of unchanged elements are kept, named ones included.
+	if plain.Elem() == t.Elem() {
+		return t
+	}
+	return plain
+}
+
+// convertToPlain returns a copy of v as the type to, built by plainType.
+func convertToPlain(v reflect.Value, to reflect.Type) reflect.Value {
+	if v.Type() == to {
+		return v
+	}
+
+	switch to.Kind() {
+	case reflect.Struct:
+		out := reflect.New(to).Elem()
+		j := 0
+		for i := range v.NumField() {
+			if !v.Type().Field(i).IsExported() {
+				continue
+			}
+			out.Field(j).Set(convertToPlain(v.Field(i), to.Field(j).Type))
+			j++
+		}
+		return out
+	case reflect.Pointer:
+		if v.IsNil() {
+			return reflect.Zero(to)
+		}
+		out := reflect.New(to.Elem())
+		out.Elem().Set(convertToPlain(v.Elem(), to.Elem()))
+		return out
+	case reflect.Slice:
+		if v.IsNil() {
+			return reflect.Zero(to)
+		}
+		out := reflect.MakeSlice(to, v.Len(), v.Len())
+		for i := range v.Len() {
+			out.Index(i).Set(convertToPlain(v.Index(i), to.Elem()))
+		}
+		return out
+	case reflect.Array:
+		out := reflect.New(to).Elem()
+		for i := range v.Len() {
+			out.Index(i).Set(convertToPlain(v.Index(i), to.Elem()))
+		}
+		return out
+	case reflect.Map:
+		if v.IsNil() {
+			return reflect.Zero(to)
+		}
+		out := reflect.MakeMapWithSize(to, v.Len())
+		for iter := v.MapRange(); iter.Next(); {
+			out.SetMapIndex(iter.Key(), convertToPlain(iter.Value(), to.Elem()))
+		}
+		return out
+	}
+	return v.Convert(to)
+}
+
+// implements returns whether t or a pointer to it implements iface.
+func implements(t, iface reflect.Type) bool {
+	return t.Implements(iface) || reflect.PointerTo(t).Implements(iface)
+}
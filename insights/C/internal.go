@@ -27,9 +27,17 @@ void call_log_callback(insights_log_level level, char* msg) {
 }
 
 int has_log_callback() { return global_log_callback != NULL; }
+
+INSIGHTS_HIDDEN bool call_report_callback(insights_report_callback callback,
+                                          const insights_report_info* info,
+                                          void* user_data) {
+  return callback(info, user_data);
+}
 */
 import "C"
 
+import "unsafe"
+
 func setLogCallbackImpl(callback C.insights_logger_callback) {
 	C.set_log_callback_impl(callback)
 }
@@ -41,3 +49,7 @@ func callLogCallback(level C.insights_log_level, msg *C.char) {
 func hasLogCallback() bool {
 	return C.has_log_callback() != 0
 }
+
+func callReportCallback(callback C.insights_report_callback, info *C.insights_report_info, userData unsafe.Pointer) bool {
+	return bool(C.call_report_callback(callback, info, userData))
+}
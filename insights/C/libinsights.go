@@ -9,8 +9,10 @@ package main
 import "C"
 
 import (
+	"errors"
 	"log/slog"
 	"os"
+	"runtime/cgo"
 	"unsafe"
 
 	"github.com/ubuntu/ubuntu-insights/insights"
@@ -48,20 +50,7 @@ type collector = func(conf insights.Config, source string, flags insights.Collec
 // collectCustomInsights handles C to Go translation and calls the custom collector.
 func collectCustomInsights(config *C.insights_const_config, source *C.insights_const_char, flags *C.insights_const_collect_flags, outReport **C.char, customCollector collector) *C.char {
 	conf := toGoInsightsConfig(config)
-
-	f := insights.CollectFlags{}
-	if flags != nil {
-		f.Period = (uint32)(flags.period)
-		f.Force = (bool)(flags.force)
-		f.DryRun = (bool)(flags.dry_run)
-
-		if flags.source_metrics_path != nil {
-			f.SourceMetricsPath = C.GoString(flags.source_metrics_path)
-		}
-		if flags.source_metrics_json != nil && flags.source_metrics_json_len > 0 {
-			f.SourceMetricsJSON = C.GoBytes(flags.source_metrics_json, C.int(flags.source_metrics_json_len))
-		}
-	}
+	f := toGoCollectFlags(flags)
 
 	sourceStr := ""
 	if source != nil {
@@ -90,6 +79,87 @@ func collectCustomInsights(config *C.insights_const_config, source *C.insights_c
 	return nil
 }
 
+// toGoCollectFlags converts C collect flags into the equivalent Go structure.
+func toGoCollectFlags(flags *C.insights_const_collect_flags) insights.CollectFlags {
+	f := insights.CollectFlags{}
+	if flags == nil {
+		return f
+	}
+
+	f.Period = (uint32)(flags.period)
+	f.Force = (bool)(flags.force)
+	f.DryRun = (bool)(flags.dry_run)
+	f.Sections = (insights.Sections)(flags.sections)
+
+	if flags.source_metrics_path != nil {
+		f.SourceMetricsPath = C.GoString(flags.source_metrics_path)
+	}
+	if flags.source_metrics_json != nil && flags.source_metrics_json_len > 0 {
+		f.SourceMetricsJSON = C.GoBytes(flags.source_metrics_json, C.int(flags.source_metrics_json_len))
+	}
+	f.SourceMetrics = toGoMetrics(flags.source_metrics)
+	return f
+}
+
+/**
+ * insights_collect_many creates a report for each of the specified sources,
+ * collecting system information only once for all of them.
+ * If config is NULL, defaults are used.
+ * specs is an array of specs_len sources, each with its own flags.
+ * A source may be NULL or "" to use the platform source.
+ * A failing source does not prevent the others from being collected.
+ * If any source fails, an error string describing all failures is returned.
+ * Otherwise, this returns NULL.
+ *
+ * If out_reports is not NULL, it must point to an array of specs_len
+ * pointers. Each one is set to the pretty printed report of the source
+ * at the same index, as a null-terminated C string, or NULL if that
+ * source failed.
+ *
+ * Each report in out_reports must be freed by the caller.
+ * The error string must be freed.
+ **/
+//export insights_collect_many
+func insights_collect_many(config *C.insights_const_config, specs *C.insights_const_source_spec, specs_len C.size_t, out_reports **C.char) *C.char { //nolint:revive // Exported for C
+	return collectManyCustomInsights(config, specs, specs_len, out_reports, func(conf insights.Config, sources []insights.SourceSpec) ([][]byte, error) {
+		return conf.CollectMany(sources)
+	})
+}
+
+// manyCollector is a function that collects multiple sources using the given parameters.
+type manyCollector = func(conf insights.Config, sources []insights.SourceSpec) ([][]byte, error)
+
+// collectManyCustomInsights handles C to Go translation and calls the custom collector.
+func collectManyCustomInsights(config *C.insights_const_config, specs *C.insights_const_source_spec, specsLen C.size_t, outReports **C.char, customCollector manyCollector) *C.char {
+	conf := toGoInsightsConfig(config)
+
+	var sources []insights.SourceSpec
+	if specs != nil && specsLen > 0 {
+		cSpecs := unsafe.Slice(specs, specsLen)
+		sources = make([]insights.SourceSpec, specsLen)
+		for i := range cSpecs {
+			if cSpecs[i].source != nil {
+				sources[i].Source = C.GoString(cSpecs[i].source)
+			}
+			sources[i].Flags = toGoCollectFlags(&cSpecs[i].flags)
+		}
+	}
+
+	reports, err := customCollector(conf, sources)
+
+	if outReports != nil && specsLen > 0 {
+		cReports := unsafe.Slice(outReports, specsLen)
+		for i := range cReports {
+			cReports[i] = nil
+			if i < len(reports) && len(reports[i]) > 0 {
+				cReports[i] = C.CString(string(reports[i]))
+			}
+		}
+	}
+
+	return errToCString(err)
+}
+
 /**
  * insights_compile compiles the report for the specified source.
  * If config is NULL, defaults are used.
@@ -117,12 +187,15 @@ func compileCustomInsights(config *C.insights_const_config, flags *C.insights_co
 
 	f := insights.CompileFlags{}
 	if flags != nil {
+		f.Sections = (insights.Sections)(flags.sections)
+
 		if flags.source_metrics_path != nil {
 			f.SourceMetricsPath = C.GoString(flags.source_metrics_path)
 		}
 		if flags.source_metrics_json != nil && flags.source_metrics_json_len > 0 {
 			f.SourceMetricsJSON = C.GoBytes(flags.source_metrics_json, C.int(flags.source_metrics_json_len))
 		}
+		f.SourceMetrics = toGoMetrics(flags.source_metrics)
 	}
 
 	report, err := customCompiler(conf, f)
@@ -147,6 +220,228 @@ func compileCustomInsights(config *C.insights_const_config, flags *C.insights_co
 	return nil
 }
 
+/**
+ * insights_metrics_new returns a handle to empty source metrics,
+ * to be filled with the insights_metrics_set_* functions and passed
+ * as source_metrics in the collect or compile flags.
+ * Keys are reported in the order they were first set in,
+ * and setting a key again replaces its value.
+ *
+ * The metrics are only encoded when a report is compiled,
+ * saving the caller from encoding them to JSON beforehand.
+ *
+ * The handle must be freed with insights_metrics_free.
+ **/
+//export insights_metrics_new
+func insights_metrics_new() C.insights_metrics { //nolint:revive // Exported for C
+	return C.insights_metrics(cgo.NewHandle(insights.NewMetrics()))
+}
+
+/**
+ * insights_metrics_set_int sets key to the integer value in the metrics.
+ * This returns false if metrics is 0 or key is NULL.
+ **/
+//export insights_metrics_set_int
+func insights_metrics_set_int(metrics C.insights_metrics, key *C.insights_const_char, value C.int64_t) C.bool { //nolint:revive // Exported for C
+	m := toGoMetrics(metrics)
+	if m == nil || key == nil {
+		return false
+	}
+	m.SetInt(C.GoString(key), int64(value))
+	return true
+}
+
+/**
+ * insights_metrics_set_str sets key to the null-terminated string value in the metrics.
+ * The string is copied.
+ * This returns false if metrics is 0, or key or value is NULL.
+ **/
+//export insights_metrics_set_str
+func insights_metrics_set_str(metrics C.insights_metrics, key *C.insights_const_char, value *C.insights_const_char) C.bool { //nolint:revive // Exported for C
+	m := toGoMetrics(metrics)
+	if m == nil || key == nil || value == nil {
+		return false
+	}
+	m.SetString(C.GoString(key), C.GoString(value))
+	return true
+}
+
+/**
+ * insights_metrics_set_bool sets key to the boolean value in the metrics.
+ * This returns false if metrics is 0 or key is NULL.
+ **/
+//export insights_metrics_set_bool
+func insights_metrics_set_bool(metrics C.insights_metrics, key *C.insights_const_char, value C.bool) C.bool { //nolint:revive // Exported for C
+	m := toGoMetrics(metrics)
+	if m == nil || key == nil {
+		return false
+	}
+	m.SetBool(C.GoString(key), bool(value))
+	return true
+}
+
+/**
+ * insights_metrics_set_double sets key to the number value in the metrics.
+ * This returns false if metrics is 0, key is NULL, or value is NaN or infinite.
+ **/
+//export insights_metrics_set_double
+func insights_metrics_set_double(metrics C.insights_metrics, key *C.insights_const_char, value C.double) C.bool { //nolint:revive // Exported for C
+	m := toGoMetrics(metrics)
+	if m == nil || key == nil {
+		return false
+	}
+	return m.SetFloat(C.GoString(key), float64(value)) == nil
+}
+
+/**
+ * insights_metrics_set_object sets key to a nested object in the metrics,
+ * holding a copy of the metrics in value.
+ * value remains owned by the caller, and may be modified or freed right after.
+ * This returns false if metrics or value is 0, or key is NULL.
+ **/
+//export insights_metrics_set_object
+func insights_metrics_set_object(metrics C.insights_metrics, key *C.insights_const_char, value C.insights_metrics) C.bool { //nolint:revive // Exported for C
+	m, v := toGoMetrics(metrics), toGoMetrics(value)
+	if m == nil || v == nil || key == nil {
+		return false
+	}
+	m.SetObject(C.GoString(key), v)
+	return true
+}
+
+/**
+ * insights_metrics_free releases the metrics.
+ * The handle must not be used afterwards.
+ * Freeing 0 does nothing.
+ **/
+//export insights_metrics_free
+func insights_metrics_free(metrics C.insights_metrics) { //nolint:revive // Exported for C
+	if metrics == 0 {
+		return
+	}
+	cgo.Handle(metrics).Delete()
+}
+
+// toGoMetrics returns the metrics behind the handle, or nil for 0.
+func toGoMetrics(metrics C.insights_metrics) *insights.Metrics {
+	if metrics == 0 {
+		return nil
+	}
+	return cgo.Handle(metrics).Value().(*insights.Metrics)
+}
+
+/**
+ * insights_list_reports calls callback with the metadata of each report of the specified source,
+ * in the states selected by the states bitmask of insights_report_state, until callback returns false.
+ * If config is NULL, defaults are used.
+ * source may be NULL or "" to list the reports of the platform source.
+ * user_data is passed as is to callback.
+ *
+ * Reports are not read: their metadata comes from directory entries alone.
+ * Reports moved while listing may be missed or listed twice.
+ *
+ * If listing fails, an error string is returned.
+ * Otherwise, this returns NULL.
+ * The error string must be freed.
+ **/
+//export insights_list_reports
+func insights_list_reports(config *C.insights_const_config, source *C.insights_const_char, states C.uint32_t, callback C.insights_report_callback, user_data unsafe.Pointer) *C.char { //nolint:revive // Exported for C
+	if callback == nil {
+		return errToCString(errors.New("callback cannot be NULL"))
+	}
+
+	conf := toGoInsightsConfig(config)
+
+	sourceStr := ""
+	if source != nil {
+		sourceStr = C.GoString(source)
+	}
+
+	err := conf.ListReports(sourceStr, insights.ReportState(states), func(i insights.ReportInfo) bool {
+		info := C.insights_report_info{
+			timestamp: C.int64_t(i.TimeStamp),
+			size:      C.int64_t(i.Size),
+			state:     C.insights_report_state(i.State),
+		}
+		return callReportCallback(callback, &info, user_data)
+	})
+	return errToCString(err)
+}
+
+/**
+ * insights_read_report reads the report of the specified source in state, with the given timestamp,
+ * as listed by insights_list_reports.
+ * If config is NULL, defaults are used.
+ * source may be NULL or "" to read a report of the platform source.
+ * state must be a single state.
+ *
+ * On success, out_view is set to a read-only view of the report, which is mapped into memory
+ * rather than copied where supported, and this returns NULL.
+ * The view must be released with insights_free_report_view.
+ *
+ * If reading fails, out_view is zeroed and an error string is returned.
+ * The error string must be freed.
+ **/
+//export insights_read_report
+func insights_read_report(config *C.insights_const_config, source *C.insights_const_char, state C.insights_report_state, timestamp C.int64_t, out_view *C.insights_report_view) *C.char { //nolint:revive // Exported for C
+	if out_view == nil {
+		return errToCString(errors.New("out_view cannot be NULL"))
+	}
+	*out_view = C.insights_report_view{}
+
+	conf := toGoInsightsConfig(config)
+
+	sourceStr := ""
+	if source != nil {
+		sourceStr = C.GoString(source)
+	}
+
+	v, err := conf.ReadReport(sourceStr, insights.ReportState(state), int64(timestamp))
+	if err != nil {
+		return errToCString(err)
+	}
+
+	data := v.Bytes()
+	if len(data) == 0 {
+		_ = v.Close()
+		return nil
+	}
+
+	// Mapped memory is not managed by Go, and can be handed out as is until the view is released.
+	// Content read into Go memory is copied into C memory instead.
+	if v.Mapped() {
+		out_view.data = (*C.char)(unsafe.Pointer(&data[0]))
+		out_view.len = C.size_t(len(data))
+		out_view.handle = C.uintptr_t(cgo.NewHandle(v))
+		return nil
+	}
+
+	out_view.data = (*C.char)(C.CBytes(data))
+	out_view.len = C.size_t(len(data))
+	_ = v.Close()
+	return nil
+}
+
+/**
+ * insights_free_report_view releases a view returned by insights_read_report, and zeroes it.
+ * Releasing a zeroed view, or NULL, does nothing.
+ **/
+//export insights_free_report_view
+func insights_free_report_view(view *C.insights_report_view) { //nolint:revive // Exported for C
+	if view == nil {
+		return
+	}
+
+	if view.handle != 0 {
+		h := cgo.Handle(view.handle)
+		_ = h.Value().(*insights.ReportView).Close()
+		h.Delete()
+	} else if view.data != nil {
+		C.free(unsafe.Pointer(view.data))
+	}
+	*view = C.insights_report_view{}
+}
+
 /**
  * insights_write writes the report to disk based on the consent state.
  * If config is NULL, defaults are used.
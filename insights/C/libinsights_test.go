@@ -14,11 +14,36 @@ func TestCollect(t *testing.T) {
 	main.TestCollectImpl(t)
 }
 
+// TestCollectMany tests C.CollectManyInsights.
+func TestCollectMany(t *testing.T) {
+	main.TestCollectManyImpl(t)
+}
+
+// TestSections tests that C sections match Go ones.
+func TestSections(t *testing.T) {
+	main.TestSectionsImpl(t)
+}
+
 // TestCompile tests C.CompileInsights.
 func TestCompile(t *testing.T) {
 	main.TestCompileImpl(t)
 }
 
+// TestMetrics tests building source metrics with the C API.
+func TestMetrics(t *testing.T) {
+	main.TestMetricsImpl(t)
+}
+
+// TestListReports tests C.insights_list_reports.
+func TestListReports(t *testing.T) {
+	main.TestListReportsImpl(t)
+}
+
+// TestReadReport tests C.insights_read_report.
+func TestReadReport(t *testing.T) {
+	main.TestReadReportImpl(t)
+}
+
 // TestWrite tests C.WriteInsights.
 func TestWrite(t *testing.T) {
 	main.TestWriteImpl(t)
@@ -78,3 +78,17 @@ int get_test_cb_count() { return test_cb_state.count; }
 char* get_test_cb_buffer() { return test_cb_state.buf; }
 
 bool get_test_cb_buf_exceeded() { return test_cb_state.buf_exceeded; }
+
+static bool test_report_callback_fn(const insights_report_info* info,
+                                    void* user_data) {
+  test_report_list* list = user_data;
+  if (list->count < TEST_REPORT_LIST_MAX) {
+    list->infos[list->count] = *info;
+  }
+  list->count++;
+  return list->stop_after == 0 || list->count < list->stop_after;
+}
+
+insights_report_callback get_test_report_callback() {
+  return test_report_callback_fn;
+}
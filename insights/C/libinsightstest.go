@@ -8,7 +8,11 @@ import "C"
 
 import (
 	"errors"
+	"fmt"
 	"log/slog"
+	"math"
+	"os"
+	"path/filepath"
 	"runtime"
 	"testing"
 	"unsafe"
@@ -17,6 +21,7 @@ import (
 	"github.com/stretchr/testify/require"
 	"github.com/ubuntu/ubuntu-insights/common/testutils"
 	"github.com/ubuntu/ubuntu-insights/insights"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 )
 
 // TestCollectImpl tests collect since import "C" and _test aren't compatible.
@@ -28,6 +33,7 @@ func TestCollectImpl(t *testing.T) {
 		source            string
 		metricsPath       *string
 		sourceMetricsJSON []byte
+		metrics           func(*testing.T) C.insights_metrics
 		flags             *C.insights_collect_flags
 
 		outReport **C.char
@@ -61,6 +67,16 @@ func TestCollectImpl(t *testing.T) {
 			sourceMetricsJSON: []byte(`{"key": "value"}`),
 		},
 
+		"SourceMetrics gets converted": {
+			metrics: makeMetrics,
+		},
+
+		"Sections get converted": {
+			flags: &C.insights_collect_flags{
+				sections: C.uint32_t(C.INSIGHTS_SECTION_HARDWARE_GPUS | C.INSIGHTS_SECTION_HARDWARE_SCREENS),
+			},
+		},
+
 		"Flags get converted": {
 			flags: &C.insights_collect_flags{
 				period:  C.uint32_t(10),
@@ -134,6 +150,11 @@ func TestCollectImpl(t *testing.T) {
 				tc.flags.source_metrics_json_len = C.size_t(len(tc.sourceMetricsJSON))
 			}
 
+			if tc.metrics != nil {
+				tc.flags.source_metrics = tc.metrics(t)
+				defer insights_metrics_free(tc.flags.source_metrics)
+			}
+
 			var got struct {
 				Conf   insights.Config
 				Source string
@@ -169,6 +190,9 @@ func TestCollectImpl(t *testing.T) {
 				got.Flags.SourceMetricsJSON = []byte{}
 			}
 
+			assertMetrics(t, tc.metrics != nil, got.Flags.SourceMetrics)
+			got.Flags.SourceMetrics = nil
+
 			if tc.outReport != nil {
 				got.OutReport = C.GoString(*tc.outReport)
 			}
@@ -181,6 +205,170 @@ func TestCollectImpl(t *testing.T) {
 	}
 }
 
+// TestCollectManyImpl tests collect many since import "C" and _test aren't compatible.
+func TestCollectManyImpl(t *testing.T) {
+	t.Parallel()
+
+	type spec struct {
+		source      *string
+		metricsPath *string
+		flags       C.insights_collect_flags
+	}
+
+	tests := map[string]struct {
+		specs      []spec
+		outReports bool
+
+		mockOut [][]byte
+		mockErr error
+
+		wantSources []insights.SourceSpec
+		wantReports []string
+	}{
+		// conversion cases
+		"Null values are empty": {},
+
+		"Specs get converted": {
+			specs: []spec{
+				{},
+				{source: strPtr("wsl"), metricsPath: strPtr("metrics"), flags: C.insights_collect_flags{
+					period:  C.uint32_t(2000),
+					force:   C.bool(true),
+					dry_run: C.bool(true),
+				}},
+			},
+			wantSources: []insights.SourceSpec{
+				{},
+				{Source: "wsl", Flags: insights.CollectFlags{SourceMetricsPath: "metrics", Period: 2000, Force: true, DryRun: true}},
+			},
+		},
+
+		// Report output
+		"Reports are returned when outReports is provided": {
+			specs:       []spec{{source: strPtr("a")}, {source: strPtr("b")}},
+			outReports:  true,
+			mockOut:     [][]byte{[]byte(`{"output": "a"}`), []byte(`{"output": "b"}`)},
+			wantSources: []insights.SourceSpec{{Source: "a"}, {Source: "b"}},
+			wantReports: []string{`{"output": "a"}`, `{"output": "b"}`},
+		},
+		"Reports are not returned when outReports is nil": {
+			specs:       []spec{{source: strPtr("a")}},
+			mockOut:     [][]byte{[]byte(`{"output": "a"}`)},
+			wantSources: []insights.SourceSpec{{Source: "a"}},
+		},
+
+		// error case
+		"Error returns error string and reports of successful sources": {
+			specs:       []spec{{source: strPtr("a")}, {source: strPtr("b")}},
+			outReports:  true,
+			mockOut:     [][]byte{nil, []byte(`{"output": "b"}`)},
+			mockErr:     errors.New("error string"),
+			wantSources: []insights.SourceSpec{{Source: "a"}, {Source: "b"}},
+			wantReports: []string{"", `{"output": "b"}`},
+		},
+	}
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			inConfig, cleanup := makeConfig(nil)
+			defer cleanup()
+
+			var specs []C.insights_source_spec
+			for _, s := range tc.specs {
+				cs := C.insights_source_spec{flags: s.flags}
+				if s.source != nil {
+					cs.source = C.CString(*s.source)
+					defer C.free(unsafe.Pointer(cs.source))
+				}
+				if s.metricsPath != nil {
+					cs.flags.source_metrics_path = C.CString(*s.metricsPath)
+					defer C.free(unsafe.Pointer(cs.flags.source_metrics_path))
+				}
+				specs = append(specs, cs)
+			}
+			var specsPtr *C.insights_source_spec
+			if len(specs) > 0 {
+				specsPtr = &specs[0]
+			}
+
+			var outReports []*C.char
+			var outReportsPtr **C.char
+			if tc.outReports {
+				outReports = make([]*C.char, len(specs))
+				outReportsPtr = &outReports[0]
+			}
+
+			var gotSources []insights.SourceSpec
+			ret := collectManyCustomInsights(inConfig, specsPtr, C.size_t(len(specs)), outReportsPtr, func(conf insights.Config, sources []insights.SourceSpec) ([][]byte, error) {
+				assert.NotNil(t, conf.Logger, "Logger should not be nil in the callback")
+				gotSources = sources
+				return tc.mockOut, tc.mockErr
+			})
+			defer C.free(unsafe.Pointer(ret))
+
+			if tc.mockErr == nil {
+				assert.Nil(t, ret)
+			} else {
+				assert.Equal(t, tc.mockErr.Error(), C.GoString(ret))
+			}
+
+			// ensure SourceMetricsJSON is nil for better comparison
+			for i := range gotSources {
+				assert.Empty(t, gotSources[i].Flags.SourceMetricsJSON, "SourceMetricsJSON should be empty when not provided")
+				gotSources[i].Flags.SourceMetricsJSON = nil
+			}
+			assert.Equal(t, tc.wantSources, gotSources, "C structures should be correctly translated to Go")
+
+			var gotReports []string
+			for _, r := range outReports {
+				gotReports = append(gotReports, C.GoString(r))
+				C.free(unsafe.Pointer(r))
+			}
+			assert.Equal(t, tc.wantReports, gotReports, "Reports should be returned at the index of their source")
+		})
+	}
+}
+
+// TestSectionsImpl tests that the C sections match the Go ones.
+func TestSectionsImpl(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		c    insights.Sections
+		want insights.Sections
+	}{
+		"Hardware product":      {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_PRODUCT), want: insights.SectionHardwareProduct},
+		"Hardware CPU":          {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_CPU), want: insights.SectionHardwareCPU},
+		"Hardware GPUs":         {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_GPUS), want: insights.SectionHardwareGPUs},
+		"Hardware accelerators": {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_ACCELERATORS), want: insights.SectionHardwareAccelerators},
+		"Hardware memory":       {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_MEMORY), want: insights.SectionHardwareMemory},
+		"Hardware disks":        {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_DISKS), want: insights.SectionHardwareDisks},
+		"Hardware screens":      {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE_SCREENS), want: insights.SectionHardwareScreens},
+		"Hardware":              {c: insights.Sections(C.INSIGHTS_SECTION_HARDWARE), want: insights.SectionHardware},
+
+		"Software OS":       {c: insights.Sections(C.INSIGHTS_SECTION_SOFTWARE_OS), want: insights.SectionSoftwareOS},
+		"Software timezone": {c: insights.Sections(C.INSIGHTS_SECTION_SOFTWARE_TIMEZONE), want: insights.SectionSoftwareTimezone},
+		"Software language": {c: insights.Sections(C.INSIGHTS_SECTION_SOFTWARE_LANGUAGE), want: insights.SectionSoftwareLanguage},
+		"Software BIOS":     {c: insights.Sections(C.INSIGHTS_SECTION_SOFTWARE_BIOS), want: insights.SectionSoftwareBios},
+		"Software":          {c: insights.Sections(C.INSIGHTS_SECTION_SOFTWARE), want: insights.SectionSoftware},
+
+		"Platform WSL":          {c: insights.Sections(C.INSIGHTS_SECTION_PLATFORM_WSL), want: insights.SectionPlatformWSL},
+		"Platform desktop":      {c: insights.Sections(C.INSIGHTS_SECTION_PLATFORM_DESKTOP), want: insights.SectionPlatformDesktop},
+		"Platform pro attached": {c: insights.Sections(C.INSIGHTS_SECTION_PLATFORM_PRO_ATTACHED), want: insights.SectionPlatformProAttached},
+		"Platform":              {c: insights.Sections(C.INSIGHTS_SECTION_PLATFORM), want: insights.SectionPlatform},
+
+		"All": {c: insights.Sections(C.INSIGHTS_SECTION_ALL), want: insights.SectionAll},
+	}
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			assert.Equal(t, tc.want, tc.c, "C section should match the Go one")
+		})
+	}
+}
+
 // TestCompileImpl tests compile.
 func TestCompileImpl(t *testing.T) {
 	t.Parallel()
@@ -189,6 +377,8 @@ func TestCompileImpl(t *testing.T) {
 		config            *insightsConfig
 		metricsPath       *string
 		sourceMetricsJSON []byte
+		metrics           func(*testing.T) C.insights_metrics
+		sections          C.uint32_t
 
 		outReport **C.char
 
@@ -209,6 +399,12 @@ func TestCompileImpl(t *testing.T) {
 			metricsPath:       strPtr("metrics"),
 			sourceMetricsJSON: []byte(`{"key": "value"}`),
 		},
+		"SourceMetrics gets converted": {
+			metrics: makeMetrics,
+		},
+		"Sections get converted": {
+			sections: C.uint32_t(C.INSIGHTS_SECTION_SOFTWARE_OS),
+		},
 
 		// Report output
 		"Report is returned when outReport and outReportLen are provided": {
@@ -246,7 +442,7 @@ func TestCompileImpl(t *testing.T) {
 			inConfig, cleanup := makeConfig(tc.config)
 			defer cleanup()
 
-			flags := &C.insights_compile_flags{}
+			flags := &C.insights_compile_flags{sections: tc.sections}
 			if tc.metricsPath != nil {
 				flags.source_metrics_path = C.CString(*tc.metricsPath)
 				defer C.free(unsafe.Pointer(flags.source_metrics_path))
@@ -257,6 +453,11 @@ func TestCompileImpl(t *testing.T) {
 				flags.source_metrics_json_len = C.size_t(len(tc.sourceMetricsJSON))
 			}
 
+			if tc.metrics != nil {
+				flags.source_metrics = tc.metrics(t)
+				defer insights_metrics_free(flags.source_metrics)
+			}
+
 			var got struct {
 				Conf  insights.Config
 				Flags insights.CompileFlags
@@ -291,6 +492,9 @@ func TestCompileImpl(t *testing.T) {
 				got.Flags.SourceMetricsJSON = []byte{}
 			}
 
+			assertMetrics(t, tc.metrics != nil, got.Flags.SourceMetrics)
+			got.Flags.SourceMetrics = nil
+
 			assert.NotNil(t, got.Conf.Logger, "Logger should not be nil in the callback")
 			got.Conf.Logger = nil // Logger is not part of the golden file, so we set it to nil for comparison.
 			want := testutils.LoadWithUpdateFromGoldenYAML(t, got)
@@ -299,6 +503,258 @@ func TestCompileImpl(t *testing.T) {
 	}
 }
 
+// TestMetricsImpl tests building source metrics through the C API.
+func TestMetricsImpl(t *testing.T) {
+	t.Parallel()
+
+	key := C.CString("key")
+	defer C.free(unsafe.Pointer(key))
+	value := C.CString("value")
+	defer C.free(unsafe.Pointer(value))
+
+	tests := map[string]struct {
+		set func(m C.insights_metrics) C.bool
+
+		want   string
+		wantOk bool
+	}{
+		"Int is set":    {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_int(m, key, -7) }, want: `{"key":-7}`, wantOk: true},
+		"String is set": {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_str(m, key, value) }, want: `{"key":"value"}`, wantOk: true},
+		"Bool is set":   {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_bool(m, key, true) }, want: `{"key":true}`, wantOk: true},
+		"Double is set": {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_double(m, key, 1.5) }, want: `{"key":1.5}`, wantOk: true},
+		"Object is set": {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_object(m, key, m) }, want: `{"key":{}}`, wantOk: true},
+
+		// Error cases
+		"Null key is rejected":      {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_int(m, nil, 1) }, want: `{}`},
+		"Null string is rejected":   {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_str(m, key, nil) }, want: `{}`},
+		"NaN is rejected":           {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_double(m, key, C.double(math.NaN())) }, want: `{}`},
+		"Null object is rejected":   {set: func(m C.insights_metrics) C.bool { return insights_metrics_set_object(m, key, 0) }, want: `{}`},
+		"Null metrics are rejected": {set: func(C.insights_metrics) C.bool { return insights_metrics_set_bool(0, key, true) }, want: `{}`},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			m := insights_metrics_new()
+			defer insights_metrics_free(m)
+
+			require.Equal(t, tc.wantOk, bool(tc.set(m)), "Setter should return whether the value was set")
+
+			got, err := toGoMetrics(m).MarshalJSON()
+			require.NoError(t, err, "Metrics should encode")
+			assert.Equal(t, tc.want, string(got), "Metrics should hold the expected values")
+		})
+	}
+
+	// Freeing no metrics is a no-op.
+	insights_metrics_free(0)
+}
+
+// makeMetrics builds source metrics holding a nested object through the C API.
+func makeMetrics(t *testing.T) C.insights_metrics {
+	t.Helper()
+
+	cstr := func(s string) *C.char {
+		c := C.CString(s)
+		t.Cleanup(func() { C.free(unsafe.Pointer(c)) })
+		return c
+	}
+
+	nested := insights_metrics_new()
+	defer insights_metrics_free(nested)
+	require.True(t, bool(insights_metrics_set_double(nested, cstr("ratio"), 0.25)), "Setup: failed to set double")
+
+	m := insights_metrics_new()
+	require.True(t, bool(insights_metrics_set_str(m, cstr("name"), cstr("host"))), "Setup: failed to set string")
+	require.True(t, bool(insights_metrics_set_int(m, cstr("count"), 3)), "Setup: failed to set int")
+	require.True(t, bool(insights_metrics_set_bool(m, cstr("enabled"), true)), "Setup: failed to set bool")
+	require.True(t, bool(insights_metrics_set_object(m, cstr("nested"), nested)), "Setup: failed to set object")
+	return m
+}
+
+// assertMetrics checks that the converted metrics are the ones built by makeMetrics when set, and nil otherwise.
+func assertMetrics(t *testing.T, set bool, m *insights.Metrics) {
+	t.Helper()
+
+	if !set {
+		assert.Nil(t, m, "SourceMetrics should be nil when not provided")
+		return
+	}
+	require.NotNil(t, m, "SourceMetrics should be converted")
+	got, err := m.MarshalJSON()
+	require.NoError(t, err, "SourceMetrics should encode")
+	assert.Equal(t, `{"name":"host","count":3,"enabled":true,"nested":{"ratio":0.25}}`, string(got), "SourceMetrics should hold the values set through C")
+}
+
+// TestListReportsImpl tests listing reports through the C API.
+func TestListReportsImpl(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		source    *string
+		states    C.uint32_t
+		stopAfter int
+		noCb      bool
+
+		want    map[int64]C.insights_report_state
+		wantErr bool
+	}{
+		"Lists all reports": {
+			source: strPtr("source"), states: C.INSIGHTS_REPORT_ALL,
+			want: map[int64]C.insights_report_state{1: C.INSIGHTS_REPORT_LOCAL, 2: C.INSIGHTS_REPORT_UPLOADED},
+		},
+		"Lists local reports": {
+			source: strPtr("source"), states: C.INSIGHTS_REPORT_LOCAL,
+			want: map[int64]C.insights_report_state{1: C.INSIGHTS_REPORT_LOCAL},
+		},
+		"Lists uploaded reports": {
+			source: strPtr("source"), states: C.INSIGHTS_REPORT_UPLOADED,
+			want: map[int64]C.insights_report_state{2: C.INSIGHTS_REPORT_UPLOADED},
+		},
+		"Null source lists platform reports": {
+			states: C.INSIGHTS_REPORT_ALL,
+			want:   map[int64]C.insights_report_state{3: C.INSIGHTS_REPORT_LOCAL},
+		},
+		"Stops when the callback returns false": {
+			source: strPtr("source"), states: C.INSIGHTS_REPORT_ALL, stopAfter: 1,
+		},
+
+		// Error cases
+		"Null callback errors": {source: strPtr("source"), states: C.INSIGHTS_REPORT_ALL, noCb: true, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := setupReportStore(t)
+			inConfig, cleanup := makeConfig(&insightsConfig{cache: &dir})
+			defer cleanup()
+
+			var source *C.char
+			if tc.source != nil {
+				source = C.CString(*tc.source)
+				defer C.free(unsafe.Pointer(source))
+			}
+
+			list := (*C.test_report_list)(C.calloc(1, C.sizeof_test_report_list))
+			defer C.free(unsafe.Pointer(list))
+			list.stop_after = C.int(tc.stopAfter)
+
+			cb := C.get_test_report_callback()
+			if tc.noCb {
+				cb = nil
+			}
+
+			ret := insights_list_reports(inConfig, source, tc.states, cb, unsafe.Pointer(list))
+			defer C.free(unsafe.Pointer(ret))
+			if tc.wantErr {
+				require.NotNil(t, ret, "insights_list_reports should return an error")
+				return
+			}
+			require.Nil(t, ret, "insights_list_reports should not return an error, got %s", C.GoString(ret))
+
+			if tc.stopAfter > 0 {
+				require.Equal(t, tc.stopAfter, int(list.count), "Listing should stop when the callback returns false")
+				return
+			}
+			got := make(map[int64]C.insights_report_state)
+			for _, info := range list.infos[:list.count] {
+				assert.Equal(t, C.int64_t(len(reportContent(int64(info.timestamp)))), info.size, "Size should be the one of the report")
+				got[int64(info.timestamp)] = info.state
+			}
+			assert.Equal(t, tc.want, got, "Listed reports should be the ones in the selected states")
+		})
+	}
+}
+
+// TestReadReportImpl tests reading reports through the C API.
+func TestReadReportImpl(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		source    *string
+		state     C.insights_report_state
+		timestamp C.int64_t
+		noView    bool
+
+		wantErr bool
+	}{
+		"Reads local report":                {source: strPtr("source"), state: C.INSIGHTS_REPORT_LOCAL, timestamp: 1},
+		"Reads uploaded report":             {source: strPtr("source"), state: C.INSIGHTS_REPORT_UPLOADED, timestamp: 2},
+		"Null source reads platform report": {state: C.INSIGHTS_REPORT_LOCAL, timestamp: 3},
+
+		// Error cases
+		"Missing report errors": {source: strPtr("source"), state: C.INSIGHTS_REPORT_LOCAL, timestamp: 2, wantErr: true},
+		"Several states error":  {source: strPtr("source"), state: C.INSIGHTS_REPORT_ALL, timestamp: 1, wantErr: true},
+		"Null out_view errors":  {source: strPtr("source"), state: C.INSIGHTS_REPORT_LOCAL, timestamp: 1, noView: true, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := setupReportStore(t)
+			inConfig, cleanup := makeConfig(&insightsConfig{cache: &dir})
+			defer cleanup()
+
+			var source *C.char
+			if tc.source != nil {
+				source = C.CString(*tc.source)
+				defer C.free(unsafe.Pointer(source))
+			}
+
+			var view *C.insights_report_view
+			if !tc.noView {
+				view = (*C.insights_report_view)(C.calloc(1, C.sizeof_insights_report_view))
+				defer C.free(unsafe.Pointer(view))
+			}
+
+			ret := insights_read_report(inConfig, source, tc.state, tc.timestamp, view)
+			defer C.free(unsafe.Pointer(ret))
+			if tc.wantErr {
+				require.NotNil(t, ret, "insights_read_report should return an error")
+				if view != nil {
+					assert.Nil(t, view.data, "View should be zeroed on error")
+				}
+				return
+			}
+			require.Nil(t, ret, "insights_read_report should not return an error, got %s", C.GoString(ret))
+
+			got := C.GoStringN(view.data, C.int(view.len))
+			assert.Equal(t, reportContent(int64(tc.timestamp)), got, "View should hold the content of the report")
+
+			insights_free_report_view(view)
+			assert.Nil(t, view.data, "View should be zeroed once released")
+			insights_free_report_view(view)
+			insights_free_report_view(nil)
+		})
+	}
+}
+
+// setupReportStore creates reports for a source and the platform source in a new insights directory,
+// which is returned.
+func setupReportStore(t *testing.T) string {
+	t.Helper()
+
+	dir := t.TempDir()
+	for path, timestamp := range map[string]int64{
+		filepath.Join("source", "local", "1.json"):                 1,
+		filepath.Join("source", "uploaded", "2.json"):              2,
+		filepath.Join(constants.PlatformSource, "local", "3.json"): 3,
+	} {
+		require.NoError(t, os.MkdirAll(filepath.Join(dir, filepath.Dir(path)), 0700), "Setup: failed to create report directory")
+		require.NoError(t, os.WriteFile(filepath.Join(dir, path), []byte(reportContent(timestamp)), 0600), "Setup: failed to write report")
+	}
+	return dir
+}
+
+// reportContent returns the content of the report with the timestamp in the store created by setupReportStore.
+func reportContent(timestamp int64) string {
+	return fmt.Sprintf(`{"report":%d}`, timestamp)
+}
+
 // TestWriteImpl tests the write functionality.
 func TestWriteImpl(t *testing.T) {
 	t.Parallel()
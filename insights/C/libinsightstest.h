@@ -10,6 +10,8 @@
 // External functions from libinsights
 extern char* insights_collect(const insights_config*, const char*,
                               const insights_collect_flags*, char**);
+extern char* insights_collect_many(const insights_config*,
+                                   const insights_source_spec*, size_t, char**);
 extern char* insights_compile(const insights_config*,
                               const insights_compile_flags*, char**);
 extern char* insights_write(const insights_config*, const char*, const char*,
@@ -23,6 +25,12 @@ extern char* insights_set_consent_state(const insights_config*, const char*,
 extern bool insights_get_system_opt_out_state(const insights_config*);
 extern char* insights_set_system_opt_out_state(const insights_config*, bool);
 extern void insights_set_log_callback(insights_logger_callback);
+extern char* insights_list_reports(const insights_config*, const char*,
+                                   uint32_t, insights_report_callback, void*);
+extern char* insights_read_report(const insights_config*, const char*,
+                                  insights_report_state, int64_t,
+                                  insights_report_view*);
+extern void insights_free_report_view(insights_report_view*);
 
 // Test helpers
 insights_logger_callback get_test_callback();
@@ -31,4 +39,15 @@ int get_test_cb_count();
 char* get_test_cb_buffer();
 bool get_test_cb_buf_exceeded();
 
+#define TEST_REPORT_LIST_MAX 8
+
+// Reports received by the test report callback, passed as its user_data.
+typedef struct {
+  int count;
+  int stop_after;  // Stop the listing after this many reports, 0 for never.
+  insights_report_info infos[TEST_REPORT_LIST_MAX];
+} test_report_list;
+
+insights_report_callback get_test_report_callback();
+
 #endif
@@ -18,6 +18,86 @@ typedef enum {
   INSIGHTS_LOG_DEBUG = 3,
 } insights_log_level;
 
+/**
+ * @brief System information sections, combined as a bitmask in the
+ * sections field of the collect and compile flags.
+ *
+ * The probes of the sections left out are not run at all.
+ * A mask of 0 collects everything.
+ */
+typedef enum {
+  INSIGHTS_SECTION_HARDWARE_PRODUCT = 1 << 0,
+  INSIGHTS_SECTION_HARDWARE_CPU = 1 << 1,
+  INSIGHTS_SECTION_HARDWARE_GPUS = 1 << 2,
+  INSIGHTS_SECTION_HARDWARE_ACCELERATORS = 1 << 3,
+  INSIGHTS_SECTION_HARDWARE_MEMORY = 1 << 4,
+  INSIGHTS_SECTION_HARDWARE_DISKS = 1 << 5,
+  INSIGHTS_SECTION_HARDWARE_SCREENS = 1 << 6,
+  INSIGHTS_SECTION_HARDWARE = 0x7F,
+
+  INSIGHTS_SECTION_SOFTWARE_OS = 1 << 8,
+  INSIGHTS_SECTION_SOFTWARE_TIMEZONE = 1 << 9,
+  INSIGHTS_SECTION_SOFTWARE_LANGUAGE = 1 << 10,
+  INSIGHTS_SECTION_SOFTWARE_BIOS = 1 << 11,
+  INSIGHTS_SECTION_SOFTWARE = 0xF00,
+
+  INSIGHTS_SECTION_PLATFORM_WSL = 1 << 16,
+  INSIGHTS_SECTION_PLATFORM_DESKTOP = 1 << 17,
+  INSIGHTS_SECTION_PLATFORM_PRO_ATTACHED = 1 << 18,
+  INSIGHTS_SECTION_PLATFORM = 0x70000,
+
+  INSIGHTS_SECTION_ALL = 0x70F7F,
+} insights_section;
+
+/**
+ * @brief Handle to source metrics built with insights_metrics_new and the
+ * insights_metrics_set_* functions, without encoding them to JSON first.
+ *
+ * A handle must be released with insights_metrics_free. 0 is never a valid
+ * handle, and stands for no source metrics in the collect and compile flags.
+ * A handle must not be used concurrently from multiple threads.
+ */
+typedef uintptr_t insights_metrics;
+
+/**
+ * @brief Report states, combined as a bitmask to select the reports listed
+ * by insights_list_reports.
+ */
+typedef enum {
+  INSIGHTS_REPORT_LOCAL = 1 << 0,     // Collected, waiting to be uploaded
+  INSIGHTS_REPORT_UPLOADED = 1 << 1,  // Uploaded, or replaced by an opt-out
+  INSIGHTS_REPORT_ALL = 0x3,
+} insights_report_state;
+
+/**
+ * @brief Metadata of a report, as listed by insights_list_reports.
+ */
+typedef struct {
+  int64_t timestamp;  // Collection time of the report, as a Unix timestamp
+  int64_t size;       // Size of the report in bytes
+  insights_report_state state;  // Single state of the report
+} insights_report_info;
+
+/**
+ * @brief Callback receiving each report listed by insights_list_reports.
+ *
+ * info is only valid during the call. Returning false stops the listing.
+ */
+typedef bool (*insights_report_callback)(const insights_report_info* info,
+                                         void* user_data);
+
+/**
+ * @brief Read-only view of a report, returned by insights_read_report.
+ *
+ * data is not null-terminated, and is valid until the view is released with
+ * insights_free_report_view.
+ */
+typedef struct {
+  const char* data;  // Content of the report
+  size_t len;        // Length of data in bytes
+  uintptr_t handle;  // Internal, released by insights_free_report_view
+} insights_report_view;
+
 typedef void (*insights_logger_callback)(insights_log_level level,
                                          const char* msg);
 
@@ -35,7 +115,8 @@ typedef struct {
 /**
  * @brief Parameters for insights collection.
  *
- * @note source_metrics_path and source_metrics_json are mutually exclusive.
+ * @note source_metrics_path, source_metrics_json and source_metrics are
+ * mutually exclusive.
  */
 typedef struct {
   const char* source_metrics_path;  // Path to JSON file (default: empty)
@@ -44,12 +125,33 @@ typedef struct {
   uint32_t period;                  // Collection period in seconds (default: 0)
   bool force;    // Force collection, ignoring duplicates (default: false)
   bool dry_run;  // Simulate operation without writing files (default: false)
+  uint32_t sections;  // Bitmask of insights_section to collect (default: 0,
+                      // everything)
+  insights_metrics source_metrics;  // Built source metrics (default: 0)
 } insights_collect_flags;
 
+/**
+ * @brief A source to collect with insights_collect_many, with its own
+ * collection parameters.
+ */
+typedef struct {
+  const char* source;  // Source name (default: platform source)
+  insights_collect_flags flags;  // Parameters for this source
+} insights_source_spec;
+
+/**
+ * @brief Parameters for insights compilation.
+ *
+ * @note source_metrics_path, source_metrics_json and source_metrics are
+ * mutually exclusive.
+ */
 typedef struct {
   const char* source_metrics_path;  // Path to JSON file (default: empty)
   const void* source_metrics_json;  // Raw JSON data as bytes (default: NULL)
   size_t source_metrics_json_len;   // Length of source_metrics_json in bytes
+  uint32_t sections;  // Bitmask of insights_section to collect (default: 0,
+                      // everything)
+  insights_metrics source_metrics;  // Built source metrics (default: 0)
 } insights_compile_flags;
 
 typedef struct {
@@ -69,6 +171,7 @@ typedef struct {
 typedef const char insights_const_char;
 typedef const insights_config insights_const_config;
 typedef const insights_collect_flags insights_const_collect_flags;
+typedef const insights_source_spec insights_const_source_spec;
 typedef const insights_compile_flags insights_const_compile_flags;
 typedef const insights_write_flags insights_const_write_flags;
 typedef const insights_upload_flags insights_const_upload_flags;
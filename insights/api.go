@@ -3,14 +3,17 @@ package insights
 
 import (
 	"bytes"
-	"encoding/json"
 	"errors"
 	"fmt"
 	"log/slog"
+	"path/filepath"
 
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/consent"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/systemconfig"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/uploader"
 )
@@ -24,19 +27,68 @@ type Config struct {
 	Logger *slog.Logger // Optional logger, if not set, a new one will be created.
 }
 
+// Sections is a mask selecting the parts of the system information to collect.
+// Probes of the sections left out are not run at all. An empty mask collects everything.
+type Sections = sections.Mask
+
+// System information sections, to be combined into Sections.
+const (
+	SectionHardwareProduct      = sections.HardwareProduct
+	SectionHardwareCPU          = sections.HardwareCPU
+	SectionHardwareGPUs         = sections.HardwareGPUs
+	SectionHardwareAccelerators = sections.HardwareAccelerators
+	SectionHardwareMemory       = sections.HardwareMemory
+	SectionHardwareDisks        = sections.HardwareDisks
+	SectionHardwareScreens      = sections.HardwareScreens
+	SectionHardware             = sections.Hardware
+
+	SectionSoftwareOS       = sections.SoftwareOS
+	SectionSoftwareTimezone = sections.SoftwareTimezone
+	SectionSoftwareLanguage = sections.SoftwareLanguage
+	SectionSoftwareBios     = sections.SoftwareBios
+	SectionSoftware         = sections.Software
+
+	SectionPlatformWSL         = sections.PlatformWSL
+	SectionPlatformDesktop     = sections.PlatformDesktop
+	SectionPlatformProAttached = sections.PlatformProAttached
+	SectionPlatform            = sections.Platform
+
+	SectionAll = sections.All
+)
+
+// Metrics holds source metrics built key by key, which saves encoding them to JSON beforehand.
+// Keys are reported in the order they were first set in, and setting a key again replaces its value.
+// A Metrics is not safe for concurrent use.
+type Metrics = collector.Metrics
+
+// NewMetrics returns empty source metrics, to be filled with the Set methods.
+func NewMetrics() *Metrics {
+	return collector.NewMetrics()
+}
+
 // CollectFlags represents optional parameters for Collect.
 type CollectFlags struct {
-	SourceMetricsPath string // Path to a JSON file a valid JSON object for source metrics.
-	SourceMetricsJSON []byte // JSON object for source metrics.
+	SourceMetricsPath string   // Path to a JSON file a valid JSON object for source metrics.
+	SourceMetricsJSON []byte   // JSON object for source metrics.
+	SourceMetrics     *Metrics // Source metrics built in place.
 	Period            uint32
 	Force             bool
 	DryRun            bool
+	Sections          Sections // System information sections to collect, everything if empty.
+}
+
+// SourceSpec describes a source to collect with CollectMany, along with its own collection parameters.
+type SourceSpec struct {
+	Source string
+	Flags  CollectFlags
 }
 
 // CompileFlags represents optional parameters for Compile.
 type CompileFlags struct {
-	SourceMetricsPath string // Path to a JSON file a valid JSON object for source metrics.
-	SourceMetricsJSON []byte // JSON object for source metrics.
+	SourceMetricsPath string   // Path to a JSON file a valid JSON object for source metrics.
+	SourceMetricsJSON []byte   // JSON object for source metrics.
+	SourceMetrics     *Metrics // Source metrics built in place.
+	Sections          Sections // System information sections to collect, everything if empty.
 }
 
 // WriteFlags represents optional parameters for Write.
@@ -51,8 +103,27 @@ type UploadFlags struct {
 	MinAge uint32
 	Force  bool
 	DryRun bool
+	Deltas bool // Deltas sends reports as deltas against the last uploaded report, when the server supports it.
 }
 
+// ReportState is where a report is in its lifecycle, combined as a bitmask to select reports in several states.
+type ReportState = report.State
+
+// Report states, to be combined into a ReportState.
+const (
+	ReportLocal    = report.StateLocal    // Collected, waiting to be uploaded.
+	ReportUploaded = report.StateUploaded // Uploaded, or replaced by an opt-out report.
+
+	ReportAll = report.StateAll
+)
+
+// ReportInfo is the metadata of a report, as listed by ListReports.
+type ReportInfo = report.Info
+
+// ReportView is the read-only content of a report, returned by ReadReport.
+// Its Bytes are only valid until it is closed.
+type ReportView = fileutils.Mapping
+
 // Collect errors.
 var (
 	// ErrDuplicateReport is returned by Collect when a report for the specified period already exists.
@@ -99,8 +170,8 @@ func (c Config) Resolve() Config {
 
 // Collect creates a report for the specified source and writes it to Config.InsightsDir.
 //
-// The SourceMetricsPath and SourceMetricsJSON fields in flags are mutually exclusive.
-// If both are set, an error will be returned.
+// The SourceMetricsPath, SourceMetricsJSON and SourceMetrics fields in flags are mutually exclusive.
+// If more than one is set, an error will be returned.
 // If SourceMetricsPath in flags is set, it must be a valid path to a JSON file with a valid JSON object.
 // SourceMetricsJSON in flags if set must be a valid JSON object, not an array or primitive.
 //
@@ -113,37 +184,78 @@ func (c Config) Resolve() Config {
 func (c Config) Collect(source string, flags CollectFlags) ([]byte, error) {
 	r := c.Resolve()
 
+	cm := consent.NewWithSystemConfig(r.Logger, r.ConsentDir, r.SystemConfigDir)
+	return r.collect(cm, source, flags)
+}
+
+// CollectMany creates a report for each of the specified sources, as Collect does, and writes them to Config.InsightsDir.
+// System information is collected once and shared by all reports, while source metrics and consent are handled per source.
+//
+// Sources are collected in order, and a failing source does not prevent the others from being collected.
+// The returned slice holds the pretty printed report of each source at the same index, or nil if that source failed.
+// The errors of all failing sources are joined in the returned error.
+//
+// This method calls Resolve() on the config before proceeding.
+func (c Config) CollectMany(sources []SourceSpec) ([][]byte, error) {
+	r := c.Resolve()
+
+	// The shared snapshot covers the sections of all sources, and each report only keeps its own.
+	var union Sections
+	for _, s := range sources {
+		union |= s.Flags.Sections.OrAll()
+	}
+
+	cm := consent.NewWithSystemConfig(r.Logger, r.ConsentDir, r.SystemConfigDir)
+	shared := collector.NewSharedSysInfo(union)
+
+	reports := make([][]byte, len(sources))
+	var errs error
+	for i, s := range sources {
+		report, err := r.collect(cm, s.Source, s.Flags, collector.WithSharedSysInfo(shared))
+		if err != nil {
+			errs = errors.Join(errs, fmt.Errorf("failed to collect source %q: %w", s.Source, err))
+			continue
+		}
+		reports[i] = report
+	}
+
+	return reports, errs
+}
+
+// collect compiles and writes a report for a single source, with an already resolved config.
+func (c Config) collect(cm collector.Consent, source string, flags CollectFlags, args ...collector.Options) ([]byte, error) {
 	cConf := collector.Config{
 		Source:            source,
-		CachePath:         r.InsightsDir,
+		CachePath:         c.InsightsDir,
 		SourceMetricsPath: flags.SourceMetricsPath,
 		SourceMetricsJSON: flags.SourceMetricsJSON,
+		SourceMetrics:     flags.SourceMetrics,
+		Sections:          flags.Sections,
 	}
 
-	cm := consent.NewWithSystemConfig(r.Logger, r.ConsentDir, r.SystemConfigDir)
-	col, err := collector.New(r.Logger, cm, cConf)
+	col, err := collector.New(c.Logger, cm, cConf, args...)
 	if err != nil {
 		return nil, err
 	}
 
-	insights, err := col.Compile()
+	report, err := col.Compile()
 	if err != nil { // Errors may need to be exposed for caller correction.
 		return nil, err
 	}
 
-	if err := col.Write(insights, flags.Period, flags.Force, flags.DryRun); err != nil {
+	if err := col.Write(report, flags.Period, flags.Force, flags.DryRun); err != nil {
 		if !flags.DryRun || !errors.Is(err, ErrConsentFileNotFound) {
 			return nil, err
 		}
 	}
 
-	return json.MarshalIndent(insights, "", "  ")
+	return report.PrettyJSON()
 }
 
 // Compile compiles and returns a pretty printed insights report. Consent and duplicity are not checked.
 //
-// The SourceMetricsPath and SourceMetricsJSON fields in flags are mutually exclusive.
-// If both are set, an error will be returned.
+// The SourceMetricsPath, SourceMetricsJSON and SourceMetrics fields in flags are mutually exclusive.
+// If more than one is set, an error will be returned.
 // If SourceMetricsPath in flags is set, it must be a valid path to a JSON file with a valid JSON object.
 // SourceMetricsJSON in flags if set must be a valid JSON object, not an array or primitive.
 func (c Config) Compile(flags CompileFlags) ([]byte, error) {
@@ -154,6 +266,8 @@ func (c Config) Compile(flags CompileFlags) ([]byte, error) {
 		CachePath:         r.InsightsDir,
 		SourceMetricsPath: flags.SourceMetricsPath,
 		SourceMetricsJSON: flags.SourceMetricsJSON,
+		SourceMetrics:     flags.SourceMetrics,
+		Sections:          flags.Sections,
 	}
 
 	// TODO: remove consent manager dependency from Compile
@@ -164,12 +278,12 @@ func (c Config) Compile(flags CompileFlags) ([]byte, error) {
 		return nil, err
 	}
 
-	insights, err := col.Compile()
+	report, err := col.Compile()
 	if err != nil { // Errors may need to be exposed for caller correction.
 		return nil, err
 	}
 
-	return json.MarshalIndent(insights, "", "  ")
+	return report.PrettyJSON()
 }
 
 // Write writes a valid insights report to disk based on consent.
@@ -188,14 +302,13 @@ func (c Config) Write(source string, report []byte, flags WriteFlags) error {
 		return err
 	}
 
-	var insightsObj collector.Insights
-	dec := json.NewDecoder(bytes.NewReader(report))
-	dec.DisallowUnknownFields()
-	if err := dec.Decode(&insightsObj); err != nil {
+	// The report is validated strictly, then written as given in compact form rather than re-encoded.
+	encoded, err := collector.ParseEncoded(bytes.NewReader(report))
+	if err != nil {
 		return err
 	}
 
-	return col.Write(insightsObj, flags.Period, flags.Force, flags.DryRun)
+	return col.Write(encoded, flags.Period, flags.Force, flags.DryRun)
 }
 
 // Upload uploads reports for the specified sources.
@@ -211,6 +324,7 @@ func (c Config) Upload(sources []string, flags UploadFlags) error {
 		Force:   flags.Force,
 		DryRun:  flags.DryRun,
 		Retry:   false,
+		Deltas:  flags.Deltas,
 	}
 	err := uConf.Sanitize(r.Logger, r.ConsentDir)
 	if err != nil {
@@ -218,7 +332,7 @@ func (c Config) Upload(sources []string, flags UploadFlags) error {
 	}
 
 	cm := consent.NewWithSystemConfig(r.Logger, r.ConsentDir, r.SystemConfigDir)
-	uploader, err := uploader.New(r.Logger, cm, r.InsightsDir, uConf.MinAge, uConf.DryRun)
+	uploader, err := uploader.New(r.Logger, cm, r.InsightsDir, uConf.MinAge, uConf.DryRun, uploader.WithDeltas(uConf.Deltas))
 	if err != nil {
 		return fmt.Errorf("failed to create uploader: %v", err)
 	}
@@ -226,6 +340,38 @@ func (c Config) Upload(sources []string, flags UploadFlags) error {
 	return uploader.UploadAll(uConf.Sources, uConf.Force, uConf.Retry)
 }
 
+// ListReports calls fn with the metadata of each report of the specified source in the selected states,
+// until fn returns false. If source is "", the reports of the platform source are listed.
+//
+// The metadata comes from directory entries alone, without reading the reports, so that listing
+// stays cheap however often it is done. Reports moved while listing may be missed or listed twice.
+//
+// This method calls Resolve() on the config before proceeding.
+func (c Config) ListReports(source string, states ReportState, fn func(ReportInfo) bool) error {
+	r := c.Resolve()
+	if source == "" {
+		source = constants.PlatformSource
+	}
+
+	return report.List(r.Logger, filepath.Join(r.InsightsDir, source), states, fn)
+}
+
+// ReadReport returns the content of the report of the specified source in state, with the given timestamp.
+// If source is "", the platform source is used. state must be a single state.
+//
+// The report is mapped read-only into memory where supported, rather than copied, and the view must be
+// closed after use. Reports are never modified in place, so the view keeps the content it was opened with.
+//
+// This method calls Resolve() on the config before proceeding.
+func (c Config) ReadReport(source string, state ReportState, timestamp int64) (*ReportView, error) {
+	r := c.Resolve()
+	if source == "" {
+		source = constants.PlatformSource
+	}
+
+	return report.Map(filepath.Join(r.InsightsDir, source), state, timestamp)
+}
+
 // GetConsentState gets the state for the specified source.
 // If source is "", the platform source consent state is retrieved.
 //
@@ -13,6 +13,7 @@ import (
 	"github.com/stretchr/testify/require"
 	"github.com/ubuntu/ubuntu-insights/insights"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 )
 
 func TestResolve(t *testing.T) {
@@ -163,6 +164,95 @@ func TestCollect(t *testing.T) {
 	}
 }
 
+// TestCollectMany tests the CollectMany insights.
+func TestCollectMany(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		sources []insights.SourceSpec
+
+		wantFailed []bool
+		wantErr    bool
+	}{
+		"No sources doesn't error": {},
+		"Sources with and without metrics don't error": {
+			sources: []insights.SourceSpec{
+				{Source: "valid_true", Flags: insights.CollectFlags{DryRun: true}},
+				{Source: "valid_false", Flags: insights.CollectFlags{SourceMetricsPath: "custom.json", DryRun: true}},
+				{Source: "missing_consent_file", Flags: insights.CollectFlags{SourceMetricsJSON: []byte(`{"key": "source metrics JSON"}`), DryRun: true}},
+			},
+			wantFailed: []bool{false, false, false},
+		},
+
+		// Error cases
+		"Failing source does not prevent collecting the others": {
+			sources: []insights.SourceSpec{
+				{Source: "valid_true", Flags: insights.CollectFlags{SourceMetricsJSON: []byte(`["array", "not", "object"]`), DryRun: true}},
+				{Source: "valid_false", Flags: insights.CollectFlags{DryRun: true}},
+			},
+			wantFailed: []bool{true, false},
+			wantErr:    true,
+		},
+	}
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+
+			conf := insights.Config{
+				ConsentDir:  filepath.Join("testdata", "consent_files"),
+				InsightsDir: dir,
+			}
+
+			for i, s := range tc.sources {
+				if s.Flags.SourceMetricsPath != "" {
+					tc.sources[i].Flags.SourceMetricsPath = filepath.Join("testdata", "metrics", s.Flags.SourceMetricsPath)
+				}
+			}
+
+			reports, err := conf.CollectMany(tc.sources)
+			if tc.wantErr {
+				require.Error(t, err)
+			} else {
+				require.NoError(t, err)
+			}
+			require.Len(t, reports, len(tc.sources), "CollectMany should return one report per source")
+
+			var sysInfo json.RawMessage
+			for i, report := range reports {
+				if tc.wantFailed[i] {
+					assert.Nil(t, report, "Failed source should not return a report")
+					continue
+				}
+
+				var mReport struct {
+					InsightsVersion string
+					SystemInfo      json.RawMessage
+					SourceMetrics   json.RawMessage
+				}
+				require.NoError(t, json.Unmarshal(report, &mReport), "Failed to unmarshal report")
+				assert.NotEmpty(t, mReport.InsightsVersion, "Insights version should not be empty")
+
+				if tc.sources[i].Flags.SourceMetricsJSON != nil || tc.sources[i].Flags.SourceMetricsPath != "" {
+					assert.NotEmpty(t, mReport.SourceMetrics, "Source metrics should not be empty")
+				} else {
+					assert.Empty(t, mReport.SourceMetrics, "Source metrics should be empty when not provided")
+				}
+
+				// All reports share the same system information snapshot.
+				if sysInfo == nil {
+					sysInfo = mReport.SystemInfo
+				}
+				assert.JSONEq(t, string(sysInfo), string(mReport.SystemInfo), "System information should be shared by all reports")
+
+				// test that dry run was applied.
+				assert.NoDirExists(t, filepath.Join(dir, tc.sources[i].Source, "local"))
+			}
+		})
+	}
+}
+
 func TestCompile(t *testing.T) {
 	t.Parallel()
 
@@ -360,6 +450,58 @@ func TestUpload(t *testing.T) {
 }
 
 // TestGetConsentState tests the GetConsentState insights.
+// TestListReports tests listing reports, and reading the listed ones.
+func TestListReports(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		source string
+		states insights.ReportState
+
+		want map[int64]string
+	}{
+		"Lists and reads all reports":         {source: "source", states: insights.ReportAll, want: map[int64]string{1: `{"report":1}`, 2: `{"report":2}`}},
+		"Lists and reads local reports":       {source: "source", states: insights.ReportLocal, want: map[int64]string{1: `{"report":1}`}},
+		"Lists and reads uploaded reports":    {source: "source", states: insights.ReportUploaded, want: map[int64]string{2: `{"report":2}`}},
+		"Lists platform reports by default":   {states: insights.ReportAll, want: map[int64]string{3: `{"report":3}`}},
+		"Lists no reports for missing source": {source: "missing", states: insights.ReportAll, want: map[int64]string{}},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			for path, data := range map[string]string{
+				filepath.Join("source", "local", "1.json"):                 `{"report":1}`,
+				filepath.Join("source", "uploaded", "2.json"):              `{"report":2}`,
+				filepath.Join(constants.PlatformSource, "local", "3.json"): `{"report":3}`,
+			} {
+				require.NoError(t, os.MkdirAll(filepath.Join(dir, filepath.Dir(path)), 0700), "Setup: failed to create report directory")
+				require.NoError(t, os.WriteFile(filepath.Join(dir, path), []byte(data), 0600), "Setup: failed to write report")
+			}
+			conf := insights.Config{InsightsDir: dir}
+
+			var infos []insights.ReportInfo
+			err := conf.ListReports(tc.source, tc.states, func(i insights.ReportInfo) bool {
+				infos = append(infos, i)
+				return true
+			})
+			require.NoError(t, err, "ListReports should not return an error")
+
+			got := make(map[int64]string)
+			for _, i := range infos {
+				v, err := conf.ReadReport(tc.source, i.State, i.TimeStamp)
+				require.NoError(t, err, "ReadReport should read listed reports")
+				assert.Equal(t, int64(len(v.Bytes())), i.Size, "ListReports should return the size of the report")
+				got[i.TimeStamp] = string(v.Bytes())
+				require.NoError(t, v.Close(), "Closing the report view should not fail")
+			}
+			assert.Equal(t, tc.want, got, "ListReports should list the reports in the selected states")
+		})
+	}
+}
+
 func TestGetConsentState(t *testing.T) {
 	t.Parallel()
 
@@ -1,7 +1,6 @@
 package commands
 
 import (
-	"encoding/json"
 	"errors"
 	"fmt"
 	"log/slog"
@@ -12,33 +11,31 @@ import (
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/consent"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 )
 
 func installCollectCmd(app *App) {
 	collectCmd := &cobra.Command{
-		Use:   "collect [source] [source-metrics-path](required if source provided)",
+		Use:   "collect [source source-metrics-path]...",
 		Short: "Collect system information",
 		Long: `Collect system information and metrics and store it locally.
 
 If source is not provided, then the source is assumed to be the currently detected platform. Additionally, there should be no source-metrics-path provided.
-If source is provided, then the source-metrics-path should be provided as well.`,
+If source is provided, then the source-metrics-path should be provided as well.
+Several sources can be collected at once by providing multiple source and source-metrics-path pairs. System information is then collected only once, and shared by the reports of all sources.`,
 		Args: func(cmd *cobra.Command, args []string) error {
-			if err := cobra.MaximumNArgs(2)(cmd, args); err != nil {
-				return err
+			if len(args)%2 != 0 {
+				return fmt.Errorf("accepts no args, or pairs of source and source-metrics-path args, received %d", len(args))
 			}
 
-			if len(args) != 0 {
-				if err := cobra.MatchAll(cobra.OnlyValidArgs, cobra.ExactArgs(2))(cmd, args); err != nil {
-					return fmt.Errorf("accepts no args, or exactly 2 args, received 1")
-				}
-
-				fileInfo, err := os.Stat(args[1])
+			for i := 1; i < len(args); i += 2 {
+				fileInfo, err := os.Stat(args[i])
 				if err != nil {
-					return fmt.Errorf("the second argument, source-metrics-path, should be a valid JSON file. Error: %s", err.Error())
+					return fmt.Errorf("the source-metrics-path of source %q should be a valid JSON file. Error: %s", args[i-1], err.Error())
 				}
 
 				if fileInfo.IsDir() {
-					return fmt.Errorf("the second argument, source-metrics-path, should be a valid JSON file, not a directory")
+					return fmt.Errorf("the source-metrics-path of source %q should be a valid JSON file, not a directory", args[i-1])
 				}
 			}
 
@@ -46,9 +43,19 @@ If source is provided, then the source-metrics-path should be provided as well.`
 		},
 		RunE: func(cmd *cobra.Command, args []string) error {
 			// Set Sources to Args
-			if len(args) == 2 {
+			switch {
+			case len(args) == 2:
 				app.config.Collect.Source = args[0]
 				app.config.Collect.SourceMetricsPath = args[1]
+			case len(args) > 2:
+				for i := 0; i < len(args); i += 2 {
+					app.config.Collect.sources = append(app.config.Collect.sources, collector.Config{
+						Source:               args[i],
+						SourceMetricsPath:    args[i+1],
+						MaxSourceMetricsSize: app.config.Collect.MaxSourceMetricsSize,
+						ReportFormat:         report.Format(app.config.Collect.ReportFormat),
+					})
+				}
 			}
 
 			slog.Info("Running collect command")
@@ -58,6 +65,8 @@ If source is provided, then the source-metrics-path should be provided as well.`
 
 	collectCmd.Flags().Uint32VarP(&app.config.Collect.Period, "period", "p", constants.DefaultPeriod, "the minimum period between 2 collection periods for validation purposes in seconds")
 	collectCmd.Flags().BoolVarP(&app.config.Collect.Force, "force", "f", false, "force a collection, override the report if there are any conflicts (doesn't ignore consent)")
+	collectCmd.Flags().Int64Var(&app.config.Collect.MaxSourceMetricsSize, "max-source-metrics-size", constants.DefaultMaxSourceMetricsSize, "the maximum size in bytes of a source metrics file")
+	collectCmd.Flags().StringVar(&app.config.Collect.ReportFormat, "report-format", string(report.FormatJSON), "the format to store reports in, either json or cbor (smaller, with a checksum instead of JSON validation)")
 	collectCmd.Flags().BoolVarP(&app.config.Collect.DryRun, "dry-run", "d", false, "perform a dry-run where a report is collected, but not written to disk")
 
 	app.cmd.AddCommand(collectCmd)
@@ -68,15 +77,35 @@ func (a App) collectRun() (err error) {
 	defer decorate.OnError(&err, "failed to collect insights")
 
 	l := slog.Default()
+	cm := consent.NewWithSystemConfig(l, a.config.consentDir, a.config.systemConfigDir)
 
-	cConfig := collector.Config{
-		Source:            a.config.Collect.Source,
-		CachePath:         a.config.insightsDir,
-		SourceMetricsPath: a.config.Collect.SourceMetricsPath,
+	sources := a.config.Collect.sources
+	if len(sources) == 0 {
+		return a.collectSource(l, cm, collector.Config{
+			Source:               a.config.Collect.Source,
+			SourceMetricsPath:    a.config.Collect.SourceMetricsPath,
+			MaxSourceMetricsSize: a.config.Collect.MaxSourceMetricsSize,
+			ReportFormat:         report.Format(a.config.Collect.ReportFormat),
+		})
 	}
 
-	cm := consent.NewWithSystemConfig(l, a.config.consentDir, a.config.systemConfigDir)
-	c, err := a.newCollector(l, cm, cConfig)
+	// All sources share a single system information snapshot, so that the system is only probed once.
+	shared := collector.NewSharedSysInfo(0)
+	var errs error
+	for _, s := range sources {
+		if err := a.collectSource(l, cm, s, collector.WithSharedSysInfo(shared)); err != nil {
+			errs = errors.Join(errs, fmt.Errorf("source %q: %w", s.Source, err))
+		}
+	}
+
+	return errs
+}
+
+// collectSource compiles and writes the report of a single source.
+func (a App) collectSource(l *slog.Logger, cm collector.Consent, cConfig collector.Config, args ...collector.Options) error {
+	cConfig.CachePath = a.config.insightsDir
+
+	c, err := a.newCollector(l, cm, cConfig, args...)
 	if err != nil {
 		if errors.Is(err, collector.ErrSanitizeError) {
 			a.cmd.SilenceUsage = false
@@ -85,22 +114,22 @@ func (a App) collectRun() (err error) {
 		return err
 	}
 
-	insights, err := c.Compile()
+	report, err := c.Compile()
 	if err != nil {
 		return err
 	}
 
 	if !a.config.Quiet {
-		ib, err := json.MarshalIndent(insights, "", "  ")
+		ib, err := report.PrettyJSON()
 		if err != nil {
 			return fmt.Errorf("failed to marshal insights report for console printing: %v", err)
 		}
 		fmt.Println(string(ib))
 	}
 
-	err = c.Write(insights, a.config.Collect.Period, a.config.Collect.Force, a.config.Collect.DryRun)
+	err = c.Write(report, a.config.Collect.Period, a.config.Collect.Force, a.config.Collect.DryRun)
 	if errors.Is(err, consent.ErrConsentFileNotFound) {
-		slog.Warn("Consent file not found, will not write insights report to disk or upload.")
+		slog.Warn("Consent file not found, will not write insights report to disk or upload.", "source", cConfig.Source)
 		return nil
 	}
 
@@ -14,6 +14,8 @@ import (
 	"github.com/ubuntu/ubuntu-insights/insights/cmd/insights/commands"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/consent"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 )
 
 func TestCollect(t *testing.T) {
@@ -27,8 +29,10 @@ func TestCollect(t *testing.T) {
 
 		platformConsent consentFixture
 
-		wantErr      bool
-		wantUsageErr bool
+		wantMaxSourceMetricsSize int64
+		wantReportFormat         report.Format
+		wantErr                  bool
+		wantUsageErr             bool
 	}{
 		// Platform source basic cases
 		"Collect Basic": {
@@ -50,6 +54,12 @@ func TestCollect(t *testing.T) {
 			args: []string{"collect", "source", getSourceMetricsPath("normal.json"), "--period=10", "--dry-run"},
 		}, "Collect source normal, period, dry-run, force": {
 			args: []string{"collect", "source", getSourceMetricsPath("normal.json"), "--period=10", "--dry-run", "--force"},
+		}, "Collect source normal, max source metrics size": {
+			args:                     []string{"collect", "source", getSourceMetricsPath("normal.json"), "--max-source-metrics-size=10"},
+			wantMaxSourceMetricsSize: 10,
+		}, "Collect source normal, report format": {
+			args:             []string{"collect", "source", getSourceMetricsPath("normal.json"), "--report-format=cbor"},
+			wantReportFormat: report.FormatCBOR,
 		},
 
 		// Argument usage errors
@@ -129,6 +139,14 @@ func TestCollect(t *testing.T) {
 			require.False(t, a.UsageError())
 
 			assert.Equal(t, cachePath, gotConfig.CachePath, "Cache path passed to app is not as expected")
+			if tc.wantMaxSourceMetricsSize == 0 {
+				tc.wantMaxSourceMetricsSize = constants.DefaultMaxSourceMetricsSize
+			}
+			assert.Equal(t, tc.wantMaxSourceMetricsSize, gotConfig.MaxSourceMetricsSize, "Maximum source metrics size passed to collector is not as expected")
+			if tc.wantReportFormat == "" {
+				tc.wantReportFormat = report.FormatJSON
+			}
+			assert.Equal(t, tc.wantReportFormat, gotConfig.ReportFormat, "Report format passed to collector is not as expected")
 
 			got := struct {
 				Source string
@@ -148,6 +166,76 @@ func TestCollect(t *testing.T) {
 	}
 }
 
+func TestCollectMultipleSources(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		args          []string
+		failingSource string
+
+		wantSources  []string
+		wantErr      bool
+		wantUsageErr bool
+	}{
+		"Collect multiple sources": {
+			args:        []string{"collect", "a", getSourceMetricsPath("normal.json"), "b", getSourceMetricsPath("normal.json"), "c", getSourceMetricsPath("normal.json")},
+			wantSources: []string{"a", "b", "c"},
+		},
+		"Collect multiple sources, dry-run": {
+			args:        []string{"collect", "a", getSourceMetricsPath("normal.json"), "b", getSourceMetricsPath("normal.json"), "--dry-run"},
+			wantSources: []string{"a", "b"},
+		},
+
+		// Error cases
+		"Failing source does not prevent collecting the others": {
+			args:          []string{"collect", "a", getSourceMetricsPath("normal.json"), "b", getSourceMetricsPath("normal.json"), "c", getSourceMetricsPath("normal.json")},
+			failingSource: "b",
+			wantSources:   []string{"a", "b", "c"},
+			wantErr:       true,
+		},
+		"Errors when the source metrics file of a source is not provided": {
+			args:         []string{"collect", "a", getSourceMetricsPath("normal.json"), "b"},
+			wantErr:      true,
+			wantUsageErr: true,
+		},
+		"Errors when the source metrics path of a source does not exist": {
+			args:         []string{"collect", "a", getSourceMetricsPath("normal.json"), "b", "invalid-path"},
+			wantErr:      true,
+			wantUsageErr: true,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			var gotSources []string
+			newCollector := func(l *slog.Logger, cm collector.Consent, c collector.Config, args ...collector.Options) (collector.Collector, error) {
+				gotSources = append(gotSources, c.Source)
+				assert.Equal(t, getSourceMetricsPath("normal.json"), c.SourceMetricsPath, "Source metrics path should be passed with its source")
+				assert.Len(t, args, 1, "Collectors should be given the shared system information")
+
+				mc := &mockCollector{}
+				if c.Source == tc.failingSource {
+					mc.writeErr = fmt.Errorf("write error")
+				}
+				return mc, nil
+			}
+
+			a, _ := newAppForTests(t, tc.args, fixtureTrue, commands.WithNewCollector(newCollector))
+
+			err := a.Run()
+			assert.Equal(t, tc.wantUsageErr, a.UsageError(), "Unexpected usage error state")
+			assert.Equal(t, tc.wantSources, gotSources, "All sources should be collected in order")
+			if tc.wantErr {
+				require.Error(t, err)
+				return
+			}
+			require.NoError(t, err)
+		})
+	}
+}
+
 func TestCollectCollectorErrors(t *testing.T) {
 	t.Parallel()
 
@@ -255,11 +343,15 @@ type mockCollector struct {
 	gotDryRun bool
 }
 
-func (m *mockCollector) Compile() (collector.Insights, error) {
-	return collector.Insights{}, m.compileErr
+func (m *mockCollector) Compile() (collector.Encoded, error) {
+	r, err := collector.NewEncoded(collector.Insights{})
+	if err != nil {
+		return collector.Encoded{}, err
+	}
+	return r, m.compileErr
 }
 
-func (m *mockCollector) Write(insights collector.Insights, period uint32, force, dryRun bool) error {
+func (m *mockCollector) Write(r collector.Encoded, period uint32, force, dryRun bool) error {
 	m.gotPeriod = period
 	m.gotForce = force
 	m.gotDryRun = dryRun
@@ -30,11 +30,15 @@ type App struct {
 
 		Upload  uploader.Config
 		Collect struct {
-			Source            string
-			SourceMetricsPath string
-			Period            uint32
-			Force             bool
-			DryRun            bool
+			Source               string
+			SourceMetricsPath    string
+			MaxSourceMetricsSize int64
+			ReportFormat         string
+			Period               uint32
+			Force                bool
+			DryRun               bool
+
+			sources []collector.Config // Set when several source and source metrics pairs are given as arguments.
 		}
 
 		Consent struct {
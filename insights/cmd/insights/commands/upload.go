@@ -7,6 +7,7 @@ import (
 	"github.com/spf13/cobra"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/consent"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/uploader"
 )
 
 func installUploadCmd(app *App) {
@@ -35,6 +36,8 @@ If consent is not given for a source, an opt-out notification will be sent regar
 	uploadCmd.Flags().BoolVarP(&app.config.Upload.Force, "force", "f", false, "force an upload, ignoring min age and clashes between the collected file and a file in the uploaded folder, replacing the clashing uploaded report if it exists (doesn't ignore consent)")
 	uploadCmd.Flags().BoolVarP(&app.config.Upload.DryRun, "dry-run", "d", false, "go through the motions of doing an upload, but do not communicate with the server, send the payload, or modify local files")
 	uploadCmd.Flags().BoolVarP(&app.config.Upload.Retry, "retry", "r", false, "enable a limited number of retries for failed uploads")
+	uploadCmd.Flags().BoolVar(&app.config.Upload.Deltas, "deltas", false, "send reports as deltas against the last uploaded report of their source when the server supports it")
+	uploadCmd.Flags().BoolVar(&app.config.Upload.Scheduled, "scheduled", false, "wait for the upload slot of this machine in the window advertised by the server, and for any delay it asked for (ignored with --force)")
 
 	app.cmd.AddCommand(uploadCmd)
 }
@@ -49,7 +52,8 @@ func (a App) uploadRun() error {
 	}
 
 	cm := consent.NewWithSystemConfig(l, a.config.consentDir, a.config.systemConfigDir)
-	u, err := a.newUploader(l, cm, a.config.insightsDir, uConfig.MinAge, uConfig.DryRun)
+	u, err := a.newUploader(l, cm, a.config.insightsDir, uConfig.MinAge, uConfig.DryRun,
+		uploader.WithDeltas(uConfig.Deltas), uploader.WithSchedule(uConfig.Scheduled))
 	if err != nil {
 		return fmt.Errorf("failed to create uploader: %v", err)
 	}
@@ -48,6 +48,12 @@ func TestUpload(t *testing.T) {
 		"Retry flag does not error": {
 			args: []string{"upload", "--retry"},
 		},
+		"Deltas flag does not error": {
+			args: []string{"upload", "--deltas"},
+		},
+		"Scheduled flag does not error": {
+			args: []string{"upload", "--scheduled"},
+		},
 		"Does not error when no consent files": {
 			args:           []string{"upload", "Unknown"},
 			defaultConsent: fixtureNone,
@@ -3,17 +3,20 @@
 package collector
 
 import (
+	"bytes"
 	"encoding/json"
 	"errors"
 	"fmt"
 	"log/slog"
 	"os"
 	"path/filepath"
+	"sync"
 	"time"
 
 	"github.com/ubuntu/decorate"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 )
@@ -27,12 +30,14 @@ var (
 	ErrSourceMetricsError = fmt.Errorf("source metrics could not be loaded or parsed")
 )
 
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate collector.go Insights
+
 // Insights contains the insights report compiled by the collector.
 type Insights struct {
-	InsightsVersion string         `json:"insightsVersion"`
-	CollectionTime  int64          `json:"collectionTime"`
-	SysInfo         sysinfo.Info   `json:"systemInfo"`
-	SourceMetrics   map[string]any `json:"sourceMetrics,omitempty"`
+	InsightsVersion string          `json:"insightsVersion"`
+	CollectionTime  int64           `json:"collectionTime"`
+	SysInfo         sysinfo.Info    `json:"systemInfo"`
+	SourceMetrics   json.RawMessage `json:"sourceMetrics,omitempty"`
 }
 
 // Consent is an interface for getting the consent state for a given source.
@@ -45,19 +50,50 @@ type SysInfo interface {
 	Collect() (sysinfo.Info, error)
 }
 
+// SharedSysInfo is a system information snapshot shared by several collectors, so that the system is probed
+// once for all of them. The first collector to compile collects it, and the others reuse its result, errors included.
+type SharedSysInfo struct {
+	sections sections.Mask
+
+	once sync.Once
+	info sysinfo.Info
+	err  error
+}
+
+// NewSharedSysInfo returns an empty system information snapshot, to be passed to collectors with WithSharedSysInfo.
+// The snapshot holds the given sections, which must cover the sections of all collectors using it.
+// An empty mask collects everything.
+func NewSharedSysInfo(m sections.Mask) *SharedSysInfo {
+	return &SharedSysInfo{sections: m.OrAll()}
+}
+
+// sharedSysInfo collects system information through its SharedSysInfo snapshot.
+type sharedSysInfo struct {
+	shared  *SharedSysInfo
+	sysInfo SysInfo
+}
+
+// Collect returns the snapshot, collecting it first if no other collector did.
+func (s sharedSysInfo) Collect() (sysinfo.Info, error) {
+	s.shared.once.Do(func() {
+		s.shared.info, s.shared.err = s.sysInfo.Collect()
+	})
+	return s.shared.info, s.shared.err
+}
+
 // Collector is an interface for the collector component.
 type Collector interface {
-	// Compile checks if appropriate to make a new report, and if so, collects and compiles the data into a report.
-	Compile() (Insights, error)
+	// Compile checks if appropriate to make a new report, and if so, collects and compiles the data into an encoded report.
+	Compile() (Encoded, error)
 
-	// Write writes the insights report to disk, and cleans up old reports.
+	// Write writes the encoded insights report to disk, and cleans up old reports.
 	//
 	// If force is true, then Write will overwrite any existing reports for a given period.
 	// If dryRun is true, then Write does nothing, other than checking consent.
 	//
 	// Note that duplicity checks and the timestamp in the file name is based on the current time,
 	// not the collection time of the Insights report passed.
-	Write(insights Insights, period uint32, force, dryRun bool) error
+	Write(r Encoded, period uint32, force, dryRun bool) error
 }
 
 // collector is an abstraction of the collector component.
@@ -69,6 +105,11 @@ type collector struct {
 	uploadedDir       string
 	sourceMetricsPath string
 	sourceMetricsJSON []byte
+	sourceMetrics     *Metrics
+	maxMetricsSize    int64
+	sections          sections.Mask
+	format            report.Format
+	sync              fileutils.SyncPolicy
 
 	// Overrides for testing.
 	maxReports uint32
@@ -83,6 +124,8 @@ type options struct {
 	maxReports uint32
 	time       timeFunc
 	sysInfo    func(*slog.Logger, ...sysinfo.Options) SysInfo
+
+	sharedSysInfo *SharedSysInfo
 }
 
 type timeFunc func() int64
@@ -98,12 +141,33 @@ var defaultOptions = options{
 // Options represents an optional function to override Collector default values.
 type Options func(*options)
 
+// WithSharedSysInfo makes the collector use the given snapshot for system information,
+// instead of probing the system itself.
+func WithSharedSysInfo(s *SharedSysInfo) Options {
+	return func(o *options) {
+		o.sharedSysInfo = s
+	}
+}
+
 // Config represents the collector specific data needed to collect.
 type Config struct {
 	Source            string
 	CachePath         string
 	SourceMetricsPath string
 	SourceMetricsJSON []byte
+	SourceMetrics     *Metrics      // Source metrics built in place, encoded when the report is compiled.
+	Sections          sections.Mask // System information sections to collect. An empty mask collects everything.
+
+	// MaxSourceMetricsSize is the maximum size in bytes of the file at SourceMetricsPath.
+	// It defaults to constants.DefaultMaxSourceMetricsSize.
+	MaxSourceMetricsSize int64
+
+	// ReportFormat is the format reports are stored in. It defaults to report.FormatJSON.
+	ReportFormat report.Format
+
+	// ReportSync is how durable written reports are. It defaults to fileutils.SyncNone, as a report lost to a power
+	// failure is only collected again at the next period.
+	ReportSync fileutils.SyncPolicy
 }
 
 // Sanitize sets defaults and checks that the Config is properly configured.
@@ -114,14 +178,32 @@ func (c *Config) Sanitize(l *slog.Logger) error {
 		l.Info("No source provided, defaulting to platform", "source", c.Source)
 	}
 
-	if c.SourceMetricsPath != "" && c.SourceMetricsJSON != nil {
-		return errors.New("only one of SourceMetricsPath or SourceMetricsJSON can be provided")
+	provided := 0
+	for _, set := range []bool{c.SourceMetricsPath != "", c.SourceMetricsJSON != nil, c.SourceMetrics != nil} {
+		if set {
+			provided++
+		}
+	}
+	if provided > 1 {
+		return errors.New("only one of SourceMetricsPath, SourceMetricsJSON or SourceMetrics can be provided")
 	}
 
 	if c.SourceMetricsJSON != nil && !json.Valid(c.SourceMetricsJSON) {
 		return errors.New("provided SourceMetricsJSON is not valid JSON")
 	}
 
+	if c.MaxSourceMetricsSize <= 0 {
+		c.MaxSourceMetricsSize = constants.DefaultMaxSourceMetricsSize
+	}
+
+	switch c.ReportFormat {
+	case "":
+		c.ReportFormat = report.FormatJSON
+	case report.FormatJSON, report.FormatCBOR:
+	default:
+		return fmt.Errorf("unknown report format %q", c.ReportFormat)
+	}
+
 	if c.CachePath == "" {
 		c.CachePath = constants.DefaultCachePath
 		l.Info("No cache path provided, defaulting to", "cachePath", c.CachePath)
@@ -154,6 +236,16 @@ func New(l *slog.Logger, cm Consent, c Config, args ...Options) (Collector, erro
 		opt(&opts)
 	}
 
+	var si SysInfo
+	if opts.sharedSysInfo != nil {
+		si = sharedSysInfo{
+			shared:  opts.sharedSysInfo,
+			sysInfo: opts.sysInfo(l, sysinfo.WithSections(opts.sharedSysInfo.sections), sysinfo.WithCacheDir(c.CachePath)),
+		}
+	} else {
+		si = opts.sysInfo(l, sysinfo.WithSections(c.Sections), sysinfo.WithCacheDir(c.CachePath))
+	}
+
 	return collector{
 		consent: cm,
 		source:  c.Source,
@@ -163,28 +255,39 @@ func New(l *slog.Logger, cm Consent, c Config, args ...Options) (Collector, erro
 		uploadedDir:       filepath.Join(c.CachePath, c.Source, constants.UploadedFolder),
 		sourceMetricsPath: c.SourceMetricsPath,
 		sourceMetricsJSON: c.SourceMetricsJSON,
+		sourceMetrics:     c.SourceMetrics,
+		maxMetricsSize:    c.MaxSourceMetricsSize,
+		sections:          c.Sections.OrAll(),
+		format:            c.ReportFormat,
+		sync:              c.ReportSync,
 		maxReports:        opts.maxReports,
-		sysInfo:           opts.sysInfo(l),
+		sysInfo:           si,
 
 		log: l,
 	}, nil
 }
 
-// Compile collects and compiles data into a report.
+// Compile collects and compiles data into a report, encoding it once.
 //
 // Compile does not check consent or report duplicity, as this should be done at write time.
 // Note that any source metrics must be a valid JSON object, not an array or primitive.
-func (c collector) Compile() (insights Insights, err error) {
+func (c collector) Compile() (r Encoded, err error) {
 	c.log.Debug("Collecting data")
 	defer decorate.OnError(&err, "insights compile failed")
 
-	insights, err = c.compile()
+	insights, err := c.compile()
 	if err != nil {
-		return Insights{}, fmt.Errorf("failed to compile insights: %w", err) // Need to expose these errors
+		return Encoded{}, fmt.Errorf("failed to compile insights: %w", err) // Need to expose these errors
 	}
-	c.log.Info("Insights report compiled", "report", insights)
 
-	return insights, nil
+	r, err = NewEncoded(insights)
+	if err != nil {
+		return Encoded{}, err
+	}
+	c.log.Info("Insights report compiled", "size", len(r.JSON()))
+	c.log.Debug("Compiled insights report", "report", json.RawMessage(r.JSON()))
+
+	return r, nil
 }
 
 // Write writes the insights report to disk, and cleans up old reports.
@@ -194,13 +297,13 @@ func (c collector) Compile() (insights Insights, err error) {
 //
 // Note that duplicity checks and the timestamp in the file name is based on the current time,
 // not the collection time of the Insights report passed.
-func (c collector) Write(insights Insights, period uint32, force, dryRun bool) (err error) {
+func (c collector) Write(r Encoded, period uint32, force, dryRun bool) (err error) {
 	c.log.Debug("Writing data", "period", period, "force", force, "dryRun", dryRun)
 	defer decorate.OnError(&err, "insights write failed")
 
-	data, err := json.Marshal(insights)
-	if err != nil {
-		return fmt.Errorf("failed to marshal insights: %v", err)
+	data := r.JSON()
+	if len(data) == 0 {
+		return errors.New("insights report is not encoded")
 	}
 
 	consent, err := c.consent.GetState(c.source)
@@ -214,11 +317,24 @@ func (c collector) Write(insights Insights, period uint32, force, dryRun bool) (
 		data = constants.OptOutPayload
 	}
 
-	time := insights.CollectionTime
+	time := r.Insights.CollectionTime
 	if time == 0 {
 		time = c.time // If no collection time is provided (zero value), use the current time
 	}
 
+	if !dryRun {
+		if err := c.makeDirs(); err != nil {
+			return fmt.Errorf("failed to create directories: %v", err)
+		}
+	}
+
+	// Dry runs only read the reports.
+	unlock, err := report.LockStore(c.log, filepath.Dir(c.collectedDir), !dryRun)
+	if err != nil {
+		return err
+	}
+	defer unlock()
+
 	if err := c.handleDuplicates(force, dryRun, time, period); err != nil {
 		return err
 	}
@@ -228,10 +344,6 @@ func (c collector) Write(insights Insights, period uint32, force, dryRun bool) (
 		return nil
 	}
 
-	if err := c.makeDirs(); err != nil {
-		return fmt.Errorf("failed to create directories: %v", err)
-	}
-
 	if err := c.write(data, time); err != nil {
 		return fmt.Errorf("failed to write insights report: %v", err)
 	}
@@ -320,7 +432,8 @@ func (c collector) compile() (Insights, error) {
 	if err != nil {
 		return Insights{}, fmt.Errorf("failed to collect system information: %v", err)
 	}
-	insights.SysInfo = info
+	// The system information may hold more sections than requested, when shared with other collectors.
+	insights.SysInfo = info.Filter(c.sections)
 
 	// Load source specific metrics.
 	metrics, err := c.getSourceMetrics()
@@ -333,20 +446,35 @@ func (c collector) compile() (Insights, error) {
 }
 
 // getSourceMetrics loads source specific metrics.
-// If sourceMetricsJSON is set, it will attempt to use that.
+// If sourceMetrics is set, it is encoded directly, as it can only hold a valid JSON object.
+// Otherwise, if sourceMetricsJSON is set, it will attempt to use that.
 // Otherwise, it will use sourceMetricsPath to load from a JSON file.
 // If the sourceMetricsPath is empty, it returns nil.
 //
-// If sourceMetricsJSON is set but not valid JSON, it returns an error.
-// If the file does not exist, or cannot be read, it returns an error.
-// If the file is not valid JSON, it returns an error.
-func (c collector) getSourceMetrics() (map[string]any, error) {
+// The metrics are passed through as raw JSON: they are validated, but only decoded into a tree to drop duplicate keys.
+// Empty metrics are left out of the report.
+// If sourceMetricsJSON is set but not a valid JSON object, it returns an error.
+// If the file does not exist, cannot be read, or is larger than maxMetricsSize, it returns an error.
+// If the file is not a valid JSON object, it returns an error.
+func (c collector) getSourceMetrics() (json.RawMessage, error) {
 	c.log.Debug("Loading source metrics", "path", c.sourceMetricsPath)
 
+	if c.sourceMetrics != nil {
+		// An empty object is left out of the report, as any other empty source metrics.
+		if len(c.sourceMetrics.entries) == 0 {
+			return nil, nil
+		}
+		metrics, err := c.sourceMetrics.AppendJSON(nil)
+		if err != nil {
+			return nil, fmt.Errorf("invalid source metrics: %v", err)
+		}
+		return metrics, nil
+	}
+
 	if c.sourceMetricsJSON != nil {
-		var metrics map[string]any
-		if err := json.Unmarshal(c.sourceMetricsJSON, &metrics); err != nil {
-			return nil, fmt.Errorf("failed to unmarshal source metrics JSON, might be an invalid JSON object: %v", err)
+		metrics, err := validateSourceMetrics(c.sourceMetricsJSON)
+		if err != nil {
+			return nil, fmt.Errorf("invalid source metrics JSON: %v", err)
 		}
 		return metrics, nil
 	}
@@ -356,26 +484,107 @@ func (c collector) getSourceMetrics() (map[string]any, error) {
 		return nil, nil
 	}
 
-	data, err := os.ReadFile(c.sourceMetricsPath)
+	// The file is validated in place, and only the validated object is copied into the report.
+	var metrics json.RawMessage
+	var invalid error
+	err := fileutils.WithMappedFile(c.sourceMetricsPath, c.maxMetricsSize, func(data []byte) error {
+		m, err := validateSourceMetrics(data)
+		if err != nil {
+			invalid = err
+			return err
+		}
+		metrics = bytes.Clone(m)
+		return nil
+	})
+	if invalid != nil {
+		return nil, fmt.Errorf("invalid source metrics file: %v", invalid)
+	}
 	if err != nil {
 		return nil, fmt.Errorf("failed to read source metrics file: %v", err)
 	}
 
-	var metrics map[string]any
-	if err := json.Unmarshal(data, &metrics); err != nil {
-		return nil, fmt.Errorf("failed to unmarshal source metrics, might be an invalid JSON object: %v", err)
+	return metrics, nil
+}
+
+// validateSourceMetrics checks that data is a single valid JSON object and returns it as raw JSON.
+// A JSON null or an empty object is accepted and treated as no source metrics.
+// Objects holding a key more than once are re-encoded with its last value, as they were when decoded into a map.
+func validateSourceMetrics(data []byte) (json.RawMessage, error) {
+	trimmed := bytes.TrimSpace(data)
+	if bytes.Equal(trimmed, []byte("null")) {
+		return nil, nil
+	}
+	// Reject anything but an object from its delimiters, before scanning it all.
+	if len(trimmed) < 2 || trimmed[0] != '{' || trimmed[len(trimmed)-1] != '}' {
+		return nil, errors.New("source metrics must be a JSON object")
+	}
+	if !json.Valid(trimmed) {
+		return nil, errors.New("source metrics are not valid JSON")
+	}
+	if len(bytes.TrimSpace(trimmed[1:len(trimmed)-1])) == 0 {
+		return nil, nil
 	}
 
-	return metrics, nil
+	dec := json.NewDecoder(bytes.NewReader(trimmed))
+	dec.UseNumber()
+	tok, err := dec.Token()
+	if err != nil {
+		return nil, fmt.Errorf("source metrics are not valid JSON: %v", err)
+	}
+	dup, err := hasDuplicateKeys(dec, tok)
+	if err != nil {
+		return nil, fmt.Errorf("source metrics are not valid JSON: %v", err)
+	}
+	if !dup {
+		return json.RawMessage(trimmed), nil
+	}
+
+	var metrics map[string]any
+	if err := json.Unmarshal(trimmed, &metrics); err != nil {
+		return nil, fmt.Errorf("source metrics are not valid JSON: %v", err)
+	}
+	return json.Marshal(metrics)
 }
 
-// write writes the insights report to disk, with the appropriate name.
-func (c collector) write(insights []byte, time int64) error {
-	reportPath := filepath.Join(c.collectedDir, fmt.Sprintf("%v.json", time))
-	if err := fileutils.AtomicWrite(reportPath, insights); err != nil {
-		return fmt.Errorf("failed to write to disk: %v", err)
+// hasDuplicateKeys reads the rest of the JSON value starting with tok from dec, and returns whether any object in it
+// holds a key more than once.
+func hasDuplicateKeys(dec *json.Decoder, tok json.Token) (bool, error) {
+	delim, ok := tok.(json.Delim)
+	if !ok {
+		return false, nil
 	}
-	c.log.Info("Insights report written", "file", reportPath)
 
-	return nil
+	var keys map[string]struct{}
+	if delim == '{' {
+		keys = make(map[string]struct{})
+	}
+	dup := false
+	for dec.More() {
+		if keys != nil {
+			k, err := dec.Token()
+			if err != nil {
+				return false, err
+			}
+			key, _ := k.(string)
+			if _, seen := keys[key]; seen {
+				dup = true
+			}
+			keys[key] = struct{}{}
+		}
+
+		v, err := dec.Token()
+		if err != nil {
+			return false, err
+		}
+		d, err := hasDuplicateKeys(dec, v)
+		if err != nil {
+			return false, err
+		}
+		dup = dup || d
+	}
+	// Closing delimiter.
+	if _, err := dec.Token(); err != nil {
+		return false, err
+	}
+	return dup, nil
 }
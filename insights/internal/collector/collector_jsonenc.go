@@ -0,0 +1,34 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package collector
+
+import (
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Insights) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	dst = append(dst, '{')
+	dst = append(dst, `"insightsVersion":`...)
+	dst = jsonenc.AppendString(dst, v.InsightsVersion)
+	dst = append(dst, `,"collectionTime":`...)
+	dst = jsonenc.AppendInt(dst, v.CollectionTime)
+	dst = append(dst, `,"systemInfo":`...)
+	if dst, err = v.SysInfo.AppendJSON(dst); err != nil {
+		return dst, err
+	}
+	if len(v.SourceMetrics) != 0 {
+		dst = append(dst, `,"sourceMetrics":`...)
+		if dst, err = jsonenc.AppendRaw(dst, v.SourceMetrics); err != nil {
+			return dst, err
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Insights) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
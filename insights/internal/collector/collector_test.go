@@ -14,6 +14,7 @@ import (
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 )
 
 var (
@@ -41,6 +42,22 @@ func (m testSysInfo) Collect() (sysinfo.Info, error) {
 	return m.info, m.err
 }
 
+// testMetrics returns source metrics holding a value of each type, in a nested object.
+func testMetrics(t *testing.T) *collector.Metrics {
+	t.Helper()
+
+	nested := collector.NewMetrics()
+	nested.SetString("name", "nested")
+	require.NoError(t, nested.SetFloat("ratio", 0.5), "Setup: failed to set float metric")
+
+	m := collector.NewMetrics()
+	m.SetString("test", "sourceMetrics")
+	m.SetInt("count", 42)
+	m.SetBool("enabled", true)
+	m.SetObject("nested", nested)
+	return m
+}
+
 func TestSanitize(t *testing.T) {
 	t.Parallel()
 
@@ -71,6 +88,20 @@ func TestSanitize(t *testing.T) {
 				CachePath:         "fakeCachePath",
 			},
 		},
+		"Custom source with sourceMetrics": {
+			config: collector.Config{
+				Source:        "customSource",
+				SourceMetrics: collector.NewMetrics(),
+				CachePath:     "fakeCachePath",
+			},
+		},
+		"Custom source with binary report format": {
+			config: collector.Config{
+				Source:       "customSource",
+				CachePath:    "fakeCachePath",
+				ReportFormat: report.FormatCBOR,
+			},
+		},
 
 		// Error cases
 		"Both sourceMetricsPath and sourceMetricsJSON provided with customSource errors": {
@@ -82,6 +113,23 @@ func TestSanitize(t *testing.T) {
 			},
 			wantErr: true,
 		},
+		"Both sourceMetricsJSON and sourceMetrics provided with customSource errors": {
+			config: collector.Config{
+				Source:            "customSource",
+				SourceMetricsJSON: []byte(`{"test": "sourceMetricsJson"}`),
+				SourceMetrics:     collector.NewMetrics(),
+				CachePath:         "fakeCachePath",
+			},
+			wantErr: true,
+		},
+		"Unknown report format errors": {
+			config: collector.Config{
+				Source:       "customSource",
+				CachePath:    "fakeCachePath",
+				ReportFormat: "xml",
+			},
+			wantErr: true,
+		},
 		"Invalid sourceMetricsJSON provided with customSource errors": {
 			config: collector.Config{
 				Source:            "customSource",
@@ -203,6 +251,30 @@ func TestCompile(t *testing.T) {
 			},
 			consentM: cTrue,
 		},
+		"With SourceMetrics built in place": {
+			config: collector.Config{
+				SourceMetrics: testMetrics(t),
+			},
+			consentM: cTrue,
+		},
+		"With empty SourceMetrics JSON left out": {
+			config: collector.Config{
+				SourceMetricsJSON: []byte(` { } `),
+			},
+			consentM: cTrue,
+		},
+		"With empty SourceMetrics built in place left out": {
+			config: collector.Config{
+				SourceMetrics: collector.NewMetrics(),
+			},
+			consentM: cTrue,
+		},
+		"With SourceMetrics JSON duplicate keys keeping the last value": {
+			config: collector.Config{
+				SourceMetricsJSON: []byte(`{"b": 1, "a": {"c": 1, "c": 2}, "b": 2}`),
+			},
+			consentM: cTrue,
+		},
 		"Consent False": {
 			consentM: cFalse,
 		},
@@ -236,6 +308,14 @@ func TestCompile(t *testing.T) {
 			consentM: cTrue,
 			wantErr:  true,
 		},
+		"Source metrics file over the maximum size": {
+			config: collector.Config{
+				SourceMetricsPath:    "testdata/source_metrics/normal.json",
+				MaxSourceMetricsSize: 4,
+			},
+			consentM: cTrue,
+			wantErr:  true,
+		},
 		"Empty source metrics file": {
 			config: collector.Config{
 				SourceMetricsPath: "testdata/source_metrics/empty.json",
@@ -290,10 +370,15 @@ func TestCompile(t *testing.T) {
 			require.NoError(t, err)
 			assert.NotNil(t, results)
 
-			assert.Equal(t, constants.Version, results.InsightsVersion, "Compiled insights should have the expected version")
-			results.InsightsVersion = "Tests"
+			assert.Equal(t, constants.Version, results.Insights.InsightsVersion, "Compiled insights should have the expected version")
+			pretty, err := results.PrettyJSON()
+			require.NoError(t, err)
+			reencoded, err := json.MarshalIndent(results.Insights, "", "  ")
+			require.NoError(t, err)
+			require.Equal(t, string(reencoded), string(pretty), "Pretty report should be derived from the same encoding")
 
-			got, err := json.MarshalIndent(results, "", "  ")
+			results.Insights.InsightsVersion = "Tests"
+			got, err := json.MarshalIndent(results.Insights, "", "  ")
 			require.NoError(t, err)
 			want := testutils.LoadWithUpdateFromGolden(t, string(got))
 			assert.Equal(t, want, string(got), "Collect should return expected sys information")
@@ -301,6 +386,64 @@ func TestCompile(t *testing.T) {
 	}
 }
 
+func TestCompileWithSharedSysInfo(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		sysInfoErr error
+
+		wantErr bool
+	}{
+		"System information is collected once for all collectors": {},
+
+		// Error cases
+		"SysInfo Collect Error is shared by all collectors": {
+			sysInfoErr: fmt.Errorf("sysinfo error"),
+			wantErr:    true,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			si := &countingSysInfo{err: tc.sysInfoErr}
+			shared := collector.NewSharedSysInfo(0)
+			l := slog.New(slog.NewTextHandler(os.Stderr, nil))
+
+			for _, source := range []string{"source1", "source2", "source3"} {
+				c, err := collector.New(l, cTrue, collector.Config{Source: source, CachePath: t.TempDir()},
+					collector.WithSharedSysInfo(shared),
+					collector.WithSysInfo(func(l *slog.Logger, opts ...sysinfo.Options) collector.SysInfo {
+						return si
+					}),
+				)
+				require.NoError(t, err, "Setup: failed to create collector")
+
+				_, err = c.Compile()
+				if tc.wantErr {
+					require.Error(t, err, "Compile should return the shared collection error")
+					continue
+				}
+				require.NoError(t, err, "Compile should not fail")
+			}
+
+			assert.Equal(t, 1, si.calls, "System information should be collected only once")
+		})
+	}
+}
+
+// countingSysInfo counts how many times the system information is collected.
+type countingSysInfo struct {
+	calls int
+	err   error
+}
+
+func (m *countingSysInfo) Collect() (sysinfo.Info, error) {
+	m.calls++
+	return sysinfo.Info{}, m.err
+}
+
 func TestWrite(t *testing.T) {
 	t.Parallel()
 
@@ -309,9 +452,6 @@ func TestWrite(t *testing.T) {
 		source   = "source"
 	)
 
-	invalidInsights := collector.Insights{SourceMetrics: make(map[string]any)}
-	invalidInsights.SourceMetrics["Invalid"] = func() {}
-
 	tests := map[string]struct {
 		consentM collector.Consent
 
@@ -321,6 +461,7 @@ func TestWrite(t *testing.T) {
 		dryRun     bool
 		maxReports uint32
 		insights   collector.Insights
+		notEncoded bool
 
 		time  int64
 		noDir bool
@@ -384,13 +525,10 @@ func TestWrite(t *testing.T) {
 			maxReports: 5,
 			wantErr:    true,
 		},
-		"Errors if Insights cannot be marshaled": {
-			config: collector.Config{
-				CachePath: "",
-			},
+		"Errors if report is not encoded": {
 			period:     1,
 			maxReports: 5,
-			insights:   invalidInsights,
+			notEncoded: true,
 			wantErr:    true,
 		},
 		"Errors if there are duplicate reports": {
@@ -421,10 +559,15 @@ func TestWrite(t *testing.T) {
 			if tc.consentM == nil {
 				tc.consentM = cTrue
 			}
-			if tc.insights.SourceMetrics == nil {
-				tc.insights.SourceMetrics = make(map[string]any)
+			metrics, err := json.Marshal(map[string]string{"Test Name": name})
+			require.NoError(t, err, "Setup: failed to marshal source metrics")
+			tc.insights.SourceMetrics = metrics
+
+			report := collector.Encoded{Insights: tc.insights}
+			if !tc.notEncoded {
+				report, err = collector.NewEncoded(tc.insights)
+				require.NoError(t, err, "Setup: failed to encode insights")
 			}
-			tc.insights.SourceMetrics["Test Name"] = name
 
 			sDir := filepath.Join(dir, source)
 			require.NoError(t, testutils.CopyDir(t, filepath.Join("testdata", "reports_cache"), sDir), "Setup: failed to copy reports cache")
@@ -446,7 +589,7 @@ func TestWrite(t *testing.T) {
 			c, err := collector.New(l, tc.consentM, tc.config, opts...)
 			require.NoError(t, err, "Setup: failed to create collector")
 
-			err = c.Write(tc.insights, tc.period, tc.force, tc.dryRun)
+			err = c.Write(report, tc.period, tc.force, tc.dryRun)
 			if tc.wantErr {
 				require.Error(t, err)
 				return
@@ -0,0 +1,82 @@
+package collector
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// Encoded is an insights report together with its single compact JSON encoding.
+//
+// Every other representation of the report (pretty printed, written to disk) is derived from
+// that encoding, so the report is never serialized more than once.
+type Encoded struct {
+	Insights Insights
+	data     []byte
+}
+
+// NewEncoded encodes the given insights report once, into compact JSON, with its generated encoder.
+func NewEncoded(insights Insights) (Encoded, error) {
+	data, err := jsonenc.Marshal(insights)
+	if err != nil {
+		return Encoded{}, fmt.Errorf("failed to encode insights: %v", err)
+	}
+	return Encoded{
+		Insights: insights,
+		data:     data,
+	}, nil
+}
+
+// ParseEncoded strictly validates a JSON insights report, rejecting unknown fields,
+// and keeps a compact copy of the given document instead of re-encoding it.
+func ParseEncoded(r io.Reader) (Encoded, error) {
+	var buf bytes.Buffer
+	if _, err := buf.ReadFrom(r); err != nil {
+		return Encoded{}, fmt.Errorf("failed to read insights report: %v", err)
+	}
+
+	var insights Insights
+	dec := json.NewDecoder(bytes.NewReader(buf.Bytes()))
+	dec.DisallowUnknownFields()
+	if err := dec.Decode(&insights); err != nil {
+		return Encoded{}, fmt.Errorf("failed to decode insights report: %v", err)
+	}
+	if dec.More() {
+		return Encoded{}, errors.New("insights report contains trailing data")
+	}
+
+	var compact bytes.Buffer
+	compact.Grow(buf.Len())
+	if err := json.Compact(&compact, buf.Bytes()); err != nil {
+		return Encoded{}, fmt.Errorf("failed to compact insights report: %v", err)
+	}
+
+	return Encoded{
+		Insights: insights,
+		data:     compact.Bytes(),
+	}, nil
+}
+
+// JSON returns the compact JSON encoding of the report.
+// The returned slice must not be modified.
+func (e Encoded) JSON() []byte {
+	return e.data
+}
+
+// PrettyJSON returns the report indented for human consumption, derived from its compact encoding.
+func (e Encoded) PrettyJSON() ([]byte, error) {
+	if len(e.data) == 0 {
+		return nil, errors.New("insights report is not encoded")
+	}
+
+	var out bytes.Buffer
+	out.Grow(len(e.data) * 2)
+	if err := json.Indent(&out, e.data, "", "  "); err != nil {
+		return nil, fmt.Errorf("failed to indent insights report: %v", err)
+	}
+	return out.Bytes(), nil
+}
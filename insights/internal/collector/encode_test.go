@@ -0,0 +1,176 @@
+package collector_test
+
+import (
+	"bytes"
+	"encoding/json"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+	"github.com/ubuntu/ubuntu-insights/common/testutils"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
+)
+
+func TestParseEncoded(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		report string
+
+		want       string
+		wantPretty string
+		wantErr    bool
+	}{
+		"Empty object": {
+			report:     `{}`,
+			want:       `{}`,
+			wantPretty: `{}`,
+		},
+		"Report is compacted without reordering": {
+			report: `{
+  "insightsVersion": "Tests",
+  "collectionTime": 5,
+  "sourceMetrics": {"b": 1.50, "a": [1, 2]}
+}`,
+			want: `{"insightsVersion":"Tests","collectionTime":5,"sourceMetrics":{"b":1.50,"a":[1,2]}}`,
+			wantPretty: `{
+  "insightsVersion": "Tests",
+  "collectionTime": 5,
+  "sourceMetrics": {
+    "b": 1.50,
+    "a": [
+      1,
+      2
+    ]
+  }
+}`,
+		},
+
+		// Error cases
+		"Errors on empty report": {
+			report:  ``,
+			wantErr: true,
+		},
+		"Errors on unknown field": {
+			report:  `{"unknown": true}`,
+			wantErr: true,
+		},
+		"Errors on trailing data": {
+			report:  `{} {}`,
+			wantErr: true,
+		},
+		"Errors on invalid JSON": {
+			report:  `{"insightsVersion": }`,
+			wantErr: true,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := collector.ParseEncoded(strings.NewReader(tc.report))
+			if tc.wantErr {
+				require.Error(t, err)
+				return
+			}
+			require.NoError(t, err)
+
+			assert.Equal(t, tc.want, string(got.JSON()), "ParseEncoded should keep a compact copy of the report")
+			pretty, err := got.PrettyJSON()
+			require.NoError(t, err)
+			assert.Equal(t, tc.wantPretty, string(pretty), "PrettyJSON should indent the compact report")
+		})
+	}
+}
+
+func TestPrettyJSONErrorsIfNotEncoded(t *testing.T) {
+	t.Parallel()
+
+	_, err := collector.Encoded{}.PrettyJSON()
+	require.Error(t, err, "PrettyJSON should fail on a report that was never encoded")
+}
+
+func TestNewEncodedMatchesEncodingJSON(t *testing.T) {
+	t.Parallel()
+
+	// The fixture is written in field order, so that encoding it again must give back the same document.
+	data, err := os.ReadFile(filepath.Join("testdata", "encode", "report.json"))
+	require.NoError(t, err, "Setup: failed to read report fixture")
+	var want bytes.Buffer
+	require.NoError(t, json.Compact(&want, data), "Setup: failed to compact report fixture")
+	var wantEscaped bytes.Buffer
+	json.HTMLEscape(&wantEscaped, want.Bytes())
+
+	parsed, err := collector.ParseEncoded(bytes.NewReader(data))
+	require.NoError(t, err, "Setup: failed to parse report fixture")
+
+	got, err := collector.NewEncoded(parsed.Insights)
+	require.NoError(t, err, "NewEncoded should not fail on a valid report")
+	assert.Equal(t, wantEscaped.String(), string(got.JSON()), "NewEncoded should encode as encoding/json does")
+}
+
+func BenchmarkNewEncoded(b *testing.B) {
+	data, err := os.ReadFile(filepath.Join("testdata", "encode", "report.json"))
+	require.NoError(b, err, "Setup: failed to read report fixture")
+	parsed, err := collector.ParseEncoded(bytes.NewReader(data))
+	require.NoError(b, err, "Setup: failed to parse report fixture")
+
+	b.ReportAllocs()
+	for b.Loop() {
+		if _, err := collector.NewEncoded(parsed.Insights); err != nil {
+			b.Fatalf("NewEncoded failed: %v", err)
+		}
+	}
+}
+
+// BenchmarkEncode compares the generated encoder of each report model with encoding/json.
+func BenchmarkEncode(b *testing.B) {
+	data, err := os.ReadFile(filepath.Join("testdata", "encode", "report.json"))
+	require.NoError(b, err, "Setup: failed to read report fixture")
+	parsed, err := collector.ParseEncoded(bytes.NewReader(data))
+	require.NoError(b, err, "Setup: failed to parse report fixture")
+	info := parsed.Insights.SysInfo
+
+	models := []struct {
+		name string
+		v    interface{ AppendJSON([]byte) ([]byte, error) }
+	}{
+		{name: "Insights", v: parsed.Insights},
+		{name: "SysInfo", v: info},
+		{name: "Hardware", v: info.Hardware},
+		{name: "Software", v: info.Software},
+		{name: "Platform", v: info.Platform},
+	}
+
+	for _, m := range models {
+		// encoding/json would otherwise call the generated encoder through MarshalJSON.
+		plain := testutils.WithoutGeneratedJSON(m.v)
+		want, err := json.Marshal(plain)
+		require.NoError(b, err, "Setup: encoding/json failed to encode %s", m.name)
+		got, err := jsonenc.Marshal(m.v)
+		require.NoError(b, err, "Setup: generated encoder failed to encode %s", m.name)
+		require.Equal(b, string(want), string(got), "Setup: both encoders should encode %s the same", m.name)
+
+		b.Run(m.name+"/Generated", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := jsonenc.Marshal(m.v); err != nil {
+					b.Fatalf("Generated encoder failed: %v", err)
+				}
+			}
+		})
+		b.Run(m.name+"/EncodingJSON", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := json.Marshal(plain); err != nil {
+					b.Fatalf("encoding/json failed: %v", err)
+				}
+			}
+		})
+	}
+}
@@ -0,0 +1,119 @@
+package collector
+
+import (
+	"errors"
+	"math"
+
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// Metrics holds source metrics built key by key, as an alternative to providing them as JSON.
+//
+// Keys are encoded in the order they were first set in, and setting a key again replaces its value.
+// A Metrics is not safe for concurrent use.
+type Metrics struct {
+	entries []metric
+	index   map[string]int
+}
+
+// metric is a single entry of Metrics. value is an int64, a string, a bool, a float64 or a *Metrics.
+type metric struct {
+	key   string
+	value any
+}
+
+// NewMetrics returns an empty Metrics, which encodes as an empty JSON object.
+func NewMetrics() *Metrics {
+	return &Metrics{index: make(map[string]int)}
+}
+
+// SetInt sets key to the integer v.
+func (m *Metrics) SetInt(key string, v int64) {
+	m.set(key, v)
+}
+
+// SetString sets key to the string v.
+func (m *Metrics) SetString(key string, v string) {
+	m.set(key, v)
+}
+
+// SetBool sets key to the boolean v.
+func (m *Metrics) SetBool(key string, v bool) {
+	m.set(key, v)
+}
+
+// SetFloat sets key to the number v.
+// It returns an error for NaN and infinite values, which JSON cannot represent.
+func (m *Metrics) SetFloat(key string, v float64) error {
+	if math.IsNaN(v) || math.IsInf(v, 0) {
+		return errors.New("source metrics can't hold NaN or infinite values")
+	}
+	m.set(key, v)
+	return nil
+}
+
+// SetObject sets key to a copy of the object v, so that v can be changed or reused afterwards.
+func (m *Metrics) SetObject(key string, v *Metrics) {
+	m.set(key, v.clone())
+}
+
+func (m *Metrics) set(key string, v any) {
+	if i, ok := m.index[key]; ok {
+		m.entries[i].value = v
+		return
+	}
+	m.index[key] = len(m.entries)
+	m.entries = append(m.entries, metric{key: key, value: v})
+}
+
+// clone returns a deep copy of m.
+func (m *Metrics) clone() *Metrics {
+	c := &Metrics{
+		entries: make([]metric, len(m.entries)),
+		index:   make(map[string]int, len(m.index)),
+	}
+	for i, e := range m.entries {
+		if o, ok := e.value.(*Metrics); ok {
+			e.value = o.clone()
+		}
+		c.entries[i] = e
+		c.index[e.key] = i
+	}
+	return c
+}
+
+// AppendJSON appends the JSON object encoding of m to dst.
+func (m *Metrics) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	dst = append(dst, '{')
+	for i, e := range m.entries {
+		if i > 0 {
+			dst = append(dst, ',')
+		}
+		dst = jsonenc.AppendString(dst, e.key)
+		dst = append(dst, ':')
+		switch v := e.value.(type) {
+		case int64:
+			dst = jsonenc.AppendInt(dst, v)
+		case string:
+			dst = jsonenc.AppendString(dst, v)
+		case bool:
+			dst = jsonenc.AppendBool(dst, v)
+		case float64:
+			if dst, err = jsonenc.AppendFloat(dst, v, 64); err != nil {
+				return dst, err
+			}
+		case *Metrics:
+			if dst, err = v.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the reflection-free encoder.
+func (m *Metrics) MarshalJSON() ([]byte, error) {
+	return m.AppendJSON(nil)
+}
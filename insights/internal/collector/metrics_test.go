@@ -0,0 +1,92 @@
+package collector_test
+
+import (
+	"encoding/json"
+	"math"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
+)
+
+func TestMetricsAppendJSON(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		build func(m *collector.Metrics)
+
+		want string
+	}{
+		"Empty metrics encode as an empty object": {
+			build: func(*collector.Metrics) {},
+			want:  `{}`,
+		},
+		"Keys are kept in insertion order": {
+			build: func(m *collector.Metrics) {
+				m.SetString("b", "first")
+				m.SetInt("a", -3)
+				m.SetBool("c", false)
+			},
+			want: `{"b":"first","a":-3,"c":false}`,
+		},
+		"Setting a key again replaces its value in place": {
+			build: func(m *collector.Metrics) {
+				m.SetInt("a", 1)
+				m.SetInt("b", 2)
+				m.SetString("a", "replaced")
+			},
+			want: `{"a":"replaced","b":2}`,
+		},
+		"Floats are encoded as encoding/json does": {
+			build: func(m *collector.Metrics) {
+				require.NoError(t, m.SetFloat("small", 1e-7), "Setup: failed to set float metric")
+				require.NoError(t, m.SetFloat("whole", 3), "Setup: failed to set float metric")
+			},
+			want: `{"small":1e-7,"whole":3}`,
+		},
+		"Strings are escaped": {
+			build: func(m *collector.Metrics) {
+				m.SetString("quote\"", "<tab>\t")
+			},
+			want: `{"quote\"":"\u003ctab\u003e\t"}`,
+		},
+		"Objects are copied when set": {
+			build: func(m *collector.Metrics) {
+				nested := collector.NewMetrics()
+				nested.SetInt("before", 1)
+				m.SetObject("nested", nested)
+				nested.SetInt("after", 2)
+				m.SetObject("again", nested)
+			},
+			want: `{"nested":{"before":1},"again":{"before":1,"after":2}}`,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			m := collector.NewMetrics()
+			tc.build(m)
+
+			got, err := m.AppendJSON(nil)
+			require.NoError(t, err, "AppendJSON should not return an error")
+			assert.Equal(t, tc.want, string(got), "AppendJSON should return the expected object")
+			assert.True(t, json.Valid(got), "AppendJSON should return valid JSON")
+		})
+	}
+}
+
+func TestMetricsSetFloatRejectsNonFinite(t *testing.T) {
+	t.Parallel()
+
+	m := collector.NewMetrics()
+	for _, v := range []float64{math.NaN(), math.Inf(1), math.Inf(-1)} {
+		require.Error(t, m.SetFloat("value", v), "SetFloat should reject %v", v)
+	}
+
+	got, err := m.AppendJSON(nil)
+	require.NoError(t, err, "AppendJSON should not return an error")
+	assert.Equal(t, `{}`, string(got), "Rejected values should not be set")
+}
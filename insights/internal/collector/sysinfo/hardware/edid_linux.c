@@ -0,0 +1,64 @@
+#include "edid_linux.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define EDID_BLOCK_SIZE 128
+#define EDID_PREFERRED_TIMING 54
+
+static const uint8_t edid_header[] = {0x00, 0xff, 0xff, 0xff,
+                                      0xff, 0xff, 0xff, 0x00};
+
+int parse_edid(const uint8_t* data, size_t len, struct edid_info* info) {
+  if (!data || !info || len < EDID_BLOCK_SIZE ||
+      memcmp(data, edid_header, sizeof(edid_header)) != 0) {
+    return -1;
+  }
+
+  uint8_t sum = 0;
+  for (size_t i = 0; i < EDID_BLOCK_SIZE; i++) {
+    sum += data[i];
+  }
+  if (sum != 0) {
+    return -1;
+  }
+
+  memset(info, 0, sizeof(struct edid_info));
+
+  // The basic display parameters only have the size in cm.
+  info->phys_width = data[21] * 10;
+  info->phys_height = data[22] * 10;
+
+  // The first detailed timing descriptor is the preferred timing. A zero
+  // pixel clock means the descriptor holds something else.
+  const uint8_t* d = data + EDID_PREFERRED_TIMING;
+  uint32_t clock = (uint32_t)(d[0] | d[1] << 8) * 10000;  // In Hz.
+  if (clock == 0) {
+    return 0;
+  }
+
+  int32_t hactive = d[2] | (d[4] & 0xf0) << 4;
+  int32_t hblank = d[3] | (d[4] & 0x0f) << 8;
+  int32_t vactive = d[5] | (d[7] & 0xf0) << 4;
+  int32_t vblank = d[6] | (d[7] & 0x0f) << 8;
+  int32_t himage = d[12] | (d[14] & 0xf0) << 4;
+  int32_t vimage = d[13] | (d[14] & 0x0f) << 8;
+  bool interlaced = d[17] & 0x80;
+
+  int32_t htotal = hactive + hblank;
+  int32_t vtotal = vactive + vblank;
+  if (htotal != 0 && vtotal != 0) {
+    info->refresh =
+        (int32_t)((uint64_t)clock * 1000 / ((uint64_t)htotal * vtotal));
+  }
+
+  // Interlaced timings describe a single field.
+  info->width = hactive;
+  info->height = interlaced ? vactive * 2 : vactive;
+
+  if (himage != 0 && vimage != 0) {
+    info->phys_width = himage;
+    info->phys_height = vimage;
+  }
+  return 0;
+}
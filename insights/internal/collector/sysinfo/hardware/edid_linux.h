@@ -0,0 +1,21 @@
+#ifndef EDID_H
+#define EDID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Structure representing the preferred timing and size of a display, as
+// advertised in its EDID.
+struct edid_info {
+  int32_t width;
+  int32_t height;
+  int32_t refresh;  // In mHz.
+  int32_t phys_width;
+  int32_t phys_height;
+};
+
+// Parse the base block of an EDID blob.
+// Returns 0 on success, or -1 if the blob is not a valid EDID.
+int parse_edid(const uint8_t* data, size_t len, struct edid_info* info);
+
+#endif  // EDID_H
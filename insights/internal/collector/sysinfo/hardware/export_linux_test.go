@@ -2,6 +2,7 @@ package hardware
 
 type Screen = screen
 type CWaylandDisplay = cWaylandDisplay
+type CX11Display = cX11Display
 
 // WithRoot overrides default root directory of the system.
 func WithRoot(root string) Options {
@@ -37,3 +38,10 @@ func WithWaylandProvider(wp waylandProvider) Options {
 		o.platform.wayland = wp
 	}
 }
+
+// WithX11Provider overrides default X11 provider.
+func WithX11Provider(xp x11Provider) Options {
+	return func(o *options) {
+		o.platform.x11 = xp
+	}
+}
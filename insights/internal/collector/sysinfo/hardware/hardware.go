@@ -6,8 +6,11 @@ import (
 	"runtime"
 
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 )
 
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate hardware.go Info
+
 // Info aggregates hardware info.
 type Info struct {
 	Product      product       `json:"product,omitzero"`
@@ -78,8 +81,9 @@ type screen struct {
 // Collector handles dependencies for collecting hardware information.
 // Collector implements CollectorT[hardware.Info].
 type Collector struct {
-	log  *slog.Logger
-	arch string
+	log      *slog.Logger
+	arch     string
+	sections sections.Mask
 
 	platform platformOptions
 }
@@ -88,15 +92,24 @@ type Collector struct {
 type Options func(*options)
 
 type options struct {
-	arch string
+	arch     string
+	sections sections.Mask
 
 	platform platformOptions
 }
 
+// WithSections restricts the collection to the given hardware sections. Other probes are not run.
+func WithSections(m sections.Mask) Options {
+	return func(o *options) {
+		o.sections = m
+	}
+}
+
 // New returns a new Collector.
 func New(l *slog.Logger, args ...Options) Collector {
 	opts := &options{
-		arch: runtime.GOARCH,
+		arch:     runtime.GOARCH,
+		sections: sections.All,
 	}
 	opts.platform = defaultPlatformOptions()
 
@@ -105,60 +118,103 @@ func New(l *slog.Logger, args ...Options) Collector {
 	}
 
 	return Collector{
-		log:  l,
-		arch: opts.arch,
+		log:      l,
+		arch:     opts.arch,
+		sections: opts.sections,
 
 		platform: opts.platform,
 	}
 }
 
 // Collect aggregates the data from all the other hardware collect functions.
+// Only the selected sections are collected.
 func (h Collector) Collect(pi platform.Info) (info Info, err error) {
 	h.log.Debug("collecting hardware info")
 
-	info.Product, err = h.collectProduct(pi)
-	if err != nil {
-		h.log.Warn("failed to collect Product info", "error", err)
-		info.Product = product{}
+	if h.sections.Has(sections.HardwareProduct) {
+		info.Product, err = h.collectProduct(pi)
+		if err != nil {
+			h.log.Warn("failed to collect Product info", "error", err)
+			info.Product = product{}
+		}
 	}
 
-	info.CPU, err = h.collectCPU()
-	if err != nil {
-		h.log.Warn("failed to collect CPU info", "error", err)
-		info.CPU = cpu{
-			Arch: h.arch,
+	if h.sections.Has(sections.HardwareCPU) {
+		info.CPU, err = h.collectCPU()
+		if err != nil {
+			h.log.Warn("failed to collect CPU info", "error", err)
+			info.CPU = cpu{
+				Arch: h.arch,
+			}
 		}
 	}
 
-	info.GPUs, err = h.collectGPUs(pi)
-	if err != nil {
-		h.log.Warn("failed to collect GPU info", "error", err)
-		info.GPUs = []gpu{}
+	if h.sections.Has(sections.HardwareGPUs) {
+		info.GPUs, err = h.collectGPUs(pi)
+		if err != nil {
+			h.log.Warn("failed to collect GPU info", "error", err)
+			info.GPUs = []gpu{}
+		}
 	}
 
-	info.Accelerators, err = h.collectAccelerators(pi)
-	if err != nil {
-		h.log.Warn("failed to collect acceleration device info", "error", err)
-		info.Accelerators = []accelerator{}
+	if h.sections.Has(sections.HardwareAccelerators) {
+		info.Accelerators, err = h.collectAccelerators(pi)
+		if err != nil {
+			h.log.Warn("failed to collect acceleration device info", "error", err)
+			info.Accelerators = []accelerator{}
+		}
 	}
 
-	info.Mem, err = h.collectMemory()
-	if err != nil {
-		h.log.Warn("failed to collect memory info", "error", err)
-		info.Mem = memory{}
+	if h.sections.Has(sections.HardwareMemory) {
+		info.Mem, err = h.collectMemory()
+		if err != nil {
+			h.log.Warn("failed to collect memory info", "error", err)
+			info.Mem = memory{}
+		}
 	}
 
-	info.Blks, err = h.collectDisks()
-	if err != nil {
-		h.log.Warn("failed to collect disk info", "error", err)
-		info.Blks = []disk{}
+	if h.sections.Has(sections.HardwareDisks) {
+		info.Blks, err = h.collectDisks()
+		if err != nil {
+			h.log.Warn("failed to collect disk info", "error", err)
+			info.Blks = []disk{}
+		}
 	}
 
-	info.Screens, err = h.collectScreens(pi)
-	if err != nil {
-		h.log.Warn("failed to collect screen info", "error", err)
-		info.Screens = []screen{}
+	if h.sections.Has(sections.HardwareScreens) {
+		info.Screens, err = h.collectScreens(pi)
+		if err != nil {
+			h.log.Warn("failed to collect screen info", "error", err)
+			info.Screens = []screen{}
+		}
 	}
 
 	return info, nil
 }
+
+// Filter returns a copy of the information with only the selected sections.
+func (i Info) Filter(m sections.Mask) Info {
+	var f Info
+	if m.Has(sections.HardwareProduct) {
+		f.Product = i.Product
+	}
+	if m.Has(sections.HardwareCPU) {
+		f.CPU = i.CPU
+	}
+	if m.Has(sections.HardwareGPUs) {
+		f.GPUs = i.GPUs
+	}
+	if m.Has(sections.HardwareAccelerators) {
+		f.Accelerators = i.Accelerators
+	}
+	if m.Has(sections.HardwareMemory) {
+		f.Mem = i.Mem
+	}
+	if m.Has(sections.HardwareDisks) {
+		f.Blks = i.Blks
+	}
+	if m.Has(sections.HardwareScreens) {
+		f.Screens = i.Screens
+	}
+	return f
+}
@@ -0,0 +1,328 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package hardware
+
+import (
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Info) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	comma := false
+	dst = append(dst, '{')
+	if v.Product != (product{}) {
+		dst = append(dst, `"product":`...)
+		if dst, err = v.Product.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.CPU != (cpu{}) {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"cpu":`...)
+		if dst, err = v.CPU.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if len(v.GPUs) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"gpus":`...)
+		dst = append(dst, '[')
+		for i0, e0 := range v.GPUs {
+			if i0 > 0 {
+				dst = append(dst, ',')
+			}
+			if dst, err = e0.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+		dst = append(dst, ']')
+		comma = true
+	}
+	if len(v.Accelerators) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"accelerators":`...)
+		dst = append(dst, '[')
+		for i0, e0 := range v.Accelerators {
+			if i0 > 0 {
+				dst = append(dst, ',')
+			}
+			if dst, err = e0.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+		dst = append(dst, ']')
+		comma = true
+	}
+	if v.Mem != (memory{}) {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"memory":`...)
+		if dst, err = v.Mem.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if len(v.Blks) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"disks":`...)
+		dst = append(dst, '[')
+		for i0, e0 := range v.Blks {
+			if i0 > 0 {
+				dst = append(dst, ',')
+			}
+			if dst, err = e0.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+		dst = append(dst, ']')
+		comma = true
+	}
+	if len(v.Screens) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"screens":`...)
+		dst = append(dst, '[')
+		for i0, e0 := range v.Screens {
+			if i0 > 0 {
+				dst = append(dst, ',')
+			}
+			if dst, err = e0.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+		dst = append(dst, ']')
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Info) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v product) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, `"family":`...)
+	dst = jsonenc.AppendString(dst, v.Family)
+	dst = append(dst, `,"name":`...)
+	dst = jsonenc.AppendString(dst, v.Name)
+	dst = append(dst, `,"vendor":`...)
+	dst = jsonenc.AppendString(dst, v.Vendor)
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v product) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v cpu) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, `"name":`...)
+	dst = jsonenc.AppendString(dst, v.Name)
+	dst = append(dst, `,"vendor":`...)
+	dst = jsonenc.AppendString(dst, v.Vendor)
+	dst = append(dst, `,"architecture":`...)
+	dst = jsonenc.AppendString(dst, v.Arch)
+	dst = append(dst, `,"cpus":`...)
+	dst = jsonenc.AppendUint(dst, v.Cpus)
+	dst = append(dst, `,"sockets":`...)
+	dst = jsonenc.AppendUint(dst, v.Sockets)
+	dst = append(dst, `,"coresPerSocket":`...)
+	dst = jsonenc.AppendUint(dst, v.Cores)
+	dst = append(dst, `,"threadsPerCore":`...)
+	dst = jsonenc.AppendUint(dst, v.Threads)
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v cpu) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v gpu) AppendJSON(dst []byte) ([]byte, error) {
+	comma := false
+	dst = append(dst, '{')
+	if v.Name != "" {
+		dst = append(dst, `"name":`...)
+		dst = jsonenc.AppendString(dst, v.Name)
+		comma = true
+	}
+	if v.Device != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"device":`...)
+		dst = jsonenc.AppendString(dst, v.Device)
+		comma = true
+	}
+	if comma {
+		dst = append(dst, ',')
+	}
+	dst = append(dst, `"vendor":`...)
+	dst = jsonenc.AppendString(dst, v.Vendor)
+	dst = append(dst, `,"driver":`...)
+	dst = jsonenc.AppendString(dst, v.Driver)
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v gpu) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v accelerator) AppendJSON(dst []byte) ([]byte, error) {
+	comma := false
+	dst = append(dst, '{')
+	if v.Name != "" {
+		dst = append(dst, `"name":`...)
+		dst = jsonenc.AppendString(dst, v.Name)
+		comma = true
+	}
+	if v.Device != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"device":`...)
+		dst = jsonenc.AppendString(dst, v.Device)
+		comma = true
+	}
+	if v.Vendor != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"vendor":`...)
+		dst = jsonenc.AppendString(dst, v.Vendor)
+		comma = true
+	}
+	if v.Driver != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"driver":`...)
+		dst = jsonenc.AppendString(dst, v.Driver)
+		comma = true
+	}
+	if v.Type != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"type":`...)
+		dst = jsonenc.AppendString(dst, v.Type)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v accelerator) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v memory) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, `"size":`...)
+	dst = jsonenc.AppendInt(dst, v.Total)
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v memory) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v disk) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	dst = append(dst, '{')
+	dst = append(dst, `"size":`...)
+	dst = jsonenc.AppendUint(dst, v.Size)
+	if v.Type != "" {
+		dst = append(dst, `,"type":`...)
+		dst = jsonenc.AppendString(dst, v.Type)
+	}
+	if len(v.Children) != 0 {
+		dst = append(dst, `,"children":`...)
+		dst = append(dst, '[')
+		for i0, e0 := range v.Children {
+			if i0 > 0 {
+				dst = append(dst, ',')
+			}
+			if dst, err = e0.AppendJSON(dst); err != nil {
+				return dst, err
+			}
+		}
+		dst = append(dst, ']')
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v disk) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v screen) AppendJSON(dst []byte) ([]byte, error) {
+	comma := false
+	dst = append(dst, '{')
+	if v.PhysicalResolution != "" {
+		dst = append(dst, `"physicalResolution":`...)
+		dst = jsonenc.AppendString(dst, v.PhysicalResolution)
+		comma = true
+	}
+	if v.Size != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"size":`...)
+		dst = jsonenc.AppendString(dst, v.Size)
+		comma = true
+	}
+	if v.Resolution != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"resolution":`...)
+		dst = jsonenc.AppendString(dst, v.Resolution)
+		comma = true
+	}
+	if v.RefreshRate != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"refreshRate":`...)
+		dst = jsonenc.AppendString(dst, v.RefreshRate)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v screen) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
@@ -1,8 +1,10 @@
 package hardware
 
 /*
-#cgo LDFLAGS: -lwayland-client
+#cgo LDFLAGS: -lwayland-client -lxcb -lxcb-randr
+#include "edid_linux.h"
 #include "wayland_displays_linux.h"
+#include "x11_displays_linux.h"
 */
 import "C"
 
@@ -31,6 +33,7 @@ type platformOptions struct {
 	lsblkCmd   []string
 	screenCmd  []string
 	wayland    waylandProvider
+	x11        x11Provider
 }
 
 // defaultOptions returns options for when running under a normal environment.
@@ -41,6 +44,7 @@ func defaultPlatformOptions() platformOptions {
 		lsblkCmd:   []string{"lsblk", "-o", "NAME,SIZE,TYPE,RM", "--tree", "-J"},
 		screenCmd:  []string{"xrandr"},
 		wayland:    &realWaylandProvider{},
+		x11:        &realX11Provider{},
 	}
 }
 
@@ -48,7 +52,14 @@ type waylandProvider interface {
 	InitWayland() int
 }
 
-var waylandMutex sync.Mutex
+type x11Provider interface {
+	InitX11() int
+}
+
+var (
+	waylandMutex sync.Mutex
+	x11Mutex     sync.Mutex
+)
 
 // collectProduct reads sysfs to find information about the system.
 func (h Collector) collectProduct(pi platform.Info) (product, error) {
@@ -57,26 +68,18 @@ func (h Collector) collectProduct(pi platform.Info) (product, error) {
 		return product{}, nil
 	}
 
-	info := product{
-		Vendor: fileutils.ReadFileLogError(filepath.Join(h.platform.root, "sys/class/dmi/id/sys_vendor"), h.log),
-		Name:   fileutils.ReadFileLogError(filepath.Join(h.platform.root, "sys/class/dmi/id/product_name"), h.log),
-		Family: fileutils.ReadFileLogError(filepath.Join(h.platform.root, "sys/class/dmi/id/product_family"), h.log),
-	}
-
-	if strings.ContainsRune(info.Vendor, '\n') {
-		h.log.Warn("product vendor contains invalid value")
-		info.Vendor = ""
-	}
-	if strings.ContainsRune(info.Name, '\n') {
-		h.log.Warn("product name contains invalid value")
-		info.Name = ""
-	}
-	if strings.ContainsRune(info.Family, '\n') {
-		h.log.Warn("product family contains invalid value")
-		info.Family = ""
+	dmi, err := fileutils.OpenSysfsDir(filepath.Join(h.platform.root, "sys/class/dmi/id"))
+	if err != nil {
+		h.log.Warn("failed to open DMI directory", "error", err)
+		return product{}, nil
 	}
+	defer dmi.Close()
 
-	return info, nil
+	return product{
+		Vendor: dmi.ReadLog("sys_vendor", h.log, slog.LevelWarn),
+		Name:   dmi.ReadLog("product_name", h.log, slog.LevelWarn),
+		Family: dmi.ReadLog("product_family", h.log, slog.LevelWarn),
+	}, nil
 }
 
 // collectCPU uses lscpu to collect information about the CPUs.
@@ -212,35 +215,23 @@ func (h Collector) collectGPUs(pi platform.Info) (gpus []gpu, err error) {
 
 // collectGPU handles gathering information for a single GPU.
 func (h Collector) collectGPU(card string) (info gpu, err error) {
-	cardDir, err := filepath.EvalSymlinks(filepath.Join(h.platform.root, "sys/class/drm", card))
+	cardDir, err := fileutils.OpenSysfsDir(filepath.Join(h.platform.root, "sys/class/drm", card))
 	if err != nil {
 		return info, fmt.Errorf("failed to follow %s symlink: %v", card, err)
 	}
+	defer cardDir.Close()
 
-	devDir, err := filepath.EvalSymlinks(filepath.Join(cardDir, "device"))
+	devDir, err := cardDir.Open("device")
 	if err != nil {
 		return info, fmt.Errorf("failed to follow %s device symlink: %v", card, err)
 	}
+	defer devDir.Close()
 
-	info.Vendor = fileutils.ReadFileLogError(filepath.Join(devDir, "vendor"), h.log)
-	info.Name = fileutils.ReadFileLog(filepath.Join(devDir, "label"), h.log, slog.LevelInfo) // label is not always present
-	info.Device = fileutils.ReadFileLogError(filepath.Join(devDir, "device"), h.log)
-
-	if strings.ContainsRune(info.Vendor, '\n') {
-		h.log.Warn("gpu vendor contains invalid value", "GPU", card)
-		info.Vendor = ""
-	}
-	if strings.ContainsRune(info.Name, '\n') {
-		h.log.Warn("gpu name contains invalid value", "GPU", card)
-		info.Name = ""
-	}
+	info.Vendor = devDir.ReadLog("vendor", h.log, slog.LevelWarn)
+	info.Name = devDir.ReadLog("label", h.log, slog.LevelInfo) // label is not always present
+	info.Device = devDir.ReadLog("device", h.log, slog.LevelWarn)
 
-	if strings.ContainsRune(info.Device, '\n') {
-		h.log.Warn("gpu device contains invalid value", "GPU", card)
-		info.Device = ""
-	}
-
-	driverLink, err := os.Readlink(filepath.Join(devDir, "driver"))
+	driverLink, err := devDir.Readlink("driver")
 	if err != nil {
 		h.log.Warn("failed to get GPU driver", "GPU", card, "error", err)
 		return info, nil
@@ -285,39 +276,24 @@ func (h Collector) collectAccelerators(_ platform.Info) ([]accelerator, error) {
 
 // collectAccelerator handles gathering information for a single acceleration device.
 func (h Collector) collectAccelerator(accelName string) (info accelerator, err error) {
-	accelDir, err := filepath.EvalSymlinks(filepath.Join(h.platform.root, "sys/class/accel", accelName))
+	accelDir, err := fileutils.OpenSysfsDir(filepath.Join(h.platform.root, "sys/class/accel", accelName))
 	if err != nil {
 		return info, fmt.Errorf("failed to follow %s symlink: %v", accelName, err)
 	}
+	defer accelDir.Close()
 
-	devDir, err := filepath.EvalSymlinks(filepath.Join(accelDir, "device"))
+	devDir, err := accelDir.Open("device")
 	if err != nil {
 		return info, fmt.Errorf("failed to follow %s device symlink: %v", accelName, err)
 	}
+	defer devDir.Close()
 
-	info.Vendor = fileutils.ReadFileLogError(filepath.Join(devDir, "vendor"), h.log)
-	info.Name = fileutils.ReadFileLog(filepath.Join(devDir, "label"), h.log, slog.LevelInfo) // label is not always present
-	info.Device = fileutils.ReadFileLogError(filepath.Join(devDir, "device"), h.log)
-	info.Type = fileutils.ReadFileLog(filepath.Join(devDir, "class"), h.log, slog.LevelInfo) // class is not always present
+	info.Vendor = devDir.ReadLog("vendor", h.log, slog.LevelWarn)
+	info.Name = devDir.ReadLog("label", h.log, slog.LevelInfo) // label is not always present
+	info.Device = devDir.ReadLog("device", h.log, slog.LevelWarn)
+	info.Type = devDir.ReadLog("class", h.log, slog.LevelInfo) // class is not always present
 
-	if strings.ContainsRune(info.Vendor, '\n') {
-		h.log.Warn("acceleration device vendor contains invalid value", "device", accelName)
-		info.Vendor = ""
-	}
-	if strings.ContainsRune(info.Name, '\n') {
-		h.log.Warn("acceleration device name contains invalid value", "device", accelName)
-		info.Name = ""
-	}
-	if strings.ContainsRune(info.Device, '\n') {
-		h.log.Warn("acceleration device ID contains invalid value", "device", accelName)
-		info.Device = ""
-	}
-	if strings.ContainsRune(info.Type, '\n') {
-		h.log.Warn("acceleration device class contains invalid value", "device", accelName)
-		info.Type = ""
-	}
-
-	driverLink, err := os.Readlink(filepath.Join(devDir, "driver"))
+	driverLink, err := devDir.Readlink("driver")
 	if err != nil {
 		h.log.Warn("failed to get acceleration device driver", "device", accelName, "error", err)
 		return info, nil
@@ -473,18 +449,35 @@ var screenHeaderRegex = regexp.MustCompile(`(?m)^(\S+)\s+connected\s+(?:(primary
 var screenConfigRegex = regexp.MustCompile(`(?m)^\s*([0-9]+x[0-9]+)\s.*?([0-9]+\.[0-9]+)\+?\*\+?.*$`)
 
 // collectScreens collects screen information. Skips collection on WSL.
+// The display server of the session, or the DRM connectors when there is none, are queried directly,
+// and xrandr is only used when that fails.
 func (h Collector) collectScreens(pi platform.Info) (info []screen, err error) {
 	if pi.WSL.SubsystemVersion != 0 {
 		h.log.Debug("skipping screen info collection on WSL")
 		return []screen{}, nil
 	}
 
-	info, err = h.cScreensWayland()
-	if err == nil && len(info) > 0 {
-		return info, nil
+	var probes []func() ([]screen, error)
+	switch pi.Desktop.SessionType {
+	case "wayland":
+		probes = []func() ([]screen, error){h.cScreensWayland, h.cScreensDRM}
+	case "x11":
+		probes = []func() ([]screen, error){h.cScreensX11, h.cScreensDRM}
+	default:
+		// No known display server (headless, greeter, tty…): start with the one probe which does not need one.
+		probes = []func() ([]screen, error){h.cScreensDRM, h.cScreensWayland, h.cScreensX11}
+	}
+	for _, probe := range probes {
+		info, err = probe()
+		if err == nil && len(info) > 0 {
+			return info, nil
+		}
+		if err != nil {
+			h.log.Debug("failed to query screens", "error", err)
+		}
 	}
 
-	// Fall back to xrandr if Wayland fails.
+	// Fall back to xrandr if the display server could not be queried.
 	stdout, stderr, err := cmdutils.RunWithTimeout(context.Background(), 15*time.Second, h.platform.screenCmd[0], h.platform.screenCmd[1:]...)
 	if err != nil {
 		return nil, fmt.Errorf("failed to run xrandr: %v", err)
@@ -564,3 +557,98 @@ func (h Collector) cScreensWayland() (screens []screen, err error) {
 
 	return screens, nil
 }
+
+type realX11Provider struct{}
+
+func (*realX11Provider) InitX11() int {
+	return int(C.init_x11())
+}
+
+// cScreensX11 queries the connected outputs and their current mode through the X11 RandR extension.
+func (h Collector) cScreensX11() (screens []screen, err error) {
+	x11Mutex.Lock()
+	defer x11Mutex.Unlock()
+	if h.platform.x11.InitX11() != 0 {
+		return nil, fmt.Errorf("failed to query X11 display")
+	}
+	defer C.cleanup_x11()
+
+	if bool(C.had_x11_memory_error()) {
+		h.log.Warn("Memory error while trying to get X11 displays")
+		return nil, fmt.Errorf("failed to get displays")
+	}
+
+	count := int(C.get_x11_output_count())
+	screens = make([]screen, count)
+	displays := unsafe.Slice(C.get_x11_displays(), count)
+	for i, display := range displays {
+		if display.width != 0 && display.height != 0 {
+			screens[i].Resolution = fmt.Sprintf("%dx%d", display.width, display.height)
+		}
+		if display.refresh != 0 {
+			screens[i].RefreshRate = fmt.Sprintf("%.2f", float64(display.refresh)/1000)
+		}
+		if display.phys_width != 0 && display.phys_height != 0 {
+			screens[i].Size = fmt.Sprintf("%dmm x %dmm", display.phys_width, display.phys_height)
+		}
+	}
+
+	return screens, nil
+}
+
+// drmConnectorRegex matches the name of a DRM connector folder, like card0-DP-1.
+var drmConnectorRegex = regexp.MustCompile(`^card[0-9]+-.+$`)
+
+// cScreensDRM reads the screens plugged in the DRM connectors from sysfs, parsing their EDID.
+// It does not need a display server.
+func (h Collector) cScreensDRM() (screens []screen, err error) {
+	drmDir := filepath.Join(h.platform.root, "sys/class/drm")
+	ds, err := os.ReadDir(drmDir)
+	if err != nil {
+		return nil, fmt.Errorf("failed to read DRM directory in sysfs: %v", err)
+	}
+
+	for _, d := range ds {
+		if !drmConnectorRegex.MatchString(d.Name()) {
+			continue
+		}
+		connDir := filepath.Join(drmDir, d.Name())
+		status, err := os.ReadFile(filepath.Join(connDir, "status"))
+		if err != nil || strings.TrimSpace(string(status)) != "connected" {
+			continue
+		}
+		screens = append(screens, h.drmScreen(connDir))
+	}
+	return screens, nil
+}
+
+// drmScreen returns the preferred timing and size of the screen plugged in a DRM connector.
+// The preferred mode listed by the connector is used when the EDID is missing or invalid.
+func (h Collector) drmScreen(connDir string) (s screen) {
+	var info C.struct_edid_info
+	edid, err := os.ReadFile(filepath.Join(connDir, "edid"))
+	if err == nil && len(edid) > 0 &&
+		C.parse_edid((*C.uint8_t)(unsafe.Pointer(&edid[0])), C.size_t(len(edid)), &info) == 0 {
+		if info.width != 0 && info.height != 0 {
+			s.PhysicalResolution = fmt.Sprintf("%dx%d", info.width, info.height)
+		}
+		if info.refresh != 0 {
+			s.RefreshRate = fmt.Sprintf("%.2f", float64(info.refresh)/1000)
+		}
+		if info.phys_width != 0 && info.phys_height != 0 {
+			s.Size = fmt.Sprintf("%dmm x %dmm", info.phys_width, info.phys_height)
+		}
+		return s
+	}
+	h.log.Debug("no valid EDID for DRM connector, using its modes", "connector", filepath.Base(connDir))
+
+	// The preferred mode is listed first.
+	modes, err := os.ReadFile(filepath.Join(connDir, "modes"))
+	if err != nil {
+		h.log.Warn("failed to read DRM connector modes", "connector", filepath.Base(connDir), "error", err)
+		return s
+	}
+	mode, _, _ := strings.Cut(string(modes), "\n")
+	s.PhysicalResolution = strings.TrimSpace(mode)
+	return s
+}
@@ -56,6 +56,14 @@ func TestCollectLinux(t *testing.T) {
 		WaylandMultipleDisplays
 	)
 
+	type x11Type int
+	const (
+		X11None x11Type = iota
+		X11MemoryError
+		X11SingleDisplay
+		X11MultipleDisplays
+	)
+
 	tests := map[string]struct {
 		root         string
 		cpuInfo      string
@@ -65,6 +73,7 @@ func TestCollectLinux(t *testing.T) {
 		writeFiles   map[string]string
 		pinfo        platform.Info
 		wayland      waylandType
+		x11          x11Type
 
 		logs    map[slog.Level]uint
 		wantErr bool
@@ -389,13 +398,150 @@ func TestCollectLinux(t *testing.T) {
 			wayland: WaylandMultipleDisplays,
 		},
 
+		"X11 MemoryError warns and falls back": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+
+			x11: X11MemoryError,
+			logs: map[slog.Level]uint{
+				slog.LevelWarn: 1,
+			},
+		},
+
+		"X11 SingleDisplay is sane": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+
+			x11: X11SingleDisplay,
+		},
+
+		"X11 MultipleDisplays is sane": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+
+			x11: X11MultipleDisplays,
+		},
+
+		"Wayland is preferred on unknown session type": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+
+			wayland: WaylandSingleDisplay,
+			x11:     X11MultipleDisplays,
+		},
+
+		"X11 session does not query Wayland": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			pinfo:      platform.Info{Desktop: platform.Desktop{SessionType: "x11"}},
+
+			wayland: WaylandMultipleDisplays,
+			x11:     X11SingleDisplay,
+		},
+
+		"Wayland session does not query X11": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			pinfo:      platform.Info{Desktop: platform.Desktop{SessionType: "wayland"}},
+
+			wayland: WaylandNone,
+			x11:     X11SingleDisplay,
+		},
+
+		"DRM connector is used before display servers on unknown session type": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-HDMI-A-1/status": "connected\n",
+				"sys/class/drm/card2-HDMI-A-1/modes":  "1920x1080\n1280x720\n",
+				"sys/class/drm/card2-HDMI-A-1/edid":   makeEDID(),
+			},
+
+			wayland: WaylandSingleDisplay,
+		},
+
+		"DRM connector is used when Wayland fails in a Wayland session": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-HDMI-A-1/status": "connected\n",
+				"sys/class/drm/card2-HDMI-A-1/edid":   makeEDID(),
+			},
+			pinfo: platform.Info{Desktop: platform.Desktop{SessionType: "wayland"}},
+		},
+
+		"DRM connector without EDID uses its preferred mode": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-eDP-1/status": "connected\n",
+				"sys/class/drm/card2-eDP-1/modes":  "2560x1440\n1920x1080\n",
+				"sys/class/drm/card2-eDP-1/edid":   "",
+			},
+		},
+
+		"DRM connector with invalid EDID uses its preferred mode": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-eDP-1/status": "connected\n",
+				"sys/class/drm/card2-eDP-1/modes":  "2560x1440\n1920x1080\n",
+				"sys/class/drm/card2-eDP-1/edid":   "garbage",
+			},
+		},
+
+		"DRM connector without modes or EDID warns": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-eDP-1/status": "connected\n",
+			},
+
+			logs: map[slog.Level]uint{
+				slog.LevelWarn: 1,
+			},
+		},
+
+		"Disconnected DRM connector is ignored": {
+			root:       "regular",
+			cpuInfo:    "regular",
+			blkInfo:    "regular",
+			screenInfo: "regular",
+			writeFiles: map[string]string{
+				"sys/class/drm/card2-HDMI-A-1/status": "disconnected\n",
+				"sys/class/drm/card2-HDMI-A-1/edid":   makeEDID(),
+			},
+		},
+
 		"Missing hardware information is empty": {
 			root:       "withoutinfo",
 			cpuInfo:    "",
 			blkInfo:    "",
 			screenInfo: "",
 			logs: map[slog.Level]uint{
-				slog.LevelWarn: 8,
+				slog.LevelWarn: 6,
 			},
 		},
 
@@ -554,6 +700,25 @@ func TestCollectLinux(t *testing.T) {
 			wm.t = t
 			options = append(options, hardware.WithWaylandProvider(&wm))
 
+			var xm x11Mock
+			switch tc.x11 {
+			case X11None:
+				xm = x11Mock{initReturn: -1}
+			case X11MemoryError:
+				xm = x11Mock{initReturn: 0, memoryError: true}
+			case X11SingleDisplay:
+				xm = x11Mock{initReturn: 0,
+					displays: []hardware.CX11Display{{Width: 1920, Height: 1080, Refresh: 60004, PhysWidth: 598, PhysHeight: 336}}}
+			case X11MultipleDisplays:
+				xm = x11Mock{initReturn: 0,
+					displays: []hardware.CX11Display{{Width: 2560, Height: 1440, Refresh: 143998, PhysWidth: 597, PhysHeight: 336},
+						{}, {Width: 1920, Height: 1200, Refresh: 59950, PhysWidth: 518, PhysHeight: 324}}}
+			default:
+				t.Fatalf("Setup: X11 type not implemented, %d", tc.x11)
+			}
+			xm.t = t
+			options = append(options, hardware.WithX11Provider(&xm))
+
 			l := testutils.NewMockHandler(slog.LevelDebug)
 			s := hardware.New(slog.New(&l), options...)
 
@@ -1052,6 +1217,22 @@ HDMI-0 connected primary 3840x2160+3072+0 (normal left inverted right x axis y a
 	}
 }
 
+// makeEDID returns an EDID base block with a 1920x1080 at 60Hz preferred timing, for a 527mm x 296mm screen.
+func makeEDID() string {
+	edid := make([]byte, 128)
+	copy(edid, []byte{0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00})
+	// Size in cm, overridden by the size of the preferred timing.
+	edid[21], edid[22] = 53, 30
+	copy(edid[54:], []byte{0x02, 0x3a, 0x80, 0x18, 0x71, 0x38, 0x2d, 0x40, 0, 0, 0, 0, 0x0f, 0x28, 0x21})
+
+	var sum byte
+	for _, b := range edid[:127] {
+		sum += b
+	}
+	edid[127] = -sum
+	return string(edid)
+}
+
 type waylandMock struct {
 	t           *testing.T
 	initReturn  int
@@ -1063,3 +1244,15 @@ func (w *waylandMock) InitWayland() int {
 	hardware.TestingInitWayland(w.t, w.displays, w.memoryError)
 	return w.initReturn
 }
+
+type x11Mock struct {
+	t           *testing.T
+	initReturn  int
+	memoryError bool
+	displays    []hardware.CX11Display
+}
+
+func (x *x11Mock) InitX11() int {
+	hardware.TestingInitX11(x.t, x.displays, x.memoryError)
+	return x.initReturn
+}
@@ -0,0 +1,204 @@
+#include "x11_displays_linux.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/randr.h>
+#include <xcb/xcb.h>
+
+#include "x11_displays_linux_test.h"
+
+static bool memory_error = false;
+
+static struct x11_display** displays = NULL;
+static size_t count = 0;
+
+// Find the mode with the given id in the screen resources.
+static const xcb_randr_mode_info_t* find_mode(
+    const xcb_randr_get_screen_resources_current_reply_t* resources,
+    xcb_randr_mode_t id) {
+  const xcb_randr_mode_info_t* modes =
+      xcb_randr_get_screen_resources_current_modes(resources);
+  int n = xcb_randr_get_screen_resources_current_modes_length(resources);
+  for (int i = 0; i < n; i++) {
+    if (modes[i].id == id) {
+      return &modes[i];
+    }
+  }
+  return NULL;
+}
+
+// Compute the refresh rate of a mode in mHz, the same way xrandr does.
+static int32_t mode_refresh(const xcb_randr_mode_info_t* mode) {
+  double vtotal = mode->vtotal;
+  if (mode->mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN) {
+    vtotal *= 2;
+  }
+  if (mode->mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE) {
+    vtotal /= 2;
+  }
+  if (mode->htotal == 0 || vtotal == 0) {
+    return 0;
+  }
+  return (int32_t)((double)mode->dot_clock * 1000 /
+                   ((double)mode->htotal * vtotal));
+}
+
+// Query the connected outputs of the root window, and fill the displays.
+// The output and CRTC requests are all sent before waiting on any reply, so
+// that the whole probe only costs two round trips to the X server.
+static int query_outputs(xcb_connection_t* conn, xcb_window_t root) {
+  // Announce the RandR version we speak in the same batch as the resources.
+  xcb_randr_query_version_cookie_t version_cookie =
+      xcb_randr_query_version(conn, XCB_RANDR_MAJOR_VERSION,
+                              XCB_RANDR_MINOR_VERSION);
+  xcb_randr_get_screen_resources_current_cookie_t resources_cookie =
+      xcb_randr_get_screen_resources_current(conn, root);
+
+  free(xcb_randr_query_version_reply(conn, version_cookie, NULL));
+  xcb_randr_get_screen_resources_current_reply_t* resources =
+      xcb_randr_get_screen_resources_current_reply(conn, resources_cookie,
+                                                   NULL);
+  if (!resources) {
+    return -1;
+  }
+
+  xcb_timestamp_t timestamp = resources->config_timestamp;
+  xcb_randr_output_t* outputs =
+      xcb_randr_get_screen_resources_current_outputs(resources);
+  int n_outputs =
+      xcb_randr_get_screen_resources_current_outputs_length(resources);
+  xcb_randr_crtc_t* crtcs =
+      xcb_randr_get_screen_resources_current_crtcs(resources);
+  int n_crtcs = xcb_randr_get_screen_resources_current_crtcs_length(resources);
+
+  xcb_randr_get_output_info_cookie_t* output_cookies =
+      malloc(n_outputs * sizeof(xcb_randr_get_output_info_cookie_t));
+  xcb_randr_get_crtc_info_cookie_t* crtc_cookies =
+      malloc(n_crtcs * sizeof(xcb_randr_get_crtc_info_cookie_t));
+  xcb_randr_get_crtc_info_reply_t** crtc_infos =
+      calloc(n_crtcs, sizeof(xcb_randr_get_crtc_info_reply_t*));
+  displays = calloc(n_outputs, sizeof(struct x11_display*));
+  if ((n_outputs > 0 && (!output_cookies || !displays)) ||
+      (n_crtcs > 0 && (!crtc_cookies || !crtc_infos))) {
+    free(output_cookies);
+    free(crtc_cookies);
+    free(crtc_infos);
+    free(resources);
+    memory_error = true;
+    return 0;
+  }
+
+  for (int i = 0; i < n_outputs; i++) {
+    output_cookies[i] = xcb_randr_get_output_info(conn, outputs[i], timestamp);
+  }
+  for (int i = 0; i < n_crtcs; i++) {
+    crtc_cookies[i] = xcb_randr_get_crtc_info(conn, crtcs[i], timestamp);
+  }
+  for (int i = 0; i < n_crtcs; i++) {
+    crtc_infos[i] = xcb_randr_get_crtc_info_reply(conn, crtc_cookies[i], NULL);
+  }
+
+  for (int i = 0; i < n_outputs; i++) {
+    xcb_randr_get_output_info_reply_t* output =
+        xcb_randr_get_output_info_reply(conn, output_cookies[i], NULL);
+    // Match xrandr, which only lists connected outputs driven by a CRTC.
+    if (!output || memory_error ||
+        output->connection != XCB_RANDR_CONNECTION_CONNECTED ||
+        output->crtc == XCB_NONE) {
+      free(output);
+      continue;
+    }
+
+    const xcb_randr_get_crtc_info_reply_t* crtc = NULL;
+    for (int j = 0; j < n_crtcs; j++) {
+      if (crtcs[j] == output->crtc) {
+        crtc = crtc_infos[j];
+        break;
+      }
+    }
+    const xcb_randr_mode_info_t* mode =
+        crtc ? find_mode(resources, crtc->mode) : NULL;
+    if (!mode) {
+      free(output);
+      continue;
+    }
+
+    struct x11_display* display = malloc(sizeof(struct x11_display));
+    if (!display) {
+      free(output);
+      memory_error = true;
+      continue;
+    }
+    display->width = mode->width;
+    display->height = mode->height;
+    display->refresh = mode_refresh(mode);
+    display->phys_width = output->mm_width;
+    display->phys_height = output->mm_height;
+    displays[count++] = display;
+    free(output);
+  }
+
+  for (int i = 0; i < n_crtcs; i++) {
+    free(crtc_infos[i]);
+  }
+  free(output_cookies);
+  free(crtc_cookies);
+  free(crtc_infos);
+  free(resources);
+  return 0;
+}
+
+int init_x11() {
+  int screen_num;
+  xcb_connection_t* conn = xcb_connect(NULL, &screen_num);
+  if (xcb_connection_has_error(conn)) {
+    xcb_disconnect(conn);
+    return -1;
+  }
+
+  const xcb_query_extension_reply_t* randr =
+      xcb_get_extension_data(conn, &xcb_randr_id);
+  if (!randr || !randr->present) {
+    xcb_disconnect(conn);
+    return -1;
+  }
+
+  xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(conn));
+  for (int i = 0; i < screen_num && it.rem; i++) {
+    xcb_screen_next(&it);
+  }
+  if (!it.rem) {
+    xcb_disconnect(conn);
+    return -1;
+  }
+
+  int ret = query_outputs(conn, it.data->root);
+  xcb_disconnect(conn);
+  if (ret != 0) {
+    cleanup_x11();
+  }
+  return ret;
+}
+
+void cleanup_x11() {
+  for (size_t i = 0; i < count; i++) {
+    free(displays[i]);
+  }
+  free(displays);
+  displays = NULL;
+  count = 0;
+  memory_error = false;
+}
+
+struct x11_display** get_x11_displays() { return displays; }
+
+int get_x11_output_count() { return count; }
+bool had_x11_memory_error() { return memory_error; }
+
+void set_x11_displays(struct x11_display** new_displays, int c) {
+  cleanup_x11();
+  displays = new_displays;
+  count = c;
+}
+
+void set_x11_memory_error(bool error) { memory_error = error; }
@@ -0,0 +1,31 @@
+#ifndef X11_DISPLAYS_H
+#define X11_DISPLAYS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Structure representing the X11 display information of a connected output.
+struct x11_display {
+  int32_t width;
+  int32_t height;
+  int32_t refresh;  // In mHz.
+  int32_t phys_width;
+  int32_t phys_height;
+};
+
+// Initialize X11 display information through the RandR extension.
+int init_x11();
+
+// Cleanup X11 display information.
+void cleanup_x11();
+
+// Get the X11 display information.
+struct x11_display** get_x11_displays();
+
+// Get the number of X11 displays.
+int get_x11_output_count();
+
+// Checks if there was a memory error.
+bool had_x11_memory_error();
+
+#endif  // X11_DISPLAYS_H
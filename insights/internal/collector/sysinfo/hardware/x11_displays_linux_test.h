@@ -0,0 +1,11 @@
+#ifndef X11_DISPLAYS_TEST_H
+#define X11_DISPLAYS_TEST_H
+#include <stdbool.h>
+
+// Setter function to set displays for testing purposes
+void set_x11_displays(struct x11_display** displays, int count);
+
+// Setter function to set memory error for testing purposes
+void set_x11_memory_error(bool error);
+
+#endif  // X11_DISPLAYS_TEST_H
@@ -0,0 +1,51 @@
+package hardware
+
+/*
+#cgo LDFLAGS: -lxcb -lxcb-randr
+#include "x11_displays_linux.h"
+#include "x11_displays_linux_test.h"
+*/
+import "C"
+
+import (
+	"testing"
+	"unsafe"
+)
+
+type cX11Display struct {
+	Width      int32
+	Height     int32
+	Refresh    int32
+	PhysWidth  int32
+	PhysHeight int32
+}
+
+// makeCX11Displays converts Go cX11Display structs to a C array of displays.
+func makeCX11Displays(d []cX11Display) (xds **C.struct_x11_display) {
+	if len(d) == 0 {
+		return nil
+	}
+
+	// Cleanup is done in C.
+	xds = (**C.struct_x11_display)(C.malloc(C.size_t(len(d)) * C.size_t(unsafe.Sizeof((*C.struct_x11_display)(nil)))))
+	slice := unsafe.Slice(xds, len(d))
+	for i, display := range d {
+		xd := (*C.struct_x11_display)(C.malloc(C.size_t(C.sizeof_struct_x11_display)))
+		xd.width = C.int32_t(display.Width)
+		xd.height = C.int32_t(display.Height)
+		xd.refresh = C.int32_t(display.Refresh)
+		xd.phys_width = C.int32_t(display.PhysWidth)
+		xd.phys_height = C.int32_t(display.PhysHeight)
+		slice[i] = xd
+	}
+	return xds
+}
+
+// TestingInitX11 initializes the X11 displays for testing purposes.
+func TestingInitX11(t *testing.T, cxd []cX11Display, memoryErr bool) {
+	t.Helper()
+
+	xds := makeCX11Displays(cxd)
+	C.set_x11_displays(xds, C.int(len(cxd)))
+	C.set_x11_memory_error(C.bool(memoryErr))
+}
@@ -1,7 +1,9 @@
 package platform
 
 import (
+	"context"
 	"errors"
+	"time"
 
 	"github.com/godbus/dbus/v5"
 )
@@ -41,17 +43,26 @@ func WithProStatusCmd(cmd []string) Options {
 	}
 }
 
-// fakeProDBusObject is a fake proDBusObject returning a preconfigured value or error.
+// fakeProDBusObject is a fake proDBusObject returning preconfigured properties or error.
 type fakeProDBusObject struct {
 	value any
 	err   error
+	hang  bool
 }
 
-func (o fakeProDBusObject) GetProperty(string) (dbus.Variant, error) {
+func (o fakeProDBusObject) CallWithContext(ctx context.Context, _ string, _ dbus.Flags, _ ...any) *dbus.Call {
+	if o.hang {
+		<-ctx.Done()
+		return &dbus.Call{Err: ctx.Err()}
+	}
 	if o.err != nil {
-		return dbus.Variant{}, o.err
+		return &dbus.Call{Err: o.err}
+	}
+	props := map[string]dbus.Variant{"ContractStatus": dbus.MakeVariant("")}
+	if o.value != nil {
+		props[proDBusProp] = dbus.MakeVariant(o.value)
 	}
-	return dbus.MakeVariant(o.value), nil
+	return &dbus.Call{Body: []any{props}}
 }
 
 // fakeProDBusConn is a fake proDBusConn returning a preconfigured object.
@@ -63,10 +74,6 @@ func (c fakeProDBusConn) Object(string, dbus.ObjectPath) proDBusObject {
 	return c.obj
 }
 
-func (c fakeProDBusConn) Close() error {
-	return nil
-}
-
 // ProDBusSpec identifies which fake D-Bus behaviour WithProDBusConnector injects.
 type ProDBusSpec int
 
@@ -77,10 +84,14 @@ const (
 	ProDBusAttached
 	// ProDBusDetached makes the connector report a detached state.
 	ProDBusDetached
-	// ProDBusPropertyError makes the connection succeed but reading the property fail.
+	// ProDBusPropertyError makes the connection succeed but reading the properties fail.
 	ProDBusPropertyError
 	// ProDBusGarbage makes the connection succeed but return an unexpected property type.
 	ProDBusGarbage
+	// ProDBusMissing makes the connection succeed but return properties without the attach state.
+	ProDBusMissing
+	// ProDBusHang makes the connection succeed but reading the properties never answer.
+	ProDBusHang
 )
 
 // WithProDBusConnector sets the pro D-Bus connector for the platform collector.
@@ -96,6 +107,10 @@ func WithProDBusConnector(spec ProDBusSpec) Options {
 				return fakeProDBusConn{obj: fakeProDBusObject{err: errors.New("fake property error")}}, nil
 			case ProDBusGarbage:
 				return fakeProDBusConn{obj: fakeProDBusObject{value: "not a bool"}}, nil
+			case ProDBusMissing:
+				return fakeProDBusConn{obj: fakeProDBusObject{}}, nil
+			case ProDBusHang:
+				return fakeProDBusConn{obj: fakeProDBusObject{hang: true}}, nil
 			default: // ProDBusConnectError
 				return nil, errors.New("fake connect error")
 			}
@@ -103,6 +118,20 @@ func WithProDBusConnector(spec ProDBusSpec) Options {
 	}
 }
 
+// WithProDBusTimeout sets how long the platform collector waits on D-Bus before using the pro CLI.
+func WithProDBusTimeout(timeout time.Duration) Options {
+	return func(o *options) {
+		o.platform.proDBusTimeout = timeout
+	}
+}
+
+// WithProStatusRefreshWait sets how long the platform collector waits on the pro CLI refreshing a stale cached state.
+func WithProStatusRefreshWait(wait time.Duration) Options {
+	return func(o *options) {
+		o.platform.proStatusRefreshWait = wait
+	}
+}
+
 // WithGetenv sets the getenv function for the linux platform collector using a map.
 func WithGetenv(env map[string]string) Options {
 	return func(o *options) {
@@ -111,3 +140,13 @@ func WithGetenv(env map[string]string) Options {
 		}
 	}
 }
+
+// WithHypervisor sets the hypervisor the CPU reports for the linux platform collector.
+// An empty name means the CPU can't tell, so that virtualization detection falls back to systemd-detect-virt.
+func WithHypervisor(name string) Options {
+	return func(o *options) {
+		o.platform.cpuHypervisor = func() (string, bool) {
+			return name, name != ""
+		}
+	}
+}
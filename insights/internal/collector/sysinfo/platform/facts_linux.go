@@ -0,0 +1,51 @@
+package platform
+
+import (
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+)
+
+// facts memoizes the system facts several platform probes depend on, so that each of them is only
+// computed once per collection, however many probes need it.
+// The hardware and software collectors get what is derived from them through Info.
+type facts struct {
+	virtualization func() string
+	procVersion    func() string
+	systemdBooted  func() bool
+}
+
+// newFacts returns the facts of a collection, lazily computed by p.
+// They are detected in-process first, and only fall back to the system tools when that is inconclusive.
+func newFacts(p Collector) *facts {
+	path := filepath.Join(p.platform.root, "proc/version")
+	readProcVersion := sync.OnceValues(func() (string, error) {
+		p.log.Debug("reading file", "file", path)
+		v, err := os.ReadFile(path)
+		return strings.TrimSpace(string(v)), err
+	})
+
+	return &facts{
+		virtualization: sync.OnceValue(func() string {
+			if v, ok := p.detectVirtualizationNative(readProcVersion); ok {
+				return v
+			}
+			return p.detectVirtualization()
+		}),
+		// Not being able to read /proc/version only matters once we know we are under WSL.
+		procVersion: sync.OnceValue(func() string {
+			v, err := readProcVersion()
+			if err != nil {
+				p.log.Warn("failed to read file", "file", path, "error", err)
+			}
+			return v
+		}),
+		systemdBooted: sync.OnceValue(func() bool {
+			if booted, ok := p.detectSystemdBootedNative(); ok {
+				return booted
+			}
+			return p.wasSystemdUsed()
+		}),
+	}
+}
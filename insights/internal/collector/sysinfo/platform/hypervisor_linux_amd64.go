@@ -0,0 +1,23 @@
+package platform
+
+// cpuid executes the CPUID instruction for leaf and subleaf.
+//
+//go:noescape
+func cpuid(leaf, subleaf uint32) (eax, ebx, ecx, edx uint32)
+
+// cpuHypervisor returns the systemd-detect-virt name of the hypervisor the CPU reports running under,
+// or "none" if it reports none.
+// It returns false if the hypervisor is not one systemd-detect-virt names.
+func cpuHypervisor() (string, bool) {
+	// The hypervisor present bit is reserved to hypervisors.
+	if _, _, ecx, _ := cpuid(1, 0); ecx&(1<<31) == 0 {
+		return "none", true
+	}
+
+	_, ebx, ecx, edx := cpuid(0x40000000, 0)
+	sig := make([]byte, 0, 12)
+	for _, r := range []uint32{ebx, ecx, edx} {
+		sig = append(sig, byte(r), byte(r>>8), byte(r>>16), byte(r>>24))
+	}
+	return hypervisorName(string(sig))
+}
@@ -0,0 +1,8 @@
+//go:build linux && !amd64
+
+package platform
+
+// cpuHypervisor can't query the CPU on this architecture, so it never detects anything.
+func cpuHypervisor() (string, bool) {
+	return "", false
+}
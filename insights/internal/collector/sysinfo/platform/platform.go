@@ -3,12 +3,21 @@ package platform
 
 import (
 	"log/slog"
+
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 )
 
+// Info is declared per platform, so are its generated encoders.
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate platform_linux.go Info
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate platform_darwin.go Info
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate platform_windows.go Info
+
 // Collector handles dependencies for collecting platform information.
 // Collector implements CollectorT[platform.Info].
 type Collector struct {
 	log      *slog.Logger
+	sections sections.Mask
+	cacheDir string
 	platform platformOptions
 }
 
@@ -16,12 +25,32 @@ type Collector struct {
 type Options func(*options)
 
 type options struct {
+	sections sections.Mask
+	cacheDir string
 	platform platformOptions
 }
 
+// WithSections restricts the collection to the given platform sections. Other probes are not run, except for
+// detecting the platform itself when sections.PlatformDependent ones are selected.
+func WithSections(m sections.Mask) Options {
+	return func(o *options) {
+		o.sections = m
+	}
+}
+
+// WithCacheDir makes the collector keep, in dir, the facts which are slow to probe and rarely change, for later
+// collections to reuse. They are only kept in memory otherwise.
+func WithCacheDir(dir string) Options {
+	return func(o *options) {
+		o.cacheDir = dir
+	}
+}
+
 // New returns a new Collector.
 func New(l *slog.Logger, args ...Options) Collector {
-	opts := &options{}
+	opts := &options{
+		sections: sections.All,
+	}
 	opts.platform = defaultPlatformOptions()
 	for _, opt := range args {
 		opt(opts)
@@ -29,6 +58,8 @@ func New(l *slog.Logger, args ...Options) Collector {
 
 	return Collector{
 		log:      l,
+		sections: opts.sections,
+		cacheDir: opts.cacheDir,
 		platform: opts.platform,
 	}
 }
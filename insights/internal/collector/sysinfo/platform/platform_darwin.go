@@ -1,5 +1,7 @@
 package platform
 
+import "github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
+
 type platformOptions struct {
 }
 
@@ -15,3 +17,8 @@ type Info struct {
 func (p Collector) collectPlatform() (info Info, err error) {
 	return info, nil
 }
+
+// Filter returns a copy of the information with only the selected sections.
+func (i Info) Filter(_ sections.Mask) Info {
+	return i
+}
@@ -0,0 +1,127 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package platform
+
+import (
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Info) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	comma := false
+	dst = append(dst, '{')
+	if v.WSL != (WSL{}) {
+		dst = append(dst, `"wsl":`...)
+		if dst, err = v.WSL.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.Desktop != (Desktop{}) {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"desktop":`...)
+		if dst, err = v.Desktop.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.ProAttached {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"proAttached":`...)
+		dst = jsonenc.AppendBool(dst, v.ProAttached)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Info) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v WSL) AppendJSON(dst []byte) ([]byte, error) {
+	comma := false
+	dst = append(dst, '{')
+	if v.SubsystemVersion != 0 {
+		dst = append(dst, `"subsystemVersion":`...)
+		dst = jsonenc.AppendUint(dst, uint64(v.SubsystemVersion))
+		comma = true
+	}
+	if v.Systemd != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"systemd":`...)
+		dst = jsonenc.AppendString(dst, v.Systemd)
+		comma = true
+	}
+	if v.Interop != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"interop":`...)
+		dst = jsonenc.AppendString(dst, v.Interop)
+		comma = true
+	}
+	if v.Version != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"version":`...)
+		dst = jsonenc.AppendString(dst, v.Version)
+		comma = true
+	}
+	if v.KernelVersion != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"kernelVersion":`...)
+		dst = jsonenc.AppendString(dst, v.KernelVersion)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v WSL) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Desktop) AppendJSON(dst []byte) ([]byte, error) {
+	comma := false
+	dst = append(dst, '{')
+	if v.DesktopEnvironment != "" {
+		dst = append(dst, `"desktopEnvironment":`...)
+		dst = jsonenc.AppendString(dst, v.DesktopEnvironment)
+		comma = true
+	}
+	if v.SessionName != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"sessionName":`...)
+		dst = jsonenc.AppendString(dst, v.SessionName)
+		comma = true
+	}
+	if v.SessionType != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"sessionType":`...)
+		dst = jsonenc.AppendString(dst, v.SessionType)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Desktop) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
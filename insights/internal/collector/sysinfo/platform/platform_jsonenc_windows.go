@@ -0,0 +1,15 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package platform
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Info) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Info) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
@@ -3,18 +3,22 @@ package platform
 import (
 	"context"
 	"encoding/json"
+	"errors"
 	"fmt"
 	"io"
 	"os"
 	"path/filepath"
 	"regexp"
 	"strings"
+	"sync"
 	"time"
 
 	"github.com/godbus/dbus/v5"
 	"github.com/ubuntu/decorate"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/cmdutils"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 	"golang.org/x/text/encoding/unicode"
 	"golang.org/x/text/transform"
 	"gopkg.in/ini.v1"
@@ -27,19 +31,31 @@ const (
 	proDBusDest  = "com.canonical.UbuntuAdvantage"
 	proDBusPath  = "/com/canonical/UbuntuAdvantage/Manager"
 	proDBusIface = "com.canonical.UbuntuAdvantage.Manager"
-	proDBusProp  = proDBusIface + ".Attached"
+	proDBusProp  = "Attached"
 )
 
-// proDBusObject is the subset of dbus.BusObject used to read the attach state.
+// proDBusTimeout bounds how long the Pro probe waits on D-Bus before using a cached state or the `pro` CLI instead.
+const proDBusTimeout = 2 * time.Second
+
+// proStatusCacheTTL is how long a cached attach state is used without running the `pro` CLI again.
+const proStatusCacheTTL = time.Hour
+
+// proStatusCacheMaxAge is how long a stale cached attach state can still be used while the `pro` CLI refreshing it
+// runs. Past it, the CLI is waited on, so that collections exiting before it answers do not keep the state forever.
+const proStatusCacheMaxAge = 7 * 24 * time.Hour
+
+// proStatusRefreshWait bounds how long the `pro` CLI refreshing a stale cached attach state is waited on.
+const proStatusRefreshWait = 5 * time.Second
+
+// proDBusObject is the subset of dbus.BusObject used to read the Pro properties.
 type proDBusObject interface {
-	GetProperty(p string) (dbus.Variant, error)
+	CallWithContext(ctx context.Context, method string, flags dbus.Flags, args ...any) *dbus.Call
 }
 
-// proDBusConn is the subset of *dbus.Conn used to read the attach state.
+// proDBusConn is the subset of *dbus.Conn used to read the Pro properties.
 // It is an interface to allow injecting a fake connection in tests.
 type proDBusConn interface {
 	Object(dest string, path dbus.ObjectPath) proDBusObject
-	Close() error
 }
 
 // systemBusConn wraps a *dbus.Conn to satisfy proDBusConn.
@@ -51,17 +67,55 @@ func (c systemBusConn) Object(dest string, path dbus.ObjectPath) proDBusObject {
 	return c.conn.Object(dest, path)
 }
 
-func (c systemBusConn) Close() error {
-	return c.conn.Close()
+// systemBus is the system bus connection shared by every collection of the process, so that the
+// connection, authentication and Hello handshake are only paid once for the daemon or CLI lifetime.
+var systemBus struct {
+	mu   sync.Mutex
+	conn *dbus.Conn
 }
 
-// connectSystemBus connects to the system bus and returns a proDBusConn.
-func connectSystemBus() (proDBusConn, error) {
-	conn, err := dbus.ConnectSystemBus()
-	if err != nil {
-		return nil, err
+// sharedSystemBus returns the shared system bus connection, connecting again if it was lost.
+// The connection must not be closed by its users.
+func sharedSystemBus() (proDBusConn, error) {
+	systemBus.mu.Lock()
+	defer systemBus.mu.Unlock()
+
+	if systemBus.conn == nil || !systemBus.conn.Connected() {
+		conn, err := dbus.ConnectSystemBus()
+		if err != nil {
+			return nil, err
+		}
+		systemBus.conn = conn
 	}
-	return systemBusConn{conn: conn}, nil
+	return systemBusConn{conn: systemBus.conn}, nil
+}
+
+// proStatusCache caches the last known attach state of Ubuntu Pro for the lifetime of the process, by `pro` CLI
+// command. It is also persisted in the cache directory of the collector, if any.
+var proStatusCache = struct {
+	mu      sync.Mutex
+	entries map[string]proStatusEntry
+	// running is the set of commands the `pro` CLI is being run for.
+	running map[string]bool
+}{entries: make(map[string]proStatusEntry), running: make(map[string]bool)}
+
+type proStatusEntry struct {
+	attached bool
+	at       time.Time
+}
+
+// proStatusFile is the attach state of Ubuntu Pro persisted in the cache directory, for one-shot collections not to
+// run the `pro` CLI each time.
+type proStatusFile struct {
+	Command   []string `json:"command"`
+	Attached  bool     `json:"attached"`
+	CheckedAt int64    `json:"checkedAt"`
+}
+
+// proResult is the attach state of Ubuntu Pro reported by a probe.
+type proResult struct {
+	attached bool
+	err      error
 }
 
 // Info contains platform information for Linux.
@@ -94,7 +148,10 @@ type platformOptions struct {
 	wslVersionCmd     []string
 	proStatusCmd      []string
 
-	proDBusConnector func() (proDBusConn, error)
+	proDBusConnector     func() (proDBusConn, error)
+	proDBusTimeout       time.Duration
+	proStatusRefreshWait time.Duration
+	cpuHypervisor        func() (string, bool)
 
 	getenv func(key string) string
 }
@@ -108,7 +165,10 @@ func defaultPlatformOptions() platformOptions {
 		wslVersionCmd:     []string{"wsl.exe", "-v"},
 		proStatusCmd:      []string{"pro", "api", "u.pro.status.is_attached.v1"},
 
-		proDBusConnector: connectSystemBus,
+		proDBusConnector:     sharedSystemBus,
+		proDBusTimeout:       proDBusTimeout,
+		proStatusRefreshWait: proStatusRefreshWait,
+		cpuHypervisor:        cpuHypervisor,
 
 		getenv: os.Getenv,
 	}
@@ -118,35 +178,65 @@ func (p Collector) collectPlatform() (info Info, err error) {
 	defer func() {
 		decorate.OnError(&err, "failed to collect platform information")
 	}()
-	info.WSL = p.collectWSL()
-	if info.WSL.SubsystemVersion == 0 {
+
+	f := newFacts(p)
+	switch {
+	case p.sections.Has(sections.PlatformWSL):
+		info.WSL = p.collectWSL(f)
+	case p.sections.Has(sections.PlatformDependent):
+		// Only detect WSL, which other sections adapt to.
+		info.WSL.SubsystemVersion = p.getWSLSubsystemVersion(f)
+	}
+	// Screens are queried through the display server of the session type.
+	if info.WSL.SubsystemVersion == 0 && p.sections.Has(sections.PlatformDesktop|sections.HardwareScreens) {
 		info.Desktop = p.getDesktop()
 	}
-	info.ProAttached = p.isProAttached()
+	if p.sections.Has(sections.PlatformProAttached) {
+		info.ProAttached = p.isProAttached()
+	}
 
 	return info, nil
 }
 
+// Filter returns a copy of the information with only the selected sections.
+func (i Info) Filter(m sections.Mask) Info {
+	var f Info
+	if m.Has(sections.PlatformWSL) {
+		f.WSL = i.WSL
+	}
+	if m.Has(sections.PlatformDesktop) {
+		f.Desktop = i.Desktop
+	}
+	if m.Has(sections.PlatformProAttached) {
+		f.ProAttached = i.ProAttached
+	}
+	return f
+}
+
 // isWSL returns true if the system is running under Windows Subsystem for Linux.
-// This is done by checking the output of systemd-detect-virt.
-func (p Collector) isWSL() bool {
+func (p Collector) isWSL(f *facts) bool {
+	if strings.Contains(f.virtualization(), "wsl") {
+		p.log.Debug("WSL detected")
+		return true
+	}
+	return false
+}
+
+// detectVirtualization returns the virtualization technology the system runs under, as reported by
+// systemd-detect-virt, or "" if it could not be detected.
+// It is only used when detectVirtualizationNative is inconclusive.
+func (p Collector) detectVirtualization() string {
 	stdout, stderr, err := cmdutils.RunWithTimeout(context.Background(), 15*time.Second, p.platform.detectVirtCmd[0], p.platform.detectVirtCmd[1:]...)
 	if err != nil {
 		if !strings.Contains(stdout.String(), "none") {
 			p.log.Warn("failed to run systemd-detect-virt", "error", err)
 		}
-		return false
+		return ""
 	}
 	if stderr.Len() > 0 {
 		p.log.Info("systemd-detect-virt output to stderr", "stderr", stderr)
 	}
-
-	if strings.Contains(stdout.String(), "wsl") {
-		p.log.Debug("WSL detected")
-		return true
-	}
-
-	return false
+	return strings.TrimSpace(stdout.String())
 }
 
 // interopEnabled returns true if WSL interop is enabled.
@@ -154,8 +244,8 @@ func (p Collector) isWSL() bool {
 // If /wtc/wsl.conf does not exist, it assumes the default behavior, interop is enabled.
 //
 // This function does not check if interop is disabled using an alternative methods.
-func (p Collector) interopEnabled() bool {
-	if p.getWSLSubsystemVersion() == 0 {
+func (p Collector) interopEnabled(f *facts) bool {
+	if p.getWSLSubsystemVersion(f) == 0 {
 		return false
 	}
 
@@ -181,22 +271,22 @@ func (p Collector) interopEnabled() bool {
 }
 
 // collectWSL collects information about Windows Subsystem for Linux.
-func (p Collector) collectWSL() WSL {
-	info := WSL{SubsystemVersion: p.getWSLSubsystemVersion()}
+func (p Collector) collectWSL(f *facts) WSL {
+	info := WSL{SubsystemVersion: p.getWSLSubsystemVersion(f)}
 	if info.SubsystemVersion == 0 {
 		return info
 	}
 
 	// Get the kernel version
-	info.KernelVersion = p.getKernelVersion()
+	info.KernelVersion = p.getKernelVersion(f)
 
 	// Check if systemd was used during boot
 	info.Systemd = "not used"
-	if p.wasSystemdUsed() {
+	if f.systemdBooted() {
 		info.Systemd = "used"
 	}
 
-	if !p.interopEnabled() {
+	if !p.interopEnabled(f) {
 		info.Interop = "disabled"
 		return info
 	}
@@ -246,12 +336,12 @@ func (p Collector) collectWSL() WSL {
 // If not in WSL, it returns 0.
 //
 // This could potentially be fooled by a custom kernel with '-Microsoft \(Microsoft@Microsoft\.com\)' in the name.
-func (p Collector) getWSLSubsystemVersion() uint8 {
-	if !p.isWSL() {
+func (p Collector) getWSLSubsystemVersion(f *facts) uint8 {
+	if !p.isWSL(f) {
 		return 0
 	}
 
-	kVersion := fileutils.ReadFileLogError(filepath.Join(p.platform.root, "proc/version"), p.log)
+	kVersion := f.procVersion()
 	if !strings.Contains(kVersion, `-Microsoft (Microsoft@Microsoft.com)`) {
 		return 2
 	}
@@ -260,8 +350,8 @@ func (p Collector) getWSLSubsystemVersion() uint8 {
 }
 
 // getKernelVersion returns the kernel version of the system.
-func (p Collector) getKernelVersion() string {
-	k := fileutils.ReadFileLogError(filepath.Join(p.platform.root, "proc/version"), p.log)
+func (p Collector) getKernelVersion(f *facts) string {
+	k := f.procVersion()
 	// The kernel version is the third word in the file.
 	s := strings.Fields(k)
 	if len(s) < 3 {
@@ -282,6 +372,7 @@ func getWSLRegex(entry string) *regexp.Regexp {
 }
 
 // wasSystemdUsed checks if systemd was used during boot.
+// It is only used when detectSystemdBootedNative is inconclusive.
 // It executes the systemd-analyze command with a timeout of 15 seconds to determine if systemd was used.
 //
 // If the command outputs "System has not been booted with systemd as init system" to stderr, it returns false.
@@ -323,39 +414,91 @@ func (p Collector) getDesktop() Desktop {
 
 // isProAttached returns the attach state of Ubuntu Pro.
 //
-// It first attempts to query the state over D-Bus, which works inside confined
-// snaps via the ubuntu-pro-control interface. If that fails (for example, the
-// daemon is not installed or the system bus is unavailable), it falls back to
-// the `pro` CLI.
+// It queries the state over D-Bus, which works inside confined snaps via the ubuntu-pro-control interface. When D-Bus
+// fails or does not answer in time (for example, the daemon is not installed or the system bus is unavailable), a
+// state cached less than an hour ago is used, and the `pro` CLI, which takes seconds, is only run otherwise.
+// A stale cached state is only used if the CLI does not answer within a bounded wait, and for at most a week.
 func (p Collector) isProAttached() bool {
-	attached, err := p.isProAttachedDBus()
+	key := strings.Join(p.platform.proStatusCmd, "\x00")
+
+	attached, err := p.isProAttachedDBusWithTimeout()
 	if err == nil {
+		p.storeProStatus(key, attached)
 		return attached
 	}
-	p.log.Debug("failed to get pro status over D-Bus, falling back to CLI", "error", err)
+	p.log.Debug("failed to get pro status over D-Bus", "error", err)
 
-	attached, err = p.isProAttachedCLI()
-	if err != nil {
-		p.log.Warn("failed to get pro status", "error", err)
+	cached, found := p.cachedProStatus(key)
+	age := time.Since(cached.at)
+	if found && age <= proStatusCacheTTL {
+		return cached.attached
+	}
+
+	if found && age <= proStatusCacheMaxAge {
+		// A stale state is refreshed by a single run of the CLI.
+		cliResult := p.runProStatusCLI(key, true)
+		if cliResult == nil {
+			return cached.attached
+		}
+		select {
+		case r := <-cliResult:
+			if r.err == nil {
+				return r.attached
+			}
+			p.log.Debug("failed to refresh cached pro status", "error", r.err)
+		case <-time.After(p.platform.proStatusRefreshWait):
+			p.log.Debug("timed out refreshing cached pro status", "timeout", p.platform.proStatusRefreshWait)
+		}
+		return cached.attached
+	}
+
+	r := <-p.runProStatusCLI(key, false)
+	if r.err != nil {
+		p.log.Warn("failed to get pro status", "error", r.err)
 		return false
 	}
-	return attached
+	return r.attached
+}
+
+// isProAttachedDBusWithTimeout returns the attach state of Ubuntu Pro over D-Bus, or an error if it does not answer
+// within the D-Bus timeout.
+func (p Collector) isProAttachedDBusWithTimeout() (bool, error) {
+	ctx, cancel := context.WithTimeout(context.Background(), p.platform.proDBusTimeout)
+	defer cancel()
+	dbusResult := make(chan proResult, 1)
+	go func() {
+		attached, err := p.isProAttachedDBus(ctx)
+		dbusResult <- proResult{attached, err}
+	}()
+
+	// Connecting is not bound by the context, so race the whole D-Bus query against it.
+	select {
+	case r := <-dbusResult:
+		return r.attached, r.err
+	case <-ctx.Done():
+		return false, fmt.Errorf("timed out after %s", p.platform.proDBusTimeout)
+	}
 }
 
 // isProAttachedDBus returns the attach state of Ubuntu Pro by reading the
-// Attached property from the ubuntu-advantage-desktop-daemon over the system bus.
-func (p Collector) isProAttachedDBus() (bool, error) {
+// properties of the ubuntu-advantage-desktop-daemon over the system bus.
+// They are all fetched in a single GetAll call.
+func (p Collector) isProAttachedDBus(ctx context.Context) (bool, error) {
 	conn, err := p.platform.proDBusConnector()
 	if err != nil {
 		return false, fmt.Errorf("failed to connect to system bus: %v", err)
 	}
-	defer conn.Close()
 
-	v, err := conn.Object(proDBusDest, proDBusPath).GetProperty(proDBusProp)
+	var props map[string]dbus.Variant
+	err = conn.Object(proDBusDest, proDBusPath).CallWithContext(ctx, "org.freedesktop.DBus.Properties.GetAll", 0, proDBusIface).Store(&props)
 	if err != nil {
-		return false, fmt.Errorf("failed to get %q property: %v", proDBusProp, err)
+		return false, fmt.Errorf("failed to get %q properties: %v", proDBusIface, err)
 	}
 
+	v, ok := props[proDBusProp]
+	if !ok {
+		return false, fmt.Errorf("missing %q property", proDBusProp)
+	}
 	attached, ok := v.Value().(bool)
 	if !ok {
 		return false, fmt.Errorf("unexpected type %T for %q property", v.Value(), proDBusProp)
@@ -363,6 +506,87 @@ func (p Collector) isProAttachedDBus() (bool, error) {
 	return attached, nil
 }
 
+// cachedProStatus returns the last known attach state of Ubuntu Pro for the `pro` CLI command key, from memory or
+// else from the cache directory.
+func (p Collector) cachedProStatus(key string) (proStatusEntry, bool) {
+	proStatusCache.mu.Lock()
+	defer proStatusCache.mu.Unlock()
+
+	if e, ok := proStatusCache.entries[key]; ok {
+		return e, true
+	}
+	if p.cacheDir == "" {
+		return proStatusEntry{}, false
+	}
+
+	data, err := os.ReadFile(filepath.Join(p.cacheDir, constants.ProStatusFileName))
+	if err != nil {
+		if !errors.Is(err, os.ErrNotExist) {
+			p.log.Debug("failed to read cached pro status", "error", err)
+		}
+		return proStatusEntry{}, false
+	}
+	var f proStatusFile
+	if err := json.Unmarshal(data, &f); err != nil {
+		p.log.Debug("failed to parse cached pro status", "error", err)
+		return proStatusEntry{}, false
+	}
+	if strings.Join(f.Command, "\x00") != key {
+		return proStatusEntry{}, false
+	}
+
+	e := proStatusEntry{attached: f.Attached, at: time.Unix(f.CheckedAt, 0)}
+	proStatusCache.entries[key] = e
+	return e, true
+}
+
+// storeProStatus caches the attach state of Ubuntu Pro for the `pro` CLI command key, in memory and in the cache
+// directory if any.
+func (p Collector) storeProStatus(key string, attached bool) {
+	now := time.Now()
+	proStatusCache.mu.Lock()
+	proStatusCache.entries[key] = proStatusEntry{attached: attached, at: now}
+	proStatusCache.mu.Unlock()
+
+	if p.cacheDir == "" {
+		return
+	}
+	data, err := json.Marshal(proStatusFile{Command: p.platform.proStatusCmd, Attached: attached, CheckedAt: now.Unix()})
+	if err != nil {
+		p.log.Debug("failed to encode pro status", "error", err)
+		return
+	}
+	if err := fileutils.AtomicWrite(filepath.Join(p.cacheDir, constants.ProStatusFileName), data); err != nil {
+		p.log.Debug("failed to cache pro status", "error", err)
+	}
+}
+
+// runProStatusCLI runs the `pro` CLI in the background, caching the attach state it reports under key, and returns
+// the channel its result is sent on. If onlyOnce is set and the CLI is already running for key, it returns nil.
+func (p Collector) runProStatusCLI(key string, onlyOnce bool) <-chan proResult {
+	proStatusCache.mu.Lock()
+	if onlyOnce && proStatusCache.running[key] {
+		proStatusCache.mu.Unlock()
+		return nil
+	}
+	proStatusCache.running[key] = true
+	proStatusCache.mu.Unlock()
+
+	result := make(chan proResult, 1)
+	go func() {
+		attached, err := p.isProAttachedCLI()
+
+		proStatusCache.mu.Lock()
+		delete(proStatusCache.running, key)
+		proStatusCache.mu.Unlock()
+		if err == nil {
+			p.storeProStatus(key, attached)
+		}
+		result <- proResult{attached, err}
+	}()
+	return result
+}
+
 // isProAttachedCLI returns the attach state of Ubuntu Pro using the `pro` CLI.
 func (p Collector) isProAttachedCLI() (bool, error) {
 	stdout, stderr, err := cmdutils.RunWithTimeout(context.Background(), 15*time.Second, p.platform.proStatusCmd[0], p.platform.proStatusCmd[1:]...)
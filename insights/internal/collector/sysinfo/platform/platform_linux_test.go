@@ -1,16 +1,19 @@
 package platform_test
 
 import (
+	"encoding/json"
 	"fmt"
 	"log/slog"
 	"os"
 	"path/filepath"
 	"testing"
+	"time"
 	"unicode/utf16"
 
 	"github.com/stretchr/testify/require"
 	"github.com/ubuntu/ubuntu-insights/common/testutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 )
 
 func TestNewLinux(t *testing.T) {
@@ -25,11 +28,19 @@ func TestCollectLinux(t *testing.T) {
 
 	tests := map[string]struct {
 		roots             []string
+		dirs              []string
+		hypervisor        string
 		detectVirtCmd     string
 		systemdAnalyzeCmd string
 		wslVersionCmd     string
 		proStatusCmd      string
 		proDBus           platform.ProDBusSpec
+		proDBusTimeout    time.Duration
+		proCache          string        // Attach state cached in the cache directory, if any.
+		proCacheAge       time.Duration // Age of the cached attach state.
+		proRefreshWait    time.Duration // Wait on the CLI refreshing a stale cached attach state.
+		wantProCache      string        // Attach state expected to be cached at the end, if any.
+		wantProCacheNow   bool          // Whether it is cached once Collect returns, as if the process exited then.
 		env               map[string]string
 
 		missingFiles []string
@@ -161,6 +172,21 @@ func TestCollectLinux(t *testing.T) {
 			proStatusCmd:      "detached",
 			proDBus:           platform.ProDBusGarbage,
 		},
+		"Pro D-Bus missing property falls back to CLI detached": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "detached",
+			proDBus:           platform.ProDBusMissing,
+		},
+		"Pro D-Bus not answering in time falls back to CLI detached": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "detached",
+			proDBus:           platform.ProDBusHang,
+			proDBusTimeout:    10 * time.Millisecond,
+		},
 		"Pro D-Bus and CLI both fail warns": {
 			detectVirtCmd:     "none",
 			systemdAnalyzeCmd: "regular",
@@ -172,6 +198,68 @@ func TestCollectLinux(t *testing.T) {
 				slog.LevelWarn: 1,
 			},
 		},
+		"Pro state from D-Bus is cached": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "error",
+			proDBus:           platform.ProDBusAttached,
+			wantProCache:      "attached",
+		},
+		"Pro state from CLI is cached": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "detached",
+			wantProCache:      "detached",
+		},
+		"Pro cached state is used when D-Bus fails without running CLI": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "error",
+			proCache:          "attached",
+			wantProCache:      "attached",
+		},
+		"Pro stale cached state is refreshed by CLI when D-Bus fails": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "detached",
+			proCache:          "attached",
+			proCacheAge:       2 * time.Hour,
+			wantProCache:      "detached",
+		},
+		"Pro stale cached state is used when the CLI does not refresh it in time": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "slow detached",
+			proCache:          "attached",
+			proCacheAge:       2 * time.Hour,
+			proRefreshWait:    10 * time.Millisecond,
+			wantProCache:      "detached",
+		},
+		"Pro cached state past its max age is refreshed before exiting": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "slow detached",
+			proCache:          "attached",
+			proCacheAge:       30 * 24 * time.Hour,
+			proRefreshWait:    10 * time.Millisecond,
+			wantProCache:      "detached",
+			wantProCacheNow:   true,
+		},
+		"Pro state from D-Bus replaces cached state": {
+			detectVirtCmd:     "none",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "error",
+			proDBus:           platform.ProDBusDetached,
+			proCache:          "attached",
+			wantProCache:      "detached",
+		},
 
 		// Other virt types
 		"Other virt type (uml) with Pro Attached": {
@@ -359,7 +447,7 @@ func TestCollectLinux(t *testing.T) {
 			proStatusCmd:      "attached",
 
 			logs: map[slog.Level]uint{
-				slog.LevelWarn: 4,
+				slog.LevelWarn: 2,
 			},
 		},
 		"WSL2 ignores desktop env vars": {
@@ -427,6 +515,60 @@ func TestCollectLinux(t *testing.T) {
 			wslVersionCmd:     "regular-en",
 			proStatusCmd:      "attached",
 		},
+
+		// Native detection, without the system tools.
+		"Non-WSL bare metal does not run systemd-detect-virt": {
+			hypervisor:        "none",
+			detectVirtCmd:     "error",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "attached",
+		},
+		"Non-WSL virtual machine does not run systemd-detect-virt": {
+			hypervisor:        "kvm",
+			detectVirtCmd:     "error",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "attached",
+		},
+		"Non-WSL container does not run systemd-detect-virt": {
+			roots:             []string{"container"},
+			detectVirtCmd:     "error",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "error",
+			proStatusCmd:      "attached",
+		},
+		"WSL2 detected from kernel version does not run systemd-detect-virt": {
+			roots:             []string{"enabled", "version-wsl2"},
+			detectVirtCmd:     "error",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "regular-en",
+			proStatusCmd:      "attached",
+		},
+		"WSL2 detected from interop binary format is preferred over hypervisor": {
+			roots:             []string{"enabled", "version-custom", "binfmt-wsl"},
+			hypervisor:        "microsoft",
+			detectVirtCmd:     "error",
+			systemdAnalyzeCmd: "regular",
+			wslVersionCmd:     "regular-en",
+			proStatusCmd:      "attached",
+		},
+		"WSL2 booted with systemd does not run systemd-analyze": {
+			roots:             []string{"enabled", "version-wsl2"},
+			dirs:              []string{"run/systemd/system"},
+			detectVirtCmd:     "wsl",
+			systemdAnalyzeCmd: "error",
+			wslVersionCmd:     "regular-en",
+			proStatusCmd:      "attached",
+		},
+		"WSL2 booted without systemd does not run systemd-analyze": {
+			roots:             []string{"enabled", "version-wsl2"},
+			dirs:              []string{"run"},
+			detectVirtCmd:     "wsl",
+			systemdAnalyzeCmd: "error",
+			wslVersionCmd:     "regular-en",
+			proStatusCmd:      "attached",
+		},
 	}
 
 	for name, tc := range tests {
@@ -439,6 +581,11 @@ func TestCollectLinux(t *testing.T) {
 				require.NoError(t, err, "setup: failed to copy test data directory: ")
 			}
 
+			for _, d := range tc.dirs {
+				err := os.MkdirAll(filepath.Join(tmp, d), 0700)
+				require.NoError(t, err, "setup: failed to create directory %s: ", d)
+			}
+
 			for _, f := range tc.missingFiles {
 				err := os.Remove(filepath.Join(tmp, f))
 				require.NoError(t, err, "setup: failed to remove file %s: ", f)
@@ -448,6 +595,7 @@ func TestCollectLinux(t *testing.T) {
 			options := []platform.Options{
 				platform.WithRoot(tmp),
 				platform.WithGetenv(tc.env),
+				platform.WithHypervisor(tc.hypervisor),
 			}
 
 			if tc.detectVirtCmd != "-" {
@@ -465,14 +613,36 @@ func TestCollectLinux(t *testing.T) {
 				options = append(options, platform.WithWSLVersionCmd(cmdArgs))
 			}
 
+			proCmdArgs := testutils.SetupFakeCmdArgs("TestFakeProStatus", tc.proStatusCmd, name)
 			if tc.proStatusCmd != "-" {
-				cmdArgs := testutils.SetupFakeCmdArgs("TestFakeProStatus", tc.proStatusCmd)
-				options = append(options, platform.WithProStatusCmd(cmdArgs))
+				// The test name keeps the attach state cached in memory by command apart between tests.
+				options = append(options, platform.WithProStatusCmd(proCmdArgs))
+			}
+
+			cacheDir := t.TempDir()
+			if tc.proCache != "" || tc.wantProCache != "" {
+				options = append(options, platform.WithCacheDir(cacheDir))
+			}
+			if tc.proCache != "" {
+				data, err := json.Marshal(map[string]any{
+					"command":   proCmdArgs,
+					"attached":  tc.proCache == "attached",
+					"checkedAt": time.Now().Add(-tc.proCacheAge).Unix(),
+				})
+				require.NoError(t, err, "Setup: failed to encode cached pro status")
+				err = os.WriteFile(filepath.Join(cacheDir, constants.ProStatusFileName), data, 0600)
+				require.NoError(t, err, "Setup: failed to write cached pro status")
 			}
 
 			// Default (zero value) is ProDBusConnectError, so tests that do not set
 			// proDBus fall back to the `pro` CLI path being exercised above.
 			options = append(options, platform.WithProDBusConnector(tc.proDBus))
+			if tc.proDBusTimeout != 0 {
+				options = append(options, platform.WithProDBusTimeout(tc.proDBusTimeout))
+			}
+			if tc.proRefreshWait != 0 {
+				options = append(options, platform.WithProStatusRefreshWait(tc.proRefreshWait))
+			}
 
 			p := platform.New(slog.New(&l), options...)
 
@@ -490,6 +660,24 @@ func TestCollectLinux(t *testing.T) {
 
 			want := testutils.LoadWithUpdateFromGoldenYAML(t, got)
 			require.Equal(t, want, got, "Collect should return expected platform information")
+
+			if tc.wantProCache == "" {
+				return
+			}
+			cachedAsWanted := func() bool {
+				data, err := os.ReadFile(filepath.Join(cacheDir, constants.ProStatusFileName))
+				if err != nil {
+					return false
+				}
+				var cached struct{ Attached bool }
+				return json.Unmarshal(data, &cached) == nil && cached.Attached == (tc.wantProCache == "attached")
+			}
+			if tc.wantProCacheNow {
+				require.True(t, cachedAsWanted(), "Pro attach state should be cached before Collect returns")
+				return
+			}
+			// A stale state may be refreshed in the background.
+			require.Eventually(t, cachedAsWanted, 5*time.Second, 10*time.Millisecond, "Pro attach state should be cached")
 		})
 	}
 }
@@ -685,6 +873,9 @@ func TestFakeProStatus(_ *testing.T) {
 	case "attached":
 		fmt.Println(`
 {"_schema_version": "v1", "data": {"attributes": {"contract_remaining_days": 2912745, "contract_status": "active", "is_attached": true, "is_attached_and_contract_valid": true}, "meta": {"environment_vars": []}, "type": "IsAttached"}, "errors": [], "result": "success", "version": "34~24.04", "warnings": []}`)
+	case "slow detached":
+		time.Sleep(500 * time.Millisecond)
+		fallthrough
 	case "detached":
 		fmt.Println(`
 {"_schema_version": "v1", "data": {"attributes": {"contract_remaining_days": 0, "contract_status": null, "is_attached": false, "is_attached_and_contract_valid": false}, "meta": {"environment_vars": []}, "type": "IsAttached"}, "errors": [], "result": "success", "version": "34~24.04", "warnings": []}`)
@@ -0,0 +1,80 @@
+package platform
+
+import (
+	"errors"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"strings"
+)
+
+// hypervisors maps the vendor signatures of the CPUID hypervisor leaf to the names systemd-detect-virt uses.
+var hypervisors = map[string]string{
+	"KVMKVMKVM\x00\x00\x00": "kvm",
+	"Linux KVM Hv":          "kvm",
+	"TCGTCGTCGTCG":          "qemu",
+	"XenVMMXenVMM":          "xen",
+	"VMwareVMware":          "vmware",
+	"Microsoft Hv":          "microsoft",
+	"VBoxVBoxVBox":          "oracle",
+	"bhyve bhyve ":          "bhyve",
+	"QNXQVMBSQG\x00\x00":    "qnx",
+	"ACRNACRNACRN":          "acrn",
+	"SRESRESRESRE":          "sre",
+	"prl hyperv  ":          "parallels",
+	" lrpepyh  vr":          "parallels",
+}
+
+// hypervisorName returns the systemd-detect-virt name of the hypervisor with the CPUID vendor signature sig,
+// and whether it is known.
+func hypervisorName(sig string) (string, bool) {
+	name, ok := hypervisors[sig]
+	return name, ok
+}
+
+// detectVirtualizationNative detects the virtualization technology the system runs under without spawning any
+// process, the same way systemd-detect-virt does: containers first, then WSL, then the CPUID hypervisor leaf.
+// procVersion returns the content of /proc/version.
+//
+// It returns false when the detection is inconclusive, like when the CPU can't tell whether a hypervisor is present.
+func (p Collector) detectVirtualizationNative(procVersion func() (string, error)) (string, bool) {
+	// systemd records the container manager it was started by.
+	if c, err := os.ReadFile(filepath.Join(p.platform.root, "run/systemd/container")); err == nil {
+		if v := strings.TrimSpace(string(c)); v != "" {
+			p.log.Debug("container detected", "container", v)
+			return v, true
+		}
+	}
+
+	// WSL registers its interop binary format, and builds its kernel with a Microsoft release string.
+	for _, name := range []string{"WSLInterop", "WSLInterop-late"} {
+		if _, err := os.Stat(filepath.Join(p.platform.root, "proc/sys/fs/binfmt_misc", name)); err == nil {
+			return "wsl", true
+		}
+	}
+	if v, err := procVersion(); err == nil && strings.Contains(strings.ToLower(v), "microsoft") {
+		return "wsl", true
+	}
+
+	return p.platform.cpuHypervisor()
+}
+
+// detectSystemdBootedNative reports whether systemd was used during boot without spawning any process,
+// the same way sd_booted does, by checking for the runtime directory systemd creates early at boot.
+//
+// It returns false as its second value when /run itself can't be inspected, so the detection is inconclusive.
+func (p Collector) detectSystemdBootedNative() (booted bool, ok bool) {
+	fi, err := os.Stat(filepath.Join(p.platform.root, "run/systemd/system"))
+	if err == nil {
+		return fi.IsDir(), true
+	}
+	if !errors.Is(err, fs.ErrNotExist) {
+		return false, false
+	}
+
+	// Without the systemd directory, only trust its absence if /run is there to hold it.
+	if _, err := os.Stat(filepath.Join(p.platform.root, "run")); err != nil {
+		return false, false
+	}
+	return false, true
+}
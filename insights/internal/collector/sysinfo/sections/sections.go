@@ -0,0 +1,62 @@
+// Package sections defines the mask selecting which parts of the system information are collected.
+package sections
+
+// Mask is a set of system information sections.
+//
+// Values are part of the C API, and must be kept in sync with the insights_section enum of types.h.
+type Mask uint32
+
+// Hardware sections.
+const (
+	HardwareProduct Mask = 1 << iota
+	HardwareCPU
+	HardwareGPUs
+	HardwareAccelerators
+	HardwareMemory
+	HardwareDisks
+	HardwareScreens
+)
+
+// Software sections.
+const (
+	SoftwareOS Mask = 1 << (iota + 8)
+	SoftwareTimezone
+	SoftwareLanguage
+	SoftwareBios
+)
+
+// Platform sections.
+const (
+	PlatformWSL Mask = 1 << (iota + 16)
+	PlatformDesktop
+	PlatformProAttached
+)
+
+// Section groups.
+const (
+	// Hardware selects all hardware sections.
+	Hardware = HardwareProduct | HardwareCPU | HardwareGPUs | HardwareAccelerators | HardwareMemory | HardwareDisks | HardwareScreens
+	// Software selects all software sections.
+	Software = SoftwareOS | SoftwareTimezone | SoftwareLanguage | SoftwareBios
+	// Platform selects all platform sections.
+	Platform = PlatformWSL | PlatformDesktop | PlatformProAttached
+	// All selects every section.
+	All = Hardware | Software | Platform
+
+	// PlatformDependent are the sections whose collection adapts to the platform they run on (e.g. WSL).
+	// The platform is detected when any of them is selected, even if the platform sections are not.
+	PlatformDependent = HardwareProduct | HardwareGPUs | HardwareScreens | SoftwareBios | PlatformDesktop
+)
+
+// OrAll returns m, or All if m is empty. Unset masks are meant to collect everything.
+func (m Mask) OrAll() Mask {
+	if m == 0 {
+		return All
+	}
+	return m
+}
+
+// Has reports whether any of the sections in s is selected by m.
+func (m Mask) Has(s Mask) bool {
+	return m&s != 0
+}
@@ -7,8 +7,11 @@ import (
 	"time"
 
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 )
 
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate software.go Info
+
 // Info is the software specific part.
 type Info struct {
 	OS       osInfo `json:"os,omitzero"`
@@ -34,6 +37,7 @@ type bios struct {
 type Collector struct {
 	log      *slog.Logger
 	timezone func() string
+	sections sections.Mask
 	platform platformOptions
 }
 
@@ -42,10 +46,18 @@ type Options func(*options)
 
 type options struct {
 	timezone func() string
+	sections sections.Mask
 
 	platform platformOptions
 }
 
+// WithSections restricts the collection to the given software sections. Other probes are not run.
+func WithSections(m sections.Mask) Options {
+	return func(o *options) {
+		o.sections = m
+	}
+}
+
 // New returns a new Collector.
 func New(l *slog.Logger, args ...Options) Collector {
 	opts := &options{
@@ -53,6 +65,7 @@ func New(l *slog.Logger, args ...Options) Collector {
 			zone, _ := time.Now().Zone()
 			return zone
 		},
+		sections: sections.All,
 	}
 	opts.platform = defaultPlatformOptions()
 	for _, opt := range args {
@@ -62,33 +75,61 @@ func New(l *slog.Logger, args ...Options) Collector {
 	return Collector{
 		log:      l,
 		timezone: opts.timezone,
+		sections: opts.sections,
 		platform: opts.platform,
 	}
 }
 
 // Collect aggregates the data from all the other software collect functions.
+// Only the selected sections are collected.
 func (s Collector) Collect(pi platform.Info) (info Info, err error) {
 	s.log.Debug("collecting software info")
 
-	info.Timezone = s.timezone()
+	if s.sections.Has(sections.SoftwareTimezone) {
+		info.Timezone = s.timezone()
+	}
 
-	info.OS, err = s.collectOS()
-	if err != nil {
-		s.log.Warn("failed to collect OS info", "error", err)
-		info.OS = osInfo{
-			Family: runtime.GOOS,
+	if s.sections.Has(sections.SoftwareOS) {
+		info.OS, err = s.collectOS()
+		if err != nil {
+			s.log.Warn("failed to collect OS info", "error", err)
+			info.OS = osInfo{
+				Family: runtime.GOOS,
+			}
 		}
 	}
 
-	info.Lang, err = s.collectLang()
-	if err != nil {
-		s.log.Warn("failed to collect language info", "error", err)
+	if s.sections.Has(sections.SoftwareLanguage) {
+		info.Lang, err = s.collectLang()
+		if err != nil {
+			s.log.Warn("failed to collect language info", "error", err)
+		}
 	}
 
-	info.Bios, err = s.collectBios(pi)
-	if err != nil {
-		s.log.Warn("failed to collect BIOS info", "error", err)
+	if s.sections.Has(sections.SoftwareBios) {
+		info.Bios, err = s.collectBios(pi)
+		if err != nil {
+			s.log.Warn("failed to collect BIOS info", "error", err)
+		}
 	}
 
 	return info, nil
 }
+
+// Filter returns a copy of the information with only the selected sections.
+func (i Info) Filter(m sections.Mask) Info {
+	var f Info
+	if m.Has(sections.SoftwareOS) {
+		f.OS = i.OS
+	}
+	if m.Has(sections.SoftwareTimezone) {
+		f.Timezone = i.Timezone
+	}
+	if m.Has(sections.SoftwareLanguage) {
+		f.Lang = i.Lang
+	}
+	if m.Has(sections.SoftwareBios) {
+		f.Bios = i.Bios
+	}
+	return f
+}
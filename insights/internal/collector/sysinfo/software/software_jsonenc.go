@@ -0,0 +1,91 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package software
+
+import (
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Info) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	comma := false
+	dst = append(dst, '{')
+	if v.OS != (osInfo{}) {
+		dst = append(dst, `"os":`...)
+		if dst, err = v.OS.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.Timezone != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"timezone":`...)
+		dst = jsonenc.AppendString(dst, v.Timezone)
+		comma = true
+	}
+	if v.Lang != "" {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"language":`...)
+		dst = jsonenc.AppendString(dst, v.Lang)
+		comma = true
+	}
+	if v.Bios != (bios{}) {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"bios":`...)
+		if dst, err = v.Bios.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Info) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v osInfo) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, `"family":`...)
+	dst = jsonenc.AppendString(dst, v.Family)
+	dst = append(dst, `,"distribution":`...)
+	dst = jsonenc.AppendString(dst, v.Distro)
+	dst = append(dst, `,"version":`...)
+	dst = jsonenc.AppendString(dst, v.Version)
+	if v.Edition != "" {
+		dst = append(dst, `,"edition":`...)
+		dst = jsonenc.AppendString(dst, v.Edition)
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v osInfo) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v bios) AppendJSON(dst []byte) ([]byte, error) {
+	dst = append(dst, '{')
+	dst = append(dst, `"vendor":`...)
+	dst = jsonenc.AppendString(dst, v.Vendor)
+	dst = append(dst, `,"version":`...)
+	dst = jsonenc.AppendString(dst, v.Version)
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v bios) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
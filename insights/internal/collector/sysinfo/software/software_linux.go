@@ -3,6 +3,7 @@ package software
 import (
 	"errors"
 	"fmt"
+	"log/slog"
 	"os"
 	"path/filepath"
 	"runtime"
@@ -220,19 +221,15 @@ func (s Collector) collectBios(pi platform.Info) (bios, error) {
 		return bios{}, nil
 	}
 
-	info := bios{
-		Vendor:  fileutils.ReadFileLogError(filepath.Join(s.platform.root, "sys/class/dmi/id/bios_vendor"), s.log),
-		Version: fileutils.ReadFileLogError(filepath.Join(s.platform.root, "sys/class/dmi/id/bios_version"), s.log),
-	}
-
-	if strings.ContainsRune(info.Vendor, '\n') {
-		s.log.Warn("BIOS info vendor contains invalid value")
-		info.Vendor = ""
-	}
-	if strings.ContainsRune(info.Version, '\n') {
-		s.log.Warn("BIOS info version contains invalid value")
-		info.Version = ""
+	dmi, err := fileutils.OpenSysfsDir(filepath.Join(s.platform.root, "sys/class/dmi/id"))
+	if err != nil {
+		s.log.Warn("failed to open DMI directory", "error", err)
+		return bios{}, nil
 	}
+	defer dmi.Close()
 
-	return info, nil
+	return bios{
+		Vendor:  dmi.ReadLog("bios_vendor", s.log, slog.LevelWarn),
+		Version: dmi.ReadLog("bios_version", s.log, slog.LevelWarn),
+	}, nil
 }
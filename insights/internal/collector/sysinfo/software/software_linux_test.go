@@ -221,7 +221,7 @@ func TestCollectLinux(t *testing.T) {
 			language: "ja",
 
 			logs: map[slog.Level]uint{
-				slog.LevelWarn: 2,
+				slog.LevelWarn: 1,
 			},
 		},
 
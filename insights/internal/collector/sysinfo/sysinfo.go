@@ -7,6 +7,7 @@ import (
 
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/hardware"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/software"
 )
 
@@ -27,6 +28,24 @@ type options struct {
 	hw PCollectorT[hardware.Info]
 	sw PCollectorT[software.Info]
 	pl CollectorT[platform.Info]
+
+	sections sections.Mask
+	cacheDir string
+}
+
+// WithSections restricts the collection to the given sections. The probes of other sections are not run.
+// An empty mask collects everything.
+func WithSections(m sections.Mask) Options {
+	return func(o *options) {
+		o.sections = m
+	}
+}
+
+// WithCacheDir makes the collectors keep, in dir, the facts which are slow to probe and rarely change.
+func WithCacheDir(dir string) Options {
+	return func(o *options) {
+		o.cacheDir = dir
+	}
 }
 
 // Collector handles dependencies for collecting software & hardware information.
@@ -36,9 +55,13 @@ type Collector struct {
 	sw PCollectorT[software.Info]
 	pl CollectorT[platform.Info]
 
+	sections sections.Mask
+
 	log *slog.Logger
 }
 
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate sysinfo.go Info
+
 // Info contains Software and Hardware information of the system.
 type Info struct {
 	Hardware hardware.Info `json:"hardware"`
@@ -48,22 +71,30 @@ type Info struct {
 
 // New returns a new Collector.
 func New(l *slog.Logger, args ...Options) Collector {
-	opts := &options{
-		hw: hardware.New(l),
-		sw: software.New(l),
-		pl: platform.New(l),
-	}
-
+	opts := &options{}
 	for _, opt := range args {
 		opt(opts)
 	}
 
+	opts.sections = opts.sections.OrAll()
+	if opts.hw == nil {
+		opts.hw = hardware.New(l, hardware.WithSections(opts.sections))
+	}
+	if opts.sw == nil {
+		opts.sw = software.New(l, software.WithSections(opts.sections))
+	}
+	if opts.pl == nil {
+		opts.pl = platform.New(l, platform.WithSections(opts.sections), platform.WithCacheDir(opts.cacheDir))
+	}
+
 	return Collector{
 		log: l,
 
 		hw: opts.hw,
 		sw: opts.sw,
 		pl: opts.pl,
+
+		sections: opts.sections,
 	}
 }
 
@@ -95,9 +126,19 @@ func (s Collector) Collect() (Info, error) {
 		return Info{}, fmt.Errorf("failed to collect system information")
 	}
 
+	// Platform information may have been collected only for the sections depending on it.
 	return Info{
 		Platform: plInfo,
 		Hardware: hwInfo,
 		Software: swInfo,
-	}, nil
+	}.Filter(s.sections), nil
+}
+
+// Filter returns a copy of the information with only the selected sections.
+func (i Info) Filter(m sections.Mask) Info {
+	return Info{
+		Hardware: i.Hardware.Filter(m),
+		Software: i.Software.Filter(m),
+		Platform: i.Platform.Filter(m),
+	}
 }
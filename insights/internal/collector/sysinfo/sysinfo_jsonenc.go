@@ -0,0 +1,34 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package sysinfo
+
+import (
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v Info) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	dst = append(dst, '{')
+	dst = append(dst, `"hardware":`...)
+	if dst, err = v.Hardware.AppendJSON(dst); err != nil {
+		return dst, err
+	}
+	dst = append(dst, `,"software":`...)
+	if dst, err = v.Software.AppendJSON(dst); err != nil {
+		return dst, err
+	}
+	if v.Platform != (platform.Info{}) {
+		dst = append(dst, `,"platform":`...)
+		if dst, err = v.Platform.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v Info) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
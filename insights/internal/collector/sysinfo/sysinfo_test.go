@@ -12,6 +12,7 @@ import (
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/hardware"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/platform"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/sections"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo/software"
 )
 
@@ -130,3 +131,36 @@ func TestCollect(t *testing.T) {
 		})
 	}
 }
+
+func TestCollectSections(t *testing.T) {
+	t.Parallel()
+
+	sw := software.Info{Timezone: "EST", Lang: "fr_FR"}
+
+	tests := map[string]struct {
+		sections sections.Mask
+
+		want software.Info
+	}{
+		"Zero mask keeps all sections": {want: sw},
+		"All sections are kept":        {sections: sections.All, want: sw},
+		"Selected sections are kept":   {sections: sections.SoftwareLanguage, want: software.Info{Lang: "fr_FR"}},
+		"Other groups are dropped":     {sections: sections.Hardware | sections.Platform, want: software.Info{}},
+	}
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			s := sysinfo.New(slog.Default(),
+				sysinfo.WithHardwareCollector(makeFakePCollector(hardware.Info{}, nil)),
+				sysinfo.WithSoftwareCollector(makeFakePCollector(sw, nil)),
+				sysinfo.WithPlatformCollector(makeFakeCollector(platform.Info{}, nil)),
+				sysinfo.WithSections(tc.sections),
+			)
+
+			got, err := s.Collect()
+			require.NoError(t, err, "Collect should not return an error and did")
+			assert.Equal(t, tc.want, got.Software, "Collect should only return the selected sections")
+		})
+	}
+}
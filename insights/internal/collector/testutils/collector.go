@@ -23,6 +23,8 @@ var defaultOptions struct {
 	maxReports uint32
 	time       timeFunc
 	sysInfo    func(*slog.Logger, ...sysinfo.Options) collector.SysInfo
+
+	sharedSysInfo *collector.SharedSysInfo
 }
 
 // SetMaxReports overrides the max reports count the uploader is using.
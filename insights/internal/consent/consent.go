@@ -15,6 +15,7 @@ import (
 	"github.com/ubuntu/decorate"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/filecache"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/systemconfig"
 )
 
@@ -140,9 +141,16 @@ func (cm Manager) getFiles() (map[string]string, error) {
 	return sourceFiles, nil
 }
 
-func readFile(l *slog.Logger, path string) (CFile, error) {
+// consentFiles caches the consent files read by all managers of the process, as consent is checked
+// repeatedly by collects and uploads.
+var consentFiles = filecache.New(func(path string) (CFile, error) {
 	var consent CFile
 	_, err := toml.DecodeFile(path, &consent)
+	return consent, err
+})
+
+func readFile(l *slog.Logger, path string) (CFile, error) {
+	consent, err := consentFiles.Get(path)
 	l.Debug("Read consent file", "file", path, "consent", consent.ConsentState)
 
 	return consent, err
@@ -157,7 +165,11 @@ func (cf CFile) write(l *slog.Logger, path string) (err error) {
 		return fmt.Errorf("could not encode consent file: %v", err)
 	}
 
-	if err := fileutils.AtomicWriteWithPerm(path, buf.Bytes(), 0750, 0600); err != nil {
+	// The consent of the user must survive a power failure once it was acknowledged.
+	err = fileutils.AtomicWriteWithPerm(path, buf.Bytes(), 0750, 0600, fileutils.WithSync(fileutils.SyncFileAndDir))
+	// Don't wait on the cache to notice the change, even if the write failed halfway.
+	consentFiles.Invalidate(path)
+	if err != nil {
 		return err
 	}
 	l.Debug("Wrote consent file", "file", path, "consent", cf.ConsentState)
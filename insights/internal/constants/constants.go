@@ -40,12 +40,24 @@ const (
 	// SystemConfigFileName is the file name of the system-wide configuration file.
 	SystemConfigFileName = "system-config.toml"
 
+	// ScheduleFileName is the file name, in the reports directory, of the upload pacing asked for by the server.
+	ScheduleFileName = "upload-schedule.json"
+
+	// ProStatusFileName is the file name, in the reports directory, of the last known attach state of Ubuntu Pro.
+	ProStatusFileName = "pro-status.json"
+
 	// ReportExt is the default extension for the report files.
 	ReportExt = ".json"
+	// BinaryReportExt is the extension for the report files stored in the binary format.
+	BinaryReportExt = ".cbor"
 
 	// MaxReports is the maximum number of report files that can exist in a folder.
 	MaxReports = 150
 
+	// DefaultMaxSourceMetricsSize is the default maximum size in bytes of a source metrics file.
+	// It matches the default upload limit of the server, which would reject larger reports anyway.
+	DefaultMaxSourceMetricsSize = 1 << 17
+
 	// DefaultPeriod is the default value for the collector's period.
 	DefaultPeriod = 0
 
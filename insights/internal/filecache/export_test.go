@@ -0,0 +1,8 @@
+package filecache
+
+// NewUnwatched returns a cache like New, which never watches directories but always checks files instead.
+func NewUnwatched[T any](decode func(path string) (T, error)) *Cache[T] {
+	c := New(decode)
+	c.noWatch = true
+	return c
+}
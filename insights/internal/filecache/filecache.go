@@ -0,0 +1,109 @@
+// Package filecache caches values decoded from files until the files change.
+//
+// Cached values are checked against the identity, modification time and size of their file before being returned.
+// Where the directory of a file can be watched for changes, which is on Linux through inotify, values are instead
+// trusted until their file changes, so that repeated lookups do not cost any system call.
+package filecache
+
+import (
+	"os"
+	"path/filepath"
+	"sync"
+)
+
+// Cache caches the values decoded from files by path.
+type Cache[T any] struct {
+	decode func(path string) (T, error)
+
+	mu      sync.Mutex
+	entries map[string]entry[T]
+	// epoch changes on every invalidation, so that lookups racing with one don't trust what they decoded.
+	epoch uint64
+
+	noWatch bool
+}
+
+type entry[T any] struct {
+	value T
+	err   error
+	info  os.FileInfo
+
+	// watched entries are invalidated as soon as their file changes, and don't need to be checked.
+	watched bool
+}
+
+// New returns a cache of the values decode returns for the files it is given.
+// The cache is meant to be long-lived, like a package variable: it is never released.
+func New[T any](decode func(path string) (T, error)) *Cache[T] {
+	c := &Cache[T]{
+		decode:  decode,
+		entries: make(map[string]entry[T]),
+	}
+	subscribe(c.Invalidate)
+	return c
+}
+
+// Get returns the value decoded from the file at path, only decoding it again if the file changed since the last call.
+//
+// Errors are only cached while the directory of the file is watched, so that fixing the file is noticed.
+func (c *Cache[T]) Get(path string) (T, error) {
+	c.mu.Lock()
+	e, ok := c.entries[path]
+	epoch := c.epoch
+	c.mu.Unlock()
+	if ok && e.watched {
+		return e.value, e.err
+	}
+
+	// Watch before reading, so that any change from now on invalidates what is read.
+	watched := !c.noWatch && watch(filepath.Dir(path))
+
+	info, statErr := os.Stat(path)
+	if ok && statErr == nil && e.err == nil && sameFile(info, e.info) {
+		if watched {
+			c.store(path, epoch, entry[T]{value: e.value, info: e.info, watched: true})
+		}
+		return e.value, nil
+	}
+
+	v, err := c.decode(path)
+	switch {
+	case watched:
+		c.store(path, epoch, entry[T]{value: v, err: err, info: info, watched: true})
+	case err == nil && statErr == nil:
+		c.store(path, epoch, entry[T]{value: v, info: info})
+	}
+	return v, err
+}
+
+// Invalidate drops the value cached for the file at path, or all of them if path is empty.
+func (c *Cache[T]) Invalidate(path string) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	c.epoch++
+	if path == "" {
+		clear(c.entries)
+		return
+	}
+	delete(c.entries, path)
+}
+
+// store caches e for path, without trusting it to be watched if anything was invalidated since epoch.
+func (c *Cache[T]) store(path string, epoch uint64, e entry[T]) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	if c.epoch != epoch {
+		if e.err != nil || e.info == nil {
+			return
+		}
+		e.watched = false
+	}
+	c.entries[path] = e
+}
+
+// sameFile returns true if a and b describe the same, unmodified, file.
+func sameFile(a, b os.FileInfo) bool {
+	return os.SameFile(a, b) && a.ModTime().Equal(b.ModTime()) && a.Size() == b.Size()
+}
@@ -0,0 +1,86 @@
+package filecache_test
+
+import (
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/filecache"
+)
+
+func TestGet(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		noFile     bool
+		replace    bool
+		invalidate bool
+		noWatch    bool
+
+		want        string
+		wantDecodes int64
+		wantErr     bool
+	}{
+		"Decodes once while file is unchanged":           {want: "first", wantDecodes: 1},
+		"Decodes again once file is replaced":            {replace: true, want: "second", wantDecodes: 2},
+		"Decodes again once invalidated":                 {invalidate: true, want: "first", wantDecodes: 2},
+		"Unwatched decodes once while file is unchanged": {noWatch: true, want: "first", wantDecodes: 1},
+		"Unwatched decodes again once file is replaced":  {noWatch: true, replace: true, want: "second", wantDecodes: 2},
+
+		"Errors on missing file":                     {noFile: true, wantErr: true},
+		"Unwatched errors on missing file each time": {noFile: true, noWatch: true, wantDecodes: 3, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			path := filepath.Join(t.TempDir(), "file")
+			if !tc.noFile {
+				require.NoError(t, os.WriteFile(path, []byte("first"), 0600), "Setup: failed to write file")
+			}
+
+			var decodes atomic.Int64
+			decode := func(path string) (string, error) {
+				decodes.Add(1)
+				data, err := os.ReadFile(path)
+				return string(data), err
+			}
+			c := filecache.New(decode)
+			if tc.noWatch {
+				c = filecache.NewUnwatched(decode)
+			}
+
+			for range 2 {
+				_, _ = c.Get(path)
+			}
+			if tc.replace {
+				require.NoError(t, fileutils.AtomicWrite(path, []byte("second")), "Setup: failed to replace file")
+			}
+			if tc.invalidate {
+				c.Invalidate(path)
+			}
+
+			// Watched files are invalidated asynchronously.
+			var got string
+			var err error
+			require.Eventually(t, func() bool {
+				got, err = c.Get(path)
+				return tc.wantErr || got == tc.want
+			}, time.Second, time.Millisecond, "Get should return the current value of the file")
+
+			if tc.wantErr {
+				require.Error(t, err, "Get should return an error")
+			} else {
+				require.NoError(t, err, "Get should not return an error")
+			}
+			if tc.wantDecodes != 0 {
+				require.Equal(t, tc.wantDecodes, decodes.Load(), "Get should only decode the file when it changed")
+			}
+		})
+	}
+}
@@ -0,0 +1,130 @@
+package filecache
+
+import (
+	"bytes"
+	"encoding/binary"
+	"os"
+	"path/filepath"
+	"sync"
+
+	"golang.org/x/sys/unix"
+)
+
+// watchMask is every change of a directory entry which can affect what is decoded from it.
+const watchMask = unix.IN_ONLYDIR | unix.IN_CREATE | unix.IN_DELETE | unix.IN_MODIFY | unix.IN_ATTRIB |
+	unix.IN_CLOSE_WRITE | unix.IN_MOVED_FROM | unix.IN_MOVED_TO | unix.IN_DELETE_SELF | unix.IN_MOVE_SELF
+
+// watcher is the inotify instance shared by all caches of the process.
+var watcher struct {
+	once sync.Once
+	f    *os.File
+
+	mu          sync.Mutex
+	dirs        map[string]int
+	wds         map[int]string
+	subscribers []func(path string)
+}
+
+// subscribe makes the watcher call invalidate with the path of every file changing in a watched directory,
+// or an empty path when it can't tell which ones did.
+func subscribe(invalidate func(path string)) {
+	watcher.mu.Lock()
+	defer watcher.mu.Unlock()
+	watcher.subscribers = append(watcher.subscribers, invalidate)
+}
+
+// watch watches the directory dir, and returns false if it can't.
+func watch(dir string) bool {
+	watcher.once.Do(startWatcher)
+
+	watcher.mu.Lock()
+	defer watcher.mu.Unlock()
+
+	if watcher.f == nil {
+		return false
+	}
+	if _, ok := watcher.dirs[dir]; ok {
+		return true
+	}
+
+	wd, err := unix.InotifyAddWatch(int(watcher.f.Fd()), dir, watchMask)
+	if err != nil {
+		return false
+	}
+	watcher.dirs[dir] = wd
+	watcher.wds[wd] = dir
+	return true
+}
+
+// startWatcher creates the inotify instance, and starts dispatching its events.
+// Without it, like when the limit of instances of the user is reached, caches fall back to checking files.
+func startWatcher() {
+	fd, err := unix.InotifyInit1(unix.IN_CLOEXEC | unix.IN_NONBLOCK)
+	if err != nil {
+		return
+	}
+	// Non-blocking, the file is read through the runtime poller rather than tying up a thread.
+	watcher.f = os.NewFile(uintptr(fd), "inotify")
+	watcher.dirs = make(map[string]int)
+	watcher.wds = make(map[int]string)
+	go readEvents(watcher.f)
+}
+
+// readEvents dispatches the events of the inotify instance f until it fails.
+func readEvents(f *os.File) {
+	buf := make([]byte, 64*(unix.SizeofInotifyEvent+unix.NAME_MAX+1))
+	for {
+		n, err := f.Read(buf)
+		if err != nil {
+			// Nothing can be trusted to be watched anymore.
+			watcher.mu.Lock()
+			watcher.f = nil
+			watcher.mu.Unlock()
+			notify("")
+			return
+		}
+
+		for off := 0; off+unix.SizeofInotifyEvent <= n; {
+			wd := int(int32(binary.NativeEndian.Uint32(buf[off:])))
+			mask := binary.NativeEndian.Uint32(buf[off+4:])
+			nameLen := int(binary.NativeEndian.Uint32(buf[off+12:]))
+			name := buf[off+unix.SizeofInotifyEvent : off+unix.SizeofInotifyEvent+nameLen]
+			off += unix.SizeofInotifyEvent + nameLen
+
+			notify(eventPath(wd, mask, string(bytes.TrimRight(name, "\x00"))))
+		}
+	}
+}
+
+// eventPath returns the path of the file an event is about, or an empty path if it affects the whole directory
+// or the queue overflowed.
+func eventPath(wd int, mask uint32, name string) string {
+	watcher.mu.Lock()
+	defer watcher.mu.Unlock()
+
+	dir, ok := watcher.wds[wd]
+	if mask&(unix.IN_IGNORED|unix.IN_DELETE_SELF|unix.IN_MOVE_SELF) != 0 && ok {
+		// The directory is gone, or is not at its path anymore.
+		if mask&unix.IN_IGNORED == 0 {
+			_, _ = unix.InotifyRmWatch(int(watcher.f.Fd()), uint32(wd))
+		}
+		delete(watcher.wds, wd)
+		delete(watcher.dirs, dir)
+		return ""
+	}
+	if !ok || name == "" || mask&unix.IN_Q_OVERFLOW != 0 {
+		return ""
+	}
+	return filepath.Join(dir, name)
+}
+
+// notify invalidates path in all caches.
+func notify(path string) {
+	watcher.mu.Lock()
+	subscribers := watcher.subscribers
+	watcher.mu.Unlock()
+
+	for _, invalidate := range subscribers {
+		invalidate(path)
+	}
+}
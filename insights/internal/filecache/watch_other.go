@@ -0,0 +1,11 @@
+//go:build !linux
+
+package filecache
+
+// subscribe does nothing, as directories are not watched outside Linux.
+func subscribe(func(path string)) {}
+
+// watch returns false, as directories are not watched outside Linux.
+func watch(string) bool {
+	return false
+}
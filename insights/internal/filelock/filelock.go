@@ -0,0 +1,105 @@
+// Package filelock provides advisory reader/writer locks on directories, shared between processes.
+//
+// Each lock opens its own handle, so that locks taken by goroutines of the same process exclude each
+// other the same way they exclude other processes.
+package filelock
+
+import (
+	"fmt"
+	"os"
+	"sync/atomic"
+	"time"
+)
+
+// Lock is a lock held on a directory.
+type Lock struct {
+	f      *os.File
+	waited time.Duration
+}
+
+// Stats are the lock-wait metrics of the process.
+type Stats struct {
+	// Acquired is the number of locks acquired.
+	Acquired uint64
+	// Contended is the number of locks which had to wait for another holder to release them.
+	Contended uint64
+	// Wait is the total time spent waiting for locks.
+	Wait time.Duration
+	// MaxWait is the longest time spent waiting for a single lock.
+	MaxWait time.Duration
+}
+
+var stats struct {
+	acquired  atomic.Uint64
+	contended atomic.Uint64
+	wait      atomic.Int64
+	maxWait   atomic.Int64
+}
+
+// Exclusive locks the directory at path for writing, waiting for any other holder to release it.
+func Exclusive(path string) (*Lock, error) {
+	return acquire(path, true)
+}
+
+// Shared locks the directory at path for reading, waiting for any writer to release it.
+// Several readers can hold the lock at once.
+func Shared(path string) (*Lock, error) {
+	return acquire(path, false)
+}
+
+// Waited returns how long acquiring the lock waited for other holders.
+func (l *Lock) Waited() time.Duration {
+	return l.waited
+}
+
+// Unlock releases the lock.
+func (l *Lock) Unlock() error {
+	err := unlock(l.f)
+	if e := l.f.Close(); err == nil {
+		err = e
+	}
+	return err
+}
+
+// ReadStats returns the lock-wait metrics of the process so far.
+func ReadStats() Stats {
+	return Stats{
+		Acquired:  stats.acquired.Load(),
+		Contended: stats.contended.Load(),
+		Wait:      time.Duration(stats.wait.Load()),
+		MaxWait:   time.Duration(stats.maxWait.Load()),
+	}
+}
+
+func acquire(path string, exclusive bool) (*Lock, error) {
+	f, err := open(path)
+	if err != nil {
+		return nil, fmt.Errorf("could not open %s for locking: %v", path, err)
+	}
+
+	// Only measure the wait when the lock is actually contended.
+	var waited time.Duration
+	ok, err := tryLock(f, exclusive)
+	if err == nil && !ok {
+		start := time.Now()
+		err = lock(f, exclusive)
+		waited = time.Since(start)
+	}
+	if err != nil {
+		_ = f.Close()
+		return nil, fmt.Errorf("could not lock %s: %v", path, err)
+	}
+
+	stats.acquired.Add(1)
+	if !ok {
+		stats.contended.Add(1)
+		stats.wait.Add(int64(waited))
+		for {
+			m := stats.maxWait.Load()
+			if int64(waited) <= m || stats.maxWait.CompareAndSwap(m, int64(waited)) {
+				break
+			}
+		}
+	}
+	return &Lock{f: f, waited: waited}, nil
+}
@@ -0,0 +1,88 @@
+package filelock_test
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/filelock"
+)
+
+func TestLock(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		firstExclusive  bool
+		secondExclusive bool
+
+		wantWait bool
+	}{
+		"Readers do not wait for each other": {},
+		"Writer waits for reader":            {secondExclusive: true, wantWait: true},
+		"Reader waits for writer":            {firstExclusive: true, wantWait: true},
+		"Writer waits for writer":            {firstExclusive: true, secondExclusive: true, wantWait: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			first, err := acquire(dir, tc.firstExclusive)
+			require.NoError(t, err, "First lock should not return an error")
+			require.Zero(t, first.Waited(), "First lock should not wait")
+
+			const hold = 100 * time.Millisecond
+			acquired := make(chan *filelock.Lock, 1)
+			errs := make(chan error, 1)
+			go func() {
+				second, err := acquire(dir, tc.secondExclusive)
+				errs <- err
+				acquired <- second
+			}()
+
+			var second *filelock.Lock
+			select {
+			case err := <-errs:
+				require.NoError(t, err, "Second lock should not return an error")
+				require.False(t, tc.wantWait, "Second lock should wait for the first one to be released")
+				second = <-acquired
+			case <-time.After(hold):
+				require.True(t, tc.wantWait, "Second lock should not wait for the first one")
+				require.NoError(t, first.Unlock(), "Unlock should not return an error")
+				require.NoError(t, <-errs, "Second lock should not return an error")
+				second = <-acquired
+				require.Greater(t, second.Waited(), time.Duration(0), "Second lock should report its wait")
+				require.NotZero(t, filelock.ReadStats().Contended, "Stats should count contended locks")
+				require.GreaterOrEqual(t, filelock.ReadStats().MaxWait, second.Waited(), "Stats should record the longest wait")
+				first = nil
+			}
+
+			if first != nil {
+				require.NoError(t, first.Unlock(), "Unlock should not return an error")
+			}
+			require.NoError(t, second.Unlock(), "Unlock should not return an error")
+		})
+	}
+}
+
+func TestLockMissingDirectory(t *testing.T) {
+	t.Parallel()
+
+	path := filepath.Join(t.TempDir(), "missing")
+	_, err := filelock.Exclusive(path)
+	require.Error(t, err, "Exclusive should return an error")
+	_, err = filelock.Shared(path)
+	require.Error(t, err, "Shared should return an error")
+	_, err = os.Stat(path)
+	require.ErrorIs(t, err, os.ErrNotExist, "Locking should not create the directory")
+}
+
+func acquire(path string, exclusive bool) (*filelock.Lock, error) {
+	if exclusive {
+		return filelock.Exclusive(path)
+	}
+	return filelock.Shared(path)
+}
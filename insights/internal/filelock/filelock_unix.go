@@ -0,0 +1,49 @@
+//go:build !windows
+
+package filelock
+
+import (
+	"errors"
+	"os"
+
+	"golang.org/x/sys/unix"
+)
+
+// open opens the directory at path, which is locked directly.
+func open(path string) (*os.File, error) {
+	return os.Open(path)
+}
+
+// tryLock locks f without waiting, and returns false if it is held by someone else.
+func tryLock(f *os.File, exclusive bool) (bool, error) {
+	err := flock(f, how(exclusive)|unix.LOCK_NB)
+	if errors.Is(err, unix.EWOULDBLOCK) {
+		return false, nil
+	}
+	return err == nil, err
+}
+
+// lock locks f, waiting for it to be released by anyone else.
+func lock(f *os.File, exclusive bool) error {
+	return flock(f, how(exclusive))
+}
+
+func unlock(f *os.File) error {
+	return flock(f, unix.LOCK_UN)
+}
+
+func how(exclusive bool) int {
+	if exclusive {
+		return unix.LOCK_EX
+	}
+	return unix.LOCK_SH
+}
+
+func flock(f *os.File, how int) error {
+	for {
+		err := unix.Flock(int(f.Fd()), how)
+		if !errors.Is(err, unix.EINTR) {
+			return err
+		}
+	}
+}
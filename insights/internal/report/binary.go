@@ -0,0 +1,301 @@
+package report
+
+import (
+	"bytes"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"hash/crc32"
+	"io"
+	"math"
+	"strconv"
+
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// Binary reports are stored as a header followed by the report encoded in CBOR (RFC 8949):
+//
+//	magic (4 bytes) | version (1 byte) | CRC-32C of the payload (4 bytes, big endian) | CBOR payload
+//
+// The checksum makes checking the integrity of a report cheaper than validating its JSON, which is only
+// rendered when the report is read.
+const (
+	binaryMagic   = "UIRB"
+	binaryVersion = 1
+
+	binaryHeaderSize = len(binaryMagic) + 1 + 4
+)
+
+// CBOR initial bytes and major types used by binary reports.
+const (
+	cborUint      = 0 << 5
+	cborNegInt    = 1 << 5
+	cborText      = 3 << 5
+	cborArray     = 4 << 5
+	cborMap       = 5 << 5
+	cborSimple    = 7 << 5
+	cborFalse     = cborSimple | 20
+	cborTrue      = cborSimple | 21
+	cborNull      = cborSimple | 22
+	cborFloat64   = cborSimple | 27
+	cborBreak     = cborSimple | 31
+	cborArrayOpen = cborArray | 31 // Indefinite length array.
+	cborMapOpen   = cborMap | 31   // Indefinite length map.
+)
+
+// crcTable is the Castagnoli table, which is hardware accelerated on most platforms.
+var crcTable = crc32.MakeTable(crc32.Castagnoli)
+
+// ErrCorruptReport is returned when a binary report fails its integrity check.
+var ErrCorruptReport = errors.New("corrupt binary report")
+
+// EncodeBinary encodes the compact JSON report data into the binary report format.
+//
+// It returns false if the report can't be stored in binary so that it renders back to exactly data,
+// like when it holds numbers which are neither 64 bits integers nor floats, or when data is not compact.
+// Such reports are expected to be stored as JSON.
+func EncodeBinary(data []byte) ([]byte, bool) {
+	out := make([]byte, binaryHeaderSize, binaryHeaderSize+len(data))
+	copy(out, binaryMagic)
+	out[len(binaryMagic)] = binaryVersion
+
+	d := json.NewDecoder(bytes.NewReader(data))
+	d.UseNumber()
+	for {
+		tok, err := d.Token()
+		if errors.Is(err, io.EOF) {
+			break
+		}
+		if err != nil {
+			return nil, false
+		}
+
+		switch v := tok.(type) {
+		case json.Delim:
+			switch v {
+			case '{':
+				out = append(out, cborMapOpen)
+			case '[':
+				out = append(out, cborArrayOpen)
+			default:
+				out = append(out, cborBreak)
+			}
+		case string:
+			out = appendCBORHead(out, cborText, uint64(len(v)))
+			out = append(out, v...)
+		case json.Number:
+			var ok bool
+			if out, ok = appendCBORNumber(out, v); !ok {
+				return nil, false
+			}
+		case bool:
+			if v {
+				out = append(out, cborTrue)
+			} else {
+				out = append(out, cborFalse)
+			}
+		case nil:
+			out = append(out, cborNull)
+		}
+	}
+
+	payload := out[binaryHeaderSize:]
+	binary.BigEndian.PutUint32(out[len(binaryMagic)+1:], crc32.Checksum(payload, crcTable))
+
+	// Only keep the binary encoding if it is lossless.
+	if rendered, err := renderCBOR(nil, payload); err != nil || !bytes.Equal(rendered, data) {
+		return nil, false
+	}
+	return out, true
+}
+
+// DecodeBinary checks the integrity of the binary report data, and renders it as compact JSON.
+func DecodeBinary(data []byte) ([]byte, error) {
+	if len(data) < binaryHeaderSize || string(data[:len(binaryMagic)]) != binaryMagic {
+		return nil, fmt.Errorf("%w: missing header", ErrCorruptReport)
+	}
+	if v := data[len(binaryMagic)]; v != binaryVersion {
+		return nil, fmt.Errorf("unsupported binary report version %d", v)
+	}
+	payload := data[binaryHeaderSize:]
+	if binary.BigEndian.Uint32(data[len(binaryMagic)+1:]) != crc32.Checksum(payload, crcTable) {
+		return nil, fmt.Errorf("%w: checksum mismatch", ErrCorruptReport)
+	}
+
+	out, err := renderCBOR(make([]byte, 0, 2*len(payload)), payload)
+	if err != nil {
+		return nil, fmt.Errorf("%w: %v", ErrCorruptReport, err)
+	}
+	return out, nil
+}
+
+// appendCBORHead appends the head of a CBOR data item of major type major, with the argument n.
+func appendCBORHead(dst []byte, major byte, n uint64) []byte {
+	switch {
+	case n < 24:
+		return append(dst, major|byte(n))
+	case n <= math.MaxUint8:
+		return append(dst, major|24, byte(n))
+	case n <= math.MaxUint16:
+		return binary.BigEndian.AppendUint16(append(dst, major|25), uint16(n))
+	case n <= math.MaxUint32:
+		return binary.BigEndian.AppendUint32(append(dst, major|26), uint32(n))
+	default:
+		return binary.BigEndian.AppendUint64(append(dst, major|27), n)
+	}
+}
+
+// appendCBORNumber appends the JSON number n as a CBOR integer when it is one, and as a float otherwise.
+func appendCBORNumber(dst []byte, n json.Number) ([]byte, bool) {
+	if i, err := strconv.ParseInt(string(n), 10, 64); err == nil {
+		if i < 0 {
+			return appendCBORHead(dst, cborNegInt, uint64(-(i + 1))), true
+		}
+		return appendCBORHead(dst, cborUint, uint64(i)), true
+	}
+	if u, err := strconv.ParseUint(string(n), 10, 64); err == nil {
+		return appendCBORHead(dst, cborUint, u), true
+	}
+	f, err := strconv.ParseFloat(string(n), 64)
+	if err != nil {
+		return dst, false
+	}
+	return binary.BigEndian.AppendUint64(append(dst, cborFloat64), math.Float64bits(f)), true
+}
+
+// renderCBOR appends the JSON rendering of the CBOR data items binary reports are made of to dst.
+func renderCBOR(dst, data []byte) ([]byte, error) {
+	r := cborReader{data: data}
+	dst, err := r.render(dst)
+	if err != nil {
+		return nil, err
+	}
+	if r.pos != len(data) {
+		return nil, errors.New("unexpected data after report")
+	}
+	return dst, nil
+}
+
+// cborReader reads the CBOR data items binary reports are made of.
+type cborReader struct {
+	data []byte
+	pos  int
+}
+
+// render appends the JSON rendering of the next data item to dst.
+func (r *cborReader) render(dst []byte) ([]byte, error) {
+	if r.pos >= len(r.data) {
+		return nil, io.ErrUnexpectedEOF
+	}
+	b := r.data[r.pos]
+	r.pos++
+
+	switch b {
+	case cborMapOpen:
+		return r.renderContainer(append(dst, '{'), '}', true)
+	case cborArrayOpen:
+		return r.renderContainer(append(dst, '['), ']', false)
+	case cborFalse:
+		return jsonenc.AppendBool(dst, false), nil
+	case cborTrue:
+		return jsonenc.AppendBool(dst, true), nil
+	case cborNull:
+		return append(dst, "null"...), nil
+	case cborFloat64:
+		bits, err := r.next(8)
+		if err != nil {
+			return nil, err
+		}
+		return jsonenc.AppendFloat(dst, math.Float64frombits(binary.BigEndian.Uint64(bits)), 64)
+	}
+
+	n, err := r.argument(b & 0x1f)
+	if err != nil {
+		return nil, err
+	}
+	switch b & 0xe0 {
+	case cborUint:
+		return jsonenc.AppendUint(dst, n), nil
+	case cborNegInt:
+		if n > math.MaxInt64 {
+			return nil, errors.New("negative integer out of range")
+		}
+		return jsonenc.AppendInt(dst, -1-int64(n)), nil
+	case cborText:
+		if n > uint64(len(r.data)) {
+			return nil, io.ErrUnexpectedEOF
+		}
+		s, err := r.next(int(n))
+		if err != nil {
+			return nil, err
+		}
+		return jsonenc.AppendString(dst, string(s)), nil
+	}
+	return nil, fmt.Errorf("unsupported data item 0x%02x", b)
+}
+
+// renderContainer appends the items of an indefinite length map or array up to its break, and closing to dst.
+// Map keys must be text strings.
+func (r *cborReader) renderContainer(dst []byte, closing byte, isMap bool) ([]byte, error) {
+	var err error
+	for i := 0; ; i++ {
+		if r.pos >= len(r.data) {
+			return nil, io.ErrUnexpectedEOF
+		}
+		if r.data[r.pos] == cborBreak {
+			r.pos++
+			return append(dst, closing), nil
+		}
+
+		if i > 0 {
+			dst = append(dst, ',')
+		}
+		if isMap {
+			if r.data[r.pos]&0xe0 != cborText {
+				return nil, errors.New("map key is not a text string")
+			}
+			if dst, err = r.render(dst); err != nil {
+				return nil, err
+			}
+			dst = append(dst, ':')
+		}
+		if dst, err = r.render(dst); err != nil {
+			return nil, err
+		}
+	}
+}
+
+// argument returns the argument of a data item with the additional information info.
+func (r *cborReader) argument(info byte) (uint64, error) {
+	if info < 24 {
+		return uint64(info), nil
+	}
+	if info > 27 {
+		return 0, fmt.Errorf("unsupported additional information %d", info)
+	}
+	b, err := r.next(1 << (info - 24))
+	if err != nil {
+		return 0, err
+	}
+	switch len(b) {
+	case 1:
+		return uint64(b[0]), nil
+	case 2:
+		return uint64(binary.BigEndian.Uint16(b)), nil
+	case 4:
+		return uint64(binary.BigEndian.Uint32(b)), nil
+	default:
+		return binary.BigEndian.Uint64(b), nil
+	}
+}
+
+// next returns the next n bytes.
+func (r *cborReader) next(n int) ([]byte, error) {
+	if n > len(r.data)-r.pos {
+		return nil, io.ErrUnexpectedEOF
+	}
+	b := r.data[r.pos : r.pos+n]
+	r.pos += n
+	return b, nil
+}
@@ -0,0 +1,108 @@
+package report_test
+
+import (
+	"strings"
+	"testing"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
+)
+
+func TestEncodeBinary(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		data string
+
+		wantJSON bool
+	}{
+		"Empty object":    {data: `{}`},
+		"Opt-out report":  {data: `{"OptOut":true}`},
+		"Nested report":   {data: `{"insightsVersion":"1.0","collectionTime":1735689600,"systemInfo":{"hardware":{"cpu":{"cpus":8,"sockets":1},"gpus":[{"vendor":"0x10de"}],"mem":{"size":16384}},"software":{"os":{"family":"linux"}}},"sourceMetrics":{"ok":false,"ratio":0.25,"missing":null}}`},
+		"Number limits":   {data: `[0,23,24,255,256,65535,65536,4294967295,4294967296,9223372036854775807,18446744073709551615,-1,-24,-25,-9223372036854775808]`},
+		"Floats":          {data: `[1.5,-0.1,1e-7,1e+21,123456.789]`},
+		"Escaped strings": {data: `{"quote\"":"\u003ctab\u003e\t","unicode":"é"}`},
+		"Long strings":    {data: `["` + strings.Repeat("a", 300) + `"]`},
+
+		"JSON when integers overflow":                            {data: `[18446744073709551616]`, wantJSON: true},
+		"JSON when negative integers zero":                       {data: `[-0]`, wantJSON: true},
+		"JSON when numbers are not as encoding/json writes them": {data: `[1.50]`, wantJSON: true},
+		"JSON when not compact":                                  {data: `{"a": 1}`, wantJSON: true},
+		"JSON when strings are escaped differently":              {data: `["\u00e9"]`, wantJSON: true},
+		"JSON when data is invalid":                              {data: `{"a":}`, wantJSON: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			data := []byte(tc.data)
+			b, ok := report.EncodeBinary(data)
+			if tc.wantJSON {
+				require.False(t, ok, "EncodeBinary should not encode reports it can't render back exactly")
+				return
+			}
+			require.True(t, ok, "EncodeBinary should encode the report")
+
+			got, err := report.DecodeBinary(b)
+			require.NoError(t, err, "DecodeBinary should not return an error")
+			assert.Equal(t, string(data), string(got), "DecodeBinary should render the original JSON")
+		})
+	}
+}
+
+func TestDecodeBinary(t *testing.T) {
+	t.Parallel()
+
+	valid, ok := report.EncodeBinary([]byte(`{"a":[1,"b",true]}`))
+	require.True(t, ok, "Setup: failed to encode report")
+
+	tests := map[string]struct {
+		change func(b []byte) []byte
+
+		wantErr bool
+	}{
+		"Valid report": {change: func(b []byte) []byte { return b }},
+
+		"Errors when the payload is corrupted": {change: func(b []byte) []byte {
+			b[len(b)-2] ^= 0x01
+			return b
+		}, wantErr: true},
+		"Errors when the checksum is corrupted": {change: func(b []byte) []byte {
+			b[5] ^= 0x80
+			return b
+		}, wantErr: true},
+		"Errors when truncated": {change: func(b []byte) []byte {
+			return b[:len(b)-1]
+		}, wantErr: true},
+		"Errors when the magic is wrong": {change: func(b []byte) []byte {
+			b[0] = '{'
+			return b
+		}, wantErr: true},
+		"Errors when the version is unknown": {change: func(b []byte) []byte {
+			b[4] = 2
+			return b
+		}, wantErr: true},
+		"Errors on JSON reports": {change: func([]byte) []byte {
+			return []byte(`{"a":[1,"b",true]}`)
+		}, wantErr: true},
+		"Errors on empty reports": {change: func([]byte) []byte {
+			return nil
+		}, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := report.DecodeBinary(tc.change(append([]byte(nil), valid...)))
+			if tc.wantErr {
+				require.Error(t, err, "DecodeBinary should return an error")
+				return
+			}
+			require.NoError(t, err, "DecodeBinary should not return an error")
+			assert.Equal(t, `{"a":[1,"b",true]}`, string(got), "DecodeBinary should render the report")
+		})
+	}
+}
@@ -7,6 +7,8 @@ import (
 	"encoding/json"
 	"errors"
 	"fmt"
+	"io"
+	"io/fs"
 	"log/slog"
 	"math"
 	"os"
@@ -17,6 +19,7 @@ import (
 
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/filelock"
 )
 
 var (
@@ -42,10 +45,20 @@ type reportStash struct {
 	Data []byte
 }
 
+// Format is the format reports are stored in.
+type Format string
+
+const (
+	// FormatJSON stores reports as JSON.
+	FormatJSON Format = "json"
+	// FormatCBOR stores reports in CBOR behind a checksum header, see EncodeBinary.
+	FormatCBOR Format = "cbor"
+)
+
 // New creates a new Report object from a path.
 // It does not write to the file system, or validate the path.
 func New(path string) (Report, error) {
-	if filepath.Ext(path) != constants.ReportExt {
+	if !isReportExt(filepath.Ext(path)) {
 		return Report{}, ErrInvalidReportExt
 	}
 
@@ -57,13 +70,39 @@ func New(path string) (Report, error) {
 	return Report{Path: path, Name: filepath.Base(path), TimeStamp: rTime}, nil
 }
 
+// Write writes the JSON report data to dir under the timestamp t, in format, and returns the path of the report.
+// Reports which can't be stored in binary losslessly are stored as JSON. The report is as durable as sync makes it.
+func Write(dir string, t int64, data []byte, format Format, sync fileutils.SyncPolicy) (string, error) {
+	ext := constants.ReportExt
+	if format == FormatCBOR {
+		if b, ok := EncodeBinary(data); ok {
+			data, ext = b, constants.BinaryReportExt
+		}
+	}
+
+	path := filepath.Join(dir, strconv.FormatInt(t, 10)+ext)
+	if err := fileutils.AtomicWrite(path, data, fileutils.WithSync(sync)); err != nil {
+		return "", err
+	}
+	return path, nil
+}
+
 // ReadJSON reads the JSON data from the report file.
+// Binary reports are checked against their checksum and rendered as JSON, while JSON ones are validated.
 func (r Report) ReadJSON() ([]byte, error) {
 	// Read the report file
 	data, err := os.ReadFile(r.Path)
 	if err != nil {
 		return nil, fmt.Errorf("failed to read report file: %v", err)
 	}
+	return r.toJSON(data)
+}
+
+// toJSON returns the JSON data of the report from the content of its file.
+func (r Report) toJSON(data []byte) ([]byte, error) {
+	if r.isBinary() {
+		return DecodeBinary(data)
+	}
 
 	if !json.Valid(data) {
 		return nil, fmt.Errorf("invalid JSON data in report file")
@@ -72,21 +111,41 @@ func (r Report) ReadJSON() ([]byte, error) {
 	return data, nil
 }
 
+// isBinary returns true if the report is stored in the binary format.
+func (r Report) isBinary() bool {
+	return filepath.Ext(r.Name) == constants.BinaryReportExt
+}
+
 // MarkAsProcessed moves the report to a destination directory, and writes the data to the report.
 // The original report is removed.
 //
 // The new report is returned, and the original data is stashed for use with UndoProcessed.
 // Note that calling MarkAsProcessed multiple times on the same report will overwrite the stashed data.
-func (r Report) MarkAsProcessed(dest string, data []byte) (Report, error) {
-	origData, err := r.ReadJSON()
+//
+// The report is written in the format of the original one, and data is expected to be JSON.
+// The new report is as durable as sync makes it before the original is removed: only SyncFileAndDir ensures that a
+// power failure does not lose both.
+func (r Report) MarkAsProcessed(dest string, data []byte, sync fileutils.SyncPolicy) (Report, error) {
+	origData, err := os.ReadFile(r.Path)
 	if err != nil {
 		return Report{}, fmt.Errorf("failed to read original report: %v", err)
 	}
+	if _, err := r.toJSON(origData); err != nil {
+		return Report{}, fmt.Errorf("failed to read original report: %v", err)
+	}
+
+	if r.isBinary() {
+		b, ok := EncodeBinary(data)
+		if !ok {
+			return Report{}, errors.New("failed to encode report in binary")
+		}
+		data = b
+	}
 
 	newReport := Report{Path: filepath.Join(dest, r.Name), Name: r.Name, TimeStamp: r.TimeStamp,
 		reportStash: reportStash{Path: r.Path, Data: origData}}
 
-	if err := fileutils.AtomicWrite(newReport.Path, data); err != nil {
+	if err := fileutils.AtomicWrite(newReport.Path, data, fileutils.WithSync(sync)); err != nil {
 		return Report{}, fmt.Errorf("failed to write report: %v", err)
 	}
 
@@ -98,13 +157,14 @@ func (r Report) MarkAsProcessed(dest string, data []byte) (Report, error) {
 }
 
 // UndoProcessed moves the report back to the original directory, and writes the original data to the report.
-// The new report is returned, and the original data is removed.
-func (r Report) UndoProcessed() (Report, error) {
+// The new report is returned, and the original data is removed. The restored report is as durable as sync makes it
+// before the processed one is removed.
+func (r Report) UndoProcessed(sync fileutils.SyncPolicy) (Report, error) {
 	if r.reportStash.Path == "" {
 		return Report{}, errors.New("no stashed data to restore")
 	}
 
-	if err := fileutils.AtomicWrite(r.reportStash.Path, r.reportStash.Data); err != nil {
+	if err := fileutils.AtomicWrite(r.reportStash.Path, r.reportStash.Data, fileutils.WithSync(sync)); err != nil {
 		return Report{}, fmt.Errorf("failed to write report: %v", err)
 	}
 
@@ -116,6 +176,178 @@ func (r Report) UndoProcessed() (Report, error) {
 	return newReport, nil
 }
 
+// LockStore locks the report store of a source, the directory holding its collected and uploaded reports,
+// against concurrent mutations from other processes and goroutines.
+// Mutations take an exclusive lock, while reads only take a shared one, and are not locked at all if the
+// store does not exist yet.
+//
+// It returns the function releasing the lock.
+func LockStore(l *slog.Logger, dir string, exclusive bool) (unlock func(), err error) {
+	if !exclusive {
+		if _, err := os.Stat(dir); os.IsNotExist(err) {
+			return func() {}, nil
+		}
+	}
+
+	lock := filelock.Shared
+	if exclusive {
+		lock = filelock.Exclusive
+	}
+	lk, err := lock(dir)
+	if err != nil {
+		return nil, fmt.Errorf("failed to lock report store: %v", err)
+	}
+
+	stats := filelock.ReadStats()
+	l.Debug("Locked report store", "dir", dir, "exclusive", exclusive, "waited", lk.Waited(),
+		"contended", stats.Contended, "total_wait", stats.Wait, "max_wait", stats.MaxWait)
+
+	return func() {
+		if err := lk.Unlock(); err != nil {
+			l.Warn("Failed to unlock report store", "dir", dir, "error", err)
+		}
+	}, nil
+}
+
+// State is where a report is in its lifecycle, combined as a bitmask to select reports in several states.
+type State uint32
+
+const (
+	// StateLocal is the state of reports collected and waiting to be uploaded.
+	StateLocal State = 1 << iota
+	// StateUploaded is the state of reports which were uploaded, or replaced by an opt-out report.
+	StateUploaded
+
+	// StateAll selects reports in any state.
+	StateAll = StateLocal | StateUploaded
+)
+
+// Info is the metadata of a report, known from its directory entry without reading the report.
+type Info struct {
+	Path      string // Path is the path to the report file.
+	TimeStamp int64  // TimeStamp is the timestamp of the report.
+	Size      int64  // Size is the size of the report file in bytes.
+	State     State  // State is the state of the report, which is a single state.
+}
+
+// listBatchSize is the number of directory entries List reads at once.
+const listBatchSize = 64
+
+// List calls fn with the metadata of each report of the source whose store is dir, in the states selected by
+// states, until fn returns false. Local reports come first, in no particular order.
+//
+// Reports are streamed from directory entries: report files are not opened, and the directories are read in
+// batches. Missing directories hold no reports.
+// The store is not locked, so a report moved while listing may be missed or listed twice.
+func List(l *slog.Logger, dir string, states State, fn func(Info) bool) error {
+	folders := []struct {
+		name  string
+		state State
+	}{
+		{constants.LocalFolder, StateLocal},
+		{constants.UploadedFolder, StateUploaded},
+	}
+
+	for _, f := range folders {
+		if states&f.state == 0 {
+			continue
+		}
+		more, err := listDir(l, filepath.Join(dir, f.name), f.state, fn)
+		if err != nil {
+			return err
+		}
+		if !more {
+			return nil
+		}
+	}
+	return nil
+}
+
+// listDir calls fn with the metadata of each report in dir, which are in state, and returns whether fn
+// asked for more.
+func listDir(l *slog.Logger, dir string, state State, fn func(Info) bool) (more bool, err error) {
+	d, err := os.Open(dir)
+	if os.IsNotExist(err) {
+		return true, nil
+	}
+	if err != nil {
+		return false, fmt.Errorf("failed to open report directory: %v", err)
+	}
+	defer d.Close()
+
+	for {
+		entries, err := d.ReadDir(listBatchSize)
+		for _, e := range entries {
+			if !e.Type().IsRegular() || !isReportExt(filepath.Ext(e.Name())) {
+				continue
+			}
+			t, err := getReportTime(e.Name())
+			if err != nil {
+				l.Debug("Skipping non-report file", "file", e.Name(), "error", err)
+				continue
+			}
+			fi, err := e.Info()
+			if os.IsNotExist(err) {
+				continue // Moved or removed since the directory was read.
+			}
+			if err != nil {
+				return false, fmt.Errorf("failed to get report information: %v", err)
+			}
+
+			if !fn(Info{Path: filepath.Join(dir, e.Name()), TimeStamp: t, Size: fi.Size(), State: state}) {
+				return false, nil
+			}
+		}
+		if errors.Is(err, io.EOF) {
+			return true, nil
+		}
+		if err != nil {
+			return false, fmt.Errorf("failed to read report directory: %v", err)
+		}
+	}
+}
+
+// Map returns the JSON content of the report of the source whose store is dir, in state and with the timestamp t,
+// mapped read-only into memory where supported. The mapping must be closed after use.
+//
+// state must be a single state. Reports are always replaced by renaming over them, so the mapping is never
+// truncated under the caller, and keeps the content of the report as it was when it was mapped.
+// Binary reports are rendered as JSON into memory instead.
+func Map(dir string, state State, t int64) (*fileutils.Mapping, error) {
+	var folder string
+	switch state {
+	case StateLocal:
+		folder = constants.LocalFolder
+	case StateUploaded:
+		folder = constants.UploadedFolder
+	default:
+		return nil, fmt.Errorf("invalid report state %d", state)
+	}
+
+	path := filepath.Join(dir, folder, strconv.FormatInt(t, 10))
+	m, err := fileutils.MapFile(path+constants.ReportExt, math.MaxInt64)
+	if !errors.Is(err, fs.ErrNotExist) {
+		if err != nil {
+			return nil, fmt.Errorf("failed to read report: %w", err)
+		}
+		return m, nil
+	}
+
+	data, err := os.ReadFile(path + constants.BinaryReportExt)
+	if err != nil {
+		return nil, fmt.Errorf("failed to read report: %w", err)
+	}
+	if data, err = DecodeBinary(data); err != nil {
+		return nil, fmt.Errorf("failed to read report: %w", err)
+	}
+	return fileutils.NewMapping(data), nil
+}
+
+// isReportExt returns true if ext is the extension of reports in any format.
+func isReportExt(ext string) bool {
+	return ext == constants.ReportExt || ext == constants.BinaryReportExt
+}
+
 // getReportTime returns a int64 representation of the report time from the report path.
 func getReportTime(path string) (int64, error) {
 	fileName := filepath.Base(path)
@@ -6,9 +6,11 @@ import (
 	"os"
 	"path/filepath"
 	"runtime"
+	"slices"
 	"testing"
 
 	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/common/testutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 )
@@ -259,7 +261,7 @@ func TestMarkAsProcessed(t *testing.T) {
 			r, err := report.New(filepath.Join(srcDir, tc.fileName))
 			require.NoError(t, err, "Setup: failed to create report object")
 
-			r, err = r.MarkAsProcessed(dstDir, tc.data)
+			r, err = r.MarkAsProcessed(dstDir, tc.data, fileutils.SyncFileAndDir)
 			if tc.wantErr {
 				require.Error(t, err, "expected an error but got none")
 				return
@@ -332,10 +334,10 @@ func TestUndoProcessed(t *testing.T) {
 			r, err := report.New(filepath.Join(srcDir, tc.fileName))
 			require.NoError(t, err, "Setup: failed to create report object")
 
-			r, err = r.MarkAsProcessed(dstDir, tc.data)
+			r, err = r.MarkAsProcessed(dstDir, tc.data, fileutils.SyncFileAndDir)
 			require.NoError(t, err, "Setup: failed to mark report as processed")
 
-			r, err = r.UndoProcessed()
+			r, err = r.UndoProcessed(fileutils.SyncFileAndDir)
 			if tc.wantErr {
 				require.Error(t, err, "expected an error but got none")
 				return
@@ -362,7 +364,7 @@ func TestUndoProcessedNoStash(t *testing.T) {
 	r, err := report.New("1.json")
 	require.NoError(t, err, "Setup: failed to create report object")
 
-	_, err = r.UndoProcessed()
+	_, err = r.UndoProcessed(fileutils.SyncFileAndDir)
 	require.Error(t, err, "UndoProcessed should return an error if the report has not been marked as processed")
 }
 
@@ -391,10 +393,230 @@ func TestUndoProcessedNoFile(t *testing.T) {
 
 	require.NoError(t, os.Remove(r.Path), "Setup: failed to remove report file")
 
-	_, err = r.UndoProcessed()
+	_, err = r.UndoProcessed(fileutils.SyncFileAndDir)
 	require.Error(t, err, "UndoProcessed should return an error if the report file does not exist")
 }
 
+func TestLockStore(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		exclusive bool
+		noDir     bool
+
+		wantErr bool
+	}{
+		"Locks store exclusively":                 {exclusive: true},
+		"Locks store shared":                      {},
+		"Shared lock on missing store is a no-op": {noDir: true},
+
+		"Errors on exclusive lock of missing store": {exclusive: true, noDir: true, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			if tc.noDir {
+				dir = filepath.Join(dir, "missing")
+			}
+
+			unlock, err := report.LockStore(slog.Default(), dir, tc.exclusive)
+			if tc.wantErr {
+				require.Error(t, err, "LockStore should return an error")
+				return
+			}
+			require.NoError(t, err, "LockStore should not return an error")
+			defer unlock()
+
+			if tc.noDir {
+				_, err := os.Stat(dir)
+				require.ErrorIs(t, err, os.ErrNotExist, "LockStore should not create the store")
+				return
+			}
+			entries, err := os.ReadDir(dir)
+			require.NoError(t, err, "Setup: failed to read store")
+			require.Empty(t, entries, "LockStore should not add files to the store")
+		})
+	}
+}
+
+func TestList(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		local    map[string]string
+		uploaded map[string]string
+		states   report.State
+		limit    int
+		noStore  bool
+
+		want []report.Info
+	}{
+		"Lists reports in all states": {
+			local:    map[string]string{"1.json": `{"a":1}`, "2.json": `{}`},
+			uploaded: map[string]string{"3.json": `{"OptOut":true}`},
+			states:   report.StateAll,
+			want: []report.Info{
+				{Path: "local/1.json", TimeStamp: 1, Size: 7, State: report.StateLocal},
+				{Path: "local/2.json", TimeStamp: 2, Size: 2, State: report.StateLocal},
+				{Path: "uploaded/3.json", TimeStamp: 3, Size: 15, State: report.StateUploaded},
+			},
+		},
+		"Lists local reports only": {
+			local:    map[string]string{"1.json": `{}`},
+			uploaded: map[string]string{"3.json": `{}`},
+			states:   report.StateLocal,
+			want:     []report.Info{{Path: "local/1.json", TimeStamp: 1, Size: 2, State: report.StateLocal}},
+		},
+		"Lists uploaded reports only": {
+			local:    map[string]string{"1.json": `{}`},
+			uploaded: map[string]string{"3.json": `{}`},
+			states:   report.StateUploaded,
+			want:     []report.Info{{Path: "uploaded/3.json", TimeStamp: 3, Size: 2, State: report.StateUploaded}},
+		},
+		"Skips non-report files": {
+			local:  map[string]string{"1.json": `{}`, "1.txt": ``, "one.json": `{}`},
+			states: report.StateAll,
+			want:   []report.Info{{Path: "local/1.json", TimeStamp: 1, Size: 2, State: report.StateLocal}},
+		},
+		"Stops when asked to": {
+			local:    map[string]string{"1.json": `{}`, "2.json": `{}`},
+			uploaded: map[string]string{"3.json": `{}`},
+			states:   report.StateAll,
+			limit:    1,
+		},
+		"Missing store holds no reports": {noStore: true, states: report.StateAll},
+		"No state lists nothing":         {local: map[string]string{"1.json": `{}`}},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			if tc.noStore {
+				dir = filepath.Join(dir, "missing")
+			} else {
+				setupStore(t, dir, tc.local, tc.uploaded)
+			}
+
+			var got []report.Info
+			err := report.List(slog.Default(), dir, tc.states, func(i report.Info) bool {
+				rel, err := filepath.Rel(dir, i.Path)
+				require.NoError(t, err, "Setup: failed to make report path relative")
+				i.Path = filepath.ToSlash(rel)
+				got = append(got, i)
+				return tc.limit == 0 || len(got) < tc.limit
+			})
+			require.NoError(t, err, "List should not return an error")
+
+			if tc.limit > 0 {
+				require.Len(t, got, tc.limit, "List should stop when the callback returns false")
+				return
+			}
+			slices.SortFunc(got, func(a, b report.Info) int { return int(a.TimeStamp - b.TimeStamp) })
+			require.Equal(t, tc.want, got, "List should return the metadata of the selected reports")
+		})
+	}
+}
+
+func TestMap(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		state report.State
+		time  int64
+
+		want    string
+		wantErr bool
+	}{
+		"Maps local report":     {state: report.StateLocal, time: 1, want: `{"local":true}`},
+		"Maps uploaded report":  {state: report.StateUploaded, time: 1, want: `{"local":false}`},
+		"Renders binary report": {state: report.StateLocal, time: 3, want: `{"binary":true}`},
+
+		"Errors on missing report":        {state: report.StateLocal, time: 2, wantErr: true},
+		"Errors on several states":        {state: report.StateAll, time: 1, wantErr: true},
+		"Errors on corrupt binary report": {state: report.StateLocal, time: 4, wantErr: true},
+	}
+
+	binaryReport, ok := report.EncodeBinary([]byte(`{"binary":true}`))
+	require.True(t, ok, "Setup: failed to encode binary report")
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			setupStore(t, dir, map[string]string{"1.json": `{"local":true}`, "3.cbor": string(binaryReport), "4.cbor": `{"corrupt":true}`},
+				map[string]string{"1.json": `{"local":false}`})
+
+			m, err := report.Map(dir, tc.state, tc.time)
+			if tc.wantErr {
+				require.Error(t, err, "Map should return an error")
+				return
+			}
+			require.NoError(t, err, "Map should not return an error")
+			defer m.Close()
+
+			require.Equal(t, tc.want, string(m.Bytes()), "Map should return the content of the report")
+		})
+	}
+}
+
+func TestWrite(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		format report.Format
+		data   string
+
+		wantExt string
+	}{
+		"Writes JSON reports":                     {format: report.FormatJSON, data: `{"a":1}`, wantExt: ".json"},
+		"Writes binary reports":                   {format: report.FormatCBOR, data: `{"a":1}`, wantExt: ".cbor"},
+		"Writes JSON when binary is not lossless": {format: report.FormatCBOR, data: `{"a": 1.50}`, wantExt: ".json"},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			localDir, uploadedDir := filepath.Join(dir, "local"), filepath.Join(dir, "uploaded")
+			require.NoError(t, os.MkdirAll(localDir, 0750), "Setup: failed to create local directory")
+			require.NoError(t, os.MkdirAll(uploadedDir, 0750), "Setup: failed to create uploaded directory")
+
+			path, err := report.Write(localDir, 7, []byte(tc.data), tc.format, fileutils.SyncNone)
+			require.NoError(t, err, "Write should not return an error")
+			require.Equal(t, filepath.Join(localDir, "7"+tc.wantExt), path, "Write should return the path of the report")
+
+			r, err := report.New(path)
+			require.NoError(t, err, "Written report should be a valid report")
+			got, err := r.ReadJSON()
+			require.NoError(t, err, "ReadJSON should not return an error")
+			require.Equal(t, tc.data, string(got), "ReadJSON should return the written report")
+
+			// Processed reports keep their format, and are restored as they were.
+			orig, err := os.ReadFile(path)
+			require.NoError(t, err, "Setup: failed to read report")
+			processed, err := r.MarkAsProcessed(uploadedDir, []byte(`{"OptOut":true}`))
+			require.NoError(t, err, "MarkAsProcessed should not return an error")
+			require.Equal(t, filepath.Join(uploadedDir, "7"+tc.wantExt), processed.Path, "MarkAsProcessed should keep the report name")
+			got, err = processed.ReadJSON()
+			require.NoError(t, err, "ReadJSON should not return an error on processed report")
+			require.Equal(t, `{"OptOut":true}`, string(got), "Processed report should hold the new data")
+
+			restored, err := processed.UndoProcessed()
+			require.NoError(t, err, "UndoProcessed should not return an error")
+			restoredData, err := os.ReadFile(restored.Path)
+			require.NoError(t, err, "Restored report should exist")
+			require.Equal(t, orig, restoredData, "UndoProcessed should restore the original file")
+		})
+	}
+}
+
 func TestReadJSON(t *testing.T) {
 	t.Parallel()
 
@@ -604,6 +826,16 @@ func setupBasicDir(t *testing.T, files map[string]string, perms os.FileMode, dir
 	}
 }
 
+// setupStore creates the local and uploaded directories of a report store in dir, with the given reports.
+func setupStore(t *testing.T, dir string, local, uploaded map[string]string) {
+	t.Helper()
+
+	for sub, files := range map[string]map[string]string{"local": local, "uploaded": uploaded} {
+		require.NoError(t, os.MkdirAll(filepath.Join(dir, sub), 0700), "Setup: failed to create report directory")
+		setupBasicDir(t, files, 0600, filepath.Join(dir, sub))
+	}
+}
+
 func setupNoDataDir(t *testing.T, files []string, subDir string, subDirFiles []string) (string, error) {
 	t.Helper()
 
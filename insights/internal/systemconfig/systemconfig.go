@@ -16,6 +16,7 @@ import (
 	"github.com/ubuntu/decorate"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/filecache"
 )
 
 // Manager manages the system-wide configuration file.
@@ -36,14 +37,21 @@ func New(l *slog.Logger, path string) *Manager {
 	return &Manager{log: l, path: path}
 }
 
+// configFiles caches the system configuration files read by all managers of the process, as the opt-out
+// is checked along with every consent lookup.
+var configFiles = filecache.New(func(path string) (Config, error) {
+	var f Config
+	_, err := toml.DecodeFile(path, &f)
+	return f, err
+})
+
 // IsOptedOut reports whether the system opt-out is currently active.
 //
 // If the configuration file or its parent directory does not exist, IsOptedOut returns false with no error,
 // preserving backward compatibility with systems that have not set a system opt-out.
 // A malformed configuration file returns an error.
 func (m Manager) IsOptedOut() (bool, error) {
-	var f Config
-	_, err := toml.DecodeFile(m.getFile(), &f)
+	f, err := configFiles.Get(m.getFile())
 	if err != nil {
 		var pe *os.PathError
 		if errors.As(err, &pe) && errors.Is(pe.Err, os.ErrNotExist) {
@@ -85,7 +93,10 @@ func (f Config) write(l *slog.Logger, path string) (err error) {
 		return fmt.Errorf("could not encode system config file: %v", err)
 	}
 
-	if err := fileutils.AtomicWriteWithPerm(path, buf.Bytes(), 0755, 0644); err != nil {
+	err = fileutils.AtomicWriteWithPerm(path, buf.Bytes(), 0755, 0644, fileutils.WithSync(fileutils.SyncFileAndDir))
+	// Don't wait on the cache to notice the change, even if the write failed halfway.
+	configFiles.Invalidate(path)
+	if err != nil {
 		return err
 	}
 	l.Debug("Wrote system config file", "file", path, "system_opt_out", f.SystemOptOut)
@@ -0,0 +1,132 @@
+package uploader
+
+import (
+	"fmt"
+	"net/http"
+	"sync"
+
+	"github.com/ubuntu/ubuntu-insights/common/reportdelta"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
+)
+
+// deltaBase is the last report of a source acknowledged by the server, which deltas are sent against.
+// It is shared by all the uploads of the source in a run.
+type deltaBase struct {
+	data   []byte // data is the canonical encoding of the report.
+	digest string
+
+	// mu is held while deltas are sent against the base before the server answered whether it knows it, for them to
+	// be sent one at a time: a server which does not know the base refuses all of them.
+	mu    sync.Mutex
+	state baseState
+}
+
+// baseState is whether the server knows a delta base.
+type baseState int
+
+const (
+	baseUnknown baseState = iota
+	baseKnown
+	baseRefused
+)
+
+// latestDeltaBase returns the most recent report uploaded from uploadedDir as a base for deltas.
+// It returns nil if deltas are disabled, or if there is no usable report to send deltas against.
+func (um Uploader) latestDeltaBase(uploadedDir string) *deltaBase {
+	if !um.deltas {
+		return nil
+	}
+
+	reports, err := report.GetAll(um.log, uploadedDir)
+	if err != nil {
+		um.log.Debug("Failed to get uploaded reports, not sending deltas", "error", err)
+		return nil
+	}
+	if len(reports) == 0 {
+		return nil
+	}
+	latest := reports[0]
+	for _, r := range reports[1:] {
+		if r.TimeStamp > latest.TimeStamp {
+			latest = r
+		}
+	}
+
+	data, err := latest.ReadJSON()
+	if err == nil {
+		data, err = reportdelta.Canonical(data)
+	}
+	if err != nil {
+		um.log.Debug("Failed to read the latest uploaded report, not sending deltas", "file", latest.Name, "error", err)
+		return nil
+	}
+	return &deltaBase{data: data, digest: reportdelta.Digest(data)}
+}
+
+// sendWithDeltas sends data to the server as a delta against base when it is smaller than the full report,
+// and as a full report otherwise or when the server does not know base.
+// The digest of data is always sent along for the server to accept deltas against it next time.
+func (um Uploader) sendWithDeltas(url string, data []byte, base *deltaBase) error {
+	target, err := reportdelta.Canonical(data)
+	if err != nil {
+		return fmt.Errorf("failed to encode report: %v", err)
+	}
+	header := http.Header{reportdelta.DigestHeader: {reportdelta.Digest(target)}}
+
+	if base != nil {
+		if sent, err := um.sendDelta(url, target, header, base); sent {
+			return err
+		}
+	}
+
+	status, err := um.post(url, data, header)
+	if err != nil {
+		return err
+	}
+	return checkStatus(status)
+}
+
+// sendDelta sends target to the server as a delta against base, and returns whether it was sent, with the error
+// sending it if any. It is not sent if the delta is not smaller than target, or if the server does not know base, in
+// which case no other delta is sent against it.
+func (um Uploader) sendDelta(url string, target []byte, header http.Header, base *deltaBase) (sent bool, err error) {
+	patch, ok, err := reportdelta.Diff(base.data, target)
+	if err != nil {
+		um.log.Debug("Failed to compute delta, sending full report", "error", err)
+	}
+	if !ok || len(patch) >= len(target) {
+		return false, nil
+	}
+
+	base.mu.Lock()
+	state := base.state
+	if state == baseKnown {
+		// Deltas against a known base are sent concurrently.
+		base.mu.Unlock()
+	} else {
+		defer base.mu.Unlock()
+	}
+	if state == baseRefused {
+		return false, nil
+	}
+
+	deltaHeader := header.Clone()
+	deltaHeader.Set("Content-Type", reportdelta.ContentType)
+	deltaHeader.Set(reportdelta.BaseHeader, base.digest)
+
+	status, err := um.post(url, patch, deltaHeader)
+	if err != nil {
+		return true, err
+	}
+	switch {
+	case status == http.StatusConflict:
+		um.log.Debug("Server does not know the delta base, sending full report", "base", base.digest)
+		if state == baseUnknown {
+			base.state = baseRefused
+		}
+		return false, nil
+	case status == http.StatusAccepted && state == baseUnknown:
+		base.state = baseKnown
+	}
+	return true, checkStatus(status)
+}
@@ -10,13 +10,6 @@ func (m MockTimeProvider) Now() time.Time {
 	return time.Unix(m.CurrentTime, 0)
 }
 
-// WithBaseServerURL sets the base server URL for the uploader.
-func WithBaseServerURL(url string) Options {
-	return func(o *options) {
-		o.baseServerURL = url
-	}
-}
-
 // WithTimeProvider sets the time provider for the uploader.
 func WithTimeProvider(tp timeProvider) Options {
 	return func(o *options) {
@@ -45,13 +38,6 @@ func WithMaxAttempts(n uint32) Options {
 	}
 }
 
-// WithResponseTimeout sets the response timeout for the uploader when waiting for a response from the server.
-func WithResponseTimeout(d time.Duration) Options {
-	return func(o *options) {
-		o.responseTimeout = d
-	}
-}
-
 // WithMaxConcurrentUploadsPerSource sets the maximum number of concurrent uploads per source.
 func WithMaxConcurrentUploadsPerSource(n uint32) Options {
 	return func(o *options) {
@@ -65,3 +51,25 @@ func WithMaxConcurrentSources(n uint32) Options {
 		o.maxConcurrentSources = n
 	}
 }
+
+// WithMachineIDFiles sets the files the uploader reads the machine ID from.
+func WithMachineIDFiles(paths ...string) Options {
+	return func(o *options) {
+		o.machineIDFiles = paths
+	}
+}
+
+// WithMaxScheduleDelay sets the maximum time a scheduled uploader waits for before uploading.
+func WithMaxScheduleDelay(d time.Duration) Options {
+	return func(o *options) {
+		o.maxScheduleDelay = d
+	}
+}
+
+// Schedule is the pacing asked for by the server, kept in the reports directory.
+type Schedule = schedule
+
+// SlotDelay returns how long after t the next upload slot of the machine with ID id is, in windows of length window.
+func SlotDelay(id string, window time.Duration, t time.Time) time.Duration {
+	return slotDelay(id, window, t)
+}
@@ -1,13 +1,16 @@
 package uploader
 
 import (
+	"fmt"
 	"log/slog"
 	"net/http"
 	"net/http/httptest"
 	"os"
 	"path/filepath"
 	"testing"
+	"time"
 
+	"github.com/stretchr/testify/assert"
 	"github.com/stretchr/testify/require"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
@@ -143,3 +146,25 @@ func TestSend(t *testing.T) {
 		})
 	}
 }
+
+func TestSlotDelay(t *testing.T) {
+	t.Parallel()
+
+	const window = time.Hour
+	start := time.Unix(1735689600, 0)
+
+	d := slotDelay("machine", window, start)
+	require.Less(t, d, window, "The slot should be in the window")
+	require.Zero(t, slotDelay("machine", window, start.Add(d)), "The slot should be now once reached")
+	require.Equal(t, d, slotDelay("machine", window, start.Add(window)), "The slot should be stable across windows")
+	require.NotEqual(t, d, slotDelay("other machine", window, start), "Machines should get different slots")
+
+	const machines, buckets = 10000, 10
+	counts := make([]int, buckets)
+	for i := range machines {
+		counts[slotDelay(fmt.Sprintf("machine-%d", i), window, start)*buckets/window]++
+	}
+	for i, c := range counts {
+		assert.InDelta(t, machines/buckets, c, machines/buckets/5, "Slots should spread evenly over the window, bucket %d", i)
+	}
+}
@@ -0,0 +1,149 @@
+package uploader
+
+import (
+	"crypto/sha256"
+	"encoding/binary"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io/fs"
+	"net/http"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+)
+
+// schedule is the pacing the server asked for, kept in the reports directory across runs.
+type schedule struct {
+	// Window is the period over which the server asks clients to spread their uploads.
+	Window time.Duration `json:"window"`
+	// NotBefore is the time before which the server asked not to upload again.
+	NotBefore time.Time `json:"notBefore"`
+}
+
+// pacer records the pacing hints of the server answers. It is shared by all the copies of an Uploader.
+type pacer struct {
+	mu      sync.Mutex
+	s       schedule
+	changed bool
+}
+
+// observe records the pacing hints of an answer of the server with status and header h, received at now.
+func (p *pacer) observe(status int, h http.Header, now time.Time) {
+	switch status {
+	case http.StatusAccepted, http.StatusTooManyRequests, http.StatusServiceUnavailable:
+	default:
+		return
+	}
+
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	if w, ok := pacing.Window(h); ok && w != p.s.Window {
+		p.s.Window = w
+		p.changed = true
+	}
+	if d, ok := pacing.RetryAfter(h, now); ok && now.Add(d).After(p.s.NotBefore) {
+		p.s.NotBefore = now.Add(d)
+		p.changed = true
+	}
+}
+
+// delay returns how long after now the server asked not to upload for.
+func (p *pacer) delay(now time.Time) time.Duration {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	return max(p.s.NotBefore.Sub(now), 0)
+}
+
+// waitForSlot waits for the upload slot of the machine in the window advertised by the server, after any delay it
+// asked for on previous runs. The slot is derived from the machine ID so that uploads spread evenly over the window,
+// at a stable time for each machine.
+func (um Uploader) waitForSlot() {
+	s, err := um.loadSchedule()
+	if err != nil {
+		um.log.Warn("Failed to load the upload schedule, uploading now", "error", err)
+		return
+	}
+
+	um.pacer.mu.Lock()
+	um.pacer.s = s
+	um.pacer.mu.Unlock()
+
+	now := um.timeProvider.Now()
+	wait := um.pacer.delay(now)
+	if window := min(s.Window, um.maxScheduleDelay); window > 0 {
+		wait += slotDelay(um.machineID(), window, now.Add(wait))
+	}
+	wait = min(wait, um.maxScheduleDelay)
+	if wait <= 0 {
+		return
+	}
+
+	um.log.Info("Waiting for the upload slot of the machine", "seconds", wait.Seconds(), "window", s.Window)
+	time.Sleep(wait)
+}
+
+// saveSchedule keeps the pacing hints the server sent during this run for the next runs, if they changed.
+func (um Uploader) saveSchedule() error {
+	um.pacer.mu.Lock()
+	defer um.pacer.mu.Unlock()
+
+	if !um.pacer.changed {
+		return nil
+	}
+	data, err := json.Marshal(um.pacer.s)
+	if err != nil {
+		return fmt.Errorf("failed to encode upload schedule: %v", err)
+	}
+	if err := fileutils.AtomicWrite(filepath.Join(um.cacheDir, constants.ScheduleFileName), data); err != nil {
+		return fmt.Errorf("failed to write upload schedule: %v", err)
+	}
+	um.pacer.changed = false
+	return nil
+}
+
+// loadSchedule returns the pacing hints kept by the previous runs, which is empty if there are none.
+func (um Uploader) loadSchedule() (schedule, error) {
+	var s schedule
+	data, err := os.ReadFile(filepath.Join(um.cacheDir, constants.ScheduleFileName))
+	if errors.Is(err, fs.ErrNotExist) {
+		return s, nil
+	}
+	if err != nil {
+		return s, err
+	}
+	if err := json.Unmarshal(data, &s); err != nil {
+		return s, fmt.Errorf("invalid upload schedule: %v", err)
+	}
+	return s, nil
+}
+
+// machineID returns the ID of the machine, falling back on its host name where there is none.
+// It is only used locally to derive the upload slot of the machine, and never sent.
+func (um Uploader) machineID() string {
+	for _, path := range um.machineIDFiles {
+		data, err := os.ReadFile(path)
+		if id := strings.TrimSpace(string(data)); err == nil && id != "" {
+			return id
+		}
+	}
+	um.log.Debug("No machine ID found, using the host name for the upload slot")
+	name, _ := os.Hostname()
+	return name
+}
+
+// slotDelay returns how long after t the next upload slot of the machine with ID id is, in windows of length window.
+// window must be positive.
+func slotDelay(id string, window time.Duration, t time.Time) time.Duration {
+	sum := sha256.Sum256([]byte("ubuntu-insights upload slot\x00" + id))
+	offset := int64(binary.BigEndian.Uint64(sum[:8]) % uint64(window))
+	return time.Duration((offset - t.UnixNano()%int64(window) + int64(window)) % int64(window))
+}
@@ -24,11 +24,20 @@ var (
 	ErrReportNotMature = errors.New("report is not mature enough to be uploaded")
 	// ErrSendFailure is returned when a report fails to be sent to the server, either due to a network error or a non-200 status code.
 	ErrSendFailure = errors.New("report send failed")
+
+	// errReportTaken is returned when a report was sent by another upload of its source since it was listed.
+	errReportTaken = errors.New("report was taken by another upload")
 )
 
 // UploadAll concurrently calls Upload for all the provided sources.
 // Uploads do not fail fast, but rather accumulate errors and return them at the end.
+//
+// If the uploader is scheduled, it first waits for the upload slot of the machine, unless force is true.
 func (um Uploader) UploadAll(sources []string, force, retry bool) error {
+	if um.scheduled && !um.dryRun && !force {
+		um.waitForSlot()
+	}
+
 	var uploadError error
 	mu := &sync.Mutex{}
 	var wg sync.WaitGroup
@@ -60,6 +69,12 @@ func (um Uploader) UploadAll(sources []string, force, retry bool) error {
 		}()
 	}
 	wg.Wait()
+
+	if um.scheduled && !um.dryRun {
+		if err := um.saveSchedule(); err != nil {
+			um.log.Warn("Failed to save the upload schedule", "error", err)
+		}
+	}
 	return uploadError
 }
 
@@ -88,14 +103,23 @@ func (um Uploader) Upload(source string, force bool) error {
 		return fmt.Errorf("upload failed to get consent state: %w", err)
 	}
 
-	reports, err := report.GetAll(um.log, collectedDir)
+	url, err := um.getURL(source)
 	if err != nil {
-		return fmt.Errorf("failed to get reports: %v", err)
+		return fmt.Errorf("failed to get URL: %v", err)
 	}
 
-	url, err := um.getURL(source)
+	// The store is only locked while it is read or changed, not while reports are sent, for other uploads and
+	// collections of the source not to wait on the server.
+	unlock, err := report.LockStore(um.log, filepath.Dir(collectedDir), false)
 	if err != nil {
-		return fmt.Errorf("failed to get URL: %v", err)
+		return err
+	}
+	reports, err := report.GetAll(um.log, collectedDir)
+	// All the reports of this run are sent against the same base, as the server may not have acknowledged the others yet.
+	base := um.latestDeltaBase(uploadedDir)
+	unlock()
+	if err != nil {
+		return fmt.Errorf("failed to get reports: %v", err)
 	}
 
 	mu := &sync.Mutex{}
@@ -110,9 +134,11 @@ func (um Uploader) Upload(source string, force bool) error {
 			defer wg.Done()
 			defer func() { <-sem }() // Release the semaphore slot before signaling completion to the WaitGroup.
 
-			err := um.upload(r, uploadedDir, url, consent, force)
+			err := um.upload(r, uploadedDir, url, consent, force, base)
 			if errors.Is(err, ErrReportNotMature) {
 				um.log.Debug("Skipped report upload, not mature enough", "file", r.Name, "source", source)
+			} else if errors.Is(err, errReportTaken) {
+				um.log.Debug("Skipped report upload, already sent by another upload", "file", r.Name, "source", source)
 			} else if err != nil {
 				um.log.Warn("Failed to upload report", "file", r.Name, "source", source, "error", err)
 				mu.Lock()
@@ -127,11 +153,15 @@ func (um Uploader) Upload(source string, force bool) error {
 		return uploadError
 	}
 
-	return errors.Join(report.Cleanup(um.log, uploadedDir, um.maxReports), uploadError)
+	err = um.withStoreLocked(uploadedDir, func() error {
+		return report.Cleanup(um.log, uploadedDir, um.maxReports)
+	})
+	return errors.Join(err, uploadError)
 }
 
 // BackoffUpload behaves like Upload, but if there are any send errors, it will retry the upload after a backoff period.
-// The backoff period is calculated as an exponential backoff with full jitter.
+// The backoff period is calculated as an exponential backoff with full jitter, or is the delay asked for by the server
+// if it is longer.
 // If the maximum number of attempts is reached, it will stop retrying and return the last error.
 func (um Uploader) BackoffUpload(source string, force bool) (err error) {
 	um.log.Debug("Uploading reports with backoff")
@@ -152,6 +182,7 @@ func (um Uploader) BackoffUpload(source string, force bool) (err error) {
 			exp = min(um.baseRetryPeriod*time.Duration(factor), um.maxRetryPeriod)
 		}
 		wait := time.Duration(rand.Int63n(int64(max(exp, 1)))) // #nosec:G404 We don't need cryptographic randomness.
+		wait = max(wait, min(um.pacer.delay(um.timeProvider.Now()), um.maxScheduleDelay))
 
 		attempts++
 		if attempts > um.maxAttempts {
@@ -167,24 +198,19 @@ func (um Uploader) BackoffUpload(source string, force bool) (err error) {
 
 // upload uploads an individual report to the server. It returns an error if the report is not mature enough to be uploaded, or if the upload fails.
 // It also moves the report to the uploaded directory after a successful upload.
-func (um Uploader) upload(r report.Report, uploadedDir, url string, consent, force bool) error {
+// When deltas are enabled, the report is sent as a delta against base if it is not nil.
+func (um Uploader) upload(r report.Report, uploadedDir, url string, consent, force bool, base *deltaBase) error {
 	um.log.Debug("Uploading report", "file", r.Name, "consent", consent, "force", force)
 
 	if um.timeProvider.Now().Add(-um.minAge).Before(time.Unix(r.TimeStamp, 0)) && !force {
 		return ErrReportNotMature
 	}
 
-	// Check for duplicate reports.
-	_, err := os.Stat(filepath.Join(uploadedDir, r.Name))
-	if err != nil && !os.IsNotExist(err) {
-		return fmt.Errorf("failed to check if report has already been uploaded: %v", err)
-	}
-	if err == nil && !force {
-		return fmt.Errorf("report has already been uploaded")
-	}
-
 	origData, err := r.ReadJSON()
 	if err != nil {
+		if isTaken(r) {
+			return errReportTaken
+		}
 		return fmt.Errorf("failed to read report: %v", err)
 	}
 	data := origData
@@ -195,16 +221,41 @@ func (um Uploader) upload(r report.Report, uploadedDir, url string, consent, for
 
 	if um.dryRun {
 		um.log.Debug("Dry run, skipping upload")
-		return nil
+		return checkDuplicate(r, uploadedDir, force)
 	}
 
-	// Move report first to avoid the situation where the report is sent, but not marked as sent.
-	r, err = r.MarkAsProcessed(uploadedDir, data)
+	err = um.withStoreLocked(uploadedDir, func() error {
+		if isTaken(r) {
+			return errReportTaken
+		}
+		if err := checkDuplicate(r, uploadedDir, force); err != nil {
+			return err
+		}
+
+		// Move report first to avoid the situation where the report is sent, but not marked as sent.
+		var err error
+		r, err = r.MarkAsProcessed(uploadedDir, data, um.reportSync)
+		if err != nil {
+			return fmt.Errorf("failed to mark report as processed: %v", err)
+		}
+		return nil
+	})
 	if err != nil {
-		return fmt.Errorf("failed to mark report as processed: %v", err)
+		return err
 	}
-	if sendErr := um.send(url, data); sendErr != nil {
-		if _, undoErr := r.UndoProcessed(); undoErr != nil { // Need to expose sendErr.
+
+	var sendErr error
+	if um.deltas {
+		sendErr = um.sendWithDeltas(url, data, base)
+	} else {
+		sendErr = um.send(url, data)
+	}
+	if sendErr != nil {
+		undoErr := um.withStoreLocked(uploadedDir, func() error {
+			_, err := r.UndoProcessed(um.reportSync)
+			return err
+		})
+		if undoErr != nil { // Need to expose sendErr.
 			return errors.Join(sendErr, fmt.Errorf("failed to restore the original report: %v", undoErr))
 		}
 		return sendErr
@@ -213,6 +264,35 @@ func (um Uploader) upload(r report.Report, uploadedDir, url string, consent, for
 	return nil
 }
 
+// isTaken returns whether the report was moved away by another upload of its source since it was listed.
+func isTaken(r report.Report) bool {
+	_, err := os.Stat(r.Path)
+	return os.IsNotExist(err)
+}
+
+// checkDuplicate returns an error if the report has already been uploaded, unless force is true.
+func checkDuplicate(r report.Report, uploadedDir string, force bool) error {
+	_, err := os.Stat(filepath.Join(uploadedDir, r.Name))
+	if err != nil && !os.IsNotExist(err) {
+		return fmt.Errorf("failed to check if report has already been uploaded: %v", err)
+	}
+	if err == nil && !force {
+		return fmt.Errorf("report has already been uploaded")
+	}
+	return nil
+}
+
+// withStoreLocked runs f with the report store holding uploadedDir exclusively locked, against concurrent
+// mutations from other uploads and collections of its source.
+func (um Uploader) withStoreLocked(uploadedDir string, f func() error) error {
+	unlock, err := report.LockStore(um.log, filepath.Dir(uploadedDir), true)
+	if err != nil {
+		return err
+	}
+	defer unlock()
+	return f()
+}
+
 func (um Uploader) getURL(source string) (string, error) {
 	u, err := url.Parse(um.baseServerURL)
 	if err != nil {
@@ -222,25 +302,53 @@ func (um Uploader) getURL(source string) (string, error) {
 	return u.String(), nil
 }
 
+// SendReport sends data to the server as a report of source, without reading nor moving any report file,
+// and returns the status code the server answered with.
+// It is meant for tools simulating clients, which send reports the way the uploader does.
+func (um Uploader) SendReport(source string, data []byte) (int, error) {
+	url, err := um.getURL(source)
+	if err != nil {
+		return 0, fmt.Errorf("failed to get URL: %v", err)
+	}
+	return um.post(url, data, nil)
+}
+
 func (um Uploader) send(url string, data []byte) error {
+	status, err := um.post(url, data, nil)
+	if err != nil {
+		return err
+	}
+	return checkStatus(status)
+}
+
+// post sends data to url as JSON, with the additional headers in header, and returns the response status code.
+func (um Uploader) post(url string, data []byte, header http.Header) (int, error) {
 	um.log.Debug("Sending data to server", "url", url, "data", data)
 	req, err := http.NewRequest(http.MethodPost, url, bytes.NewBuffer(data))
 	if err != nil {
-		return fmt.Errorf("failed to create request: %v", err)
+		return 0, fmt.Errorf("failed to create request: %v", err)
 	}
 	req.Header.Set("Content-Type", "application/json")
+	for k, v := range header {
+		req.Header[k] = v
+	}
 
 	client := &http.Client{Timeout: um.responseTimeout}
 	resp, err := client.Do(req)
 	if err != nil {
-		return errors.Join(ErrSendFailure, fmt.Errorf("failed to send HTTP request: %v", err))
+		return 0, errors.Join(ErrSendFailure, fmt.Errorf("failed to send HTTP request: %v", err))
 	}
 	defer resp.Body.Close()
 
-	if resp.StatusCode != http.StatusAccepted {
-		return errors.Join(ErrSendFailure, fmt.Errorf("unexpected status code: %d", resp.StatusCode))
-	}
+	um.pacer.observe(resp.StatusCode, resp.Header, um.timeProvider.Now())
+	return resp.StatusCode, nil
+}
 
+// checkStatus returns an error if status is not the one the server answers accepted reports with.
+func checkStatus(status int) error {
+	if status != http.StatusAccepted {
+		return errors.Join(ErrSendFailure, fmt.Errorf("unexpected status code: %d", status))
+	}
 	return nil
 }
 
@@ -9,6 +9,7 @@ import (
 	"path/filepath"
 	"time"
 
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
 )
 
@@ -42,14 +43,24 @@ type Uploader struct {
 	maxConcurrentUploadsPerSource uint32
 	maxConcurrentSources          uint32
 
+	deltas bool // deltas is true if reports are sent as deltas against the last uploaded one when possible.
+
+	reportSync fileutils.SyncPolicy // reportSync is how durable reports moved in and out of the uploaded directory are.
+
+	scheduled        bool          // scheduled is true if uploads wait for the slot of the machine in the window advertised by the server.
+	maxScheduleDelay time.Duration // maxScheduleDelay is the maximum time to wait for before uploading, whatever the server asks for.
+	machineIDFiles   []string      // machineIDFiles are the files to read the machine ID from, in order of preference.
+	pacer            *pacer
+
 	log *slog.Logger
 }
 
 type options struct {
-	// Private members exported for tests.
 	baseServerURL string
-	maxReports    uint32
-	timeProvider  timeProvider
+
+	// Private members exported for tests.
+	maxReports   uint32
+	timeProvider timeProvider
 
 	baseRetryPeriod time.Duration
 	maxRetryPeriod  time.Duration
@@ -59,6 +70,14 @@ type options struct {
 
 	maxConcurrentUploadsPerSource uint32
 	maxConcurrentSources          uint32
+
+	deltas bool
+
+	reportSync fileutils.SyncPolicy
+
+	scheduled        bool
+	maxScheduleDelay time.Duration
+	machineIDFiles   []string
 }
 
 var defaultOptions = options{
@@ -75,15 +94,23 @@ var defaultOptions = options{
 
 	maxConcurrentUploadsPerSource: constants.MaxConcurrentUploadsPerSource,
 	maxConcurrentSources:          constants.MaxConcurrentSources,
+
+	// A report is only removed once its move survives a power failure, not to be lost or uploaded twice.
+	reportSync: fileutils.SyncFileAndDir,
+
+	maxScheduleDelay: 24 * time.Hour,
+	machineIDFiles:   []string{"/etc/machine-id", "/var/lib/dbus/machine-id"},
 }
 
 // Config represents the uploader specific data needed to upload.
 type Config struct {
-	Sources []string
-	MinAge  uint32 `mapstructure:"minAge"`
-	Force   bool
-	DryRun  bool `mapstructure:"dryRun"`
-	Retry   bool `mapstructure:"retry"`
+	Sources   []string
+	MinAge    uint32 `mapstructure:"minAge"`
+	Force     bool
+	DryRun    bool `mapstructure:"dryRun"`
+	Retry     bool `mapstructure:"retry"`
+	Deltas    bool `mapstructure:"deltas"`
+	Scheduled bool `mapstructure:"scheduled"`
 }
 
 // Sanitize sets defaults and checks that the Config is properly configured.
@@ -103,6 +130,45 @@ func (c *Config) Sanitize(l *slog.Logger, cacheDir string) error {
 // Options represents an optional function to override Upload Manager default values.
 type Options func(*options)
 
+// WithBaseServerURL sets the base URL of the server to upload reports to.
+func WithBaseServerURL(url string) Options {
+	return func(o *options) {
+		o.baseServerURL = url
+	}
+}
+
+// WithResponseTimeout sets how long to wait for the server to answer an upload.
+func WithResponseTimeout(d time.Duration) Options {
+	return func(o *options) {
+		o.responseTimeout = d
+	}
+}
+
+// WithDeltas makes the uploader send reports as deltas against the last report uploaded for their source,
+// when the server still holds it and the delta is smaller than the report.
+func WithDeltas(enabled bool) Options {
+	return func(o *options) {
+		o.deltas = enabled
+	}
+}
+
+// WithReportSync sets how durable reports moved in and out of the uploaded directory are before their original is
+// removed. It defaults to fileutils.SyncFileAndDir.
+func WithReportSync(policy fileutils.SyncPolicy) Options {
+	return func(o *options) {
+		o.reportSync = policy
+	}
+}
+
+// WithSchedule makes UploadAll wait for the upload slot of the machine before uploading, unless forced.
+// The slot is stable for each machine, and spreads uploads over the window advertised by the server.
+// Uploads also wait for any delay the server asked for on a previous run.
+func WithSchedule(enabled bool) Options {
+	return func(o *options) {
+		o.scheduled = enabled
+	}
+}
+
 // Consent is an interface for getting the consent state for a given source.
 type Consent interface {
 	GetState(source string) (bool, error)
@@ -136,6 +202,15 @@ func New(l *slog.Logger, cm Consent, cachePath string, minAge uint32, dryRun boo
 		maxConcurrentUploadsPerSource: opts.maxConcurrentUploadsPerSource,
 		maxConcurrentSources:          opts.maxConcurrentSources,
 
+		deltas: opts.deltas,
+
+		reportSync: opts.reportSync,
+
+		scheduled:        opts.scheduled,
+		maxScheduleDelay: opts.maxScheduleDelay,
+		machineIDFiles:   opts.machineIDFiles,
+		pacer:            &pacer{},
+
 		log: l,
 	}, nil
 }
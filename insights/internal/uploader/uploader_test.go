@@ -3,6 +3,7 @@ package uploader_test
 import (
 	"encoding/json"
 	"fmt"
+	"io"
 	"log/slog"
 	"net/http"
 	"net/http/httptest"
@@ -16,8 +17,11 @@ import (
 	"github.com/stretchr/testify/assert"
 	"github.com/stretchr/testify/require"
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
+	"github.com/ubuntu/ubuntu-insights/common/reportdelta"
 	"github.com/ubuntu/ubuntu-insights/common/testutils"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/report"
 	"github.com/ubuntu/ubuntu-insights/insights/internal/uploader"
 )
 
@@ -88,6 +92,7 @@ func TestUpload(t *testing.T) {
 		force   bool
 
 		skipContentCheck bool
+		wantMinDuration  time.Duration
 		wantErr          bool
 	}{
 		// Basic Tests
@@ -200,6 +205,7 @@ func TestBackoffUpload(t *testing.T) {
 		lFiles, uFiles  map[string]reportType
 		initialResponse int // If initial response is 0 or lower, the server will not respond
 		badCount        int // Number of initialResponses the server will send before an OK response
+		retryAfter      string
 		serverOffline   bool
 
 		rmLocal       bool // Remove the local directory
@@ -211,6 +217,7 @@ func TestBackoffUpload(t *testing.T) {
 		force   bool
 
 		skipContentCheck bool
+		wantMinDuration  time.Duration
 		wantErr          bool
 	}{
 		// Basic Tests
@@ -227,6 +234,9 @@ func TestBackoffUpload(t *testing.T) {
 			consent: cTrue, lFiles: map[string]reportType{"1.json": normal}, initialResponse: -1, badCount: 2},
 		"Retries when server returns a bad response": {
 			consent: cTrue, lFiles: map[string]reportType{"1.json": normal}, initialResponse: http.StatusForbidden, badCount: 2},
+		"Retries after the delay asked by the server": {
+			consent: cTrue, lFiles: map[string]reportType{"1.json": normal}, initialResponse: http.StatusTooManyRequests, badCount: 1,
+			retryAfter: "1", wantMinDuration: time.Second},
 
 		// Timeout Error Tests
 		"Gives up after too many no responses retries": {
@@ -253,6 +263,9 @@ func TestBackoffUpload(t *testing.T) {
 						time.Sleep(4 * time.Second)
 						return
 					}
+					if tc.retryAfter != "" {
+						w.Header().Set(pacing.RetryAfterHeader, tc.retryAfter)
+					}
 					w.WriteHeader(tc.initialResponse)
 					return
 				}
@@ -282,7 +295,9 @@ func TestBackoffUpload(t *testing.T) {
 				uploader.WithMaxAttempts(4))
 			require.NoError(t, err, "Setup: failed to create new uploader manager")
 
+			start := time.Now()
 			err = mgr.BackoffUpload(source, tc.force)
+			assert.GreaterOrEqual(t, time.Since(start), tc.wantMinDuration, "BackoffUpload should wait for the delay asked by the server")
 			if tc.wantErr {
 				require.Error(t, err)
 			} else {
@@ -297,6 +312,297 @@ func TestBackoffUpload(t *testing.T) {
 	}
 }
 
+func TestUploadDeltas(t *testing.T) {
+	t.Parallel()
+
+	const (
+		mockTime = 10
+		source   = "source"
+	)
+
+	type sysInfo struct {
+		CPU, Mem int
+		Name     string
+	}
+	type deltaReport struct{ SystemInfo sysInfo }
+
+	var (
+		older  reportType = deltaReport{SystemInfo: sysInfo{CPU: 2, Mem: 4, Name: "an older report of the machine"}}
+		base   reportType = deltaReport{SystemInfo: sysInfo{CPU: 4, Mem: 8, Name: "a long enough machine name"}}
+		target reportType = deltaReport{SystemInfo: sysInfo{CPU: 8, Mem: 8, Name: "a long enough machine name"}}
+	)
+
+	// request is what the server got from the uploader.
+	type request struct {
+		Base   string // Base is the delta base, empty for full reports.
+		Digest string
+		Body   string
+	}
+
+	tests := map[string]struct {
+		uFiles        map[string]reportType
+		noDeltas      bool
+		unknownBase   bool
+		noConsent     bool
+		wantDeltaBody string
+
+		wantFull bool // wantFull is true if the full report is sent after a delta.
+	}{
+		"Sends the full report with its digest when nothing was uploaded": {},
+		"Sends a delta against the latest uploaded report": {
+			uFiles: map[string]reportType{"1.json": older, "3.json": base}, wantDeltaBody: `{"SystemInfo":{"CPU":8}}`},
+		"Sends the full report when the server does not know the base": {
+			uFiles: map[string]reportType{"3.json": base}, unknownBase: true, wantDeltaBody: `{"SystemInfo":{"CPU":8}}`, wantFull: true},
+		"Sends the full report when the delta is not smaller": {
+			uFiles: map[string]reportType{"3.json": optOut}},
+		"Sends the full report when the latest uploaded report is invalid": {
+			uFiles: map[string]reportType{"1.json": base, "3.json": badContent}},
+		"Sends the full report without digest when deltas are disabled": {
+			uFiles: map[string]reportType{"3.json": base}, noDeltas: true},
+		"Sends the opt-out report as a delta": {
+			uFiles: map[string]reportType{"3.json": optOut}, noConsent: true, wantDeltaBody: `{}`},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+			dir := setupTmpDir(t, map[string]reportType{"5.json": target}, tc.uFiles, source)
+			consent := cTrue
+			if tc.noConsent {
+				consent = cFalse
+			}
+
+			var (
+				mu   sync.Mutex
+				reqs []request
+			)
+			ts := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+				body, err := io.ReadAll(r.Body)
+				assert.NoError(t, err, "Server failed to read request body")
+
+				mu.Lock()
+				reqs = append(reqs, request{
+					Base:   r.Header.Get(reportdelta.BaseHeader),
+					Digest: r.Header.Get(reportdelta.DigestHeader),
+					Body:   string(body),
+				})
+				mu.Unlock()
+
+				if r.Header.Get(reportdelta.BaseHeader) != "" {
+					assert.Equal(t, reportdelta.ContentType, r.Header.Get("Content-Type"), "Deltas should have the merge patch content type")
+					if tc.unknownBase {
+						http.Error(w, reportdelta.UnknownBase, http.StatusConflict)
+						return
+					}
+				}
+				w.WriteHeader(http.StatusAccepted)
+			}))
+			t.Cleanup(func() { ts.Close() })
+
+			mgr, err := uploader.New(slog.Default(), consent, dir, 0, false,
+				uploader.WithBaseServerURL(ts.URL),
+				uploader.WithTimeProvider(uploader.MockTimeProvider{CurrentTime: mockTime}),
+				uploader.WithDeltas(!tc.noDeltas))
+			require.NoError(t, err, "Setup: failed to create new uploader manager")
+			require.NoError(t, mgr.Upload(source, false), "Upload should not return an error")
+
+			full, err := os.ReadFile(filepath.Join(dir, source, constants.UploadedFolder, "5.json"))
+			require.NoError(t, err, "Uploaded report should be in the uploaded folder")
+			fullDigest := canonicalDigest(t, full)
+			if tc.noDeltas {
+				fullDigest = ""
+			}
+
+			var want []request
+			if tc.wantDeltaBody != "" {
+				latest, err := os.ReadFile(filepath.Join(dir, source, constants.UploadedFolder, "3.json"))
+				require.NoError(t, err, "Setup: failed to read the delta base")
+				want = append(want, request{Base: canonicalDigest(t, latest), Digest: fullDigest, Body: tc.wantDeltaBody})
+			}
+			if tc.wantDeltaBody == "" || tc.wantFull {
+				want = append(want, request{Digest: fullDigest, Body: string(full)})
+			}
+			assert.Equal(t, want, reqs, "Server should get the expected requests")
+		})
+	}
+}
+
+func TestUploadDeltasSharedBase(t *testing.T) {
+	t.Parallel()
+
+	const (
+		numReports = 5
+		source     = "source"
+	)
+
+	type deltaReport struct{ CPU, Mem int }
+
+	tests := map[string]struct {
+		unknownBase bool
+
+		wantDeltas int
+		wantFull   int
+	}{
+		"Sends all reports as deltas against a known base": {wantDeltas: numReports},
+		"Stops sending deltas against a base the server does not know": {
+			unknownBase: true, wantDeltas: 1, wantFull: numReports},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			localFiles := make(map[string]reportType, numReports)
+			for i := range numReports {
+				localFiles[fmt.Sprintf("%d.json", 5+i)] = deltaReport{CPU: 8 + i, Mem: 8}
+			}
+			dir := setupTmpDir(t, localFiles, map[string]reportType{"3.json": deltaReport{CPU: 4, Mem: 8}}, source)
+
+			var deltas, full atomic.Int32
+			ts := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+				if r.Header.Get(reportdelta.BaseHeader) == "" {
+					full.Add(1)
+					w.WriteHeader(http.StatusAccepted)
+					return
+				}
+				deltas.Add(1)
+				if tc.unknownBase {
+					http.Error(w, reportdelta.UnknownBase, http.StatusConflict)
+					return
+				}
+				w.WriteHeader(http.StatusAccepted)
+			}))
+			t.Cleanup(func() { ts.Close() })
+
+			mgr, err := uploader.New(slog.Default(), cTrue, dir, 0, false,
+				uploader.WithBaseServerURL(ts.URL),
+				uploader.WithTimeProvider(uploader.MockTimeProvider{CurrentTime: 10 + numReports}),
+				uploader.WithDeltas(true))
+			require.NoError(t, err, "Setup: failed to create new uploader manager")
+			require.NoError(t, mgr.Upload(source, false), "Upload should not return an error")
+
+			assert.EqualValues(t, tc.wantDeltas, deltas.Load(), "Server should get the expected number of deltas")
+			assert.EqualValues(t, tc.wantFull, full.Load(), "Server should get the expected number of full reports")
+		})
+	}
+}
+
+func TestUploadAllSchedule(t *testing.T) {
+	t.Parallel()
+
+	const (
+		mockTime  = 10
+		source    = "source"
+		machineID = "0123456789abcdef0123456789abcdef"
+	)
+	now := time.Unix(mockTime, 0)
+
+	tests := map[string]struct {
+		schedule    *uploader.Schedule
+		badSchedule bool
+		window      string // window is the upload window advertised by the server.
+		retryAfter  string
+		noSchedule  bool
+		force       bool
+		maxDelay    time.Duration
+
+		wantWait     time.Duration
+		wantMaxWait  time.Duration // Default 1s after wantWait.
+		wantSchedule *uploader.Schedule
+	}{
+		"Uploads right away without schedule": {},
+		"Saves the pacing asked for by the server": {
+			window: "3600", retryAfter: "120", wantSchedule: &uploader.Schedule{Window: time.Hour, NotBefore: now.Add(2 * time.Minute)}},
+		"Replaces an invalid schedule": {
+			badSchedule: true, window: "60", wantSchedule: &uploader.Schedule{Window: time.Minute}},
+
+		"Waits for the slot of the machine in the window": {
+			schedule: &uploader.Schedule{Window: 500 * time.Millisecond}, wantWait: uploader.SlotDelay(machineID, 500*time.Millisecond, now)},
+		"Turns the window off when the server advertises none": {
+			schedule: &uploader.Schedule{Window: 500 * time.Millisecond}, window: "0",
+			wantWait: uploader.SlotDelay(machineID, 500*time.Millisecond, now), wantSchedule: &uploader.Schedule{}},
+		"Waits for the delay asked for on a previous run": {
+			schedule: &uploader.Schedule{NotBefore: now.Add(300 * time.Millisecond)}, wantWait: 300 * time.Millisecond},
+		"Waits for the slot of the machine after the delay asked for": {
+			schedule: &uploader.Schedule{Window: 500 * time.Millisecond, NotBefore: now.Add(300 * time.Millisecond)},
+			wantWait: 300*time.Millisecond + uploader.SlotDelay(machineID, 500*time.Millisecond, now.Add(300*time.Millisecond))},
+		"Waits no longer than the maximum delay": {
+			schedule: &uploader.Schedule{Window: time.Hour, NotBefore: now.Add(time.Hour)}, maxDelay: 100 * time.Millisecond,
+			wantWait: 100 * time.Millisecond},
+
+		"Does not wait when forced": {
+			schedule: &uploader.Schedule{NotBefore: now.Add(time.Hour)}, force: true, maxDelay: 5 * time.Second},
+		"Does not wait nor save the pacing when not scheduled": {
+			schedule: &uploader.Schedule{NotBefore: now.Add(time.Hour)}, window: "60", noSchedule: true, maxDelay: 5 * time.Second},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+			dir := setupTmpDir(t, map[string]reportType{"1.json": normal}, nil, source)
+			schedulePath := filepath.Join(dir, constants.ScheduleFileName)
+			if tc.schedule != nil {
+				data, err := json.Marshal(tc.schedule)
+				require.NoError(t, err, "Setup: failed to encode schedule")
+				require.NoError(t, os.WriteFile(schedulePath, data, 0600), "Setup: failed to write schedule")
+				if tc.wantSchedule == nil {
+					tc.wantSchedule = tc.schedule
+				}
+			}
+			if tc.badSchedule {
+				require.NoError(t, os.WriteFile(schedulePath, []byte("not a schedule"), 0600), "Setup: failed to write schedule")
+			}
+			if tc.maxDelay == 0 {
+				tc.maxDelay = time.Hour
+			}
+			if tc.wantMaxWait == 0 {
+				tc.wantMaxWait = tc.wantWait + time.Second
+			}
+
+			machineIDFile := filepath.Join(t.TempDir(), "machine-id")
+			require.NoError(t, os.WriteFile(machineIDFile, []byte(machineID+"\n"), 0600), "Setup: failed to write machine ID")
+
+			ts := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+				if tc.window != "" {
+					w.Header().Set(pacing.WindowHeader, tc.window)
+				}
+				if tc.retryAfter != "" {
+					w.Header().Set(pacing.RetryAfterHeader, tc.retryAfter)
+				}
+				w.WriteHeader(http.StatusAccepted)
+			}))
+			t.Cleanup(func() { ts.Close() })
+
+			mgr, err := uploader.New(slog.Default(), cTrue, dir, 0, false,
+				uploader.WithBaseServerURL(ts.URL),
+				uploader.WithTimeProvider(uploader.MockTimeProvider{CurrentTime: mockTime}),
+				uploader.WithSchedule(!tc.noSchedule),
+				uploader.WithMaxScheduleDelay(tc.maxDelay),
+				uploader.WithMachineIDFiles(machineIDFile))
+			require.NoError(t, err, "Setup: failed to create new uploader manager")
+
+			start := time.Now()
+			require.NoError(t, mgr.UploadAll([]string{source}, tc.force, false), "UploadAll should not return an error")
+			elapsed := time.Since(start)
+			assert.GreaterOrEqual(t, elapsed, tc.wantWait, "UploadAll should wait for the upload slot")
+			assert.Less(t, elapsed, tc.wantMaxWait, "UploadAll should not wait longer than the upload slot")
+			require.FileExists(t, filepath.Join(dir, source, constants.UploadedFolder, "1.json"), "Report should be uploaded")
+
+			if tc.wantSchedule == nil {
+				require.NoFileExists(t, schedulePath, "UploadAll should not save a schedule")
+				return
+			}
+			data, err := os.ReadFile(schedulePath)
+			require.NoError(t, err, "UploadAll should keep the schedule")
+			var got uploader.Schedule
+			require.NoError(t, json.Unmarshal(data, &got), "Schedule should be valid")
+			assert.Equal(t, tc.wantSchedule.Window, got.Window, "Schedule should have the window advertised by the server")
+			assert.True(t, tc.wantSchedule.NotBefore.Equal(got.NotBefore), "Schedule should have the delay asked for by the server, want %v, got %v",
+				tc.wantSchedule.NotBefore, got.NotBefore)
+		})
+	}
+}
+
 func TestGetAllSources(t *testing.T) {
 	t.Parallel()
 
@@ -436,6 +742,79 @@ func TestUploadAllRespectsConcurrencyLimits(t *testing.T) {
 	assert.EqualValues(t, maxConcurrentUploads*maxConcurrentSources, maxActiveRequests, "Max concurrent uploads should match the expected value")
 }
 
+func TestConcurrentUploads(t *testing.T) {
+	t.Parallel()
+
+	const (
+		numReports   = 10
+		source       = "source"
+		lockDeadline = 5 * time.Second
+	)
+	localFiles := make(map[string]reportType, numReports)
+	for i := range numReports {
+		localFiles[fmt.Sprintf("%d.json", i)] = normal
+	}
+	dir := setupTmpDir(t, localFiles, nil, source)
+
+	var requests atomic.Int32
+	ts := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, _ *http.Request) {
+		requests.Add(1)
+
+		// The store must not stay locked while reports are sent.
+		locked := make(chan struct{})
+		go func() {
+			unlock, err := report.LockStore(slog.Default(), filepath.Join(dir, source), true)
+			if err != nil {
+				return
+			}
+			close(locked)
+			unlock()
+		}()
+		select {
+		case <-locked:
+			w.WriteHeader(http.StatusAccepted)
+		case <-time.After(lockDeadline):
+			w.WriteHeader(http.StatusInternalServerError)
+		}
+	}))
+	t.Cleanup(ts.Close)
+
+	// Both uploads list the same reports, but each report is only sent by one of them.
+	errs := make([]error, 2)
+	var wg sync.WaitGroup
+	for i := range errs {
+		um, err := uploader.New(slog.Default(), cTrue, dir, 0, false, uploader.WithBaseServerURL(ts.URL))
+		require.NoError(t, err, "Setup: failed to create new uploader manager")
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			errs[i] = um.Upload(source, false)
+		}()
+	}
+	wg.Wait()
+
+	for _, err := range errs {
+		require.NoError(t, err, "Upload should not return an error")
+	}
+	assert.EqualValues(t, numReports, requests.Load(), "Each report should be sent once")
+
+	local, err := os.ReadDir(filepath.Join(dir, source, constants.LocalFolder))
+	require.NoError(t, err, "Failed to read local reports directory")
+	assert.Empty(t, local, "All reports should have been uploaded")
+	uploaded, err := os.ReadDir(filepath.Join(dir, source, constants.UploadedFolder))
+	require.NoError(t, err, "Failed to read uploaded reports directory")
+	assert.Len(t, uploaded, numReports, "All reports should be marked as uploaded")
+}
+
+// canonicalDigest returns the digest of the canonical encoding of report.
+func canonicalDigest(t *testing.T, report []byte) string {
+	t.Helper()
+
+	c, err := reportdelta.Canonical(report)
+	require.NoError(t, err, "Setup: failed to get canonical report")
+	return reportdelta.Digest(c)
+}
+
 func setupTmpDir(t *testing.T, localFiles, uploadedFiles map[string]reportType, sources ...string) string {
 	t.Helper()
 	dir := t.TempDir()
@@ -0,0 +1,55 @@
+//go:build tools
+
+package main
+
+import (
+	"fmt"
+	"math"
+	"math/rand"
+	"slices"
+	"time"
+)
+
+// pattern is how clients arrive over the run.
+type pattern string
+
+const (
+	// patternSteady is clients arriving independently at a constant rate, as the upload timer makes them.
+	patternSteady pattern = "steady"
+	// patternRelease is most clients arriving at the beginning of the run, like when a release reaches the fleet.
+	patternRelease pattern = "release"
+	// patternBacklog is the clients which could not upload during an outage arriving at once when it ends,
+	// with the others arriving steadily.
+	patternBacklog pattern = "backlog"
+)
+
+const (
+	// releaseMean is the mean arrival offset of clients for the release pattern, as a fraction of the run.
+	releaseMean = 0.1
+	// backlogFraction is the fraction of clients which arrive at once for the backlog pattern.
+	backlogFraction = 0.5
+)
+
+// arrivals returns when each of the n clients arrives over d, in order.
+func (p pattern) arrivals(rng *rand.Rand, n int, d time.Duration) ([]time.Duration, error) {
+	offsets := make([]time.Duration, n)
+	for i := range offsets {
+		var f float64
+		switch p {
+		case patternSteady:
+			f = rng.Float64()
+		case patternRelease:
+			// Exponentially decaying arrivals, folded back into the run.
+			f = math.Mod(rng.ExpFloat64()*releaseMean, 1)
+		case patternBacklog:
+			if rng.Float64() >= backlogFraction {
+				f = rng.Float64()
+			}
+		default:
+			return nil, fmt.Errorf("unknown arrival pattern %q", p)
+		}
+		offsets[i] = time.Duration(f * float64(d))
+	}
+	slices.Sort(offsets)
+	return offsets, nil
+}
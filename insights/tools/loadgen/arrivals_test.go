@@ -0,0 +1,67 @@
+//go:build tools
+
+package main
+
+import (
+	"math/rand"
+	"slices"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+)
+
+func TestArrivals(t *testing.T) {
+	t.Parallel()
+
+	const (
+		clients  = 10000
+		duration = time.Hour
+	)
+
+	tests := map[string]struct {
+		pattern pattern
+
+		// wantEarly is the expected fraction of clients arriving in the first tenth of the run, within 5%.
+		wantEarly float64
+		// wantAtStart is the expected fraction of clients arriving right at the start of the run, within 5%.
+		wantAtStart float64
+		wantErr     bool
+	}{
+		"Steady clients arrive evenly":                  {pattern: patternSteady, wantEarly: 0.1},
+		"Release clients mostly arrive early":           {pattern: patternRelease, wantEarly: 0.63},
+		"Backlog clients arrive at once, then steadily": {pattern: patternBacklog, wantEarly: 0.55, wantAtStart: 0.5},
+		"Error on unknown pattern":                      {pattern: "burst", wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			got, err := tc.pattern.arrivals(rand.New(rand.NewSource(1)), clients, duration) // #nosec:G404 Reproducible test data.
+			if tc.wantErr {
+				require.Error(t, err, "arrivals should return an error")
+				return
+			}
+			require.NoError(t, err, "arrivals should not return an error")
+
+			require.Len(t, got, clients, "arrivals should return an offset per client")
+			assert.True(t, slices.IsSorted(got), "arrivals should be sorted")
+			assert.GreaterOrEqual(t, got[0], time.Duration(0), "arrivals should not be before the run")
+			assert.Less(t, got[len(got)-1], duration, "arrivals should be within the run")
+
+			var early, atStart int
+			for _, o := range got {
+				if o < duration/10 {
+					early++
+				}
+				if o == 0 {
+					atStart++
+				}
+			}
+			assert.InDelta(t, tc.wantEarly, float64(early)/clients, 0.05, "Unexpected fraction of early arrivals")
+			assert.InDelta(t, tc.wantAtStart, float64(atStart)/clients, 0.05, "Unexpected fraction of arrivals at start")
+		})
+	}
+}
@@ -0,0 +1,147 @@
+//go:build tools
+
+package main
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"math/rand"
+	"strconv"
+	"time"
+
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/collector/sysinfo"
+	"github.com/ubuntu/ubuntu-insights/insights/internal/constants"
+)
+
+// Values system information fixtures are picked from.
+var (
+	products = [][3]string{
+		{"ThinkPad", "ThinkPad X1 Carbon Gen 11", "LENOVO"},
+		{"XPS", "XPS 13 9340", "Dell Inc."},
+		{"HP EliteBook", "HP EliteBook 840 G10", "HP"},
+		{"Virtual Machine", "Standard PC (Q35 + ICH9, 2009)", "QEMU"},
+		{"Raspberry Pi", "Raspberry Pi 5 Model B", "Raspberry Pi Foundation"},
+	}
+	cpus = [][3]string{
+		{"13th Gen Intel(R) Core(TM) i7-1365U", "GenuineIntel", "x86_64"},
+		{"AMD Ryzen 7 7840U w/ Radeon 780M Graphics", "AuthenticAMD", "x86_64"},
+		{"Cortex-A76", "ARM", "aarch64"},
+	}
+	gpus = [][2]string{
+		{"0x8086", "i915"},
+		{"0x1002", "amdgpu"},
+		{"0x10de", "nvidia"},
+	}
+	distros     = []string{"20.04", "22.04", "24.04", "24.10", "25.04"}
+	zones       = []string{"UTC", "Europe/London", "America/New_York", "Asia/Tokyo", "America/Sao_Paulo"}
+	langs       = []string{"en_US", "en_GB", "fr_FR", "de_DE", "pt_BR", "zh_CN"}
+	resolutions = []string{"1920x1080", "2560x1440", "3840x2160", "1366x768"}
+)
+
+// newFleet returns the encoded reports of n clients, of which a fraction optOut sends opt-out reports.
+// Other reports have source metrics of a random size up to maxMetrics bytes.
+func newFleet(rng *rand.Rand, n int, optOut float64, maxMetrics int) ([][]byte, error) {
+	reports := make([][]byte, n)
+	now := time.Now()
+	for i := range reports {
+		if rng.Float64() < optOut {
+			reports[i] = constants.OptOutPayload
+			continue
+		}
+
+		info, err := newSysInfo(rng)
+		if err != nil {
+			return nil, err
+		}
+		insights := collector.Insights{
+			InsightsVersion: constants.Version,
+			CollectionTime:  now.Add(-time.Duration(rng.Int63n(int64(7 * 24 * time.Hour)))).Unix(),
+			SysInfo:         info,
+		}
+		if maxMetrics > 0 {
+			insights.SourceMetrics = newSourceMetrics(rng, rng.Intn(maxMetrics+1))
+		}
+
+		e, err := collector.NewEncoded(insights)
+		if err != nil {
+			return nil, err
+		}
+		reports[i] = e.JSON()
+	}
+	return reports, nil
+}
+
+// newSysInfo returns random system information.
+// It is decoded from its JSON form, so that fixtures are checked against the fields the collector reports.
+func newSysInfo(rng *rand.Rand) (sysinfo.Info, error) {
+	product := products[rng.Intn(len(products))]
+	cpu := cpus[rng.Intn(len(cpus))]
+	sockets, cores, threads := 1, 2<<rng.Intn(4), 1+rng.Intn(2)
+
+	gpuList := make([]any, rng.Intn(3))
+	for i := range gpuList {
+		g := gpus[rng.Intn(len(gpus))]
+		gpuList[i] = map[string]any{"device": fmt.Sprintf("0x%04x", rng.Intn(1<<16)), "vendor": g[0], "driver": g[1]}
+	}
+	diskList := make([]any, 1+rng.Intn(2))
+	for i := range diskList {
+		diskList[i] = map[string]any{
+			"size": 1 << (7 + rng.Intn(4)) * 1024,
+			"type": "disk",
+			"children": []any{
+				map[string]any{"size": 512, "type": "part"},
+				map[string]any{"size": 1 << (6 + rng.Intn(4)) * 1024, "type": "part"},
+			},
+		}
+	}
+	screenList := make([]any, rng.Intn(3))
+	for i := range screenList {
+		screenList[i] = map[string]any{"resolution": resolutions[rng.Intn(len(resolutions))], "refreshRate": strconv.Itoa(60 * (1 + rng.Intn(2)))}
+	}
+
+	fixture := map[string]any{
+		"hardware": map[string]any{
+			"product": map[string]any{"family": product[0], "name": product[1], "vendor": product[2]},
+			"cpu": map[string]any{
+				"name": cpu[0], "vendor": cpu[1], "architecture": cpu[2],
+				"cpus": sockets * cores * threads, "sockets": sockets, "coresPerSocket": cores, "threadsPerCore": threads,
+			},
+			"gpus":    gpuList,
+			"memory":  map[string]any{"size": 1024 << (2 + rng.Intn(5))},
+			"disks":   diskList,
+			"screens": screenList,
+		},
+		"software": map[string]any{
+			"os":       map[string]any{"family": "linux", "distribution": "Ubuntu", "version": distros[rng.Intn(len(distros))]},
+			"timezone": zones[rng.Intn(len(zones))],
+			"language": langs[rng.Intn(len(langs))],
+			"bios":     map[string]any{"vendor": product[2], "version": fmt.Sprintf("1.%d.%d", rng.Intn(30), rng.Intn(10))},
+		},
+	}
+
+	data, err := json.Marshal(fixture)
+	if err != nil {
+		return sysinfo.Info{}, fmt.Errorf("failed to encode system information fixture: %v", err)
+	}
+	var info sysinfo.Info
+	d := json.NewDecoder(bytes.NewReader(data))
+	d.DisallowUnknownFields()
+	if err := d.Decode(&info); err != nil {
+		return sysinfo.Info{}, fmt.Errorf("system information fixture does not match the collector: %v", err)
+	}
+	return info, nil
+}
+
+// newSourceMetrics returns source metrics of about size bytes.
+func newSourceMetrics(rng *rand.Rand, size int) json.RawMessage {
+	m := []byte{'{'}
+	for i := 0; len(m) < size-1; i++ {
+		if i > 0 {
+			m = append(m, ',')
+		}
+		m = fmt.Appendf(m, `"metric%d":%d`, i, rng.Int63())
+	}
+	return append(m, '}')
+}
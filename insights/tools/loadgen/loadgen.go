@@ -0,0 +1,132 @@
+//go:build tools
+
+// Command loadgen simulates a fleet of clients uploading reports to a web service, and reports how it coped.
+//
+// Usage, from the root of the repository:
+//
+//	go run -tags=tools ./insights/tools/loadgen [flags]
+//
+// Reports are built with the collector from randomized system information, and sent by the uploader the way
+// clients send them. They are all generated before the run, so that only the server is measured.
+//
+// It is meant to run against a web service on localhost, with the source allowed in its configuration, and rate
+// limiting left disabled as all the clients share the same address:
+//
+//	echo '{"allowList": ["linux"]}' > /tmp/loadgen.json
+//	ubuntu-insights-web-service /tmp/loadgen.json --reports-dir /tmp/loadgen-reports
+//	go run -tags=tools ./insights/tools/loadgen -clients 5000 -duration 1m -pattern release
+package main
+
+import (
+	"flag"
+	"fmt"
+	"io"
+	"log/slog"
+	"math/rand"
+	"net/url"
+	"os"
+	"sync"
+	"time"
+
+	"github.com/ubuntu/ubuntu-insights/insights/internal/uploader"
+)
+
+// config is the fleet to simulate.
+type config struct {
+	url    string
+	source string
+
+	clients     int
+	duration    time.Duration
+	pattern     pattern
+	optOut      float64
+	metrics     int
+	concurrency int
+	timeout     time.Duration
+	seed        int64
+}
+
+// result is the outcome of the upload of a client.
+type result struct {
+	start   time.Duration // start is when the report was sent, since the beginning of the run.
+	latency time.Duration
+	size    int
+	status  int
+	err     error
+}
+
+func main() {
+	var c config
+	var p string
+	flag.StringVar(&c.url, "url", "http://localhost:8080", "base URL of the web service")
+	flag.StringVar(&c.source, "source", "linux", "source to upload reports for, which must be allowed by the web service")
+	flag.IntVar(&c.clients, "clients", 1000, "number of clients uploading a report")
+	flag.DurationVar(&c.duration, "duration", time.Minute, "period over which clients arrive")
+	flag.StringVar(&p, "pattern", string(patternSteady), "arrival pattern of the clients: steady, release or backlog")
+	flag.Float64Var(&c.optOut, "opt-out", 0.1, "fraction of clients sending opt-out reports")
+	flag.IntVar(&c.metrics, "metrics-bytes", 0, "maximum size of the source metrics of reports, each getting a random size up to it")
+	flag.IntVar(&c.concurrency, "concurrency", 256, "maximum number of uploads in flight")
+	flag.DurationVar(&c.timeout, "timeout", 10*time.Second, "time to wait for the web service to answer an upload")
+	flag.Int64Var(&c.seed, "seed", 1, "seed of the random fleet, for runs to be reproducible")
+	flag.Parse()
+	c.pattern = pattern(p)
+
+	if err := run(os.Stdout, c); err != nil {
+		fmt.Fprintf(os.Stderr, "Load generation failed: %v\n", err)
+		os.Exit(1)
+	}
+}
+
+func run(w io.Writer, c config) error {
+	if c.clients <= 0 || c.concurrency <= 0 || c.duration < 0 {
+		return fmt.Errorf("clients and concurrency must be positive, and duration not negative")
+	}
+	if c.optOut < 0 || c.optOut > 1 {
+		return fmt.Errorf("opt-out fraction must be between 0 and 1, got %v", c.optOut)
+	}
+	if _, err := url.Parse(c.url); err != nil {
+		return fmt.Errorf("invalid web service URL: %v", err)
+	}
+
+	rng := rand.New(rand.NewSource(c.seed)) // #nosec:G404 The fleet is meant to be reproducible.
+	offsets, err := c.pattern.arrivals(rng, c.clients, c.duration)
+	if err != nil {
+		return err
+	}
+	reports, err := newFleet(rng, c.clients, c.optOut, c.metrics)
+	if err != nil {
+		return err
+	}
+
+	// The uploader only logs what the run summarizes anyway.
+	l := slog.New(slog.NewTextHandler(os.Stderr, &slog.HandlerOptions{Level: slog.LevelError}))
+	u, err := uploader.New(l, nil, "", 0, false, uploader.WithBaseServerURL(c.url), uploader.WithResponseTimeout(c.timeout))
+	if err != nil {
+		return fmt.Errorf("failed to create uploader: %v", err)
+	}
+
+	fmt.Fprintf(w, "Simulating %d clients over %v with the %s pattern against %s\n", c.clients, c.duration, c.pattern, c.url)
+
+	results := make([]result, c.clients)
+	sem := make(chan struct{}, c.concurrency)
+	var wg sync.WaitGroup
+	begin := time.Now()
+	for i, offset := range offsets {
+		time.Sleep(time.Until(begin.Add(offset)))
+		sem <- struct{}{} // Uploads are late rather than dropped when too many are in flight.
+
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			defer func() { <-sem }()
+
+			start := time.Now()
+			status, err := u.SendReport(c.source, reports[i])
+			results[i] = result{start: start.Sub(begin), latency: time.Since(start), size: len(reports[i]), status: status, err: err}
+		}()
+	}
+	wg.Wait()
+
+	summarize(w, results, time.Since(begin))
+	return nil
+}
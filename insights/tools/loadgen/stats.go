@@ -0,0 +1,110 @@
+//go:build tools
+
+package main
+
+import (
+	"fmt"
+	"io"
+	"maps"
+	"net/http"
+	"slices"
+	"strings"
+	"time"
+)
+
+const (
+	// barWidth is the width of the longest bar of histograms.
+	barWidth = 50
+	// throughputPeriods is the number of periods the run is split into for the throughput histogram.
+	throughputPeriods = 20
+)
+
+// summarize writes the outcome of the uploads in results, in a run which lasted elapsed, to w.
+func summarize(w io.Writer, results []result, elapsed time.Duration) {
+	statuses := make(map[string]int)
+	var latencies []time.Duration
+	var sent int
+	var firstErr error
+	for _, r := range results {
+		sent += r.size
+		if r.err != nil {
+			statuses["error"]++
+			if firstErr == nil {
+				firstErr = r.err
+			}
+			continue
+		}
+		statuses[fmt.Sprintf("%d %s", r.status, http.StatusText(r.status))]++
+		latencies = append(latencies, r.latency)
+	}
+
+	fmt.Fprintf(w, "\nSent %d reports (%d bytes) in %v: %.1f reports/s\n", len(results), sent, elapsed.Round(time.Millisecond),
+		float64(len(results))/elapsed.Seconds())
+
+	fmt.Fprintln(w, "\nAnswers:")
+	for _, s := range slices.Sorted(maps.Keys(statuses)) {
+		fmt.Fprintf(w, "  %-28s %d\n", s, statuses[s])
+	}
+	if firstErr != nil {
+		fmt.Fprintf(w, "  First error: %v\n", firstErr)
+	}
+
+	if len(latencies) == 0 {
+		return
+	}
+	slices.Sort(latencies)
+	fmt.Fprintln(w, "\nLatency of answered uploads:")
+	for _, p := range []float64{50, 90, 99, 99.9, 100} {
+		fmt.Fprintf(w, "  p%-6v %v\n", p, percentile(latencies, p).Round(time.Microsecond))
+	}
+
+	labels, counts := latencyBuckets(latencies)
+	fmt.Fprintln(w, "\nLatency histogram:")
+	histogram(w, labels, counts)
+
+	period := max(elapsed/throughputPeriods, time.Millisecond)
+	fmt.Fprintf(w, "\nThroughput histogram (uploads completed per %v):\n", period.Round(time.Millisecond))
+	labels, counts = throughputBuckets(results, elapsed, period)
+	histogram(w, labels, counts)
+}
+
+// percentile returns the p-th percentile of sorted, which must not be empty.
+func percentile(sorted []time.Duration, p float64) time.Duration {
+	return sorted[min(int(p/100*float64(len(sorted))), len(sorted)-1)]
+}
+
+// latencyBuckets counts the latencies of sorted in buckets bounded by powers of two of a millisecond, up to the
+// slowest one, and returns the label and count of each bucket.
+func latencyBuckets(sorted []time.Duration) (labels []string, counts []int) {
+	for i, upper := 0, time.Millisecond; i < len(sorted); upper *= 2 {
+		n := 0
+		for ; i < len(sorted) && sorted[i] < upper; i++ {
+			n++
+		}
+		labels = append(labels, "< "+upper.String())
+		counts = append(counts, n)
+	}
+	return labels, counts
+}
+
+// throughputBuckets counts the uploads of results completed in each period of a run which lasted elapsed, and returns
+// the label and count of each period.
+func throughputBuckets(results []result, elapsed, period time.Duration) (labels []string, counts []int) {
+	counts = make([]int, elapsed/period+1)
+	labels = make([]string, len(counts))
+	for _, r := range results {
+		counts[min((r.start+r.latency)/period, time.Duration(len(counts)-1))]++
+	}
+	for i := range labels {
+		labels[i] = (time.Duration(i) * period).Round(time.Millisecond).String()
+	}
+	return labels, counts
+}
+
+// histogram writes labelled counts as bars to w.
+func histogram(w io.Writer, labels []string, counts []int) {
+	top := max(slices.Max(counts), 1)
+	for i, n := range counts {
+		fmt.Fprintf(w, "  %12s %8d %s\n", labels[i], n, strings.Repeat("#", n*barWidth/top))
+	}
+}
@@ -0,0 +1,123 @@
+//go:build tools
+
+package main
+
+import (
+	"bytes"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+)
+
+func TestPercentile(t *testing.T) {
+	t.Parallel()
+
+	ms := func(n int) time.Duration { return time.Duration(n) * time.Millisecond }
+	sorted := []time.Duration{ms(1), ms(2), ms(3), ms(4), ms(5), ms(6), ms(7), ms(8), ms(9), ms(10)}
+
+	tests := map[string]struct {
+		sorted []time.Duration
+		p      float64
+
+		want time.Duration
+	}{
+		"Median":                {sorted: sorted, p: 50, want: ms(6)},
+		"90th percentile":       {sorted: sorted, p: 90, want: ms(10)},
+		"Lowest":                {sorted: sorted, p: 0, want: ms(1)},
+		"Highest":               {sorted: sorted, p: 100, want: ms(10)},
+		"Fractional percentile": {sorted: sorted, p: 99.9, want: ms(10)},
+		"Single latency":        {sorted: []time.Duration{ms(3)}, p: 50, want: ms(3)},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			assert.Equal(t, tc.want, percentile(tc.sorted, tc.p), "percentile should return the expected latency")
+		})
+	}
+}
+
+func TestLatencyBuckets(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		sorted []time.Duration
+
+		wantLabels []string
+		wantCounts []int
+	}{
+		"No latencies": {},
+		"Buckets by powers of two": {
+			sorted:     []time.Duration{500 * time.Microsecond, time.Millisecond, 3 * time.Millisecond, 3 * time.Millisecond},
+			wantLabels: []string{"< 1ms", "< 2ms", "< 4ms"},
+			wantCounts: []int{1, 1, 2},
+		},
+		"Keeps empty buckets below the slowest": {
+			sorted:     []time.Duration{10 * time.Millisecond},
+			wantLabels: []string{"< 1ms", "< 2ms", "< 4ms", "< 8ms", "< 16ms"},
+			wantCounts: []int{0, 0, 0, 0, 1},
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			labels, counts := latencyBuckets(tc.sorted)
+			assert.Equal(t, tc.wantLabels, labels, "latencyBuckets should return the expected labels")
+			assert.Equal(t, tc.wantCounts, counts, "latencyBuckets should return the expected counts")
+		})
+	}
+}
+
+func TestThroughputBuckets(t *testing.T) {
+	t.Parallel()
+
+	results := []result{
+		{start: 0, latency: 100 * time.Millisecond},
+		{start: 900 * time.Millisecond, latency: 50 * time.Millisecond},
+		{start: 1500 * time.Millisecond, latency: 200 * time.Millisecond},
+		// Completed after the end of the run.
+		{start: 1900 * time.Millisecond, latency: 500 * time.Millisecond},
+	}
+
+	labels, counts := throughputBuckets(results, 2*time.Second, time.Second)
+	assert.Equal(t, []string{"0s", "1s", "2s"}, labels, "throughputBuckets should label each period with its start")
+	assert.Equal(t, []int{2, 1, 1}, counts, "throughputBuckets should count the uploads completed in each period")
+}
+
+func TestHistogram(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		labels []string
+		counts []int
+
+		want string
+	}{
+		"Scales bars to the largest count": {
+			labels: []string{"a", "b", "c"},
+			counts: []int{2, 4, 0},
+			want: "             a        2 #########################\n" +
+				"             b        4 ##################################################\n" +
+				"             c        0 \n",
+		},
+		"Draws no bars without counts": {
+			labels: []string{"a"},
+			counts: []int{0},
+			want:   "             a        0 \n",
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			var b bytes.Buffer
+			histogram(&b, tc.labels, tc.counts)
+			assert.Equal(t, tc.want, b.String(), "histogram should draw the expected bars")
+		})
+	}
+}
@@ -98,8 +98,35 @@ func installRootCmd(app *App) {
 		MaxHeaderBytes: 1 << 13, // 8 KB
 		MaxUploadBytes: 1 << 17, // 128 KB
 
+		// Long enough for clients to upload their backlog over a single connection.
+		IdleTimeout: 30 * time.Second,
+
+		// Reports are left for the kernel to flush, not to wait on the disk for each upload.
+		SpoolSync: "none",
+
+		MaxDeltaBaseBytes: 0, // Deltas are opt-in.
+		UploadWindow:      0, // Clients upload on their own schedule.
+
+		SpoolMaxReports: 0, // The spool is only bounded by the free space left.
+		SpoolMaxBytes:   0,
+		MinFreeBytes:    1 << 28, // 256 MB
+		ShedRetryAfter:  10 * time.Minute,
+
+		// Clients are not limited unless asked to, as many can share an address behind a NAT or a proxy.
+		RateLimit:      0,
+		RateBurst:      60,
+		TrustedProxies: nil, // Clients are keyed by the address they connect from.
+
 		ListenPort:  8080,
+		ReusePort:   false, // A single listener accepts all connections.
+		Listeners:   0,
 		MetricsPort: 2112,
+
+		H2C: false, // Cleartext connections are HTTP/1 only, unless a proxy in front speaks HTTP/2.
+		// Uploads fit in a stream window, and a connection window holds a few of them.
+		HTTP2MaxStreams:   100,
+		HTTP2ConnWindow:   1 << 20, // 1 MB
+		HTTP2StreamWindow: 1 << 17, // 128 KB
 	}
 
 	cmd.PersistentFlags().CountVarP(&app.config.Verbosity, "verbose", "v", "issue INFO (-v), DEBUG (-vv)")
@@ -111,11 +138,32 @@ func installRootCmd(app *App) {
 	cmd.Flags().DurationVar(&app.config.Daemon.ReadTimeout, "read-timeout", defaultConf.ReadTimeout, "read timeout for HTTP server")
 	cmd.Flags().DurationVar(&app.config.Daemon.WriteTimeout, "write-timeout", defaultConf.WriteTimeout, "write timeout for HTTP server")
 	cmd.Flags().DurationVar(&app.config.Daemon.RequestTimeout, "request-timeout", defaultConf.RequestTimeout, "request timeout for HTTP server")
+	cmd.Flags().DurationVar(&app.config.Daemon.IdleTimeout, "idle-timeout", defaultConf.IdleTimeout, "time keep-alive connections are kept open waiting for the next request")
 	cmd.Flags().IntVar(&app.config.Daemon.MaxHeaderBytes, "max-header-bytes", defaultConf.MaxHeaderBytes, "maximum header bytes for HTTP server")
 	cmd.Flags().IntVar(&app.config.Daemon.MaxUploadBytes, "max-upload-bytes", defaultConf.MaxUploadBytes, "maximum upload bytes for HTTP server")
+	cmd.Flags().StringVar(&app.config.Daemon.SpoolSync, "spool-sync", defaultConf.SpoolSync, "how durable saved reports are: none, file (content flushed to disk) or file-and-dir (also their directory entry, to survive a power failure)")
+	cmd.Flags().IntVar(&app.config.Daemon.MaxDeltaBaseBytes, "max-delta-base-bytes", defaultConf.MaxDeltaBaseBytes, "memory to keep uploaded reports in until restart, for clients uploading again before they are evicted to send deltas against them (0 disables deltas)")
+	cmd.Flags().DurationVar(&app.config.Daemon.UploadWindow, "upload-window", defaultConf.UploadWindow, "period over which scheduled clients spread their uploads (0 asks them not to)")
+
+	cmd.Flags().IntVar(&app.config.Daemon.SpoolMaxReports, "spool-max-reports", defaultConf.SpoolMaxReports, "reports of an app waiting to be ingested past which its uploads are shed (0 disables)")
+	cmd.Flags().Int64Var(&app.config.Daemon.SpoolMaxBytes, "spool-max-bytes", defaultConf.SpoolMaxBytes, "size of the reports of an app waiting to be ingested past which its uploads are shed (0 disables)")
+	cmd.Flags().Int64Var(&app.config.Daemon.MinFreeBytes, "min-free-bytes", defaultConf.MinFreeBytes, "free space of the reports filesystem under which uploads are shed (0 disables)")
+	cmd.Flags().DurationVar(&app.config.Daemon.ShedRetryAfter, "shed-retry-after", defaultConf.ShedRetryAfter, "time clients whose uploads are shed are asked to wait")
+	cmd.Flags().Float64Var(&app.config.Daemon.RateLimit, "rate-limit", defaultConf.RateLimit, "uploads per second each client address can sustain for an app, unless the allowlist sets it (0 disables)")
+	cmd.Flags().IntVar(&app.config.Daemon.RateBurst, "rate-burst", defaultConf.RateBurst, "uploads each client address can send at once for an app, unless the allowlist sets it")
+	cmd.Flags().StringSliceVar(&app.config.Daemon.TrustedProxies, "trusted-proxies", defaultConf.TrustedProxies, "addresses or CIDR prefixes of the proxies whose X-Forwarded-For header rate limits clients")
 
 	cmd.Flags().StringVar(&app.config.Daemon.ListenHost, "listen-host", defaultConf.ListenHost, "host to listen on")
 	cmd.Flags().IntVar(&app.config.Daemon.ListenPort, "listen-port", defaultConf.ListenPort, "port to listen on")
+	cmd.Flags().BoolVar(&app.config.Daemon.ReusePort, "reuse-port", defaultConf.ReusePort, "accept connections on several SO_REUSEPORT listeners (Linux only)")
+	cmd.Flags().IntVar(&app.config.Daemon.Listeners, "listeners", defaultConf.Listeners, "number of SO_REUSEPORT listeners with --reuse-port (0 opens one per CPU)")
+
+	cmd.Flags().StringVar(&app.config.Daemon.TLSCertFile, "tls-cert", defaultConf.TLSCertFile, "certificate file to serve TLS with, negotiating HTTP/2 (requires --tls-key)")
+	cmd.Flags().StringVar(&app.config.Daemon.TLSKeyFile, "tls-key", defaultConf.TLSKeyFile, "key file of the TLS certificate")
+	cmd.Flags().BoolVar(&app.config.Daemon.H2C, "h2c", defaultConf.H2C, "accept cleartext HTTP/2 connections with prior knowledge, as from a proxy")
+	cmd.Flags().IntVar(&app.config.Daemon.HTTP2MaxStreams, "http2-max-streams", defaultConf.HTTP2MaxStreams, "concurrent streams each HTTP/2 connection can carry")
+	cmd.Flags().IntVar(&app.config.Daemon.HTTP2ConnWindow, "http2-conn-window", defaultConf.HTTP2ConnWindow, "bytes a client can send on an HTTP/2 connection before the server reads them")
+	cmd.Flags().IntVar(&app.config.Daemon.HTTP2StreamWindow, "http2-stream-window", defaultConf.HTTP2StreamWindow, "bytes a client can send on an HTTP/2 stream before the server reads them")
 
 	cmd.Flags().StringVar(&app.config.Daemon.MetricsHost, "metrics-host", defaultConf.MetricsHost, "host for the metrics endpoint")
 	cmd.Flags().IntVar(&app.config.Daemon.MetricsPort, "metrics-port", defaultConf.MetricsPort, "port for the metrics endpoint")
@@ -125,6 +173,12 @@ func installRootCmd(app *App) {
 		// This should never happen.
 		panic(fmt.Sprintf("failed to mark reports-dir flag as required: %v", err))
 	}
+	for _, name := range []string{"tls-cert", "tls-key"} {
+		if err := cmd.MarkFlagFilename(name); err != nil {
+			// This should never happen.
+			panic(fmt.Sprintf("failed to mark %s flag as a filename: %v", name, err))
+		}
+	}
 }
 
 // Run executes the command and associated process, returning an error if any.
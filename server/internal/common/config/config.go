@@ -6,6 +6,7 @@ import (
 	"encoding/json"
 	"fmt"
 	"log/slog"
+	"maps"
 	"os"
 	"path/filepath"
 	"sync"
@@ -21,6 +22,16 @@ var reservedNames = map[string]struct{}{
 // Conf represents the configuration structure.
 type Conf struct {
 	AllowedList []string `json:"allowList"`
+	// RateLimits are the upload budgets of each client for some apps, instead of the default one of the web service.
+	RateLimits map[string]RateLimit `json:"rateLimits,omitempty"`
+}
+
+// RateLimit is the upload budget of each client for an app.
+type RateLimit struct {
+	// Rate is the number of uploads per second a client can sustain. Clients are not limited if it is not positive.
+	Rate float64 `json:"rate"`
+	// Burst is the number of uploads a client can send at once, which is at least 1.
+	Burst int `json:"burst"`
 }
 
 // Manager is a struct that manages the configuration.
@@ -173,6 +184,13 @@ func (cm *Manager) IsAllowed(value string) bool {
 	return exists
 }
 
+// RateLimits returns a copy of the upload budgets of each client configured by app.
+func (cm *Manager) RateLimits() map[string]RateLimit {
+	cm.lock.RLock()
+	defer cm.lock.RUnlock()
+	return maps.Clone(cm.config.RateLimits)
+}
+
 // filterAllowList filters out reserved names from the allow list.
 func (cm *Manager) filterAllowList(allowList []string) []string {
 	filteredAllowList := make([]string, 0, len(allowList))
@@ -38,6 +38,9 @@ func TestLoad(t *testing.T) {
 		"Empty JSON loads": {
 			content: "{}",
 		},
+		"Valid config with rate limits loads": {
+			content: `{"allowList": ["foo", "bar"], "rateLimits": {"foo": {"rate": 0.5, "burst": 4}, "baz": {"rate": 2}}}`,
+		},
 		"Ignores reserved names": {
 			content: func() string {
 				content := `{"allowList": ["foo"`
@@ -85,16 +88,19 @@ func TestLoad(t *testing.T) {
 			require.NoError(t, err, "expected no error loading config")
 
 			got := struct {
-				AllowList []string
-				AllowSet  map[string]struct{}
+				AllowList  []string
+				AllowSet   map[string]struct{}
+				RateLimits map[string]config.RateLimit `yaml:",omitempty"`
 			}{
-				AllowList: cm.AllowList(),
-				AllowSet:  cm.AllowSet(),
+				AllowList:  cm.AllowList(),
+				AllowSet:   cm.AllowSet(),
+				RateLimits: cm.RateLimits(),
 			}
 
 			want := testutils.LoadWithUpdateFromGoldenYAML(t, got)
 			assert.Equal(t, want.AllowList, got.AllowList, "expected allowList to match")
 			assert.Equal(t, want.AllowSet, got.AllowSet, "expected allowSet to match")
+			assert.Equal(t, want.RateLimits, got.RateLimits, "expected rateLimits to match")
 		})
 	}
 }
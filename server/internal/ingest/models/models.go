@@ -5,6 +5,8 @@ import (
 	"encoding/json"
 )
 
+//go:generate go run -tags=tools github.com/ubuntu/ubuntu-insights/common/jsonenc/generate -decode models.go TargetModel
+
 // TargetModels is an interface that represents the root target models for the ingest service.
 type TargetModels interface {
 	TargetModel | LegacyTargetModel
@@ -0,0 +1,267 @@
+// Code generated by github.com/ubuntu/ubuntu-insights/common/jsonenc/generate. DO NOT EDIT.
+
+package models
+
+import (
+	"github.com/ubuntu/ubuntu-insights/common/jsonenc"
+)
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v TargetModel) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	comma := false
+	dst = append(dst, '{')
+	if v.InsightsVersion != "" {
+		dst = append(dst, `"insightsVersion":`...)
+		dst = jsonenc.AppendString(dst, v.InsightsVersion)
+		comma = true
+	}
+	if v.CollectionTime != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"collectionTime":`...)
+		dst = jsonenc.AppendInt(dst, v.CollectionTime)
+		comma = true
+	}
+	if !v.SystemInfo.jsonencIsZero() {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"systemInfo":`...)
+		if dst, err = v.SystemInfo.AppendJSON(dst); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if len(v.SourceMetrics) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"sourceMetrics":`...)
+		if dst, err = jsonenc.AppendRaw(dst, v.SourceMetrics); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.OptOut {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"OptOut":`...)
+		dst = jsonenc.AppendBool(dst, v.OptOut)
+		comma = true
+	}
+	if v.Extras != nil {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"Extras":`...)
+		if dst, err = jsonenc.AppendAny(dst, v.Extras); err != nil {
+			return dst, err
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v TargetModel) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// targetModelJSONKeys are the keys decoded into fields of TargetModel.
+var targetModelJSONKeys = []string{"insightsVersion", "collectionTime", "systemInfo", "sourceMetrics", "OptOut"}
+
+// DecodeJSON decodes the JSON object in data into v, with the generated decoder.
+// Raw JSON fields alias data. Valid input of another shape returns jsonenc.ErrUnsupported.
+func (v *TargetModel) DecodeJSON(data []byte) error {
+	d := jsonenc.NewDecoder(data)
+	if err := v.DecodeJSONFrom(d); err != nil {
+		return err
+	}
+	return d.End()
+}
+
+// DecodeJSONFrom decodes the next JSON object of d into v.
+func (v *TargetModel) DecodeJSONFrom(d *jsonenc.Decoder) error {
+	return d.Object(func(key []byte) error {
+		switch string(key) {
+		case "insightsVersion":
+			if d.Null() {
+				return nil
+			}
+			x, err := d.String()
+			if err != nil {
+				return err
+			}
+			v.InsightsVersion = x
+		case "collectionTime":
+			if d.Null() {
+				return nil
+			}
+			x, err := d.Int(64)
+			if err != nil {
+				return err
+			}
+			v.CollectionTime = x
+		case "systemInfo":
+			if d.Null() {
+				return nil
+			}
+			return v.SystemInfo.DecodeJSONFrom(d)
+		case "sourceMetrics":
+			if d.Null() {
+				return jsonenc.ErrUnsupported
+			}
+			raw, err := d.Raw()
+			if err != nil {
+				return err
+			}
+			v.SourceMetrics = raw
+		case "OptOut":
+			if d.Null() {
+				return nil
+			}
+			x, err := d.Bool()
+			if err != nil {
+				return err
+			}
+			v.OptOut = x
+		default:
+			if jsonenc.FoldMatch(key, targetModelJSONKeys) {
+				// encoding/json matches keys case-insensitively.
+				return jsonenc.ErrUnsupported
+			}
+			x, err := d.Any()
+			if err != nil {
+				return err
+			}
+			if v.Extras == nil {
+				v.Extras = make(map[string]any)
+			}
+			v.Extras[string(key)] = x
+		}
+		return nil
+	})
+}
+
+// AppendJSON appends the JSON encoding of v to dst.
+func (v TargetSystemInfo) AppendJSON(dst []byte) ([]byte, error) {
+	var err error
+	comma := false
+	dst = append(dst, '{')
+	if len(v.Hardware) != 0 {
+		dst = append(dst, `"hardware":`...)
+		if dst, err = jsonenc.AppendRaw(dst, v.Hardware); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if len(v.Software) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"software":`...)
+		if dst, err = jsonenc.AppendRaw(dst, v.Software); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if len(v.Platform) != 0 {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"platform":`...)
+		if dst, err = jsonenc.AppendRaw(dst, v.Platform); err != nil {
+			return dst, err
+		}
+		comma = true
+	}
+	if v.Extras != nil {
+		if comma {
+			dst = append(dst, ',')
+		}
+		dst = append(dst, `"Extras":`...)
+		if dst, err = jsonenc.AppendAny(dst, v.Extras); err != nil {
+			return dst, err
+		}
+	}
+	dst = append(dst, '}')
+	return dst, nil
+}
+
+// MarshalJSON implements json.Marshaler with the generated encoder.
+func (v TargetSystemInfo) MarshalJSON() ([]byte, error) {
+	return v.AppendJSON(nil)
+}
+
+// targetSystemInfoJSONKeys are the keys decoded into fields of TargetSystemInfo.
+var targetSystemInfoJSONKeys = []string{"hardware", "software", "platform"}
+
+// DecodeJSON decodes the JSON object in data into v, with the generated decoder.
+// Raw JSON fields alias data. Valid input of another shape returns jsonenc.ErrUnsupported.
+func (v *TargetSystemInfo) DecodeJSON(data []byte) error {
+	d := jsonenc.NewDecoder(data)
+	if err := v.DecodeJSONFrom(d); err != nil {
+		return err
+	}
+	return d.End()
+}
+
+// DecodeJSONFrom decodes the next JSON object of d into v.
+func (v *TargetSystemInfo) DecodeJSONFrom(d *jsonenc.Decoder) error {
+	return d.Object(func(key []byte) error {
+		switch string(key) {
+		case "hardware":
+			if d.Null() {
+				return jsonenc.ErrUnsupported
+			}
+			raw, err := d.Raw()
+			if err != nil {
+				return err
+			}
+			v.Hardware = raw
+		case "software":
+			if d.Null() {
+				return jsonenc.ErrUnsupported
+			}
+			raw, err := d.Raw()
+			if err != nil {
+				return err
+			}
+			v.Software = raw
+		case "platform":
+			if d.Null() {
+				return jsonenc.ErrUnsupported
+			}
+			raw, err := d.Raw()
+			if err != nil {
+				return err
+			}
+			v.Platform = raw
+		default:
+			if jsonenc.FoldMatch(key, targetSystemInfoJSONKeys) {
+				// encoding/json matches keys case-insensitively.
+				return jsonenc.ErrUnsupported
+			}
+			x, err := d.Any()
+			if err != nil {
+				return err
+			}
+			if v.Extras == nil {
+				v.Extras = make(map[string]any)
+			}
+			v.Extras[string(key)] = x
+		}
+		return nil
+	})
+}
+
+// jsonencIsZero reports whether v is the zero value, for omitzero.
+func (v TargetSystemInfo) jsonencIsZero() bool {
+	return v.Hardware == nil &&
+		v.Software == nil &&
+		v.Platform == nil &&
+		v.Extras == nil
+}
@@ -367,6 +367,11 @@ func sanitizeInvalidUnicodeEscapes(data []byte) []byte {
 	return bytes.ReplaceAll(data, []byte(`\u0000`), []byte(`\ufffd`))
 }
 
+// jsonDecoder is implemented by target models with a generated decoder.
+type jsonDecoder interface {
+	DecodeJSON(data []byte) error
+}
+
 // decodeFile reads a JSON file, unmarshals, and decodes it into the specified target model type.
 // It returns the target model or an error if the file is invalid or does not match the expected structure.
 func decodeFile[T models.TargetModels](file string) (*T, error) {
@@ -377,12 +382,21 @@ func decodeFile[T models.TargetModels](file string) (*T, error) {
 
 	data = sanitizeInvalidUnicodeEscapes(data)
 
+	report := new(T)
+	// Reports of the expected shape go through their generated decoder. Anything else, including
+	// input needing the weakly typed conversions of mapstructure, takes the reflection based path.
+	if d, ok := any(report).(jsonDecoder); ok {
+		if err := d.DecodeJSON(data); err == nil {
+			return report, nil
+		}
+		report = new(T)
+	}
+
 	var jsonData map[string]any
 	if err = json.Unmarshal(data, &jsonData); err != nil {
 		return nil, errors.Join(errors.New("json file is invalid and could not be parsed"), err)
 	}
 
-	report := new(T)
 	config := getDecoderConfig(report)
 	decoder, err := mapstructure.NewDecoder(config)
 	if err != nil {
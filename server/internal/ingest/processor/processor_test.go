@@ -312,6 +312,59 @@ func BenchmarkProcessFiles(b *testing.B) {
 	}
 }
 
+// BenchmarkTargetModel compares the generated decoder and encoder of the target model with encoding/json.
+func BenchmarkTargetModel(b *testing.B) {
+	for _, fixture := range []string{"valid_1.json", "optout.json"} {
+		data, err := os.ReadFile(filepath.Join(testFixturesDir, "MultiMixed", fixture))
+		require.NoError(b, err, "Setup: Failed to read report fixture")
+
+		var report models.TargetModel
+		require.NoError(b, report.DecodeJSON(data), "Setup: Generated decoder failed to decode %s", fixture)
+		// encoding/json would otherwise call the generated encoder through MarshalJSON.
+		plain := testutils.WithoutGeneratedJSON(report)
+		want, err := json.Marshal(plain)
+		require.NoError(b, err, "Setup: encoding/json failed to encode %s", fixture)
+		got, err := report.AppendJSON(nil)
+		require.NoError(b, err, "Setup: Generated encoder failed to encode %s", fixture)
+		require.Equal(b, string(want), string(got), "Setup: Both encoders should encode %s the same", fixture)
+
+		b.Run(fixture+"/Decode/Generated", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				var m models.TargetModel
+				if err := m.DecodeJSON(data); err != nil {
+					b.Fatalf("Generated decoder failed: %v", err)
+				}
+			}
+		})
+		b.Run(fixture+"/Decode/EncodingJSON", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				var m models.TargetModel
+				if err := json.Unmarshal(data, &m); err != nil {
+					b.Fatalf("encoding/json failed: %v", err)
+				}
+			}
+		})
+		b.Run(fixture+"/Encode/Generated", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := report.AppendJSON(nil); err != nil {
+					b.Fatalf("Generated encoder failed: %v", err)
+				}
+			}
+		})
+		b.Run(fixture+"/Encode/EncodingJSON", func(b *testing.B) {
+			b.ReportAllocs()
+			for b.Loop() {
+				if _, err := json.Marshal(plain); err != nil {
+					b.Fatalf("encoding/json failed: %v", err)
+				}
+			}
+		})
+	}
+}
+
 type mockDBManager struct {
 	uploadErr      error
 	reports        map[string][]*models.TargetModel       // Fake in-memory database
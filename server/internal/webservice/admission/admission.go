@@ -0,0 +1,348 @@
+// Package admission provides the admission control of uploads to the web service.
+// Uploads are shed while the spool of reports waiting for the ingest service is too deep, or the filesystem it is on
+// too full, so that an ingest backlog can't fill the disk the services share.
+package admission
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"io/fs"
+	"log/slog"
+	"maps"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"slices"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+const (
+	// smallUploadBytes is the size up to which uploads, like opt-out reports, are admitted past the spool watermarks.
+	smallUploadBytes = 1 << 10 // 1 KB
+	// defaultRefreshInterval is how often the spool is refreshed. Uploads saved in between are accounted as they are.
+	defaultRefreshInterval = 10 * time.Second
+)
+
+// Limits are the watermarks past which uploads are shed. Zero values disable them.
+type Limits struct {
+	// SpoolReports is the number of reports of an app waiting to be ingested past which its uploads are shed.
+	SpoolReports int
+	// SpoolBytes is the size of the reports of an app waiting to be ingested past which its uploads are shed.
+	SpoolBytes int64
+	// MinFreeBytes is the free space of the spool filesystem under which uploads are shed.
+	// Small uploads are only shed once half of it is left.
+	MinFreeBytes int64
+
+	// RetryAfter is how long clients are asked to wait before uploading again when shed.
+	// Clients are spread over up to half as long again, not to come back all at once.
+	RetryAfter time.Duration
+}
+
+// Enabled returns whether any watermark is set.
+func (l Limits) Enabled() bool {
+	return l.spoolLimited() || l.MinFreeBytes > 0
+}
+
+// spoolLimited returns whether any watermark on the reports waiting to be ingested is set.
+func (l Limits) spoolLimited() bool {
+	return l.SpoolReports > 0 || l.SpoolBytes > 0
+}
+
+// spool is the reports of an app waiting to be ingested.
+type spool struct {
+	reports int
+	bytes   int64
+}
+
+// Controller decides whether uploads are admitted, from the state of the reports spool.
+type Controller struct {
+	reportsDir      string
+	limits          Limits
+	refreshInterval time.Duration
+	freeBytes       func(string) (int64, error)
+
+	// free is the free space of the spool filesystem, or negative if unknown. It is read without locking, so that
+	// uploads only contend on mu if a spool watermark is set.
+	free atomic.Int64
+
+	mu sync.Mutex
+	// apps is the spool of each app, tracked from the first scan of the spool or the first upload of the app.
+	// It is only tracked if a spool watermark is set.
+	apps  map[string]spool
+	gauge struct {
+		reports *prometheus.GaugeVec
+		bytes   *prometheus.GaugeVec
+		free    prometheus.Gauge
+	}
+}
+
+type options struct {
+	refreshInterval time.Duration
+	freeBytes       func(string) (int64, error)
+}
+
+// Options represents an optional function to override Controller default values.
+type Options func(*options)
+
+// New creates a Controller for the spool in reportsDir, with its metrics registered in registry.
+// If a spool watermark is set, the whole spool is scanned once before returning for the apps with reports waiting.
+func New(reportsDir string, limits Limits, registry prometheus.Registerer, args ...Options) (*Controller, error) {
+	opts := options{
+		refreshInterval: defaultRefreshInterval,
+		freeBytes:       freeBytes,
+	}
+	for _, opt := range args {
+		opt(&opts)
+	}
+
+	if err := os.MkdirAll(reportsDir, 0750); err != nil {
+		return nil, fmt.Errorf("failed to create reports directory: %v", err)
+	}
+
+	c := &Controller{
+		reportsDir:      reportsDir,
+		limits:          limits,
+		refreshInterval: opts.refreshInterval,
+		freeBytes:       opts.freeBytes,
+		apps:            make(map[string]spool),
+	}
+	c.free.Store(-1)
+	c.gauge.reports = promauto.With(registry).NewGaugeVec(
+		prometheus.GaugeOpts{
+			Name: "webservice_spool_reports",
+			Help: "Number of reports of the app waiting to be ingested, as last seen by the web service.",
+		}, []string{"app"},
+	)
+	c.gauge.bytes = promauto.With(registry).NewGaugeVec(
+		prometheus.GaugeOpts{
+			Name: "webservice_spool_bytes",
+			Help: "Size of the reports of the app waiting to be ingested, as last seen by the web service.",
+		}, []string{"app"},
+	)
+	c.gauge.free = promauto.With(registry).NewGauge(
+		prometheus.GaugeOpts{
+			Name: "webservice_spool_free_bytes",
+			Help: "Free space of the filesystem of the reports spool, as last seen by the web service.",
+		},
+	)
+
+	if limits.spoolLimited() {
+		apps, err := c.scan()
+		if err != nil {
+			return nil, err
+		}
+		c.apps = apps
+	}
+	c.refresh()
+	return c, nil
+}
+
+// Run refreshes the state of the spool periodically until ctx is done.
+// Refresh failures are logged, and the last known state kept.
+func (c *Controller) Run(ctx context.Context) {
+	t := time.NewTicker(c.refreshInterval)
+	defer t.Stop()
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-t.C:
+			c.refresh()
+		}
+	}
+}
+
+// Admit returns whether an upload of size bytes for app is admitted, or else how long the client should wait
+// before trying again. size is negative when unknown, in which case the upload is not considered small.
+func (c *Controller) Admit(app string, size int64) (retryAfter time.Duration, ok bool) {
+	small := size >= 0 && size <= smallUploadBytes
+
+	if floor, free := c.limits.MinFreeBytes, c.free.Load(); floor > 0 && free >= 0 {
+		if small {
+			floor /= 2
+		}
+		if free < floor {
+			return c.retryAfter(), false
+		}
+	}
+	if small || !c.limits.spoolLimited() {
+		return 0, true
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	s, ok := c.apps[app]
+	if !ok {
+		// The app is counted from the next refresh on.
+		c.apps[app] = s
+	}
+	if (c.limits.SpoolReports > 0 && s.reports >= c.limits.SpoolReports) ||
+		(c.limits.SpoolBytes > 0 && s.bytes >= c.limits.SpoolBytes) {
+		return c.retryAfter(), false
+	}
+	return 0, true
+}
+
+// Saved accounts for a report of size bytes saved for app, until the next refresh of the spool.
+func (c *Controller) Saved(app string, size int64) {
+	if c.limits.spoolLimited() {
+		c.mu.Lock()
+		s := c.apps[app]
+		s.reports++
+		s.bytes += size
+		c.apps[app] = s
+		c.mu.Unlock()
+	}
+	for {
+		free := c.free.Load()
+		if free < 0 || c.free.CompareAndSwap(free, max(free-size, 0)) {
+			return
+		}
+	}
+}
+
+// retryAfter returns the delay to ask a shed client to wait, spread over half of the configured one.
+func (c *Controller) retryAfter() time.Duration {
+	d := c.limits.RetryAfter
+	if d <= 0 {
+		return 0
+	}
+	return d + time.Duration(rand.Int63n(int64(d/2)+1)) // #nosec:G404 We don't need cryptographic randomness.
+}
+
+// refresh updates the state of the spool: the reports waiting to be ingested of each tracked app if a spool watermark
+// is set, and the free space of its filesystem. Apps which can't be counted keep their last known spool, without
+// holding back the others nor the free space.
+func (c *Controller) refresh() {
+	var apps map[string]spool
+	if c.limits.spoolLimited() {
+		c.mu.Lock()
+		tracked := slices.Collect(maps.Keys(c.apps))
+		c.mu.Unlock()
+
+		apps = make(map[string]spool, len(tracked))
+		for _, app := range tracked {
+			s, err := c.count(app)
+			if err != nil {
+				slog.Warn("Failed to refresh the reports spool state", "app", app, "err", err)
+				continue
+			}
+			apps[app] = s
+		}
+	}
+
+	free, err := c.freeBytes(c.reportsDir)
+	if err != nil {
+		slog.Debug("Failed to get the free space of the reports spool filesystem", "err", err)
+		free = -1
+	}
+	c.free.Store(free)
+
+	if apps != nil {
+		c.mu.Lock()
+		// Apps tracked while the spool was counted, or which failed to be, keep their last known spool.
+		for app, s := range c.apps {
+			if _, ok := apps[app]; !ok {
+				apps[app] = s
+			}
+		}
+		c.apps = apps
+		c.mu.Unlock()
+
+		c.gauge.reports.Reset()
+		c.gauge.bytes.Reset()
+		for app, s := range apps {
+			c.gauge.reports.WithLabelValues(app).Set(float64(s.reports))
+			if c.limits.SpoolBytes > 0 {
+				c.gauge.bytes.WithLabelValues(app).Set(float64(s.bytes))
+			}
+		}
+	}
+	if free >= 0 {
+		c.gauge.free.Set(float64(free))
+	}
+}
+
+// count counts the reports of app waiting to be ingested. Their size is only looked up if the spool bytes watermark
+// is set.
+func (c *Controller) count(app string) (spool, error) {
+	entries, err := os.ReadDir(filepath.Join(c.reportsDir, filepath.FromSlash(app)))
+	// The ingest service removes the directories it emptied.
+	if errors.Is(err, fs.ErrNotExist) {
+		return spool{}, nil
+	}
+	if err != nil {
+		return spool{}, fmt.Errorf("failed to read reports spool of %s: %v", app, err)
+	}
+
+	var s spool
+	for _, e := range entries {
+		if e.IsDir() || filepath.Ext(e.Name()) != ".json" {
+			continue
+		}
+		if c.limits.SpoolBytes > 0 {
+			info, err := e.Info()
+			// The ingest service removes reports while they are counted.
+			if errors.Is(err, fs.ErrNotExist) {
+				continue
+			}
+			if err != nil {
+				return spool{}, fmt.Errorf("failed to read reports spool of %s: %v", app, err)
+			}
+			s.bytes += info.Size()
+		}
+		s.reports++
+	}
+	return s, nil
+}
+
+// scan walks the whole spool for the apps with reports waiting to be ingested, and returns their spool.
+func (c *Controller) scan() (map[string]spool, error) {
+	apps := make(map[string]spool)
+	err := filepath.WalkDir(c.reportsDir, func(path string, d fs.DirEntry, err error) error {
+		// The ingest service removes reports while they are scanned.
+		if errors.Is(err, fs.ErrNotExist) {
+			return nil
+		}
+		// An unreadable app is counted from its first upload on, as it is tracked then.
+		if err != nil && path != c.reportsDir {
+			slog.Warn("Failed to scan the reports spool", "path", path, "err", err)
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+		if d.IsDir() || filepath.Ext(path) != ".json" {
+			return nil
+		}
+		info, err := d.Info()
+		if errors.Is(err, fs.ErrNotExist) {
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+
+		rel, err := filepath.Rel(c.reportsDir, filepath.Dir(path))
+		if err != nil {
+			return err
+		}
+		app := filepath.ToSlash(rel)
+		s := apps[app]
+		s.reports++
+		s.bytes += info.Size()
+		apps[app] = s
+		return nil
+	})
+	if err != nil {
+		return nil, fmt.Errorf("failed to scan reports spool: %v", err)
+	}
+	return apps, nil
+}
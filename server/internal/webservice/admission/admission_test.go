@@ -0,0 +1,345 @@
+package admission_test
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sync/atomic"
+	"testing"
+	"time"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/testutil"
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/admission"
+)
+
+const retryAfter = time.Minute
+
+func TestNew(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		reportsDirIsFile bool
+		noReportsDir     bool
+		freeErr          bool
+
+		wantErr bool
+	}{
+		"Existing reports directory": {},
+		"Creates reports directory":  {noReportsDir: true},
+		"Free space error does not error": {
+			freeErr: true,
+		},
+
+		"Error when reports directory is a file": {reportsDirIsFile: true, wantErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dir := t.TempDir()
+			reportsDir := filepath.Join(dir, "reports")
+			if !tc.noReportsDir {
+				require.NoError(t, os.Mkdir(reportsDir, 0750), "Setup: failed to create reports directory")
+			}
+			if tc.reportsDirIsFile {
+				reportsDir = filepath.Join(dir, "file")
+				require.NoError(t, os.WriteFile(reportsDir, nil, 0600), "Setup: failed to create file")
+			}
+			free := func(string) (int64, error) { return 1 << 30, nil }
+			if tc.freeErr {
+				free = func(string) (int64, error) { return 0, fmt.Errorf("requested free space error") }
+			}
+
+			c, err := admission.New(reportsDir, admission.Limits{MinFreeBytes: 1}, prometheus.NewRegistry(), admission.WithFreeBytes(free))
+			if tc.wantErr {
+				require.Error(t, err, "New should fail")
+				return
+			}
+			require.NoError(t, err, "New should not fail")
+			assert.DirExists(t, reportsDir, "New should create the reports directory")
+			_, ok := c.Admit("app", 1<<20)
+			assert.True(t, ok, "Uploads should be admitted")
+		})
+	}
+}
+
+func TestAdmit(t *testing.T) {
+	t.Parallel()
+
+	// spool is the sizes of the reports waiting to be ingested, by app.
+	spool := map[string][]int{
+		"app":                             {2000, 2000, 2000},
+		"ubuntu-report/ubuntu/desktop/24": {2000},
+	}
+
+	tests := map[string]struct {
+		limits  admission.Limits
+		free    int64 // free is the free space of the spool filesystem, unknown if negative.
+		saved   int   // saved is the number of reports of 2000 bytes saved for app after the spool was scanned.
+		app     string
+		size    int64
+		noRetry bool
+
+		wantShed bool
+	}{
+		"Admitted without watermarks": {},
+		"Admitted under spool reports watermark": {
+			limits: admission.Limits{SpoolReports: 4},
+		},
+		"Admitted under spool bytes watermark": {
+			limits: admission.Limits{SpoolBytes: 6001},
+		},
+		"Admitted above free space watermark": {
+			limits: admission.Limits{MinFreeBytes: 1 << 20},
+		},
+		"Admitted when free space is unknown": {
+			limits: admission.Limits{MinFreeBytes: 1 << 20},
+			free:   -1,
+		},
+		"Admitted under the spool watermarks of its app": {
+			limits: admission.Limits{SpoolReports: 2},
+			app:    "ubuntu-report/ubuntu/desktop/24",
+		},
+		"Small upload admitted past spool watermarks": {
+			limits: admission.Limits{SpoolReports: 1, SpoolBytes: 1},
+			size:   16,
+		},
+		"Small upload admitted under free space watermark until half of it": {
+			limits: admission.Limits{MinFreeBytes: 1 << 20},
+			free:   1<<19 + 1,
+			size:   16,
+		},
+
+		"Shed past spool reports watermark": {
+			limits:   admission.Limits{SpoolReports: 3},
+			wantShed: true,
+		},
+		"Shed past spool bytes watermark": {
+			limits:   admission.Limits{SpoolBytes: 6000},
+			wantShed: true,
+		},
+		"Shed past spool watermark with saved reports": {
+			limits:   admission.Limits{SpoolReports: 5},
+			saved:    2,
+			wantShed: true,
+		},
+		"Shed under free space watermark": {
+			limits:   admission.Limits{MinFreeBytes: 1 << 20},
+			free:     1<<20 - 1,
+			wantShed: true,
+		},
+		"Shed under free space watermark with saved reports": {
+			limits:   admission.Limits{MinFreeBytes: 1 << 20},
+			free:     1<<20 + 3000,
+			saved:    2,
+			wantShed: true,
+		},
+		"Shed with unknown size past spool watermarks": {
+			limits:   admission.Limits{SpoolReports: 3},
+			size:     -1,
+			wantShed: true,
+		},
+		"Small upload shed under half of free space watermark": {
+			limits:   admission.Limits{MinFreeBytes: 1 << 20},
+			free:     1<<19 - 1,
+			size:     16,
+			wantShed: true,
+		},
+		"Shed without retry delay": {
+			limits:   admission.Limits{SpoolReports: 1},
+			noRetry:  true,
+			wantShed: true,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			reportsDir := t.TempDir()
+			for app, sizes := range spool {
+				dir := filepath.Join(reportsDir, app)
+				require.NoError(t, os.MkdirAll(dir, 0750), "Setup: failed to create app directory")
+				for i, size := range sizes {
+					require.NoError(t, os.WriteFile(filepath.Join(dir, fmt.Sprintf("%d.json", i)), make([]byte, size), 0600),
+						"Setup: failed to write report")
+				}
+				// Files other than reports are not accounted.
+				require.NoError(t, os.WriteFile(filepath.Join(dir, "tmp-1.tmp"), make([]byte, 1<<20), 0600),
+					"Setup: failed to write temporary file")
+			}
+			if tc.free == 0 {
+				tc.free = 1 << 30
+			}
+			if tc.app == "" {
+				tc.app = "app"
+			}
+			if tc.size == 0 {
+				tc.size = 2000
+			}
+			if !tc.noRetry {
+				tc.limits.RetryAfter = retryAfter
+			}
+
+			free := func(string) (int64, error) {
+				if tc.free < 0 {
+					return 0, fmt.Errorf("requested free space error")
+				}
+				return tc.free, nil
+			}
+			c, err := admission.New(reportsDir, tc.limits, prometheus.NewRegistry(), admission.WithFreeBytes(free))
+			require.NoError(t, err, "Setup: failed to create admission controller")
+			for range tc.saved {
+				c.Saved("app", 2000)
+			}
+
+			got, ok := c.Admit(tc.app, tc.size)
+			if !tc.wantShed {
+				require.True(t, ok, "Upload should be admitted")
+				require.Zero(t, got, "Admitted uploads should not be asked to retry")
+				return
+			}
+			require.False(t, ok, "Upload should be shed")
+			if tc.noRetry {
+				require.Zero(t, got, "Retry delay should be zero when not configured")
+				return
+			}
+			require.GreaterOrEqual(t, got, retryAfter, "Retry delay should be at least the configured one")
+			require.LessOrEqual(t, got, retryAfter*3/2, "Retry delay should be at most half as long again as the configured one")
+		})
+	}
+}
+
+func TestRun(t *testing.T) {
+	t.Parallel()
+
+	reportsDir := t.TempDir()
+	reg := prometheus.NewRegistry()
+	c, err := admission.New(reportsDir, admission.Limits{SpoolReports: 2}, reg, admission.WithRefreshInterval(10*time.Millisecond))
+	require.NoError(t, err, "Setup: failed to create admission controller")
+
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		c.Run(ctx)
+	}()
+
+	_, ok := c.Admit("app", -1)
+	require.True(t, ok, "Upload should be admitted with an empty spool")
+
+	// Reports saved by another instance of the web service are seen on the next scan.
+	dir := filepath.Join(reportsDir, "app")
+	require.NoError(t, os.MkdirAll(dir, 0750), "Setup: failed to create app directory")
+	for i := range 2 {
+		require.NoError(t, os.WriteFile(filepath.Join(dir, fmt.Sprintf("%d.json", i)), []byte("{}"), 0600), "Setup: failed to write report")
+	}
+	require.Eventually(t, func() bool {
+		_, ok := c.Admit("app", -1)
+		return !ok
+	}, 5*time.Second, 10*time.Millisecond, "Upload should be shed once the spool is scanned")
+	assert.Equal(t, 1, testutil.CollectAndCount(reg, "webservice_spool_reports"), "Spool reports should be tracked by app")
+
+	// Reports ingested are seen on the next scan too.
+	require.NoError(t, os.RemoveAll(dir), "Setup: failed to remove reports")
+	require.Eventually(t, func() bool {
+		_, ok := c.Admit("app", -1)
+		return ok
+	}, 5*time.Second, 10*time.Millisecond, "Upload should be admitted once the spool is ingested")
+
+	cancel()
+	select {
+	case <-done:
+	case <-time.After(5 * time.Second):
+		require.Fail(t, "Run should return once its context is done")
+	}
+}
+
+func TestRunWithoutSpoolWatermark(t *testing.T) {
+	t.Parallel()
+
+	reportsDir := t.TempDir()
+	dir := filepath.Join(reportsDir, "app")
+	require.NoError(t, os.MkdirAll(dir, 0750), "Setup: failed to create app directory")
+	require.NoError(t, os.WriteFile(filepath.Join(dir, "0.json"), []byte("{}"), 0600), "Setup: failed to write report")
+
+	reg := prometheus.NewRegistry()
+	free := func(string) (int64, error) { return 1 << 30, nil }
+	c, err := admission.New(reportsDir, admission.Limits{MinFreeBytes: 1}, reg,
+		admission.WithFreeBytes(free), admission.WithRefreshInterval(10*time.Millisecond))
+	require.NoError(t, err, "Setup: failed to create admission controller")
+
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		c.Run(ctx)
+	}()
+
+	c.Saved("app", 2)
+	_, ok := c.Admit("app", -1)
+	require.True(t, ok, "Upload should be admitted")
+	time.Sleep(50 * time.Millisecond)
+
+	// Only the free space is tracked.
+	assert.Equal(t, 0, testutil.CollectAndCount(reg, "webservice_spool_reports"), "Spool reports should not be tracked")
+	assert.Equal(t, 0, testutil.CollectAndCount(reg, "webservice_spool_bytes"), "Spool bytes should not be tracked")
+	assert.Equal(t, 1, testutil.CollectAndCount(reg, "webservice_spool_free_bytes"), "Free space should be tracked")
+
+	cancel()
+	<-done
+}
+
+func TestRunWithUnreadableApp(t *testing.T) {
+	t.Parallel()
+
+	reportsDir := t.TempDir()
+	// Reading the spool of an app fails whoever runs the test when it is not a directory.
+	require.NoError(t, os.WriteFile(filepath.Join(reportsDir, "broken"), nil, 0600), "Setup: failed to create file")
+
+	var free atomic.Int64
+	free.Store(1 << 30)
+	limits := admission.Limits{SpoolReports: 2, MinFreeBytes: 1 << 20}
+	c, err := admission.New(reportsDir, limits, prometheus.NewRegistry(),
+		admission.WithFreeBytes(func(string) (int64, error) { return free.Load(), nil }),
+		admission.WithRefreshInterval(10*time.Millisecond))
+	require.NoError(t, err, "Setup: failed to create admission controller")
+
+	for _, app := range []string{"broken", "app"} {
+		_, ok := c.Admit(app, -1)
+		require.True(t, ok, "Setup: upload should be admitted with an empty spool")
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		c.Run(ctx)
+	}()
+
+	// Other apps are still counted.
+	dir := filepath.Join(reportsDir, "app")
+	require.NoError(t, os.MkdirAll(dir, 0750), "Setup: failed to create app directory")
+	for i := range 2 {
+		require.NoError(t, os.WriteFile(filepath.Join(dir, fmt.Sprintf("%d.json", i)), []byte("{}"), 0600), "Setup: failed to write report")
+	}
+	require.Eventually(t, func() bool {
+		_, ok := c.Admit("app", -1)
+		return !ok
+	}, 5*time.Second, 10*time.Millisecond, "Uploads of other apps should be shed once their spool is counted")
+
+	// The free space is still refreshed.
+	free.Store(0)
+	require.Eventually(t, func() bool {
+		_, ok := c.Admit("other", 10)
+		return !ok
+	}, 5*time.Second, 10*time.Millisecond, "Uploads should be shed once the filesystem is full")
+
+	cancel()
+	<-done
+}
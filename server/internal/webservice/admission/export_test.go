@@ -0,0 +1,22 @@
+package admission
+
+import "time"
+
+// WithRefreshInterval sets how often Run refreshes the state of the spool.
+func WithRefreshInterval(d time.Duration) Options {
+	return func(o *options) {
+		o.refreshInterval = d
+	}
+}
+
+// WithFreeBytes sets the function returning the free space of the spool filesystem.
+func WithFreeBytes(f func(string) (int64, error)) Options {
+	return func(o *options) {
+		o.freeBytes = f
+	}
+}
+
+// Refresh refreshes the state of the spool now.
+func (c *Controller) Refresh() {
+	c.refresh()
+}
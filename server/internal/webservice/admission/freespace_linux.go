@@ -0,0 +1,12 @@
+package admission
+
+import "golang.org/x/sys/unix"
+
+// freeBytes returns the space available to unprivileged users on the filesystem of path.
+func freeBytes(path string) (int64, error) {
+	var st unix.Statfs_t
+	if err := unix.Statfs(path, &st); err != nil {
+		return 0, err
+	}
+	return int64(st.Bavail) * st.Bsize, nil
+}
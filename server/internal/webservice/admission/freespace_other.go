@@ -0,0 +1,10 @@
+//go:build !linux
+
+package admission
+
+import "errors"
+
+// freeBytes is not supported outside Linux, where the free space watermark is not applied.
+func freeBytes(string) (int64, error) {
+	return 0, errors.ErrUnsupported
+}
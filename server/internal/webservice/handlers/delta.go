@@ -0,0 +1,82 @@
+package handlers
+
+import (
+	"container/list"
+	"sync"
+)
+
+// deltaBases holds the most recently accepted reports, by application and digest, for delta uploads to refer to.
+// The least recently used reports are evicted once their total size exceeds maxBytes.
+type deltaBases struct {
+	maxBytes int64
+
+	mu      sync.Mutex
+	size    int64
+	entries map[deltaKey]*list.Element
+	lru     *list.List // Front is the most recently used.
+}
+
+type deltaKey struct {
+	app    string
+	digest string
+}
+
+type deltaBase struct {
+	key  deltaKey
+	data []byte
+}
+
+// newDeltaBases returns a deltaBases holding up to maxBytes of reports, or nil if maxBytes is not positive.
+func newDeltaBases(maxBytes int64) *deltaBases {
+	if maxBytes <= 0 {
+		return nil
+	}
+	return &deltaBases{
+		maxBytes: maxBytes,
+		entries:  make(map[deltaKey]*list.Element),
+		lru:      list.New(),
+	}
+}
+
+// get returns the report of app with the given digest, and whether it is held.
+// Nothing is held by a nil deltaBases.
+func (b *deltaBases) get(app, digest string) ([]byte, bool) {
+	if b == nil {
+		return nil, false
+	}
+
+	b.mu.Lock()
+	defer b.mu.Unlock()
+
+	e, ok := b.entries[deltaKey{app, digest}]
+	if !ok {
+		return nil, false
+	}
+	b.lru.MoveToFront(e)
+	return e.Value.(*deltaBase).data, true
+}
+
+// put holds data as the report of app with the given digest. data must not be modified afterwards.
+func (b *deltaBases) put(app, digest string, data []byte) {
+	size := int64(len(data))
+	if size > b.maxBytes {
+		return
+	}
+
+	b.mu.Lock()
+	defer b.mu.Unlock()
+
+	key := deltaKey{app, digest}
+	if e, ok := b.entries[key]; ok {
+		b.lru.MoveToFront(e)
+		return
+	}
+	b.entries[key] = b.lru.PushFront(&deltaBase{key: key, data: data})
+	b.size += size
+
+	for b.size > b.maxBytes {
+		oldest := b.lru.Remove(b.lru.Back()).(*deltaBase)
+		delete(b.entries, oldest.key)
+		b.size -= int64(len(oldest.data))
+	}
+}
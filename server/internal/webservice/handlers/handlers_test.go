@@ -7,6 +7,7 @@ import (
 	"net/http/httptest"
 	"path/filepath"
 	"testing"
+	"time"
 
 	"github.com/prometheus/client_golang/prometheus"
 	"github.com/prometheus/client_golang/prometheus/testutil"
@@ -48,6 +49,35 @@ func (m *mockConfigManager) IsAllowed(name string) bool {
 	return ok
 }
 
+// mockAdmitter sheds all uploads if shed is set, and counts the reports saved.
+type mockAdmitter struct {
+	shed  bool
+	saved int
+}
+
+func (m *mockAdmitter) Admit(string, int64) (time.Duration, bool) {
+	if m.shed {
+		return time.Minute, false
+	}
+	return 0, true
+}
+
+func (m *mockAdmitter) Saved(string, int64) {
+	m.saved++
+}
+
+// mockLimiter limits all requests if limited is set.
+type mockLimiter struct {
+	limited bool
+}
+
+func (m mockLimiter) Allow(*http.Request, string) (time.Duration, bool) {
+	if m.limited {
+		return time.Second, false
+	}
+	return 0, true
+}
+
 func runUploadTestCase(
 	t *testing.T,
 	handler http.Handler,
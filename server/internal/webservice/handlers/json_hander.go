@@ -2,6 +2,7 @@ package handlers
 
 import (
 	"encoding/json"
+	"errors"
 	"fmt"
 	"io"
 	"log/slog"
@@ -10,6 +11,8 @@ import (
 	"path/filepath"
 
 	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
+	"github.com/ubuntu/ubuntu-insights/common/reportdelta"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
 )
 
@@ -18,6 +21,16 @@ type jsonHandler struct {
 	reportsDir    string
 	maxUploadSize int64
 	successStatus int
+
+	// spoolSync is how durable saved reports are once acknowledged.
+	spoolSync fileutils.SyncPolicy
+
+	// bases holds the reports deltas can be sent against. It is nil when deltas are not accepted.
+	bases *deltaBases
+	// admission sheds uploads while the server is overloaded. It is nil when all uploads are admitted.
+	admission Admitter
+	// limiter limits the rate at which each client uploads. It is nil when clients are not limited.
+	limiter Limiter
 }
 
 func (h *jsonHandler) serveHTTP(w http.ResponseWriter, r *http.Request, reqID string, app string) {
@@ -37,15 +50,50 @@ func (h *jsonHandler) serveHTTP(w http.ResponseWriter, r *http.Request, reqID st
 		return
 	}
 
+	if h.limiter != nil {
+		if retryAfter, ok := h.limiter.Allow(r, app); !ok {
+			metrics.ApplyRejectReason(r, metrics.RejectReasonRateLimited)
+			pacing.SetRetryAfter(w.Header(), retryAfter)
+			http.Error(w, "Too many requests", http.StatusTooManyRequests)
+			slog.Debug("Request was rate limited", "req_id", reqID, "app", app, "remote_addr", r.RemoteAddr)
+			return
+		}
+	}
+
+	// Uploads are shed before their body is read, which the client can send again later.
+	if h.admission != nil {
+		if retryAfter, ok := h.admission.Admit(app, r.ContentLength); !ok {
+			metrics.ApplyRejectReason(r, metrics.RejectReasonOverloaded)
+			pacing.SetRetryAfter(w.Header(), retryAfter)
+			http.Error(w, "Service overloaded", http.StatusServiceUnavailable)
+			slog.Debug("Request was shed", "req_id", reqID, "app", app, "retry_after", retryAfter)
+			return
+		}
+	}
+
 	r.Body = http.MaxBytesReader(w, r.Body, h.maxUploadSize)
 	jsonData, err := io.ReadAll(r.Body)
+	if errors.Is(err, os.ErrDeadlineExceeded) || r.Context().Err() != nil {
+		timedOut(w, r, reqID, app)
+		return
+	}
 	if err != nil {
 		metrics.ApplyRejectReason(r, metrics.RejectReasonUnreadablePayload)
 		http.Error(w, "Failed to read request body", http.StatusBadRequest)
 		slog.Debug("Request had unreadable payload", "req_id", reqID, "app", app, "err", err)
 		return
 	}
-	if !json.Valid(jsonData) {
+
+	// Clients sending deltas name the digest of every report they upload, so that it can be used as a base later.
+	digest := r.Header.Get(reportdelta.DigestHeader)
+	var canonical []byte
+	if base := r.Header.Get(reportdelta.BaseHeader); base != "" {
+		var ok bool
+		if canonical, ok = h.reconstruct(w, r, reqID, app, base, digest, jsonData); !ok {
+			return
+		}
+		jsonData = canonical
+	} else if !json.Valid(jsonData) {
 		metrics.ApplyRejectReason(r, metrics.RejectReasonInvalidJSON)
 		http.Error(w, "Invalid JSON", http.StatusBadRequest)
 		slog.Debug("Request had invalid JSON", "req_id", reqID, "app", app)
@@ -63,7 +111,14 @@ func (h *jsonHandler) serveHTTP(w http.ResponseWriter, r *http.Request, reqID st
 	safeFilename := fmt.Sprintf("%s.json", reqID)
 	targetPath := filepath.Join(targetDir, safeFilename)
 
-	if err := fileutils.AtomicWrite(targetPath, jsonData); err != nil {
+	// Reports are only saved while the client waits for the answer, as it sends them again otherwise.
+	if r.Context().Err() != nil {
+		timedOut(w, r, reqID, app)
+		return
+	}
+
+	// The report is acknowledged to the client once saved, as durably as the spool sync policy asks.
+	if err := fileutils.AtomicWrite(targetPath, jsonData, fileutils.WithSync(h.spoolSync)); err != nil {
 		metrics.ApplyRejectReason(r, metrics.RejectReasonInternalServerErr)
 		http.Error(w, "Internal server error", http.StatusInternalServerError)
 		slog.Error("Error saving file", "req_id", reqID, "app", app, "target", targetPath, "err", err)
@@ -71,5 +126,67 @@ func (h *jsonHandler) serveHTTP(w http.ResponseWriter, r *http.Request, reqID st
 	}
 
 	slog.Debug("File successfully uploaded", "req_id", reqID, "app", app, "target", targetPath)
+	if h.admission != nil {
+		h.admission.Saved(app, int64(len(jsonData)))
+	}
+	if digest != "" {
+		h.keepBase(reqID, app, digest, jsonData, canonical)
+	}
 	w.WriteHeader(h.successStatus)
 }
+
+// timedOut answers a request which did not complete in time, for the client to try again later.
+func timedOut(w http.ResponseWriter, r *http.Request, reqID, app string) {
+	metrics.ApplyRejectReason(r, metrics.RejectReasonTimeout)
+	http.Error(w, "Request timed out", http.StatusServiceUnavailable)
+	slog.Debug("Request timed out", "req_id", reqID, "app", app, "err", r.Context().Err())
+}
+
+// reconstruct returns the report the delta patch rebuilds from the report with the digest base, in canonical encoding.
+// If the base is not held, or if the result does not match the expected digest when there is one, it answers
+// with reportdelta.UnknownBase for the client to send the full report instead, and returns false.
+func (h *jsonHandler) reconstruct(w http.ResponseWriter, r *http.Request, reqID, app, base, digest string, patch []byte) ([]byte, bool) {
+	baseData, ok := h.bases.get(app, base)
+	if !ok {
+		metrics.ApplyRejectReason(r, metrics.RejectReasonUnknownBase)
+		http.Error(w, reportdelta.UnknownBase, http.StatusConflict)
+		slog.Debug("Request had a delta against an unknown base", "req_id", reqID, "app", app, "base", base)
+		return nil, false
+	}
+
+	data, err := reportdelta.Apply(baseData, patch)
+	if err != nil {
+		metrics.ApplyRejectReason(r, metrics.RejectReasonInvalidJSON)
+		http.Error(w, "Invalid JSON", http.StatusBadRequest)
+		slog.Debug("Request had an invalid delta", "req_id", reqID, "app", app, "err", err)
+		return nil, false
+	}
+
+	if digest != "" && reportdelta.Digest(data) != digest {
+		metrics.ApplyRejectReason(r, metrics.RejectReasonUnknownBase)
+		http.Error(w, reportdelta.UnknownBase, http.StatusConflict)
+		slog.Debug("Request had a delta not matching its digest", "req_id", reqID, "app", app, "base", base)
+		return nil, false
+	}
+	return data, true
+}
+
+// keepBase holds the saved report data as a base for later deltas, if deltas are accepted and digest matches it.
+// canonical is the canonical encoding of data, if already known.
+func (h *jsonHandler) keepBase(reqID, app, digest string, data, canonical []byte) {
+	if h.bases == nil {
+		return
+	}
+	if canonical == nil {
+		var err error
+		if canonical, err = reportdelta.Canonical(data); err != nil {
+			slog.Debug("Failed to keep report as a delta base", "req_id", reqID, "app", app, "err", err)
+			return
+		}
+	}
+	if reportdelta.Digest(canonical) != digest {
+		slog.Debug("Report does not match its digest, not keeping it as a delta base", "req_id", reqID, "app", app)
+		return
+	}
+	h.bases.put(app, digest, canonical)
+}
@@ -7,6 +7,7 @@ import (
 	"strings"
 
 	"github.com/google/uuid"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/server/internal/common/constants"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
 )
@@ -23,13 +24,17 @@ type LegacyReport struct {
 }
 
 // NewLegacyReport creates a new LegacyReport handler.
-func NewLegacyReport(cfg ConfigProvider, reportsDir string, maxUploadSize int64) *LegacyReport {
+// Uploads are all admitted if admission is nil, and clients are not rate limited if limiter is nil.
+func NewLegacyReport(cfg ConfigProvider, reportsDir string, spoolSync fileutils.SyncPolicy, maxUploadSize int64, admission Admitter, limiter Limiter) *LegacyReport {
 	return &LegacyReport{
 		jsonHandler: &jsonHandler{
 			config:        cfg,
 			reportsDir:    reportsDir,
+			spoolSync:     spoolSync,
 			maxUploadSize: maxUploadSize,
 			successStatus: http.StatusOK,
+			admission:     admission,
+			limiter:       limiter,
 		}}
 }
 
@@ -6,6 +6,7 @@ import (
 	"testing"
 
 	"github.com/stretchr/testify/assert"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/handlers"
 )
 
@@ -35,7 +36,7 @@ func TestNewLegacyReport(t *testing.T) {
 				allowedList: tc.apps,
 			}
 
-			handler := handlers.NewLegacyReport(mockConfig, rd, 1<<10)
+			handler := handlers.NewLegacyReport(mockConfig, rd, fileutils.SyncNone, 1<<10, nil, nil)
 			assert.NotNil(t, handler)
 			assert.Equal(t, rd, handler.ReportsDir())
 			assert.Equal(t, tc.apps, mockConfig.AllowList())
@@ -119,7 +120,7 @@ func TestLegacyReportUpload(t *testing.T) {
 				tc.expectedCode = http.StatusOK
 			}
 
-			rawHandler := handlers.NewLegacyReport(mockConfig, t.TempDir(), tc.maxUploadSize)
+			rawHandler := handlers.NewLegacyReport(mockConfig, t.TempDir(), fileutils.SyncFileAndDir, tc.maxUploadSize, nil, nil)
 			tc.request.Method = tc.method
 
 			handler, reg := newEndpointMiddlewareWrap("legacy_upload", rawHandler)
@@ -1,6 +1,25 @@
 package handlers
 
+import (
+	"net/http"
+	"time"
+)
+
 // ConfigProvider is an interface that defines the configuration access methods used by the handlers.
 type ConfigProvider interface {
 	IsAllowed(string) bool // IsAllowed checks if a given item is allowed based on the present configuration state.
 }
+
+// Admitter is an interface that defines the admission control of uploads used by the handlers.
+type Admitter interface {
+	// Admit checks if an upload of size bytes for app is accepted now, or else how long its client should wait.
+	Admit(app string, size int64) (retryAfter time.Duration, ok bool)
+	// Saved accounts for a report of size bytes saved for app.
+	Saved(app string, size int64)
+}
+
+// Limiter is an interface that defines the per-client rate limiting of uploads used by the handlers.
+type Limiter interface {
+	// Allow checks if the client of r can upload for app now, or else how long it should wait.
+	Allow(r *http.Request, app string) (retryAfter time.Duration, ok bool)
+}
@@ -8,6 +8,7 @@ import (
 	"strings"
 
 	"github.com/google/uuid"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
 )
 
@@ -17,13 +18,22 @@ type Upload struct {
 }
 
 // NewUpload creates a new Upload handler.
-func NewUpload(cfg ConfigProvider, reportsDir string, maxUploadSize int64) *Upload {
+//
+// Up to maxDeltaBaseBytes of the reports uploaded by clients sending deltas are kept in memory for their next
+// upload to be a delta against them, until evicted or the server restarts. Deltas against a report no longer held
+// are refused, and sent again in full. Deltas are not accepted if maxDeltaBaseBytes is not positive.
+// Uploads are all admitted if admission is nil, and clients are not rate limited if limiter is nil.
+func NewUpload(cfg ConfigProvider, reportsDir string, spoolSync fileutils.SyncPolicy, maxUploadSize, maxDeltaBaseBytes int64, admission Admitter, limiter Limiter) *Upload {
 	return &Upload{
 		jsonHandler: &jsonHandler{
 			config:        cfg,
 			reportsDir:    reportsDir,
+			spoolSync:     spoolSync,
 			maxUploadSize: maxUploadSize,
 			successStatus: http.StatusAccepted,
+			bases:         newDeltaBases(maxDeltaBaseBytes),
+			admission:     admission,
+			limiter:       limiter,
 		}}
 }
 
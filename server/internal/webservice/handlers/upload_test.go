@@ -3,9 +3,15 @@ package handlers_test
 import (
 	"bytes"
 	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
 	"testing"
 
 	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/common/reportdelta"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/handlers"
 )
 
@@ -35,7 +41,7 @@ func TestNew(t *testing.T) {
 				allowedList: tc.apps,
 			}
 
-			handler := handlers.NewUpload(mockConfig, rd, 1<<10)
+			handler := handlers.NewUpload(mockConfig, rd, fileutils.SyncNone, 1<<10, 0, nil, nil)
 			assert.NotNil(t, handler)
 			assert.Equal(t, rd, handler.ReportsDir())
 			assert.Equal(t, tc.apps, mockConfig.AllowList())
@@ -51,11 +57,25 @@ func TestUpload(t *testing.T) {
 		request       *http.Request
 		method        string
 		maxUploadSize int64
+		shed          bool
+		limited       bool
 
 		expectedCode int
+		wantSaved    int
 	}{
 		"Valid Upload": {
-			request: insightsRequest(t, defaultApp, []byte(`{"foo": "bar"}`)),
+			request:   insightsRequest(t, defaultApp, []byte(`{"foo": "bar"}`)),
+			wantSaved: 1,
+		},
+		"Rate Limited Upload": {
+			request:      insightsRequest(t, defaultApp, []byte(`{"foo": "bar"}`)),
+			limited:      true,
+			expectedCode: http.StatusTooManyRequests,
+		},
+		"Shed Upload": {
+			request:      insightsRequest(t, defaultApp, []byte(`{"foo": "bar"}`)),
+			shed:         true,
+			expectedCode: http.StatusServiceUnavailable,
 		},
 		"Disallowed App": {
 			request:      insightsRequest(t, "unknown-app", []byte(`{"foo": "bar"}`)),
@@ -108,15 +128,131 @@ func TestUpload(t *testing.T) {
 				tc.expectedCode = http.StatusAccepted
 			}
 
-			rawHandler := handlers.NewUpload(mockConfig, t.TempDir(), tc.maxUploadSize)
+			admission := &mockAdmitter{shed: tc.shed}
+			rawHandler := handlers.NewUpload(mockConfig, t.TempDir(), fileutils.SyncFileAndDir, tc.maxUploadSize, 0, admission, mockLimiter{limited: tc.limited})
 			tc.request.Method = tc.method
 
 			handler, reg := newEndpointMiddlewareWrap("upload", rawHandler)
 			runUploadTestCase(t, handler, tc.request, tc.expectedCode, rawHandler.ReportsDir(), reg)
+			assert.Equal(t, tc.wantSaved, admission.saved, "Unexpected number of reports accounted to the admission control")
 		})
 	}
 }
 
+func TestUploadDelta(t *testing.T) {
+	t.Parallel()
+	const app = "testapp"
+
+	base := []byte(`{"systemInfo": {"cpu": {"cores": 4}, "mem": 8}, "sourceMetrics": {"a": 1}}`)
+	target := []byte(`{"systemInfo":{"cpu":{"cores":8},"mem":8}}`)
+	baseDigest := digest(t, base)
+	patch, ok, err := reportdelta.Diff(base, target)
+	require.NoError(t, err, "Setup: failed to diff reports")
+	require.True(t, ok, "Setup: reports should be expressible as a delta")
+
+	tests := map[string]struct {
+		noDeltas     bool
+		baseNoDigest bool
+		deltaBase    string
+		deltaDigest  string
+		delta        []byte
+		maxBaseBytes int64
+
+		wantCode int
+	}{
+		"Reconstructs the report from a delta": {},
+		"Accepts a delta without digest":       {deltaDigest: "-"},
+
+		"Answers unknown base when deltas are disabled": {noDeltas: true, wantCode: http.StatusConflict},
+		"Answers unknown base when the base was uploaded without digest": {
+			baseNoDigest: true, wantCode: http.StatusConflict},
+		"Answers unknown base when the base is not held": {
+			deltaBase: reportdelta.Digest([]byte(`{}`)), wantCode: http.StatusConflict},
+		"Answers unknown base when the base was too large to be kept": {
+			maxBaseBytes: 8, wantCode: http.StatusConflict},
+		"Answers unknown base when the result does not match its digest": {
+			deltaDigest: baseDigest, wantCode: http.StatusConflict},
+		"Rejects an invalid delta": {
+			delta: []byte(`[1]`), deltaDigest: "-", wantCode: http.StatusBadRequest},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			if tc.maxBaseBytes == 0 {
+				tc.maxBaseBytes = 1 << 10
+			}
+			if tc.noDeltas {
+				tc.maxBaseBytes = 0
+			}
+			if tc.deltaBase == "" {
+				tc.deltaBase = baseDigest
+			}
+			switch tc.deltaDigest {
+			case "":
+				tc.deltaDigest = digest(t, target)
+			case "-":
+				tc.deltaDigest = ""
+			}
+			if tc.delta == nil {
+				tc.delta = patch
+			}
+			if tc.wantCode == 0 {
+				tc.wantCode = http.StatusAccepted
+			}
+
+			reportsDir := t.TempDir()
+			handler := handlers.NewUpload(&mockConfigManager{allowedList: []string{app}}, reportsDir, fileutils.SyncNone, 1<<10, tc.maxBaseBytes, nil, nil)
+
+			req := insightsRequest(t, app, base)
+			if !tc.baseNoDigest {
+				req.Header.Set(reportdelta.DigestHeader, baseDigest)
+			}
+			rr := httptest.NewRecorder()
+			handler.ServeHTTP(rr, req)
+			require.Equal(t, http.StatusAccepted, rr.Code, "Setup: full upload should be accepted")
+
+			req = insightsRequest(t, app, tc.delta)
+			req.Header.Set("Content-Type", reportdelta.ContentType)
+			req.Header.Set(reportdelta.BaseHeader, tc.deltaBase)
+			if tc.deltaDigest != "" {
+				req.Header.Set(reportdelta.DigestHeader, tc.deltaDigest)
+			}
+			rr = httptest.NewRecorder()
+			handler.ServeHTTP(rr, req)
+			require.Equal(t, tc.wantCode, rr.Code, "Delta upload should get the expected status code")
+
+			entries, err := os.ReadDir(filepath.Join(reportsDir, app))
+			require.NoError(t, err, "Failed to read reports directory")
+			var got []string
+			for _, e := range entries {
+				d, err := os.ReadFile(filepath.Join(reportsDir, app, e.Name()))
+				require.NoError(t, err, "Failed to read report")
+				got = append(got, string(d))
+			}
+
+			want := []string{string(base)}
+			if tc.wantCode == http.StatusConflict {
+				assert.Contains(t, rr.Body.String(), reportdelta.UnknownBase, "Conflicts should be answered with unknown base")
+			}
+			if tc.wantCode == http.StatusAccepted {
+				want = append(want, `{"systemInfo":{"cpu":{"cores":8},"mem":8}}`)
+			}
+			assert.ElementsMatch(t, want, got, "Reports directory should hold the full reports")
+		})
+	}
+}
+
+// digest returns the digest of the canonical encoding of report.
+func digest(t *testing.T, report []byte) string {
+	t.Helper()
+
+	c, err := reportdelta.Canonical(report)
+	require.NoError(t, err, "Setup: failed to get canonical report")
+	return reportdelta.Digest(c)
+}
+
 func insightsRequest(t *testing.T, app string, data []byte) *http.Request {
 	t.Helper()
 
@@ -0,0 +1,96 @@
+package metrics
+
+import (
+	"net"
+	"net/http"
+	"sync"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+// LabelState is the label used for the state of connections in metrics.
+const LabelState label = "state"
+
+// LabelProtocol is the label used for the HTTP protocol of requests in metrics.
+const LabelProtocol label = "protocol"
+
+// LabelErrorType is the label used for the type of HTTP/2 errors in metrics.
+const LabelErrorType label = "type"
+
+// ConnMiddleware is a middleware for collecting metrics on the connections of an HTTP server, and the streams they
+// carry. Each HTTP/1 request is on a connection of its own at any time, while HTTP/2 ones share it as streams.
+type ConnMiddleware struct {
+	connections  *prometheus.GaugeVec
+	streamsTotal *prometheus.CounterVec
+	openStreams  *prometheus.GaugeVec
+	http2Errors  *prometheus.CounterVec
+
+	// states is the last http.ConnState of each open net.Conn. The server changes the state of a connection from
+	// one goroutine at a time, so connections are tracked concurrently without sharing a lock.
+	states sync.Map
+}
+
+// NewConnMiddleware creates a new ConnMiddleware instance with the provided registry.
+func NewConnMiddleware(registry prometheus.Registerer) *ConnMiddleware {
+	return &ConnMiddleware{
+		connections: promauto.With(registry).NewGaugeVec(
+			prometheus.GaugeOpts{
+				Name: "http_server_connections",
+				Help: "Tracks the number of open connections to the HTTP server, by state.",
+			}, []string{string(LabelState)},
+		),
+		streamsTotal: promauto.With(registry).NewCounterVec(
+			prometheus.CounterOpts{
+				Name: "http_server_streams_total",
+				Help: "Tracks the number of requests served by the HTTP server, each on a stream of its own with HTTP/2.",
+			}, []string{string(LabelProtocol)},
+		),
+		openStreams: promauto.With(registry).NewGaugeVec(
+			prometheus.GaugeOpts{
+				Name: "http_server_open_streams",
+				Help: "Tracks the number of requests being served by the HTTP server.",
+			}, []string{string(LabelProtocol)},
+		),
+		http2Errors: promauto.With(registry).NewCounterVec(
+			prometheus.CounterOpts{
+				Name: "http_server_http2_errors_total",
+				Help: "Tracks the number of HTTP/2 errors of the HTTP server, by type.",
+			}, []string{string(LabelErrorType)},
+		),
+	}
+}
+
+// ConnState tracks the state changes of connections. It is meant to be the ConnState hook of the server.
+func (m *ConnMiddleware) ConnState(c net.Conn, state http.ConnState) {
+	var prev any
+	var tracked bool
+	switch state {
+	case http.StateHijacked, http.StateClosed:
+		prev, tracked = m.states.LoadAndDelete(c)
+	default:
+		prev, tracked = m.states.Swap(c, state)
+		m.connections.WithLabelValues(state.String()).Inc()
+	}
+	if tracked {
+		m.connections.WithLabelValues(prev.(http.ConnState).String()).Dec()
+	}
+}
+
+// CountError counts the HTTP/2 errors of type errType. It is meant to be the CountError hook of the server's HTTP/2
+// configuration.
+func (m *ConnMiddleware) CountError(errType string) {
+	m.http2Errors.WithLabelValues(errType).Inc()
+}
+
+// Wrap is a middleware function that wraps an HTTP handler to collect metrics on the streams it serves.
+func (m *ConnMiddleware) Wrap(handler http.Handler) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		m.streamsTotal.WithLabelValues(r.Proto).Inc()
+		open := m.openStreams.WithLabelValues(r.Proto)
+		open.Inc()
+		defer open.Dec()
+
+		handler.ServeHTTP(w, r)
+	})
+}
@@ -0,0 +1,140 @@
+package metrics_test
+
+import (
+	"net"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"sync"
+	"testing"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/testutil"
+	"github.com/prometheus/common/expfmt"
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/testutils"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
+)
+
+func TestNewConnMiddleware(t *testing.T) {
+	t.Parallel()
+
+	// Ensure middleware is returned and no panic occurs.
+	require.NotNil(t, metrics.NewConnMiddleware(prometheus.NewRegistry()))
+}
+
+func TestConnMiddleware(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		connections [][]http.ConnState // State changes of each connection.
+		protocols   []string           // Protocol of each request served.
+		http2Errors []string
+	}{
+		"No Connections":      {},
+		"New Connection":      {connections: [][]http.ConnState{{http.StateNew}}},
+		"Active Connection":   {connections: [][]http.ConnState{{http.StateNew, http.StateActive}}},
+		"Idle Connection":     {connections: [][]http.ConnState{{http.StateNew, http.StateActive, http.StateIdle}}},
+		"Closed Connection":   {connections: [][]http.ConnState{{http.StateNew, http.StateActive, http.StateIdle, http.StateClosed}}},
+		"Hijacked Connection": {connections: [][]http.ConnState{{http.StateNew, http.StateActive, http.StateHijacked}}},
+		"Multiple Connections": {
+			connections: [][]http.ConnState{
+				{http.StateNew, http.StateActive},
+				{http.StateNew, http.StateActive, http.StateIdle},
+				{http.StateNew, http.StateActive, http.StateIdle, http.StateActive},
+			},
+		},
+		"Streams": {
+			connections: [][]http.ConnState{{http.StateNew, http.StateActive}},
+			protocols:   []string{"HTTP/1.1", "HTTP/2.0", "HTTP/2.0"},
+		},
+		"HTTP2 Errors": {
+			connections: [][]http.ConnState{{http.StateNew, http.StateActive, http.StateClosed}},
+			http2Errors: []string{"frame_too_large", "conn_close_lost_ping", "frame_too_large"},
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			reg := prometheus.NewRegistry()
+			mw := metrics.NewConnMiddleware(reg)
+
+			for _, states := range tc.connections {
+				c, other := net.Pipe()
+				defer c.Close()
+				defer other.Close()
+				for _, state := range states {
+					mw.ConnState(c, state)
+				}
+			}
+
+			handler := mw.Wrap(http.HandlerFunc(func(w http.ResponseWriter, _ *http.Request) {
+				w.WriteHeader(http.StatusOK)
+			}))
+			for _, proto := range tc.protocols {
+				req := httptest.NewRequest(http.MethodGet, "/", nil)
+				req.Proto = proto
+				handler.ServeHTTP(httptest.NewRecorder(), req)
+			}
+
+			for _, errType := range tc.http2Errors {
+				mw.CountError(errType)
+			}
+
+			got := make(map[string]string)
+			for _, name := range []string{
+				"http_server_connections",
+				"http_server_streams_total",
+				"http_server_open_streams",
+				"http_server_http2_errors_total",
+			} {
+				b, err := testutil.CollectAndFormat(reg, expfmt.TypeTextPlain, name)
+				require.NoError(t, err, "Failed to collect metrics for %s", name)
+				got[name] = string(b)
+			}
+
+			want := testutils.LoadWithUpdateFromGoldenYAML(t, got)
+			assert.Equal(t, want, got, "Collected metrics do not match expected values")
+		})
+	}
+}
+
+func TestConnMiddlewareConcurrentConnections(t *testing.T) {
+	t.Parallel()
+
+	const conns = 50
+
+	reg := prometheus.NewRegistry()
+	mw := metrics.NewConnMiddleware(reg)
+
+	var wg sync.WaitGroup
+	for i := range conns {
+		c, other := net.Pipe()
+		t.Cleanup(func() {
+			c.Close()
+			other.Close()
+		})
+		wg.Go(func() {
+			for _, state := range []http.ConnState{http.StateNew, http.StateActive, http.StateIdle} {
+				mw.ConnState(c, state)
+			}
+			// Half of the connections are closed.
+			if i%2 == 0 {
+				mw.ConnState(c, http.StateClosed)
+			}
+		})
+	}
+	wg.Wait()
+
+	want := `# HELP http_server_connections Tracks the number of open connections to the HTTP server, by state.
+# TYPE http_server_connections gauge
+http_server_connections{state="active"} 0
+http_server_connections{state="idle"} 25
+http_server_connections{state="new"} 0
+`
+	err := testutil.GatherAndCompare(reg, strings.NewReader(want), "http_server_connections")
+	assert.NoError(t, err, "Open connections should be tracked once each in their last state")
+}
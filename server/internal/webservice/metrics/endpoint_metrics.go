@@ -29,6 +29,14 @@ const (
 	RejectReasonUnreadablePayload = "unreadable_payload"
 	// RejectReasonInvalidJSON indicates the request body contained invalid JSON.
 	RejectReasonInvalidJSON = "invalid_json"
+	// RejectReasonUnknownBase indicates the request was a delta against a report the server does not hold.
+	RejectReasonUnknownBase = "unknown_base"
+	// RejectReasonRateLimited indicates the client sent more requests than its budget allows.
+	RejectReasonRateLimited = "rate_limited"
+	// RejectReasonOverloaded indicates the request was shed by the admission control.
+	RejectReasonOverloaded = "overloaded"
+	// RejectReasonTimeout indicates the request did not complete before the request timeout.
+	RejectReasonTimeout = "timeout"
 	// RejectReasonInternalServerErr indicates the request failed due to an internal server error.
 	RejectReasonInternalServerErr = "internal_server_error"
 )
@@ -0,0 +1,67 @@
+package metrics
+
+import (
+	"errors"
+	"net"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/promauto"
+)
+
+// LabelListener is the label used for the listener in metrics.
+const LabelListener label = "listener"
+
+// ListenerMiddleware is a middleware for collecting metrics on the connections accepted by listeners.
+type ListenerMiddleware struct {
+	acceptedTotal     *prometheus.CounterVec
+	acceptErrorsTotal *prometheus.CounterVec
+}
+
+// NewListenerMiddleware creates a new ListenerMiddleware instance with the provided registry.
+func NewListenerMiddleware(registry prometheus.Registerer) *ListenerMiddleware {
+	return &ListenerMiddleware{
+		acceptedTotal: promauto.With(registry).NewCounterVec(
+			prometheus.CounterOpts{
+				Name: "net_listener_accepted_connections_total",
+				Help: "Tracks the number of connections accepted by the listener.",
+			}, []string{string(LabelListener)},
+		),
+		acceptErrorsTotal: promauto.With(registry).NewCounterVec(
+			prometheus.CounterOpts{
+				Name: "net_listener_accept_errors_total",
+				Help: "Tracks the number of failures to accept a connection on the listener.",
+			}, []string{string(LabelListener)},
+		),
+	}
+}
+
+// Wrap is a middleware function that wraps a listener to collect metrics on the connections it accepts.
+// Listeners of a server must be wrapped with different names.
+func (m *ListenerMiddleware) Wrap(listenerName string, l net.Listener) net.Listener {
+	return &instrumentedListener{
+		Listener:     l,
+		accepted:     m.acceptedTotal.WithLabelValues(listenerName),
+		acceptErrors: m.acceptErrorsTotal.WithLabelValues(listenerName),
+	}
+}
+
+// instrumentedListener is a listener which counts the connections it accepts, and its failures to accept them.
+type instrumentedListener struct {
+	net.Listener
+	accepted     prometheus.Counter
+	acceptErrors prometheus.Counter
+}
+
+// Accept waits for and returns the next connection to the listener.
+func (l *instrumentedListener) Accept() (net.Conn, error) {
+	c, err := l.Listener.Accept()
+	if err != nil {
+		// Closing the listener is how servers stop accepting connections, rather than a failure.
+		if !errors.Is(err, net.ErrClosed) {
+			l.acceptErrors.Inc()
+		}
+		return nil, err
+	}
+	l.accepted.Inc()
+	return c, nil
+}
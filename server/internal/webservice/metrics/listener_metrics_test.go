@@ -0,0 +1,90 @@
+package metrics_test
+
+import (
+	"net"
+	"strconv"
+	"testing"
+
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/testutil"
+	"github.com/prometheus/common/expfmt"
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/testutils"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
+)
+
+func TestNewListenerMiddleware(t *testing.T) {
+	t.Parallel()
+
+	// Ensure middleware is returned and no panic occurs.
+	require.NotNil(t, metrics.NewListenerMiddleware(prometheus.NewRegistry()))
+}
+
+func TestListenerMiddlewareWrap(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		connections []int // Number of connections accepted by each listener.
+		acceptErr   bool
+	}{
+		"No Connections":       {connections: []int{0}},
+		"Single Connection":    {connections: []int{1}},
+		"Multiple Connections": {connections: []int{3}},
+		"Multiple Listeners":   {connections: []int{2, 0, 1}},
+		"Accept Error":         {connections: []int{1}, acceptErr: true},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			reg := prometheus.NewRegistry()
+			mw := metrics.NewListenerMiddleware(reg)
+
+			for i, n := range tc.connections {
+				l, err := net.Listen("tcp", "127.0.0.1:0")
+				require.NoError(t, err, "Setup: failed to listen")
+				monitored := mw.Wrap(strconv.Itoa(i), l)
+
+				for range n {
+					c, err := net.Dial("tcp", l.Addr().String())
+					require.NoError(t, err, "Setup: failed to connect to listener")
+					defer c.Close()
+
+					a, err := monitored.Accept()
+					require.NoError(t, err, "Accept should not fail")
+					defer a.Close()
+				}
+
+				if tc.acceptErr {
+					_, err := mw.Wrap(strconv.Itoa(i), failingListener{l}).Accept()
+					require.Error(t, err, "Accept should fail")
+				}
+
+				require.NoError(t, monitored.Close(), "Setup: failed to close listener")
+				_, err = monitored.Accept()
+				require.ErrorIs(t, err, net.ErrClosed, "Accept should fail once the listener is closed")
+			}
+
+			got := make(map[string]string)
+			for _, name := range []string{"net_listener_accepted_connections_total", "net_listener_accept_errors_total"} {
+				b, err := testutil.CollectAndFormat(reg, expfmt.TypeTextPlain, name)
+				require.NoError(t, err, "Failed to collect metrics for %s", name)
+				got[name] = string(b)
+			}
+
+			want := testutils.LoadWithUpdateFromGoldenYAML(t, got)
+			assert.Equal(t, want, got, "Collected metrics do not match expected values")
+		})
+	}
+}
+
+// failingListener is a listener which fails to accept connections.
+type failingListener struct {
+	net.Listener
+}
+
+func (failingListener) Accept() (net.Conn, error) {
+	return nil, &net.OpError{Op: "accept", Net: "tcp", Err: assert.AnError}
+}
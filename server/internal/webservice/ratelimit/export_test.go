@@ -0,0 +1,27 @@
+package ratelimit
+
+import "time"
+
+// WithTick sets the resolution of the clock of the Limiter.
+func WithTick(d time.Duration) Options {
+	return func(o *options) {
+		o.tick = d
+	}
+}
+
+// Advance advances the clock of the Limiter by d, rounded down to its resolution, and drops the buckets which are
+// full again.
+func (l *Limiter) Advance(d time.Duration) {
+	l.sweep(l.now.Add(int64(d / l.tick)))
+}
+
+// Buckets returns the number of buckets held by the Limiter.
+func (l *Limiter) Buckets() int {
+	var n int
+	for i := range l.shards {
+		l.shards[i].mu.Lock()
+		n += len(l.shards[i].buckets)
+		l.shards[i].mu.Unlock()
+	}
+	return n
+}
@@ -0,0 +1,238 @@
+// Package ratelimit provides the per-client rate limiting of uploads to the web service.
+//
+// Clients get a token bucket by app, keyed by their address prefix. Buckets are spread over shards, each with its
+// own lock, and refilled from a coarse clock, so that limiting requests neither contends on a single lock nor reads
+// the time. The budgets of the apps are a snapshot of the configuration, swapped as it is reloaded.
+//
+// Clients are keyed by the address of their peer, unless it is a trusted proxy, in which case the address it
+// forwards the request for in X-Forwarded-For is used.
+package ratelimit
+
+import (
+	"context"
+	"hash/maphash"
+	"net/http"
+	"net/netip"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/ubuntu/ubuntu-insights/server/internal/common/config"
+)
+
+const (
+	// numShards is the number of shards buckets are spread over.
+	numShards = 64
+	// defaultTick is the resolution of the clock buckets are refilled from.
+	defaultTick = 100 * time.Millisecond
+	// sweepInterval is how often buckets which are full again are dropped.
+	sweepInterval = time.Minute
+
+	// ipv4PrefixBits and ipv6PrefixBits are the lengths of the prefixes clients are keyed by.
+	// IPv6 clients usually get a whole /64 to pick their addresses from.
+	ipv4PrefixBits = 32
+	ipv6PrefixBits = 64
+)
+
+// key identifies the bucket of a client for an app.
+type key struct {
+	prefix netip.Prefix
+	app    string
+}
+
+// bucket is the tokens left to a client for an app, as of the tick last.
+type bucket struct {
+	tokens float64
+	last   int64
+	// full is the tick at which the bucket is full again, and can be dropped.
+	full int64
+}
+
+type shard struct {
+	mu      sync.Mutex
+	buckets map[key]bucket
+}
+
+// Limiter limits the rate at which each client uploads for each app.
+type Limiter struct {
+	def     config.RateLimit
+	budgets atomic.Pointer[map[string]config.RateLimit]
+
+	trustedProxies []netip.Prefix
+
+	seed   maphash.Seed
+	shards [numShards]shard
+
+	tick time.Duration
+	// now is the coarse clock, in ticks since the Limiter was created.
+	now atomic.Int64
+}
+
+type options struct {
+	tick           time.Duration
+	trustedProxies []netip.Prefix
+}
+
+// Options represents an optional function to override Limiter default values.
+type Options func(*options)
+
+// WithTrustedProxies sets the proxies whose X-Forwarded-For header is trusted for the address of their clients.
+func WithTrustedProxies(prefixes []netip.Prefix) Options {
+	return func(o *options) {
+		o.trustedProxies = prefixes
+	}
+}
+
+// New creates a Limiter with the default budget def, which budgets overrides for the apps it has one for.
+// Its clock only advances while Run.
+func New(def config.RateLimit, budgets map[string]config.RateLimit, args ...Options) *Limiter {
+	opts := options{tick: defaultTick}
+	for _, opt := range args {
+		opt(&opts)
+	}
+
+	l := &Limiter{
+		def:            def,
+		trustedProxies: opts.trustedProxies,
+		seed:           maphash.MakeSeed(),
+		tick:           opts.tick,
+	}
+	l.SetBudgets(budgets)
+	for i := range l.shards {
+		l.shards[i].buckets = make(map[key]bucket)
+	}
+	return l
+}
+
+// SetBudgets replaces the budgets overriding the default one for some apps, as the configuration is reloaded.
+// The buckets of the clients are kept, and refilled at the new rate from now on.
+func (l *Limiter) SetBudgets(budgets map[string]config.RateLimit) {
+	l.budgets.Store(&budgets)
+}
+
+// Run advances the clock of the Limiter and drops the buckets which are full again, until ctx is done.
+func (l *Limiter) Run(ctx context.Context) {
+	t := time.NewTicker(l.tick)
+	defer t.Stop()
+	sweepEvery := max(int64(sweepInterval/l.tick), 1)
+	for {
+		select {
+		case <-ctx.Done():
+			return
+		case <-t.C:
+			if now := l.now.Add(1); now%sweepEvery == 0 {
+				l.sweep(now)
+			}
+		}
+	}
+}
+
+// Allow returns whether the client of r can upload for app now, or else how long it should wait.
+// Clients whose address can't be parsed are not limited.
+func (l *Limiter) Allow(r *http.Request, app string) (retryAfter time.Duration, ok bool) {
+	budget := l.def
+	if b, found := (*l.budgets.Load())[app]; found {
+		budget = b
+	}
+	if budget.Rate <= 0 {
+		return 0, true
+	}
+	burst := float64(max(budget.Burst, 1))
+
+	addr, known := l.clientAddr(r)
+	if !known {
+		return 0, true
+	}
+	k := key{prefix: clientPrefix(addr), app: app}
+	// Tokens a client gets by tick.
+	perTick := budget.Rate * l.tick.Seconds()
+
+	now := l.now.Load()
+	s := &l.shards[maphash.Comparable(l.seed, k)%numShards]
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	b, found := s.buckets[k]
+	if !found {
+		b = bucket{tokens: burst, last: now}
+	}
+	b.tokens = min(b.tokens+float64(now-b.last)*perTick, burst)
+	b.last = now
+
+	if b.tokens >= 1 {
+		b.tokens--
+		ok = true
+	} else {
+		retryAfter = time.Duration((1 - b.tokens) / budget.Rate * float64(time.Second))
+	}
+	b.full = now + int64((burst-b.tokens)/perTick) + 1
+	s.buckets[k] = b
+	return retryAfter, ok
+}
+
+// sweep drops the buckets which are full at the tick now, as new ones are created full.
+func (l *Limiter) sweep(now int64) {
+	for i := range l.shards {
+		s := &l.shards[i]
+		s.mu.Lock()
+		for k, b := range s.buckets {
+			if b.full <= now {
+				delete(s.buckets, k)
+			}
+		}
+		s.mu.Unlock()
+	}
+}
+
+// clientAddr returns the address of the client of r: its peer, or the address the trusted proxies in front of it
+// forwarded the request for. The rightmost address of X-Forwarded-For which is not a trusted proxy is the client,
+// as the ones on its left are set by the client itself.
+func (l *Limiter) clientAddr(r *http.Request) (netip.Addr, bool) {
+	addrPort, err := netip.ParseAddrPort(r.RemoteAddr)
+	if err != nil {
+		return netip.Addr{}, false
+	}
+	addr := addrPort.Addr().Unmap()
+	if !l.trusted(addr) {
+		return addr, true
+	}
+
+	forwarded := r.Header.Values("X-Forwarded-For")
+	for i := len(forwarded) - 1; i >= 0; i-- {
+		hops := strings.Split(forwarded[i], ",")
+		for j := len(hops) - 1; j >= 0; j-- {
+			hop, err := netip.ParseAddr(strings.TrimSpace(hops[j]))
+			if err != nil {
+				// The proxy which forwarded it is the last address known.
+				return addr, true
+			}
+			addr = hop.Unmap()
+			if !l.trusted(addr) {
+				return addr, true
+			}
+		}
+	}
+	return addr, true
+}
+
+// trusted returns whether addr is a trusted proxy.
+func (l *Limiter) trusted(addr netip.Addr) bool {
+	for _, p := range l.trustedProxies {
+		if p.Contains(addr) {
+			return true
+		}
+	}
+	return false
+}
+
+// clientPrefix returns the prefix clients at addr are keyed by.
+func clientPrefix(addr netip.Addr) netip.Prefix {
+	addr = addr.Unmap()
+	bits := ipv4PrefixBits
+	if addr.Is6() {
+		bits = ipv6PrefixBits
+	}
+	p, _ := addr.Prefix(bits)
+	return p
+}
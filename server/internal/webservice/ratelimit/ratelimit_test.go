@@ -0,0 +1,270 @@
+package ratelimit_test
+
+import (
+	"context"
+	"net/http"
+	"net/http/httptest"
+	"net/netip"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/assert"
+	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/server/internal/common/config"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/ratelimit"
+)
+
+const tick = 100 * time.Millisecond
+
+func TestAllow(t *testing.T) {
+	t.Parallel()
+
+	type request struct {
+		advance time.Duration // advance is how long after the previous request it is sent.
+		addr    string
+		app     string
+		// forwardedFor is the X-Forwarded-For header of the request, if any.
+		forwardedFor string
+
+		wantLimited    bool
+		wantRetryAfter time.Duration
+	}
+
+	tests := map[string]struct {
+		def            config.RateLimit
+		budgets        map[string]config.RateLimit
+		trustedProxies []netip.Prefix
+
+		requests []request
+	}{
+		"Not limited without budget": {
+			requests: []request{{}, {}, {}, {}},
+		},
+		"Allowed within burst": {
+			def:      config.RateLimit{Rate: 1, Burst: 3},
+			requests: []request{{}, {}, {}},
+		},
+		"Limited past burst": {
+			def:      config.RateLimit{Rate: 1, Burst: 2},
+			requests: []request{{}, {}, {wantLimited: true, wantRetryAfter: time.Second}},
+		},
+		"Burst is at least one upload": {
+			def:      config.RateLimit{Rate: 1},
+			requests: []request{{}, {wantLimited: true, wantRetryAfter: time.Second}},
+		},
+		"Retry after accounts for partial refill": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{},
+				{advance: 400 * time.Millisecond, wantLimited: true, wantRetryAfter: 600 * time.Millisecond},
+			},
+		},
+		"Allowed again once refilled": {
+			def: config.RateLimit{Rate: 2, Burst: 1},
+			requests: []request{
+				{},
+				{wantLimited: true, wantRetryAfter: 500 * time.Millisecond},
+				{advance: 500 * time.Millisecond},
+			},
+		},
+		"Refill does not exceed burst": {
+			def: config.RateLimit{Rate: 10, Burst: 2},
+			requests: []request{
+				{advance: time.Hour}, {}, {wantLimited: true, wantRetryAfter: 100 * time.Millisecond},
+			},
+		},
+		"Limited requests do not consume tokens": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{},
+				{wantLimited: true, wantRetryAfter: time.Second},
+				{wantLimited: true, wantRetryAfter: time.Second},
+				{advance: time.Second},
+			},
+		},
+		"Clients are limited separately": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{addr: "192.0.2.1:1000"},
+				{addr: "192.0.2.2:1000"},
+				{addr: "192.0.2.1:1001", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"IPv4 mapped clients are limited as IPv4 ones": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{addr: "192.0.2.1:1000"},
+				{addr: "[::ffff:192.0.2.1]:1000", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"IPv6 clients are limited by /64": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{addr: "[2001:db8:0:1::1]:1000"},
+				{addr: "[2001:db8:0:2::1]:1000"},
+				{addr: "[2001:db8:0:1::2]:1000", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"Apps are limited separately": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{app: "linux"},
+				{app: "windows"},
+				{app: "linux", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"App budget overrides default": {
+			def:     config.RateLimit{Rate: 1, Burst: 1},
+			budgets: map[string]config.RateLimit{"linux": {Rate: 1, Burst: 3}},
+			requests: []request{
+				{app: "linux"}, {app: "linux"}, {app: "linux"},
+				{app: "windows"},
+				{app: "windows", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"App budget can lift the default one": {
+			def:      config.RateLimit{Rate: 1, Burst: 1},
+			budgets:  map[string]config.RateLimit{"linux": {}},
+			requests: []request{{app: "linux"}, {app: "linux"}, {app: "linux"}},
+		},
+		"Unparsable client address is not limited": {
+			def:      config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{{addr: "@"}, {addr: "@"}},
+		},
+
+		// Proxies.
+		"Forwarded address is ignored without trusted proxies": {
+			def: config.RateLimit{Rate: 1, Burst: 1},
+			requests: []request{
+				{forwardedFor: "198.51.100.1"},
+				{forwardedFor: "198.51.100.2", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"Forwarded address is ignored from untrusted peers": {
+			def:            config.RateLimit{Rate: 1, Burst: 1},
+			trustedProxies: []netip.Prefix{netip.MustParsePrefix("203.0.113.0/24")},
+			requests: []request{
+				{forwardedFor: "198.51.100.1"},
+				{forwardedFor: "198.51.100.2", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"Clients behind trusted proxies are limited separately": {
+			def:            config.RateLimit{Rate: 1, Burst: 1},
+			trustedProxies: []netip.Prefix{netip.MustParsePrefix("203.0.113.0/24")},
+			requests: []request{
+				{addr: "203.0.113.1:1000", forwardedFor: "198.51.100.1"},
+				{addr: "203.0.113.1:1000", forwardedFor: "198.51.100.2"},
+				{addr: "203.0.113.2:1000", forwardedFor: "198.51.100.1", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"Clients behind trusted proxies are keyed by the rightmost untrusted address": {
+			def:            config.RateLimit{Rate: 1, Burst: 1},
+			trustedProxies: []netip.Prefix{netip.MustParsePrefix("203.0.113.0/24")},
+			requests: []request{
+				{addr: "203.0.113.1:1000", forwardedFor: "192.0.2.7, 198.51.100.1, 203.0.113.2"},
+				{addr: "203.0.113.1:1000", forwardedFor: "192.0.2.8, 198.51.100.1", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+		"Trusted proxy is limited with an unparsable forwarded address": {
+			def:            config.RateLimit{Rate: 1, Burst: 1},
+			trustedProxies: []netip.Prefix{netip.MustParsePrefix("203.0.113.0/24")},
+			requests: []request{
+				{addr: "203.0.113.1:1000", forwardedFor: "unknown"},
+				{addr: "203.0.113.1:1000", wantLimited: true, wantRetryAfter: time.Second},
+			},
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			l := ratelimit.New(tc.def, tc.budgets, ratelimit.WithTick(tick), ratelimit.WithTrustedProxies(tc.trustedProxies))
+
+			for i, req := range tc.requests {
+				if req.addr == "" {
+					req.addr = "192.0.2.1:1000"
+				}
+				if req.app == "" {
+					req.app = "linux"
+				}
+				l.Advance(req.advance)
+
+				r := httptest.NewRequest(http.MethodPost, "/upload/"+req.app, nil)
+				r.RemoteAddr = req.addr
+				if req.forwardedFor != "" {
+					r.Header.Set("X-Forwarded-For", req.forwardedFor)
+				}
+				retryAfter, ok := l.Allow(r, req.app)
+				assert.Equal(t, !req.wantLimited, ok, "Unexpected limiting of request %d", i)
+				assert.InDelta(t, req.wantRetryAfter, retryAfter, float64(time.Millisecond), "Unexpected retry delay of request %d", i)
+			}
+		})
+	}
+}
+
+func TestSetBudgets(t *testing.T) {
+	t.Parallel()
+
+	l := ratelimit.New(config.RateLimit{Rate: 1, Burst: 1}, nil, ratelimit.WithTick(tick))
+	r := httptest.NewRequest(http.MethodPost, "/upload/linux", nil)
+	r.RemoteAddr = "192.0.2.1:1000"
+	_, ok := l.Allow(r, "linux")
+	require.True(t, ok, "Setup: first request should be allowed")
+	_, ok = l.Allow(r, "linux")
+	require.False(t, ok, "Setup: second request should be limited")
+
+	l.SetBudgets(map[string]config.RateLimit{"linux": {}})
+	_, ok = l.Allow(r, "linux")
+	assert.True(t, ok, "Requests should be allowed once the budget of the app is lifted")
+
+	l.SetBudgets(nil)
+	_, ok = l.Allow(r, "linux")
+	assert.False(t, ok, "Requests should be limited again by the default budget")
+}
+
+func TestSweep(t *testing.T) {
+	t.Parallel()
+
+	l := ratelimit.New(config.RateLimit{Rate: 1, Burst: 2}, nil, ratelimit.WithTick(tick))
+	for _, addr := range []string{"192.0.2.1:1000", "192.0.2.2:1000", "192.0.2.2:1000"} {
+		r := httptest.NewRequest(http.MethodPost, "/upload/linux", nil)
+		r.RemoteAddr = addr
+		_, ok := l.Allow(r, "linux")
+		require.True(t, ok, "Setup: request should be allowed")
+	}
+	require.Equal(t, 2, l.Buckets(), "Setup: a bucket should be held by client")
+
+	l.Advance(1500 * time.Millisecond)
+	assert.Equal(t, 1, l.Buckets(), "Buckets which are full again should be dropped")
+	l.Advance(time.Second)
+	assert.Equal(t, 0, l.Buckets(), "Buckets which are full again should be dropped")
+}
+
+func TestRun(t *testing.T) {
+	t.Parallel()
+
+	l := ratelimit.New(config.RateLimit{Rate: 100, Burst: 1}, nil, ratelimit.WithTick(time.Millisecond))
+	ctx, cancel := context.WithCancel(context.Background())
+	done := make(chan struct{})
+	go func() {
+		defer close(done)
+		l.Run(ctx)
+	}()
+
+	r := httptest.NewRequest(http.MethodPost, "/upload/linux", nil)
+	r.RemoteAddr = "192.0.2.1:1000"
+	_, ok := l.Allow(r, "linux")
+	require.True(t, ok, "First request should be allowed")
+	require.Eventually(t, func() bool {
+		_, ok := l.Allow(r, "linux")
+		return ok
+	}, 5*time.Second, time.Millisecond, "Requests should be allowed again as the clock advances")
+
+	cancel()
+	select {
+	case <-done:
+	case <-time.After(5 * time.Second):
+		require.Fail(t, "Run should return once its context is done")
+	}
+}
@@ -0,0 +1,13 @@
+//go:build !linux
+
+package webservice
+
+import (
+	"errors"
+	"syscall"
+)
+
+// reusePort is not supported outside Linux, where the primary server only accepts connections on a single listener.
+func reusePort(string, string, syscall.RawConn) error {
+	return errors.New("SO_REUSEPORT listeners are only supported on Linux")
+}
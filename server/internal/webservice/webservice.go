@@ -3,19 +3,28 @@ package webservice
 
 import (
 	"context"
+	"crypto/tls"
 	"errors"
 	"fmt"
 	"log/slog"
 	"net"
 	"net/http"
+	"net/netip"
+	"runtime"
+	"strconv"
 	"sync"
 	"time"
 
 	"github.com/prometheus/client_golang/prometheus"
 	"github.com/prometheus/client_golang/prometheus/collectors"
 	"github.com/prometheus/client_golang/prometheus/promhttp"
+	"github.com/ubuntu/ubuntu-insights/common/fileutils"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
+	"github.com/ubuntu/ubuntu-insights/server/internal/common/config"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/admission"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/handlers"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/metrics"
+	"github.com/ubuntu/ubuntu-insights/server/internal/webservice/ratelimit"
 )
 
 // Server is a struct that holds the HTTP server and its configuration.
@@ -24,6 +33,15 @@ type Server struct {
 	metricsServer *http.Server
 	cm            dConfigManager
 
+	reusePort  bool
+	listeners  int
+	listenerMW *metrics.ListenerMiddleware
+	connMW     *metrics.ConnMiddleware
+
+	// admission sheds uploads while the reports spool is overloaded. It is nil when no watermark is set.
+	admission *admission.Controller
+	limiter   *ratelimit.Limiter
+
 	primaryAddr net.Addr
 	metricsAddr net.Addr
 
@@ -46,12 +64,69 @@ type StaticConfig struct {
 	ReadTimeout    time.Duration
 	WriteTimeout   time.Duration
 	RequestTimeout time.Duration
+	// IdleTimeout is how long the primary server keeps connections open waiting for the next request, for clients
+	// to upload their backlog over a single one. It defaults to ReadTimeout.
+	IdleTimeout    time.Duration
 	MaxHeaderBytes int
 	MaxUploadBytes int
 
+	// MaxDeltaBaseBytes is the memory the reports uploaded by clients sending deltas are kept in, for their next
+	// upload to be a delta against them. Bases are lost on restart and evicted as others are uploaded, so deltas only
+	// pay off for sources uploading again within that lifetime: other clients pay an extra round trip before their
+	// full upload. Zero disables deltas.
+	MaxDeltaBaseBytes int
+
+	// SpoolSync is how durable a report is once acknowledged to its client: "none" leaves flushing it to the kernel,
+	// "file" flushes its content to disk and "file-and-dir" also flushes its directory entry. Saving is atomic in all
+	// cases, and a crash of the server alone loses nothing, only a power failure or a kernel crash can. An empty
+	// policy is "none".
+	SpoolSync string
+
+	// UploadWindow is the period over which clients are asked to spread their uploads. Zero asks them not to.
+	UploadWindow time.Duration
+
+	// SpoolMaxReports and SpoolMaxBytes are the number and the size of the reports of an app waiting to be ingested
+	// past which its uploads are shed. MinFreeBytes is the free space of the reports filesystem under which uploads
+	// are shed, small ones like opt-out reports being kept until half of it is left. Zero disables a watermark.
+	SpoolMaxReports int
+	SpoolMaxBytes   int64
+	MinFreeBytes    int64
+	// ShedRetryAfter is how long clients whose uploads are shed are asked to wait before trying again.
+	ShedRetryAfter time.Duration
+
+	// RateLimit is the number of uploads per second each client can sustain for an app, and RateBurst the number it
+	// can send at once. The allowlist configuration can override them by app. Clients are not limited if RateLimit
+	// is not positive.
+	RateLimit float64
+	RateBurst int
+	// TrustedProxies are the addresses or CIDR prefixes of the proxies in front of the server. Clients connecting
+	// through them are rate limited by the address they forward in X-Forwarded-For, rather than by their own.
+	TrustedProxies []string
+
 	ListenHost string
 	ListenPort int
 
+	// ReusePort makes the primary server accept connections on Listeners SO_REUSEPORT listeners sharing its address,
+	// rather than on a single one. The kernel spreads incoming connections across them. It is only supported on Linux.
+	ReusePort bool
+	// Listeners is the number of listeners of the primary server when ReusePort is set. It defaults to one per CPU.
+	Listeners int
+
+	// TLSCertFile and TLSKeyFile make the primary server serve TLS with this certificate and key, negotiating HTTP/2
+	// with the clients which support it. Both or neither must be set.
+	TLSCertFile string
+	TLSKeyFile  string
+	// H2C makes the primary server accept cleartext HTTP/2 connections with prior knowledge, as proxies open them,
+	// alongside HTTP/1 ones.
+	H2C bool
+
+	// HTTP2MaxStreams is the number of concurrent streams each HTTP/2 connection can carry. HTTP2ConnWindow and
+	// HTTP2StreamWindow are the flow control windows of connections and of their streams, which is how much a client
+	// can send before waiting for the server to read it. Zero values use the net/http defaults.
+	HTTP2MaxStreams   int
+	HTTP2ConnWindow   int
+	HTTP2StreamWindow int
+
 	MetricsHost string
 	MetricsPort int
 }
@@ -60,6 +135,7 @@ type dConfigManager interface {
 	Load() error
 	Watch(context.Context) (<-chan struct{}, <-chan error, error)
 	IsAllowed(string) bool
+	RateLimits() map[string]config.RateLimit
 }
 
 // New creates a new Server instance with the given http.Server and config.ConfigManager.
@@ -76,6 +152,9 @@ func New(ctx context.Context, cm dConfigManager, sc StaticConfig) (*Server, erro
 		ctx:    ctx,
 		cancel: cancel,
 
+		reusePort: sc.ReusePort,
+		listeners: sc.Listeners,
+
 		gracefulCtx:    gCtx,
 		gracefulCancel: gCancel}
 
@@ -84,13 +163,69 @@ func New(ctx context.Context, cm dConfigManager, sc StaticConfig) (*Server, erro
 		collectors.NewGoCollector(),
 		collectors.NewProcessCollector(collectors.ProcessCollectorOpts{}),
 	)
+	s.listenerMW = metrics.NewListenerMiddleware(registry)
+	s.connMW = metrics.NewConnMiddleware(registry)
+
+	tlsConfig, err := loadTLSConfig(sc.TLSCertFile, sc.TLSKeyFile)
+	if err != nil {
+		cancel()
+		return nil, err
+	}
+
+	spoolSync, ok := spoolSyncPolicies[sc.SpoolSync]
+	if !ok {
+		cancel()
+		return nil, fmt.Errorf("invalid spool sync policy %q", sc.SpoolSync)
+	}
+
+	limits := admission.Limits{
+		SpoolReports: sc.SpoolMaxReports,
+		SpoolBytes:   sc.SpoolMaxBytes,
+		MinFreeBytes: sc.MinFreeBytes,
+		RetryAfter:   sc.ShedRetryAfter,
+	}
+	// The handlers must get a nil interface, rather than a nil controller, to admit all uploads.
+	var admitter handlers.Admitter
+	if limits.Enabled() {
+		ac, err := admission.New(sc.ReportsDir, limits, registry)
+		if err != nil {
+			cancel()
+			return nil, fmt.Errorf("failed to create admission control: %v", err)
+		}
+		s.admission = ac
+		admitter = ac
+	}
+
+	trustedProxies, err := parseTrustedProxies(sc.TrustedProxies)
+	if err != nil {
+		cancel()
+		return nil, err
+	}
+	s.limiter = ratelimit.New(config.RateLimit{Rate: sc.RateLimit, Burst: sc.RateBurst}, cm.RateLimits(),
+		ratelimit.WithTrustedProxies(trustedProxies))
+
+	// HTTP/2 is negotiated over TLS, and only spoken in cleartext to the clients which know it is.
+	protocols := new(http.Protocols)
+	protocols.SetHTTP1(true)
+	protocols.SetHTTP2(true)
+	protocols.SetUnencryptedHTTP2(sc.H2C)
 
 	s.httpServer = &http.Server{
 		Addr:           fmt.Sprintf("%s:%d", sc.ListenHost, sc.ListenPort),
 		ReadTimeout:    sc.ReadTimeout,
 		WriteTimeout:   sc.WriteTimeout,
-		Handler:        http.TimeoutHandler(setupPrimaryMux(cm, sc, registry), sc.RequestTimeout, ""),
+		IdleTimeout:    sc.IdleTimeout,
+		Handler:        s.connMW.Wrap(withRequestTimeout(sc.RequestTimeout, setupPrimaryMux(cm, sc, spoolSync, admitter, s.limiter, registry))),
 		MaxHeaderBytes: sc.MaxHeaderBytes,
+		TLSConfig:      tlsConfig,
+		ConnState:      s.connMW.ConnState,
+		Protocols:      protocols,
+		HTTP2: &http.HTTP2Config{
+			MaxConcurrentStreams:          sc.HTTP2MaxStreams,
+			MaxReceiveBufferPerConnection: sc.HTTP2ConnWindow,
+			MaxReceiveBufferPerStream:     sc.HTTP2StreamWindow,
+			CountError:                    s.connMW.CountError,
+		},
 	}
 
 	s.metricsServer = &http.Server{
@@ -103,39 +238,120 @@ func New(ctx context.Context, cm dConfigManager, sc StaticConfig) (*Server, erro
 	return &s, nil
 }
 
-func setupPrimaryMux(cm dConfigManager, sc StaticConfig, registry *prometheus.Registry) http.Handler {
+// spoolSyncPolicies are the values of StaticConfig.SpoolSync.
+var spoolSyncPolicies = map[string]fileutils.SyncPolicy{
+	"":             fileutils.SyncNone,
+	"none":         fileutils.SyncNone,
+	"file":         fileutils.SyncFile,
+	"file-and-dir": fileutils.SyncFileAndDir,
+}
+
+// parseTrustedProxies returns the prefixes of the trusted proxies, which are either addresses or CIDR prefixes.
+func parseTrustedProxies(proxies []string) ([]netip.Prefix, error) {
+	prefixes := make([]netip.Prefix, 0, len(proxies))
+	for _, p := range proxies {
+		prefix, err := netip.ParsePrefix(p)
+		if err != nil {
+			addr, errAddr := netip.ParseAddr(p)
+			if errAddr != nil {
+				return nil, fmt.Errorf("invalid trusted proxy %q: %v", p, err)
+			}
+			prefix = netip.PrefixFrom(addr, addr.BitLen())
+		}
+		prefixes = append(prefixes, prefix.Masked())
+	}
+	return prefixes, nil
+}
+
+// loadTLSConfig returns the TLS configuration serving the certificate and key in certFile and keyFile, or nil if
+// neither is set.
+func loadTLSConfig(certFile, keyFile string) (*tls.Config, error) {
+	if certFile == "" && keyFile == "" {
+		return nil, nil
+	}
+	if certFile == "" || keyFile == "" {
+		return nil, fmt.Errorf("both a TLS certificate and key are required to serve TLS")
+	}
+
+	cert, err := tls.LoadX509KeyPair(certFile, keyFile)
+	if err != nil {
+		return nil, fmt.Errorf("failed to load TLS certificate: %v", err)
+	}
+	return &tls.Config{
+		Certificates: []tls.Certificate{cert},
+		MinVersion:   tls.VersionTLS12,
+	}, nil
+}
+
+func setupPrimaryMux(cm dConfigManager, sc StaticConfig, spoolSync fileutils.SyncPolicy, admitter handlers.Admitter, limiter handlers.Limiter, registry *prometheus.Registry) http.Handler {
 	endpointMW := metrics.NewEndpointMiddleware(registry)
 	muxMW := metrics.NewMuxMiddleware(registry)
 
-	mux := http.NewServeMux()
-	uploadHandler := handlers.NewUpload(cm, sc.ReportsDir, int64(sc.MaxUploadBytes))
-	legacyUploadHandler := handlers.NewLegacyReport(cm, sc.ReportsDir, int64(sc.MaxUploadBytes))
+	uploadHandler := handlers.NewUpload(cm, sc.ReportsDir, spoolSync, int64(sc.MaxUploadBytes), int64(sc.MaxDeltaBaseBytes), admitter, limiter)
+	legacyUploadHandler := handlers.NewLegacyReport(cm, sc.ReportsDir, spoolSync, int64(sc.MaxUploadBytes), admitter, limiter)
+
+	routes := map[string]http.Handler{
+		"POST /upload/{app}":                     endpointMW.Wrap("upload", advertiseUploadWindow(sc.UploadWindow, uploadHandler)),
+		"POST /{distribution}/desktop/{version}": endpointMW.Wrap("legacy_upload", legacyUploadHandler),
+		"GET /version":                           endpointMW.Wrap("version", http.HandlerFunc(handlers.VersionHandler)),
+	}
 
-	mux.Handle("POST /upload/{app}", endpointMW.Wrap("upload", uploadHandler))
-	mux.Handle("POST /{distribution}/desktop/{version}", endpointMW.Wrap("legacy_upload", legacyUploadHandler))
-	mux.Handle("GET /version", endpointMW.Wrap("version", http.HandlerFunc(handlers.VersionHandler)))
+	mux := http.NewServeMux()
+	// unmatched only serves the requests which match no route, to answer them as mux would without the fallback route.
+	unmatched := http.NewServeMux()
+	for pattern, h := range routes {
+		mux.Handle(pattern, h)
+		unmatched.Handle(pattern, h)
+	}
+	mux.Handle("/", debugUnknownEndpoint(unmatched))
 
-	return muxMW.Wrap("primary_mux", debugUnknownEndpoint(mux))
+	return muxMW.Wrap("primary_mux", mux)
 }
 
-// debugUnknownEndpoint is a middleware that debug logs requests that do not match any mux route.
-func debugUnknownEndpoint(mux *http.ServeMux) http.Handler {
+// withRequestTimeout is a middleware which bounds requests to timeout, if positive.
+// Once it is reached, the request context is done and reading the request body fails, for handlers to give up.
+// Unlike http.TimeoutHandler, it neither buffers responses nor serves requests in another goroutine.
+func withRequestTimeout(timeout time.Duration, next http.Handler) http.Handler {
+	if timeout <= 0 {
+		return next
+	}
 	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
-		_, pattern := mux.Handler(r)
-
-		if pattern == "" {
-			slog.Debug("Request hit unknown endpoint",
-				"method", r.Method,
-				"path", r.URL.Path,
-				"query", r.URL.RawQuery,
-				"host", r.Host,
-				"remote_addr", r.RemoteAddr,
-				"user_agent", r.UserAgent(),
-				"content_type", r.Header.Get("Content-Type"),
-			)
+		ctx, cancel := context.WithTimeout(r.Context(), timeout)
+		defer cancel()
+
+		deadline, _ := ctx.Deadline()
+		// The server resets the read deadline before reading the next request of the connection.
+		if err := http.NewResponseController(w).SetReadDeadline(deadline); err != nil {
+			slog.Debug("Failed to set the request read deadline", "err", err)
 		}
+		next.ServeHTTP(w, r.WithContext(ctx))
+	})
+}
+
+// advertiseUploadWindow is a middleware that advertises the upload window to clients, for them to spread their uploads
+// over it. A zero window is advertised too, for clients to stop following the one they kept from earlier answers.
+func advertiseUploadWindow(window time.Duration, next http.Handler) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		pacing.SetWindow(w.Header(), window)
+		next.ServeHTTP(w, r)
+	})
+}
 
-		mux.ServeHTTP(w, r)
+// debugUnknownEndpoint is the fallback route, which debug logs the requests that match no other route before
+// letting unmatched answer them.
+func debugUnknownEndpoint(unmatched http.Handler) http.Handler {
+	return http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		slog.Debug("Request hit unknown endpoint",
+			"method", r.Method,
+			"path", r.URL.Path,
+			"query", r.URL.RawQuery,
+			"host", r.Host,
+			"remote_addr", r.RemoteAddr,
+			"user_agent", r.UserAgent(),
+			"content_type", r.Header.Get("Content-Type"),
+		)
+
+		unmatched.ServeHTTP(w, r)
 	})
 }
 
@@ -175,7 +391,7 @@ func (s *Server) Run() error {
 
 // servePrimary starts the primary HTTP server and listens for incoming requests.
 func (s *Server) servePrimary() error {
-	slog.Info("Starting server", "addr", s.httpServer.Addr)
+	slog.Info("Starting server", "addr", s.httpServer.Addr, "tls", s.httpServer.TLSConfig != nil)
 
 	// already asked to quit?
 	select {
@@ -186,24 +402,56 @@ func (s *Server) servePrimary() error {
 
 	defer s.cancel()
 
-	_, watchErr, err := s.cm.Watch(s.gracefulCtx)
+	changes, watchErr, err := s.cm.Watch(s.gracefulCtx)
 	if err != nil {
 		return fmt.Errorf("failed to start watching configuration: %v", err)
 	}
 
+	// The limiter takes a snapshot of the budgets on each reload, rather than reading the configuration by request.
+	s.limiter.SetBudgets(s.cm.RateLimits())
+	go func() {
+		for range changes {
+			s.limiter.SetBudgets(s.cm.RateLimits())
+		}
+	}()
+
+	if s.admission != nil {
+		go s.admission.Run(s.gracefulCtx)
+	}
+	go s.limiter.Run(s.gracefulCtx)
+
 	serverErr := make(chan error, 1)
 	go func() {
 		defer close(serverErr)
-		l, err := net.Listen("tcp", s.httpServer.Addr)
+		ls, err := s.listenPrimary()
 		if err != nil {
 			serverErr <- err
 			return
 		}
 		s.mu.Lock()
-		s.primaryAddr = l.Addr()
+		s.primaryAddr = ls[0].Addr()
 		s.mu.Unlock()
+
+		serve := s.httpServer.Serve
+		if s.httpServer.TLSConfig != nil {
+			// The certificate is already loaded in the TLS configuration.
+			serve = func(l net.Listener) error { return s.httpServer.ServeTLS(l, "", "") }
+		}
+
 		// Listener lifecycle is managed by the server.
-		if err := s.httpServer.Serve(l); err != nil && err != http.ErrServerClosed {
+		// The server stops on the first listener failing, as it would with a single one.
+		errs := make([]error, len(ls))
+		var wg sync.WaitGroup
+		for i, l := range ls {
+			wg.Go(func() {
+				if err := serve(l); err != nil && err != http.ErrServerClosed {
+					errs[i] = err
+					s.httpServer.Close()
+				}
+			})
+		}
+		wg.Wait()
+		if err := errors.Join(errs...); err != nil {
 			serverErr <- err
 		}
 	}()
@@ -233,6 +481,40 @@ func (s *Server) servePrimary() error {
 	}
 }
 
+// listenPrimary opens the listeners of the primary server, instrumented to collect their metrics.
+func (s *Server) listenPrimary() ([]net.Listener, error) {
+	if !s.reusePort {
+		l, err := net.Listen("tcp", s.httpServer.Addr)
+		if err != nil {
+			return nil, err
+		}
+		return []net.Listener{s.listenerMW.Wrap("0", l)}, nil
+	}
+
+	n := s.listeners
+	if n <= 0 {
+		n = runtime.NumCPU()
+	}
+	slog.Info("Opening SO_REUSEPORT listeners", "count", n)
+
+	lc := net.ListenConfig{Control: reusePort}
+	addr := s.httpServer.Addr
+	ls := make([]net.Listener, 0, n)
+	for i := range n {
+		l, err := lc.Listen(s.ctx, "tcp", addr)
+		if err != nil {
+			for _, l := range ls {
+				l.Close()
+			}
+			return nil, fmt.Errorf("failed to open listener %d: %v", i, err)
+		}
+		// Other listeners bind the address of the first one, whose port the system picks if none is configured.
+		addr = l.Addr().String()
+		ls = append(ls, s.listenerMW.Wrap(strconv.Itoa(i), l))
+	}
+	return ls, nil
+}
+
 // serveMetrics starts the metrics HTTP server and listens for incoming requests.
 func (s *Server) serveMetrics() error {
 	slog.Info("Starting metrics server", "addr", s.metricsServer.Addr)
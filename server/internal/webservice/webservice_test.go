@@ -3,18 +3,31 @@ package webservice_test
 import (
 	"bytes"
 	"context"
+	"crypto/ecdsa"
+	"crypto/elliptic"
+	"crypto/rand"
+	"crypto/tls"
+	"crypto/x509"
+	"crypto/x509/pkix"
 	"encoding/json"
+	"encoding/pem"
 	"fmt"
+	"io"
+	"math/big"
+	"net"
 	"net/http"
 	"os"
 	"path/filepath"
+	"strings"
 	"sync"
 	"testing"
 	"time"
 
 	"github.com/stretchr/testify/assert"
 	"github.com/stretchr/testify/require"
+	"github.com/ubuntu/ubuntu-insights/common/pacing"
 	"github.com/ubuntu/ubuntu-insights/common/testutils"
+	"github.com/ubuntu/ubuntu-insights/server/internal/common/config"
 	"github.com/ubuntu/ubuntu-insights/server/internal/webservice"
 )
 
@@ -35,14 +48,44 @@ func TestNew(t *testing.T) {
 
 	tests := map[string]struct {
 		cmLoadErr error
+		withTLS   bool
+		certFile  string
+		keyFile   string
+		spoolSync string
+		proxies   []string
 
 		wantErr bool
 	}{
-		"Empty valid": {},
+		"Empty valid":                  {},
+		"Valid with TLS":               {withTLS: true},
+		"Valid with spool sync policy": {spoolSync: "file-and-dir"},
+		"Valid with trusted proxies":   {proxies: []string{"203.0.113.1", "2001:db8::/32"}},
+
 		"ConfigManager load error errors": {
 			cmLoadErr: assert.AnError,
 			wantErr:   true,
 		},
+		"Error with TLS certificate but no key": {
+			certFile: "cert.pem",
+			wantErr:  true,
+		},
+		"Error with TLS key but no certificate": {
+			keyFile: "key.pem",
+			wantErr: true,
+		},
+		"Error with missing TLS certificate": {
+			certFile: "does-not-exist.pem",
+			keyFile:  "does-not-exist.pem",
+			wantErr:  true,
+		},
+		"Error with invalid spool sync policy": {
+			spoolSync: "always",
+			wantErr:   true,
+		},
+		"Error with invalid trusted proxy": {
+			proxies: []string{"proxy.example.com"},
+			wantErr: true,
+		},
 	}
 
 	for name, tc := range tests {
@@ -50,7 +93,14 @@ func TestNew(t *testing.T) {
 			t.Parallel()
 
 			daemonConfig := webservice.StaticConfig{
-				ReportsDir: t.TempDir(),
+				ReportsDir:     t.TempDir(),
+				TLSCertFile:    tc.certFile,
+				TLSKeyFile:     tc.keyFile,
+				SpoolSync:      tc.spoolSync,
+				TrustedProxies: tc.proxies,
+			}
+			if tc.withTLS {
+				daemonConfig.TLSCertFile, daemonConfig.TLSKeyFile = writeTestCertificate(t, t.TempDir())
 			}
 
 			cm := &testConfigManager{
@@ -74,6 +124,7 @@ func TestServeMulti(t *testing.T) {
 	t.Parallel()
 	const defaultApp = "goodapp"
 	dConf := *defaultDaemonConfig
+	dConf.UploadWindow = 6 * time.Hour
 	cm := &testConfigManager{allowList: []string{defaultApp, "ubuntu-report/distribution/desktop/version"}}
 
 	s := createServerAndWaitReady(t, cm, &dConf, false)
@@ -84,6 +135,7 @@ func TestServeMulti(t *testing.T) {
 		contentType string
 		body        []byte
 		wantStatus  int
+		wantWindow  string
 		checkDir    string
 	}{
 		"Version": {
@@ -107,6 +159,7 @@ func TestServeMulti(t *testing.T) {
 			contentType: "application/json",
 			body:        []byte(`{"foo":"bar"}`),
 			wantStatus:  http.StatusForbidden,
+			wantWindow:  "21600",
 		},
 		"InvalidJSON BadRequest": {
 			method:      http.MethodPost,
@@ -114,6 +167,7 @@ func TestServeMulti(t *testing.T) {
 			contentType: "application/json",
 			body:        []byte(`not-json`),
 			wantStatus:  http.StatusBadRequest,
+			wantWindow:  "21600",
 		},
 		"Valid Upload Accepted": {
 			method:      http.MethodPost,
@@ -122,6 +176,7 @@ func TestServeMulti(t *testing.T) {
 			body:        []byte(`{"foo":"bar"}`),
 			checkDir:    defaultApp,
 			wantStatus:  http.StatusAccepted,
+			wantWindow:  "21600",
 		},
 		"Ubuntu Report backwards compatibility": {
 			method:      http.MethodPost,
@@ -146,6 +201,7 @@ func TestServeMulti(t *testing.T) {
 			defer resp.Body.Close()
 
 			assert.Equal(t, tc.wantStatus, resp.StatusCode, "Unexpected status response")
+			assert.Equal(t, tc.wantWindow, resp.Header.Get(pacing.WindowHeader), "Unexpected upload window")
 			if tc.checkDir != "" {
 				files, err := os.ReadDir(filepath.Join(dConf.ReportsDir, tc.checkDir))
 				require.NoError(t, err)
@@ -178,6 +234,7 @@ func TestRunSingle(t *testing.T) {
 
 		checkDir   string
 		wantStatus int
+		wantWindow string // wantWindow is the upload window advertised to the client, only checked if set.
 		wantErr    bool
 	}{
 		"Version": {
@@ -185,7 +242,7 @@ func TestRunSingle(t *testing.T) {
 			path:       "/version",
 			wantStatus: http.StatusOK,
 		},
-		"Basic Upload": {checkDir: defaultApp},
+		"Basic Upload": {checkDir: defaultApp, wantWindow: "0"},
 		"Ubuntu Report backwards compatibility": {
 			method:      http.MethodPost,
 			path:        "/distribution/desktop/version",
@@ -198,6 +255,31 @@ func TestRunSingle(t *testing.T) {
 			wantStatus: http.StatusOK,
 		},
 
+		"Upload on SO_REUSEPORT listeners": {
+			dConf: func() webservice.StaticConfig {
+				d := *defaultDaemonConfig
+				d.ReusePort = true
+				d.Listeners = 4
+				return d
+			}(),
+		},
+		"Upload on one SO_REUSEPORT listener per CPU": {
+			dConf: func() webservice.StaticConfig {
+				d := *defaultDaemonConfig
+				d.ReusePort = true
+				return d
+			}(),
+		},
+
+		"Upload shed under free space watermark": {
+			dConf: func() webservice.StaticConfig {
+				d := *defaultDaemonConfig
+				d.MinFreeBytes = 1 << 62
+				return d
+			}(),
+			wantStatus: http.StatusServiceUnavailable,
+		},
+
 		// Bad Requests
 		"Bad App StatusForbidden": {
 			path:       "/upload/badapp",
@@ -300,6 +382,9 @@ func TestRunSingle(t *testing.T) {
 			defer resp.Body.Close()
 
 			assert.Equal(t, tc.wantStatus, resp.StatusCode, "status")
+			if tc.wantWindow != "" {
+				assert.Equal(t, tc.wantWindow, resp.Header.Get(pacing.WindowHeader), "Unexpected upload window")
+			}
 
 			// Check files and file content, ignore uuid name
 			if tc.checkDir != "" {
@@ -318,6 +403,211 @@ func TestRunSingle(t *testing.T) {
 	}
 }
 
+func TestRequestTimeout(t *testing.T) {
+	t.Parallel()
+	const app = "goodapp"
+
+	tests := map[string]struct {
+		stall bool // stall is true if the client stops sending its report midway.
+
+		wantStatus int
+	}{
+		"Serves requests completing in time":            {wantStatus: http.StatusAccepted},
+		"Answers unavailable when the body is too slow": {stall: true, wantStatus: http.StatusServiceUnavailable},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dConf := *defaultDaemonConfig
+			dConf.RequestTimeout = 200 * time.Millisecond
+			s := createServerAndWaitReady(t, &testConfigManager{allowList: []string{app}}, &dConf, false)
+
+			var body io.Reader = strings.NewReader(`{"foo":"bar"}`)
+			if tc.stall {
+				pr, pw := io.Pipe()
+				t.Cleanup(func() { pw.Close() })
+				go func() { _, _ = pw.Write([]byte(`{"foo":`)) }()
+				body = pr
+			}
+			req, err := http.NewRequest(http.MethodPost, "http://"+s.PrimaryAddr().String()+"/upload/"+app, body)
+			require.NoError(t, err, "Setup: failed to create request")
+
+			start := time.Now()
+			resp, err := http.DefaultClient.Do(req)
+			require.NoError(t, err, "Request should get an answer")
+			defer resp.Body.Close()
+
+			assert.Equal(t, tc.wantStatus, resp.StatusCode, "Unexpected status response")
+			assert.Less(t, time.Since(start), 2*time.Second, "Request should not outlive the request timeout by much")
+
+			files, err := os.ReadDir(filepath.Join(dConf.ReportsDir, app))
+			if tc.stall {
+				assert.Empty(t, files, "Timed out reports should not be saved")
+				return
+			}
+			require.NoError(t, err, "Reports directory should exist")
+			assert.Len(t, files, 1, "Report should be saved")
+		})
+	}
+}
+
+func TestRateLimit(t *testing.T) {
+	t.Parallel()
+
+	tests := map[string]struct {
+		app string
+
+		wantStatuses []int
+	}{
+		"Limits clients past the default budget": {
+			app:          "goodapp",
+			wantStatuses: []int{http.StatusAccepted, http.StatusAccepted, http.StatusTooManyRequests},
+		},
+		"Limits clients past the budget of the app": {
+			app:          "strictapp",
+			wantStatuses: []int{http.StatusAccepted, http.StatusTooManyRequests},
+		},
+		"Does not limit clients of apps without budget": {
+			app:          "unlimitedapp",
+			wantStatuses: []int{http.StatusAccepted, http.StatusAccepted, http.StatusAccepted},
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dConf := *defaultDaemonConfig
+			dConf.RateLimit = 0.001
+			dConf.RateBurst = 2
+			cm := &testConfigManager{
+				allowList: []string{"goodapp", "strictapp", "unlimitedapp"},
+				rateLimits: map[string]config.RateLimit{
+					"strictapp":    {Rate: 0.001, Burst: 1},
+					"unlimitedapp": {},
+				},
+			}
+			s := createServerAndWaitReady(t, cm, &dConf, false)
+
+			for i, want := range tc.wantStatuses {
+				resp, err := http.Post("http://"+s.PrimaryAddr().String()+"/upload/"+tc.app, "application/json", strings.NewReader(`{"foo":"bar"}`))
+				require.NoError(t, err, "Request should get an answer")
+				resp.Body.Close()
+
+				assert.Equal(t, want, resp.StatusCode, "Unexpected status response to request %d", i)
+				if want != http.StatusTooManyRequests {
+					continue
+				}
+				retryAfter, ok := pacing.RetryAfter(resp.Header, time.Now())
+				assert.True(t, ok, "Rate limited requests should be asked to retry later")
+				assert.Greater(t, retryAfter, time.Minute, "Rate limited requests should wait for their budget to refill")
+			}
+		})
+	}
+}
+
+func TestServeHTTP2(t *testing.T) {
+	t.Parallel()
+
+	const (
+		app     = "goodapp"
+		uploads = 3
+	)
+
+	tests := map[string]struct {
+		tls         bool
+		h2c         bool
+		setProtocol func(*http.Protocols, bool) // setProtocol enables the only protocol the client speaks.
+
+		wantProtoMajor int
+	}{
+		"HTTP/1 in cleartext": {
+			setProtocol:    (*http.Protocols).SetHTTP1,
+			wantProtoMajor: 1,
+		},
+		"HTTP/1 alongside h2c": {
+			h2c:            true,
+			setProtocol:    (*http.Protocols).SetHTTP1,
+			wantProtoMajor: 1,
+		},
+		"HTTP/2 in cleartext with h2c": {
+			h2c:            true,
+			setProtocol:    (*http.Protocols).SetUnencryptedHTTP2,
+			wantProtoMajor: 2,
+		},
+		"HTTP/1 over TLS": {
+			tls:            true,
+			setProtocol:    (*http.Protocols).SetHTTP1,
+			wantProtoMajor: 1,
+		},
+		"HTTP/2 over TLS": {
+			tls:            true,
+			setProtocol:    (*http.Protocols).SetHTTP2,
+			wantProtoMajor: 2,
+		},
+	}
+
+	for name, tc := range tests {
+		t.Run(name, func(t *testing.T) {
+			t.Parallel()
+
+			dConf := *defaultDaemonConfig
+			dConf.H2C = tc.h2c
+			// Fewer streams than concurrent uploads are allowed by connection.
+			dConf.HTTP2MaxStreams = 2
+			dConf.HTTP2ConnWindow = 1 << 18
+			dConf.HTTP2StreamWindow = 1 << 17
+			if tc.tls {
+				dConf.TLSCertFile, dConf.TLSKeyFile = writeTestCertificate(t, t.TempDir())
+			}
+			s := createServerAndWaitReady(t, &testConfigManager{allowList: []string{app}}, &dConf, false)
+
+			protocols := new(http.Protocols)
+			tc.setProtocol(protocols, true)
+			client, scheme := newTestClient(t, &dConf, protocols)
+
+			type result struct {
+				status     int
+				protoMajor int
+			}
+			results := make([]result, uploads)
+			var wg sync.WaitGroup
+			for i := range uploads {
+				wg.Go(func() {
+					resp, err := client.Post(scheme+"://"+s.PrimaryAddr().String()+"/upload/"+app, "application/json", strings.NewReader(`{"foo":"bar"}`))
+					if !assert.NoError(t, err, "Request %d should get an answer", i) {
+						return
+					}
+					resp.Body.Close()
+					results[i] = result{status: resp.StatusCode, protoMajor: resp.ProtoMajor}
+				})
+			}
+			wg.Wait()
+
+			for i, r := range results {
+				assert.Equal(t, http.StatusAccepted, r.status, "Unexpected status response to request %d", i)
+				assert.Equal(t, tc.wantProtoMajor, r.protoMajor, "Unexpected protocol of the response to request %d", i)
+			}
+			files, err := os.ReadDir(filepath.Join(dConf.ReportsDir, app))
+			require.NoError(t, err, "Reports directory should exist")
+			assert.Len(t, files, uploads, "Reports should all be saved")
+
+			if tc.wantProtoMajor != 2 {
+				return
+			}
+			resp, err := http.Get("http://" + s.MetricsAddr().String() + "/metrics")
+			require.NoError(t, err, "Metrics should be served")
+			defer resp.Body.Close()
+			m, err := io.ReadAll(resp.Body)
+			require.NoError(t, err, "Metrics should be readable")
+			assert.Contains(t, string(m), fmt.Sprintf(`http_server_streams_total{protocol="HTTP/2.0"} %d`, uploads),
+				"Uploads should be counted as HTTP/2 streams")
+		})
+	}
+}
+
 func TestRunAfterQuitErrors(t *testing.T) {
 	t.Parallel()
 
@@ -347,6 +637,7 @@ func TestRunAfterQuitErrors(t *testing.T) {
 
 type testConfigManager struct {
 	allowList     []string
+	rateLimits    map[string]config.RateLimit
 	finishWatch   bool
 	loadErr       error
 	newWatcherErr error
@@ -401,6 +692,10 @@ func (t testConfigManager) IsAllowed(name string) bool {
 	return ok
 }
 
+func (t testConfigManager) RateLimits() map[string]config.RateLimit {
+	return t.rateLimits
+}
+
 func newForTest(t *testing.T, cm *testConfigManager, daemonConfig *webservice.StaticConfig) *webservice.Server {
 	t.Helper()
 
@@ -443,15 +738,17 @@ func createServerAndWaitReady(t *testing.T, cm *testConfigManager, daemonConfig
 		require.NoError(t, err, "Run should not fail")
 	case <-time.After(1 * time.Second):
 		require.False(t, expectErr, "Expected Run to fail with error, but it did not")
-		waitServerReady(t, s)
+		waitServerReady(t, s, daemonConfig)
 	}
 
 	return s
 }
 
-func waitServerReady(t *testing.T, s *webservice.Server) {
+func waitServerReady(t *testing.T, s *webservice.Server, daemonConfig *webservice.StaticConfig) {
 	t.Helper()
 
+	client, scheme := newTestClient(t, daemonConfig, nil)
+
 	const (
 		timeout  = 5 * time.Second
 		interval = 50 * time.Millisecond
@@ -459,7 +756,7 @@ func waitServerReady(t *testing.T, s *webservice.Server) {
 
 	deadline := time.Now().Add(timeout)
 	for time.Now().Before(deadline) {
-		resp, err := http.Get("http://" + s.PrimaryAddr().String() + "/version")
+		resp, err := client.Get(scheme + "://" + s.PrimaryAddr().String() + "/version")
 		if err == nil && resp.StatusCode == http.StatusOK {
 			resp.Body.Close()
 
@@ -475,3 +772,54 @@ func waitServerReady(t *testing.T, s *webservice.Server) {
 
 	require.True(t, time.Now().Before(deadline), "Setup: Server did not become ready in time")
 }
+
+// newTestClient returns a client of the primary server configured by daemonConfig, trusting its certificate if it
+// serves TLS, and the scheme of its URLs. The client only speaks protocols if set.
+func newTestClient(t *testing.T, daemonConfig *webservice.StaticConfig, protocols *http.Protocols) (*http.Client, string) {
+	t.Helper()
+
+	tr := &http.Transport{Protocols: protocols}
+	t.Cleanup(tr.CloseIdleConnections)
+	if daemonConfig.TLSCertFile == "" {
+		return &http.Client{Transport: tr}, "http"
+	}
+
+	cert, err := os.ReadFile(daemonConfig.TLSCertFile)
+	require.NoError(t, err, "Setup: failed to read TLS certificate")
+	roots := x509.NewCertPool()
+	require.True(t, roots.AppendCertsFromPEM(cert), "Setup: failed to parse TLS certificate")
+	tr.TLSClientConfig = &tls.Config{RootCAs: roots, MinVersion: tls.VersionTLS12}
+	return &http.Client{Transport: tr}, "https"
+}
+
+// writeTestCertificate writes a self-signed certificate for the local host and its key in dir, returning their paths.
+func writeTestCertificate(t *testing.T, dir string) (certFile, keyFile string) {
+	t.Helper()
+
+	key, err := ecdsa.GenerateKey(elliptic.P256(), rand.Reader)
+	require.NoError(t, err, "Setup: failed to generate key")
+	tmpl := &x509.Certificate{
+		SerialNumber:          big.NewInt(1),
+		Subject:               pkix.Name{CommonName: "localhost"},
+		DNSNames:              []string{"localhost"},
+		IPAddresses:           []net.IP{net.IPv4(127, 0, 0, 1), net.IPv6loopback},
+		NotBefore:             time.Now().Add(-time.Hour),
+		NotAfter:              time.Now().Add(time.Hour),
+		KeyUsage:              x509.KeyUsageDigitalSignature | x509.KeyUsageCertSign,
+		ExtKeyUsage:           []x509.ExtKeyUsage{x509.ExtKeyUsageServerAuth},
+		BasicConstraintsValid: true,
+		IsCA:                  true,
+	}
+	cert, err := x509.CreateCertificate(rand.Reader, tmpl, tmpl, &key.PublicKey, key)
+	require.NoError(t, err, "Setup: failed to create certificate")
+	keyDER, err := x509.MarshalECPrivateKey(key)
+	require.NoError(t, err, "Setup: failed to marshal key")
+
+	certFile = filepath.Join(dir, "cert.pem")
+	keyFile = filepath.Join(dir, "key.pem")
+	require.NoError(t, os.WriteFile(certFile, pem.EncodeToMemory(&pem.Block{Type: "CERTIFICATE", Bytes: cert}), 0600),
+		"Setup: failed to write certificate")
+	require.NoError(t, os.WriteFile(keyFile, pem.EncodeToMemory(&pem.Block{Type: "EC PRIVATE KEY", Bytes: keyDER}), 0600),
+		"Setup: failed to write key")
+	return certFile, keyFile
+}